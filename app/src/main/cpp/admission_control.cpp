@@ -0,0 +1,273 @@
+/**
+ * Admission Control - Implementation
+ */
+
+#include "admission_control.h"
+#include "async_log.h"
+#include "stream_metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#define LOG_TAG "PoiseAdmission"
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) POISE_LOG(poise::LOG_WARN, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+constexpr float DEFAULT_TARGET_UTILIZATION = 0.75f;
+// Streams need this many frames before their own average is trusted
+constexpr uint64_t MIN_MEASURED_FRAMES = 200;
+// Time constant of the cost estimates: a 500 ms gap moves them a quarter
+// of the way to the measurement, however often refreshLocked runs
+constexpr float COST_TIME_CONSTANT_MS = 1740.0f;
+// Process CPU time is sampled at most this often
+constexpr int64_t SAMPLE_INTERVAL_MS = 500;
+// A grant not consumed by a constructor within this time is dropped
+constexpr int64_t GRANT_TIMEOUT_MS = 5000;
+
+int64_t monotonicMs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+int64_t processCpuUs() {
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  return (static_cast<int64_t>(usage.ru_utime.tv_sec) +
+          usage.ru_stime.tv_sec) *
+             1000000 +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+const char *const DECISION_NAMES[AdmissionController::NUM_DECISIONS] = {
+    "admit", "downgrade", "reject"};
+
+} // anonymous namespace
+
+AdmissionController &AdmissionController::instance() {
+  static AdmissionController controller;
+  return controller;
+}
+
+AdmissionController::AdmissionController()
+    : models_{// Priors until streams of the model have been measured
+              {"legacy", 10.0f, 0.30f, 0.0f, 0, 0},
+              {"gtcrn", 16.0f, 0.10f, 0.0f, 0, 0}},
+      targetUtilization_(DEFAULT_TARGET_UTILIZATION),
+      onlineCores_(std::max(1L, sysconf(_SC_NPROCESSORS_ONLN))),
+      lastSampleMs_(monotonicMs()), lastCpuUs_(processCpuUs()),
+      lastCostMs_(lastSampleMs_), utilizationCores_(0.0f),
+      streamLoadCores_(0.0f) {}
+
+const char *AdmissionController::modelName(int index) {
+  return (index >= 0 && index < NUM_MODELS) ? instance().models_[index].name
+                                            : "";
+}
+
+const char *AdmissionController::decisionName(int decision) {
+  return (decision >= 0 && decision < NUM_DECISIONS) ? DECISION_NAMES[decision]
+                                                     : "";
+}
+
+int AdmissionController::modelIndex(const char *model) const {
+  if (model == nullptr) {
+    return -1;
+  }
+  for (int i = 0; i < NUM_MODELS; i++) {
+    if (std::strcmp(models_[i].name, model) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void AdmissionController::refreshLocked(int64_t nowMs) {
+  int64_t elapsedMs = nowMs - lastSampleMs_;
+  if (elapsedMs >= SAMPLE_INTERVAL_MS) {
+    int64_t cpuUs = processCpuUs();
+    utilizationCores_ = static_cast<float>(cpuUs - lastCpuUs_) /
+                        (static_cast<float>(elapsedMs) * 1000.0f);
+    lastCpuUs_ = cpuUs;
+    lastSampleMs_ = nowMs;
+  }
+
+  double sumMs[NUM_MODELS] = {};
+  uint64_t frames[NUM_MODELS] = {};
+  uint64_t bypassed[NUM_MODELS] = {};
+  float load = 0.0f;
+
+  auto &registry = MetricsRegistry::instance();
+  for (int i = 0; i < MetricsRegistry::MAX_STREAMS; i++) {
+    const StreamMetrics &m = registry.slot(i);
+    if (!m.inUse.load(std::memory_order_acquire)) {
+      continue;
+    }
+    // Daemon slots time the same work as the gtcrn stream serving them
+    int model = modelIndex(m.model.load(std::memory_order_acquire));
+    if (model < 0) {
+      continue;
+    }
+    uint64_t total = m.framesTotal.load(std::memory_order_relaxed);
+    if (total < MIN_MEASURED_FRAMES) {
+      load += models_[model].costCores;
+      continue;
+    }
+    double streamMs = m.inferenceLatency.sumMs();
+    load += static_cast<float>(streamMs / total) / models_[model].frameMs;
+    sumMs[model] += streamMs;
+    frames[model] += total;
+    bypassed[model] += m.framesBypassed.load(std::memory_order_relaxed) +
+                       m.neuralVadBypassed.load(std::memory_order_relaxed);
+  }
+
+  // Back-to-back calls (a burst of stream starts) must not count as many
+  // independent samples of the same averages
+  float smoothing =
+      1.0f - std::exp(-static_cast<float>(nowMs - lastCostMs_) /
+                      COST_TIME_CONSTANT_MS);
+  lastCostMs_ = nowMs;
+
+  for (int i = 0; i < NUM_MODELS; i++) {
+    ModelCost &cost = models_[i];
+    if (cost.pendingGrants > 0 && nowMs > cost.grantExpiryMs) {
+      cost.pendingGrants = 0;
+    }
+    load += cost.pendingGrants * cost.costCores;
+    if (frames[i] == 0) {
+      continue;
+    }
+    float measured = static_cast<float>(sumMs[i] / frames[i]) / cost.frameMs;
+    float ratio = std::min(1.0f, static_cast<float>(bypassed[i]) / frames[i]);
+    cost.costCores += smoothing * (measured - cost.costCores);
+    cost.bypassRatio += smoothing * (ratio - cost.bypassRatio);
+  }
+  streamLoadCores_ = load;
+}
+
+AdmissionResult AdmissionController::decideLocked(int model, int fallback) {
+  AdmissionResult result;
+  result.budgetCores = targetUtilization_ * onlineCores_;
+  float current = std::max(utilizationCores_, streamLoadCores_);
+
+  // The first stream always runs; there is nothing to protect yet
+  bool idle = streamLoadCores_ <= 0.0f;
+  int granted = -1;
+  if (idle || current + models_[model].costCores <= result.budgetCores) {
+    granted = model;
+    result.decision = AdmissionDecision::ADMIT;
+  } else if (fallback >= 0 &&
+             current + models_[fallback].costCores <= result.budgetCores) {
+    granted = fallback;
+    result.decision = AdmissionDecision::DOWNGRADE;
+  } else {
+    result.decision = AdmissionDecision::REJECT;
+  }
+
+  int decision = static_cast<int>(result.decision);
+  decisions_[model][decision].fetch_add(1, std::memory_order_relaxed);
+  result.projectedCores =
+      current + (granted >= 0 ? models_[granted].costCores
+                              : models_[model].costCores);
+  if (granted >= 0) {
+    result.model = models_[granted].name;
+  }
+
+  if (result.decision == AdmissionDecision::ADMIT) {
+    LOGI("Admitted %s stream: %.2f of %.2f cores projected",
+         models_[model].name, result.projectedCores, result.budgetCores);
+  } else {
+    LOGW("%s %s stream: %.2f of %.2f cores projected (%.2f measured)",
+         decision == 1 ? "Downgraded" : "Rejected", models_[model].name,
+         result.projectedCores, result.budgetCores, utilizationCores_);
+  }
+  return result;
+}
+
+AdmissionResult AdmissionController::request(const char *model,
+                                             const char *fallback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int index = modelIndex(model);
+  if (index < 0 || !enabled_.load(std::memory_order_relaxed)) {
+    // Unknown models are not accounted; let them through
+    AdmissionResult result;
+    result.model = model;
+    return result;
+  }
+
+  int64_t nowMs = monotonicMs();
+  refreshLocked(nowMs);
+  AdmissionResult result = decideLocked(index, modelIndex(fallback));
+  int granted = modelIndex(result.model);
+  if (granted >= 0) {
+    models_[granted].pendingGrants++;
+    models_[granted].grantExpiryMs = nowMs + GRANT_TIMEOUT_MS;
+  }
+  return result;
+}
+
+bool AdmissionController::acquire(const char *model) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int index = modelIndex(model);
+  if (index < 0 || !enabled_.load(std::memory_order_relaxed)) {
+    return true;
+  }
+
+  int64_t nowMs = monotonicMs();
+  ModelCost &cost = models_[index];
+  if (cost.pendingGrants > 0 && nowMs <= cost.grantExpiryMs) {
+    cost.pendingGrants--;
+    return true;
+  }
+  refreshLocked(nowMs);
+  return decideLocked(index, -1).decision != AdmissionDecision::REJECT;
+}
+
+void AdmissionController::release(const char *model) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int index = modelIndex(model);
+  if (index < 0 || !enabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  ModelCost &cost = models_[index];
+  cost.pendingGrants++;
+  cost.grantExpiryMs = monotonicMs() + GRANT_TIMEOUT_MS;
+}
+
+void AdmissionController::setTargetUtilization(float fraction) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  targetUtilization_ = std::max(0.05f, std::min(fraction, 1.0f));
+}
+
+AdmissionStats AdmissionController::getStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  refreshLocked(monotonicMs());
+  AdmissionStats stats;
+  stats.utilizationCores = utilizationCores_;
+  stats.streamLoadCores = streamLoadCores_;
+  stats.budgetCores = targetUtilization_ * onlineCores_;
+  stats.onlineCores = onlineCores_;
+  return stats;
+}
+
+float AdmissionController::streamCost(const char *model) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int index = modelIndex(model);
+  return index >= 0 ? models_[index].costCores : -1.0f;
+}
+
+float AdmissionController::bypassRatio(const char *model) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int index = modelIndex(model);
+  return index >= 0 ? models_[index].bypassRatio : 0.0f;
+}
+
+} // namespace poise
@@ -0,0 +1,128 @@
+/**
+ * Admission Control - Header
+ *
+ * Decides whether a new stream fits in the CPU before it is created. The
+ * cost of a stream is estimated per model from the inference time and
+ * bypass ratio of live streams (inference time summed over all frames, so
+ * VAD-bypassed frames lower the average), and the current load is the
+ * larger of the process CPU utilization and the summed estimate of all
+ * live streams. A stream is admitted if it fits under the target, admitted
+ * on its fallback model if only that fits, and rejected otherwise.
+ *
+ * Callers that can downgrade ask first with request(); the grant is then
+ * consumed by the native stream constructor through acquire(). Callers
+ * that reach the constructor without a grant get a decision without a
+ * fallback.
+ */
+
+#ifndef ADMISSION_CONTROL_H
+#define ADMISSION_CONTROL_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace poise {
+
+enum class AdmissionDecision : int {
+  ADMIT = 0,
+  DOWNGRADE = 1, // Admitted on the fallback model
+  REJECT = 2,
+};
+
+struct AdmissionResult {
+  AdmissionDecision decision = AdmissionDecision::ADMIT;
+  const char *model = nullptr; // Model granted, nullptr if rejected
+  float projectedCores = 0.0f; // Load including the granted stream
+  float budgetCores = 0.0f;
+};
+
+struct AdmissionStats {
+  float utilizationCores = 0.0f; // Measured process CPU use
+  float streamLoadCores = 0.0f;  // Summed estimate of live streams
+  float budgetCores = 0.0f;
+  int onlineCores = 0;
+};
+
+class AdmissionController {
+public:
+  static constexpr int NUM_MODELS = 2;
+  static constexpr int NUM_DECISIONS = 3;
+
+  static AdmissionController &instance();
+
+  /**
+   * Decide on a new stream of model, optionally falling back to a
+   * cheaper one. The granted model must then be created with acquire().
+   */
+  AdmissionResult request(const char *model, const char *fallback = nullptr);
+
+  /**
+   * Called by stream constructors. Consumes a pending grant for model if
+   * there is one, otherwise decides without a fallback.
+   * @return false if the stream must not be created
+   */
+  bool acquire(const char *model);
+
+  /**
+   * Undo a successful acquire() whose stream could not be constructed. The
+   * admission is handed back as a pending grant, so a retry is not decided
+   * again and an abandoned one expires like any other grant.
+   */
+  void release(const char *model);
+
+  // Fraction of the online cores streams may use together
+  void setTargetUtilization(float fraction);
+  // While disabled every stream is admitted and nothing is counted
+  void setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  AdmissionStats getStats();
+
+  // Estimated cores one stream of model uses, -1 for unknown models
+  float streamCost(const char *model);
+  // Fraction of frames bypassed across live and past streams of model
+  float bypassRatio(const char *model);
+
+  static const char *modelName(int index);
+  static const char *decisionName(int decision);
+  uint64_t decisionCount(int model, int decision) const {
+    return decisions_[model][decision].load(std::memory_order_relaxed);
+  }
+
+private:
+  AdmissionController();
+
+  struct ModelCost {
+    const char *name;
+    float frameMs;
+    float costCores;   // Running estimate
+    float bypassRatio; // Running estimate
+    int pendingGrants;
+    int64_t grantExpiryMs;
+  };
+
+  int modelIndex(const char *model) const;
+  void refreshLocked(int64_t nowMs);
+  AdmissionResult decideLocked(int model, int fallback);
+
+  std::mutex mutex_;
+  ModelCost models_[NUM_MODELS];
+  float targetUtilization_;
+  int onlineCores_;
+
+  // Process CPU time sampling
+  int64_t lastSampleMs_;
+  int64_t lastCpuUs_;
+  int64_t lastCostMs_; // Last cost estimate update
+  float utilizationCores_;
+  float streamLoadCores_;
+
+  std::atomic<bool> enabled_{true};
+  std::atomic<uint64_t> decisions_[NUM_MODELS][NUM_DECISIONS] = {};
+};
+
+} // namespace poise
+
+#endif // ADMISSION_CONTROL_H
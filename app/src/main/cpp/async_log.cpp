@@ -0,0 +1,466 @@
+/**
+ * Asynchronous Logging - Implementation
+ */
+
+#include "async_log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <linux/futex.h>
+#include <mutex>
+#include <string>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
+
+namespace poise {
+
+namespace {
+
+constexpr uint32_t RING_CAPACITY = 128; // Power of two
+// A ring this full wakes the writer before the flush interval is up
+constexpr uint32_t HIGH_WATER = RING_CAPACITY / 2;
+constexpr int FLUSH_INTERVAL_MS = 20;
+constexpr size_t LINE_BYTES = 1024;
+
+uint64_t nowNs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+/**
+ * SPSC ring owned by one producer thread; the writer is the consumer.
+ * Retired rings are freed by the writer once drained.
+ */
+struct ThreadRing {
+  LogRecord slots[RING_CAPACITY];
+  std::atomic<uint32_t> head{0};
+  std::atomic<uint32_t> tail{0};
+  std::atomic<bool> retired{false};
+  uint32_t threadId = 0;
+};
+
+/**
+ * What the writer thread is doing, which decides when a producer wakes it:
+ * IDLE sleeps until the next record anywhere, BATCHING collects records for
+ * up to FLUSH_INTERVAL_MS unless a ring reaches HIGH_WATER.
+ */
+enum WriterState : uint32_t {
+  WRITER_RUNNING,
+  WRITER_IDLE,
+  WRITER_BATCHING,
+};
+
+struct LogState {
+  std::mutex mutex; // Ring list and sink; never taken by a producer's log call
+  std::vector<ThreadRing *> rings;
+  std::vector<LogRecord> batch;
+
+  // Futex word the writer sleeps on; producers bump it to wake the writer
+  std::atomic<uint32_t> wakeSeq{0};
+  std::atomic<uint32_t> writerState{WRITER_RUNNING};
+
+  LogSink sink =
+#ifdef __ANDROID__
+      LogSink::LOGCAT;
+#else
+      LogSink::STDERR;
+#endif
+  FILE *file = nullptr;
+
+  std::atomic<uint8_t> minLevel{LOG_DEBUG};
+  std::atomic<uint64_t> dropped{0};
+  uint64_t droppedReported = 0;
+  std::once_flag writerStarted;
+};
+
+LogState &state() {
+  // Leaked on purpose: producers may log during static destruction
+  static LogState *instance = new LogState();
+  return *instance;
+}
+
+struct RingHolder {
+  ThreadRing *ring = nullptr;
+  ~RingHolder() {
+    if (ring != nullptr) {
+      ring->retired.store(true, std::memory_order_release);
+    }
+  }
+};
+
+thread_local RingHolder ringHolder;
+
+char levelChar(uint8_t level) {
+  switch (level) {
+  case LOG_DEBUG:
+    return 'D';
+  case LOG_INFO:
+    return 'I';
+  case LOG_WARN:
+    return 'W';
+  case LOG_ERROR:
+    return 'E';
+  default:
+    return '?';
+  }
+}
+
+/**
+ * printf-style formatting from captured arguments. Each conversion is
+ * rewritten to a fixed argument width ("ll" for integers, double for
+ * floats) and formatted on its own.
+ */
+size_t formatRecord(const LogRecord &record, char *out, size_t capacity) {
+  size_t length = 0;
+  int argIndex = 0;
+  const char *p = record.format;
+
+  auto append = [&](const char *text, size_t n) {
+    size_t room = length < capacity - 1 ? capacity - 1 - length : 0;
+    n = std::min(n, room);
+    std::memcpy(out + length, text, n);
+    length += n;
+  };
+
+  while (*p != '\0') {
+    if (*p != '%') {
+      const char *next = std::strchr(p, '%');
+      size_t n = next != nullptr ? static_cast<size_t>(next - p)
+                                 : std::strlen(p);
+      append(p, n);
+      p += n;
+      continue;
+    }
+    if (p[1] == '%') {
+      append("%", 1);
+      p += 2;
+      continue;
+    }
+
+    // %[flags][width][.precision][length]conversion
+    char spec[32];
+    size_t specLen = 0;
+    spec[specLen++] = *p++;
+    while (*p != '\0' && std::strchr("-+ #0123456789.", *p) != nullptr &&
+           specLen < sizeof(spec) - 4) {
+      spec[specLen++] = *p++;
+    }
+    while (*p != '\0' && std::strchr("hljztL", *p) != nullptr) {
+      p++;
+    }
+    char conversion = *p;
+    if (conversion == '\0') {
+      break;
+    }
+    p++;
+
+    char piece[128];
+    int n = 0;
+    uint8_t type = argIndex < record.argCount
+                       ? record.argTypes[argIndex]
+                       : static_cast<uint8_t>(LOG_ARG_POINTER);
+    uint64_t raw = argIndex < record.argCount ? record.args[argIndex] : 0;
+    bool haveArg = argIndex < record.argCount;
+    argIndex++;
+
+    if (!haveArg) {
+      n = std::snprintf(piece, sizeof(piece), "<?>");
+    } else if (std::strchr("diuoxXc", conversion) != nullptr) {
+      if (conversion == 'c') {
+        spec[specLen++] = 'c';
+        spec[specLen] = '\0';
+        n = std::snprintf(piece, sizeof(piece), spec, static_cast<int>(raw));
+      } else {
+        spec[specLen++] = 'l';
+        spec[specLen++] = 'l';
+        spec[specLen++] = conversion;
+        spec[specLen] = '\0';
+        if (type == LOG_ARG_DOUBLE) {
+          double d;
+          std::memcpy(&d, &raw, sizeof(d));
+          raw = static_cast<uint64_t>(static_cast<int64_t>(d));
+        }
+        if (conversion == 'd' || conversion == 'i') {
+          n = std::snprintf(piece, sizeof(piece), spec,
+                            static_cast<long long>(raw));
+        } else {
+          n = std::snprintf(piece, sizeof(piece), spec,
+                            static_cast<unsigned long long>(raw));
+        }
+      }
+    } else if (std::strchr("fFeEgGaA", conversion) != nullptr) {
+      spec[specLen++] = conversion;
+      spec[specLen] = '\0';
+      double d;
+      if (type == LOG_ARG_DOUBLE) {
+        std::memcpy(&d, &raw, sizeof(d));
+      } else if (type == LOG_ARG_INT) {
+        d = static_cast<double>(static_cast<int64_t>(raw));
+      } else {
+        d = static_cast<double>(raw);
+      }
+      n = std::snprintf(piece, sizeof(piece), spec, d);
+    } else if (conversion == 's') {
+      spec[specLen++] = 's';
+      spec[specLen] = '\0';
+      const char *text = type == LOG_ARG_STRING && raw < LogRecord::STRING_BYTES
+                             ? record.strings + raw
+                             : "<?>";
+      n = std::snprintf(piece, sizeof(piece), spec, text);
+    } else if (conversion == 'p') {
+      n = std::snprintf(piece, sizeof(piece), "%p",
+                        reinterpret_cast<void *>(static_cast<uintptr_t>(raw)));
+    } else {
+      n = std::snprintf(piece, sizeof(piece), "%%%c", conversion);
+    }
+
+    if (n > 0) {
+      append(piece, std::min(static_cast<size_t>(n), sizeof(piece) - 1));
+    }
+  }
+
+  out[length] = '\0';
+  return length;
+}
+
+void writeLine(LogState &s, uint8_t level, const char *tag, uint32_t threadId,
+               const char *message) {
+  switch (s.sink) {
+  case LogSink::LOGCAT:
+#ifdef __ANDROID__
+    __android_log_write(level, tag, message);
+    break;
+#endif
+  case LogSink::STDERR:
+    std::fprintf(stderr, "%c/%s(%u): %s\n", levelChar(level), tag, threadId,
+                 message);
+    break;
+  case LogSink::FILE:
+    if (s.file != nullptr) {
+      std::fprintf(s.file, "%c/%s(%u): %s\n", levelChar(level), tag, threadId,
+                   message);
+    }
+    break;
+  }
+}
+
+// Caller holds s.mutex
+void drainLocked(LogState &s) {
+  s.batch.clear();
+
+  for (auto it = s.rings.begin(); it != s.rings.end();) {
+    ThreadRing *ring = *it;
+    bool retired = ring->retired.load(std::memory_order_acquire);
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint32_t head = ring->head.load(std::memory_order_acquire);
+    for (; tail != head; tail++) {
+      s.batch.push_back(ring->slots[tail & (RING_CAPACITY - 1)]);
+    }
+    ring->tail.store(tail, std::memory_order_release);
+
+    if (retired) {
+      delete ring;
+      it = s.rings.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // Interleave threads in capture order
+  std::stable_sort(s.batch.begin(), s.batch.end(),
+                   [](const LogRecord &a, const LogRecord &b) {
+                     return a.timeNs < b.timeNs;
+                   });
+
+  char line[LINE_BYTES];
+  for (const LogRecord &record : s.batch) {
+    formatRecord(record, line, sizeof(line));
+    writeLine(s, record.level, record.tag, record.threadId, line);
+  }
+
+  uint64_t dropped = s.dropped.load(std::memory_order_relaxed);
+  if (dropped != s.droppedReported) {
+    std::snprintf(line, sizeof(line), "%llu log records dropped (total %llu)",
+                  static_cast<unsigned long long>(dropped - s.droppedReported),
+                  static_cast<unsigned long long>(dropped));
+    writeLine(s, LOG_WARN, "PoiseLog", 0, line);
+    s.droppedReported = dropped;
+  }
+
+  if (s.sink == LogSink::FILE && s.file != nullptr) {
+    std::fflush(s.file);
+  }
+}
+
+// Sleep until wakeSeq moves off seq (or timeoutMs passes, if >= 0)
+void futexWait(std::atomic<uint32_t> &word, uint32_t seq, int timeoutMs) {
+  timespec timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE,
+          seq, timeoutMs >= 0 ? &timeout : nullptr, nullptr, 0);
+}
+
+// Caller holds s.mutex
+bool anyPendingLocked(LogState &s) {
+  for (ThreadRing *ring : s.rings) {
+    if (ring->head.load(std::memory_order_acquire) !=
+            ring->tail.load(std::memory_order_relaxed) ||
+        ring->retired.load(std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return s.dropped.load(std::memory_order_relaxed) != s.droppedReported;
+}
+
+/**
+ * Sleeps without a timeout while nothing is queued. The first record wakes
+ * it; it then lets records collect for FLUSH_INTERVAL_MS (or until a ring
+ * is half full) and writes them out in one batch.
+ */
+void writerLoop() {
+  LogState &s = state();
+  for (;;) {
+    uint32_t seq = s.wakeSeq.load(std::memory_order_acquire);
+    s.writerState.store(WRITER_IDLE, std::memory_order_relaxed);
+    // Pairs with the fence in wakeWriter(): either the producer sees IDLE
+    // or this check sees its record
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool pending;
+    {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      pending = anyPendingLocked(s);
+    }
+    if (!pending) {
+      futexWait(s.wakeSeq, seq, -1);
+    }
+
+    seq = s.wakeSeq.load(std::memory_order_acquire);
+    s.writerState.store(WRITER_BATCHING, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    futexWait(s.wakeSeq, seq, FLUSH_INTERVAL_MS);
+    s.writerState.store(WRITER_RUNNING, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    drainLocked(s);
+  }
+}
+
+// Producer side, after a commit or drop: wake a writer that is waiting for
+// this record. The only syscall a producer makes.
+void wakeWriter(uint32_t pending) {
+  LogState &s = state();
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  uint32_t writer = s.writerState.load(std::memory_order_relaxed);
+  if (writer == WRITER_RUNNING ||
+      (writer == WRITER_BATCHING && pending < HIGH_WATER)) {
+    return;
+  }
+  if (s.writerState.exchange(WRITER_RUNNING, std::memory_order_relaxed) ==
+      WRITER_RUNNING) {
+    return; // Another producer got there first
+  }
+  s.wakeSeq.fetch_add(1, std::memory_order_release);
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&s.wakeSeq),
+          FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+void startWriter() {
+  std::thread(writerLoop).detach();
+  std::atexit([] { AsyncLog::flush(); });
+}
+
+ThreadRing *threadRing() {
+  ThreadRing *ring = ringHolder.ring;
+  if (ring != nullptr) {
+    return ring;
+  }
+
+  LogState &s = state();
+  std::call_once(s.writerStarted, startWriter);
+
+  ring = new ThreadRing();
+  ring->threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.rings.push_back(ring);
+  }
+  ringHolder.ring = ring;
+  return ring;
+}
+
+} // namespace
+
+void AsyncLog::setSink(LogSink sink, const char *path) {
+  LogState &s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  drainLocked(s);
+
+  if (s.file != nullptr) {
+    std::fclose(s.file);
+    s.file = nullptr;
+  }
+  if (sink == LogSink::FILE) {
+    s.file = path != nullptr ? std::fopen(path, "ae") : nullptr;
+    if (s.file == nullptr) {
+      sink = LogSink::STDERR;
+    }
+  }
+  s.sink = sink;
+}
+
+void AsyncLog::setMinLevel(LogLevel level) {
+  state().minLevel.store(level, std::memory_order_relaxed);
+}
+
+bool AsyncLog::enabled(LogLevel level) {
+  return level >= state().minLevel.load(std::memory_order_relaxed);
+}
+
+void AsyncLog::prepareThread() { threadRing(); }
+
+void AsyncLog::flush() {
+  LogState &s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  drainLocked(s);
+}
+
+uint64_t AsyncLog::droppedRecords() {
+  return state().dropped.load(std::memory_order_relaxed);
+}
+
+LogRecord *AsyncLog::beginRecord() {
+  ThreadRing *ring = threadRing();
+  uint32_t head = ring->head.load(std::memory_order_relaxed);
+  uint32_t tail = ring->tail.load(std::memory_order_acquire);
+  if (head - tail >= RING_CAPACITY) {
+    return nullptr;
+  }
+  LogRecord *record = &ring->slots[head & (RING_CAPACITY - 1)];
+  record->timeNs = nowNs();
+  record->threadId = ring->threadId;
+  return record;
+}
+
+void AsyncLog::commitRecord(LogRecord * /*record*/) {
+  ThreadRing *ring = ringHolder.ring;
+  uint32_t head = ring->head.load(std::memory_order_relaxed) + 1;
+  ring->head.store(head, std::memory_order_release);
+  wakeWriter(head - ring->tail.load(std::memory_order_relaxed));
+}
+
+void AsyncLog::dropRecord() {
+  state().dropped.fetch_add(1, std::memory_order_relaxed);
+  wakeWriter(HIGH_WATER); // A full ring is past the high-water mark
+}
+
+} // namespace poise
@@ -0,0 +1,171 @@
+/**
+ * Asynchronous Logging - Header
+ *
+ * LOGx call sites capture the format pointer and raw arguments into a
+ * per-thread lock-free ring; a background thread formats the records and
+ * writes them to the sink (logcat, stderr or a file). Producers never
+ * format or lock after their ring exists, and make a syscall only to wake
+ * the writer: it sleeps while nothing is queued, then batches for up to
+ * 20 ms after the first record (less if a ring fills past half). Records
+ * that do not fit are dropped and counted.
+ *
+ * Format strings must be literals (they are read later); "%s" arguments
+ * are copied, truncated to STRING_BYTES in total per record.
+ */
+
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace poise {
+
+// Same values as android_LogPriority
+enum LogLevel : uint8_t {
+  LOG_DEBUG = 3,
+  LOG_INFO = 4,
+  LOG_WARN = 5,
+  LOG_ERROR = 6,
+};
+
+enum class LogSink : uint8_t {
+  LOGCAT, // Default on Android
+  STDERR, // Default elsewhere
+  FILE,
+};
+
+enum LogArgType : uint8_t {
+  LOG_ARG_INT,
+  LOG_ARG_UINT,
+  LOG_ARG_DOUBLE,
+  LOG_ARG_STRING, // Offset into LogRecord::strings
+  LOG_ARG_POINTER,
+};
+
+struct LogRecord {
+  static constexpr int MAX_ARGS = 8;
+  static constexpr int STRING_BYTES = 96;
+
+  uint64_t timeNs;
+  const char *tag;
+  const char *format;
+  uint32_t threadId;
+  uint8_t level;
+  uint8_t argCount;
+  uint8_t stringBytes;
+  uint8_t argTypes[MAX_ARGS];
+  uint64_t args[MAX_ARGS];
+  char strings[STRING_BYTES];
+};
+
+class AsyncLog {
+public:
+  // Route output; FILE appends to path. Safe to call at any time.
+  static void setSink(LogSink sink, const char *path = nullptr);
+
+  // Records below this level are discarded at the call site
+  static void setMinLevel(LogLevel level);
+  static bool enabled(LogLevel level);
+
+  /**
+   * Create the calling thread's ring ahead of time, so the first log call
+   * on a real-time thread does not allocate.
+   */
+  static void prepareThread();
+
+  // Synchronously write out everything queued so far
+  static void flush();
+
+  // Records dropped because a thread's ring was full
+  static uint64_t droppedRecords();
+
+  // Internal: claim/commit a slot in the calling thread's ring
+  static LogRecord *beginRecord();
+  static void commitRecord(LogRecord *record);
+  static void dropRecord();
+};
+
+namespace detail {
+
+inline void captureArg(LogRecord &record, int index, const char *value) {
+  record.argTypes[index] = LOG_ARG_STRING;
+  record.args[index] = record.stringBytes;
+  size_t room = LogRecord::STRING_BYTES - record.stringBytes;
+  if (room == 0) {
+    return;
+  }
+  size_t len = value != nullptr ? std::strlen(value) : 0;
+  if (len >= room) {
+    len = room - 1;
+  }
+  if (len > 0) {
+    std::memcpy(record.strings + record.stringBytes, value, len);
+  }
+  record.strings[record.stringBytes + len] = '\0';
+  record.stringBytes = static_cast<uint8_t>(record.stringBytes + len + 1);
+}
+
+inline void captureArg(LogRecord &record, int index, char *value) {
+  captureArg(record, index, static_cast<const char *>(value));
+}
+
+template <typename T>
+inline void captureArg(LogRecord &record, int index, T value) {
+  if constexpr (std::is_floating_point_v<T>) {
+    double d = static_cast<double>(value);
+    record.argTypes[index] = LOG_ARG_DOUBLE;
+    std::memcpy(&record.args[index], &d, sizeof(d));
+  } else if constexpr (std::is_pointer_v<T>) {
+    record.argTypes[index] = LOG_ARG_POINTER;
+    record.args[index] = reinterpret_cast<uintptr_t>(value);
+  } else if constexpr (std::is_signed_v<T> || std::is_enum_v<T>) {
+    record.argTypes[index] = LOG_ARG_INT;
+    record.args[index] = static_cast<uint64_t>(static_cast<int64_t>(value));
+  } else {
+    record.argTypes[index] = LOG_ARG_UINT;
+    record.args[index] = static_cast<uint64_t>(value);
+  }
+}
+
+template <typename... Args>
+inline void log(LogLevel level, const char *tag, const char *format,
+                Args... args) {
+  static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS,
+                "too many log arguments");
+  if (!AsyncLog::enabled(level)) {
+    return;
+  }
+  LogRecord *record = AsyncLog::beginRecord();
+  if (record == nullptr) {
+    AsyncLog::dropRecord();
+    return;
+  }
+  record->level = level;
+  record->tag = tag;
+  record->format = format;
+  record->argCount = static_cast<uint8_t>(sizeof...(Args));
+  record->stringBytes = 0;
+  int index = 0;
+  (captureArg(*record, index++, args), ...);
+  AsyncLog::commitRecord(record);
+}
+
+// Never called; lets the compiler check LOGx formats against arguments
+inline void checkFormat(const char *, ...) __attribute__((format(printf, 1, 2)));
+inline void checkFormat(const char *, ...) {}
+
+} // namespace detail
+
+} // namespace poise
+
+#define POISE_LOG(level, tag, ...)                                             \
+  do {                                                                         \
+    if (false) {                                                               \
+      ::poise::detail::checkFormat(__VA_ARGS__);                               \
+    }                                                                          \
+    ::poise::detail::log(level, tag, __VA_ARGS__);                             \
+  } while (0)
+
+#endif // ASYNC_LOG_H
@@ -0,0 +1,91 @@
+/**
+ * Block-Sparse Matrix-Vector Kernels - Header
+ *
+ * Weight matrices of the native recurrent layers in block compressed sparse
+ * row (BSR) form. Pruning whole blocks rather than single weights keeps the
+ * inner loops dense: a 4x4 block is four vector multiply-adds into four
+ * output rows, a 1x8 block is two into one row, so the kernel does
+ * (almost) only the arithmetic of the blocks that are kept and a 50-70%
+ * sparse matrix runs in roughly 50-30% of the dense time.
+ *
+ * Matrices are packed once when weights are loaded; multiplication is
+ * allocation-free.
+ *
+ * Only the neural VAD gate uses these kernels; it is the one network whose
+ * layers run natively. GTCRN and the legacy model run in ONNX Runtime on
+ * the Kotlin side, whose CPU kernels are dense, so pruning their GRU and
+ * linear weights would not make them faster. That needs a native engine
+ * for those models, which this tree does not have.
+ */
+
+#ifndef BLOCK_SPARSE_H
+#define BLOCK_SPARSE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace poise {
+
+enum class BlockShape : int {
+  DENSE = 0, // Plain row-major, no index
+  B4X4 = 1,  // 4 rows x 4 columns
+  B1X8 = 2,  // 1 row x 8 columns
+};
+
+const char *blockShapeName(BlockShape shape);
+
+class BlockSparseMatrix {
+public:
+  // Kept-value fraction above which the dense kernel is used instead; the
+  // block kernels pay for their index loads below about this
+  static constexpr float MAX_SPARSE_DENSITY = 0.7f;
+
+  BlockSparseMatrix() = default;
+
+  /**
+   * Pack row-major weights. Blocks that are entirely zero are dropped.
+   * Falls back to DENSE when rows/cols are not multiples of the block.
+   */
+  BlockSparseMatrix(const float *dense, int rows, int cols, BlockShape shape);
+
+  /**
+   * Pack with the block shape that stores the fewest values, or DENSE when
+   * no shape gets the density below MAX_SPARSE_DENSITY.
+   */
+  static BlockSparseMatrix pack(const float *dense, int rows, int cols);
+
+  // y += W x
+  void multiplyAccumulate(const float *x, float *y) const;
+
+  // Expand back to row-major (pruned blocks as zeros)
+  void toDense(float *dense) const;
+
+  int rows() const { return rows_; }
+  int cols() const { return cols_; }
+  BlockShape shape() const { return shape_; }
+
+  // Stored values / rows * cols
+  float density() const;
+  size_t bytes() const;
+
+  // Fraction of values that lie in all-zero blocks of the given shape
+  static float blockSparsity(const float *dense, int rows, int cols,
+                             BlockShape shape);
+
+private:
+  void multiplyDense(const float *x, float *y) const;
+  void multiply4x4(const float *x, float *y) const;
+  void multiply1x8(const float *x, float *y) const;
+
+  int rows_ = 0;
+  int cols_ = 0;
+  BlockShape shape_ = BlockShape::DENSE;
+  std::vector<int32_t> rowStart_; // Per block row, first block (+1 end)
+  std::vector<int32_t> colIndex_; // First column of each block
+  std::vector<float> values_;     // 4x4 blocks column-major, 1x8 in order
+};
+
+} // namespace poise
+
+#endif // BLOCK_SPARSE_H
@@ -0,0 +1,114 @@
+/**
+ * Cold State Pool - Implementation
+ */
+
+#include "cold_state_pool.h"
+#include "memory_accounting.h"
+#include "state_codec.h"
+
+namespace poise {
+
+namespace {
+
+int64_t savingsFor(size_t count, size_t packedSize) {
+  return static_cast<int64_t>(count * sizeof(float)) -
+         static_cast<int64_t>(packedSize);
+}
+
+} // anonymous namespace
+
+ColdStatePool &ColdStatePool::instance() {
+  static ColdStatePool pool;
+  return pool;
+}
+
+size_t ColdStatePool::park(int64_t streamId, const float *state,
+                           size_t count) {
+  Entry entry;
+  entry.count = count;
+  StateCodec::encode(state, count, entry.packed);
+  size_t packedSize = entry.packed.size();
+
+  Entry previous;
+  bool replaced = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(streamId);
+    if (it != entries_.end()) {
+      previous = std::move(it->second);
+      it->second = std::move(entry);
+      replaced = true;
+    } else {
+      entries_.emplace(streamId, std::move(entry));
+    }
+  }
+
+  if (!replaced) {
+    parkedStreams_++;
+  }
+  if (replaced) {
+    adjustColdBytes(-static_cast<int64_t>(previous.packed.size()));
+    savedBytes_ -= savingsFor(previous.count, previous.packed.size());
+  }
+  adjustColdBytes(static_cast<int64_t>(packedSize));
+  savedBytes_ += savingsFor(count, packedSize);
+  totalParks_++;
+  return packedSize;
+}
+
+bool ColdStatePool::restore(int64_t streamId, float *state, size_t count) {
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(streamId);
+    if (it == entries_.end()) {
+      return false;
+    }
+    entry = std::move(it->second);
+    entries_.erase(it);
+  }
+  parkedStreams_--;
+
+  adjustColdBytes(-static_cast<int64_t>(entry.packed.size()));
+  savedBytes_ -= savingsFor(entry.count, entry.packed.size());
+  totalRestores_++;
+
+  if (entry.count != count) {
+    return false;
+  }
+  return StateCodec::decode(entry.packed, state, count);
+}
+
+void ColdStatePool::discard(int64_t streamId) {
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(streamId);
+    if (it == entries_.end()) {
+      return;
+    }
+    entry = std::move(it->second);
+    entries_.erase(it);
+  }
+  parkedStreams_--;
+
+  adjustColdBytes(-static_cast<int64_t>(entry.packed.size()));
+  savedBytes_ -= savingsFor(entry.count, entry.packed.size());
+}
+
+void ColdStatePool::adjustColdBytes(int64_t delta) {
+  coldBytes_ += delta;
+  MemoryAccounting::add(MemoryComponent::COLD_POOL, nullptr, delta);
+}
+
+ColdPoolStats ColdStatePool::getStats() const {
+  ColdPoolStats stats;
+  stats.parkedStreams = parkedStreams_.load();
+  stats.coldBytes = coldBytes_.load();
+  stats.savedBytes = savedBytes_.load();
+  stats.totalParks = totalParks_.load();
+  stats.totalRestores = totalRestores_.load();
+  return stats;
+}
+
+} // namespace poise
@@ -0,0 +1,80 @@
+/**
+ * Cold State Pool - Header
+ *
+ * Holds compressed recurrent state for streams that have gone idle.
+ */
+
+#ifndef COLD_STATE_POOL_H
+#define COLD_STATE_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace poise {
+
+struct ColdPoolStats {
+  int parkedStreams = 0;
+  int64_t coldBytes = 0;   // Packed bytes currently held
+  int64_t savedBytes = 0;  // FP32 bytes released minus packed bytes held
+  int64_t totalParks = 0;
+  int64_t totalRestores = 0;
+};
+
+/**
+ * Process-wide pool of parked stream state.
+ *
+ * Encoding/decoding runs outside the lock; the lock only guards the map
+ * insert/extract, so streams parking concurrently do not serialize on the
+ * codec.
+ */
+class ColdStatePool {
+public:
+  static ColdStatePool &instance();
+
+  /**
+   * Compress and store state for a stream.
+   * @return Packed size in bytes
+   */
+  size_t park(int64_t streamId, const float *state, size_t count);
+
+  /**
+   * Decompress parked state into the caller's buffer and drop the entry.
+   * @return false if nothing is parked for the stream or decoding failed
+   */
+  bool restore(int64_t streamId, float *state, size_t count);
+
+  // Drop parked state without restoring (stream reset/destroyed)
+  void discard(int64_t streamId);
+
+  // Lock-free; safe to call from metrics collection
+  ColdPoolStats getStats() const;
+
+private:
+  ColdStatePool() = default;
+
+  // Also reported to MemoryAccounting as COLD_POOL
+  void adjustColdBytes(int64_t delta);
+
+  struct Entry {
+    std::vector<uint8_t> packed;
+    size_t count = 0;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<int64_t, Entry> entries_;
+
+  // Mirrored in atomics so readers never take mutex_
+  std::atomic<int> parkedStreams_{0};
+  std::atomic<int64_t> coldBytes_{0};
+  std::atomic<int64_t> savedBytes_{0};
+  std::atomic<int64_t> totalParks_{0};
+  std::atomic<int64_t> totalRestores_{0};
+};
+
+} // namespace poise
+
+#endif // COLD_STATE_POOL_H
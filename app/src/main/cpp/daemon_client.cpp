@@ -0,0 +1,263 @@
+/**
+ * Denoise Daemon Client - Implementation
+ */
+
+#include "daemon_client.h"
+#include "async_log.h"
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define LOG_TAG "PoiseDaemonClient"
+#define LOGE(...) POISE_LOG(poise::LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+uint64_t nowNs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+DaemonRequest makeRequest(DaemonOp op) {
+  DaemonRequest request{};
+  request.magic = DAEMON_MAGIC;
+  request.version = DAEMON_VERSION;
+  request.op = op;
+  return request;
+}
+
+} // namespace
+
+// ============================================================================
+// DaemonStream
+// ============================================================================
+
+DaemonStream::~DaemonStream() {
+  if (inputEvent_ >= 0) {
+    close(inputEvent_);
+  }
+  if (outputEvent_ >= 0) {
+    close(outputEvent_);
+  }
+}
+
+bool DaemonStream::write(const float *frame, uint64_t captureNs) {
+  if (!input_.push(frame, captureNs != 0 ? captureNs : nowNs())) {
+    return false;
+  }
+  signalEventFd(inputEvent_);
+  return true;
+}
+
+bool DaemonStream::read(float *frame, int timeoutMs, uint64_t *latencyNs) {
+  uint64_t captureNs = 0;
+  uint64_t deadlineNs = nowNs() + static_cast<uint64_t>(timeoutMs) * 1000000;
+  // A wake-up may be left over from a frame already read, so re-check
+  // the ring after every wait until the deadline passes
+  while (!output_.pop(frame, &captureNs)) {
+    uint64_t now = nowNs();
+    if (timeoutMs == 0 || now >= deadlineNs) {
+      return false;
+    }
+    int remainingMs = static_cast<int>((deadlineNs - now + 999999) / 1000000);
+    waitEventFd(outputEvent_, remainingMs);
+  }
+  if (latencyNs != nullptr) {
+    uint64_t now = nowNs();
+    *latencyNs = now > captureNs ? now - captureNs : 0;
+  }
+  return true;
+}
+
+// ============================================================================
+// DaemonClient
+// ============================================================================
+
+DaemonClient::~DaemonClient() { disconnect(); }
+
+bool DaemonClient::connect(const char *socketPath) {
+  disconnect();
+
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  size_t pathLen = std::strlen(socketPath);
+  if (pathLen == 0 || pathLen >= sizeof(addr.sun_path)) {
+    LOGE("Invalid socket path: %s", socketPath);
+    return false;
+  }
+  std::memcpy(addr.sun_path, socketPath, pathLen);
+  socklen_t addrLen = offsetof(sockaddr_un, sun_path) + pathLen;
+  if (socketPath[0] == '@') {
+    addr.sun_path[0] = '\0';
+  } else {
+    addrLen += 1;
+  }
+
+  fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (fd_ < 0) {
+    LOGE("socket() failed: %s", std::strerror(errno));
+    return false;
+  }
+  if (::connect(fd_, reinterpret_cast<sockaddr *>(&addr), addrLen) != 0) {
+    LOGE("connect(%s) failed: %s", socketPath, std::strerror(errno));
+    disconnect();
+    return false;
+  }
+  return true;
+}
+
+void DaemonClient::disconnect() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool DaemonClient::transact(const DaemonRequest &request, DaemonReply *reply,
+                            int *fds, int *fdCount) {
+  if (fd_ < 0) {
+    return false;
+  }
+
+  ssize_t n;
+  do {
+    n = send(fd_, &request, sizeof(request), MSG_NOSIGNAL);
+  } while (n < 0 && errno == EINTR);
+  if (n != static_cast<ssize_t>(sizeof(request))) {
+    return false;
+  }
+
+  iovec iov{reply, sizeof(*reply)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * DAEMON_FD_COUNT)];
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  do {
+    n = recvmsg(fd_, &msg, MSG_CMSG_CLOEXEC);
+  } while (n < 0 && errno == EINTR);
+  if (n != static_cast<ssize_t>(sizeof(*reply)) ||
+      reply->magic != DAEMON_MAGIC) {
+    return false;
+  }
+
+  // Keep up to DAEMON_FD_COUNT descriptors where the caller expects them
+  // and close every other one we were sent, so none leak
+  int kept = 0;
+  for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+      continue;
+    }
+    int count = static_cast<int>((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+    const unsigned char *data = CMSG_DATA(cmsg);
+    for (int i = 0; i < count; i++) {
+      int received;
+      std::memcpy(&received, data + i * sizeof(int), sizeof(int));
+      if (fds != nullptr && kept < DAEMON_FD_COUNT) {
+        fds[kept++] = received;
+      } else {
+        close(received);
+      }
+    }
+  }
+  if (fdCount != nullptr) {
+    *fdCount = kept;
+  }
+  // Descriptors that did not fit were closed by the kernel; the reply is
+  // incomplete
+  if (msg.msg_flags & MSG_CTRUNC) {
+    for (int i = 0; i < kept; i++) {
+      close(fds[i]);
+    }
+    if (fdCount != nullptr) {
+      *fdCount = 0;
+    }
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<DaemonStream>
+DaemonClient::openStream(int sampleRate, int ringFrames, int latencyMs,
+                         int32_t *status) {
+  DaemonRequest request = makeRequest(DAEMON_OP_OPEN);
+  request.sampleRate = sampleRate;
+  request.ringFrames = ringFrames;
+  request.latencyMs = latencyMs;
+
+  DaemonReply reply{};
+  int fds[DAEMON_FD_COUNT] = {-1, -1, -1};
+  int fdCount = 0;
+  if (!transact(request, &reply, fds, &fdCount)) {
+    if (status != nullptr) {
+      *status = DAEMON_ERR_PROTOCOL;
+    }
+    return nullptr;
+  }
+  if (status != nullptr) {
+    *status = reply.status;
+  }
+  if (reply.status != DAEMON_OK || fdCount != DAEMON_FD_COUNT) {
+    for (int i = 0; i < fdCount && i < DAEMON_FD_COUNT; i++) {
+      close(fds[i]);
+    }
+    return nullptr;
+  }
+
+  std::unique_ptr<DaemonStream> stream(new DaemonStream());
+  stream->id_ = reply.streamId;
+  stream->sampleRate_ = reply.sampleRate;
+  stream->latencyMs_ = reply.latencyMs;
+  stream->inputEvent_ = fds[DAEMON_FD_INPUT_EVENT];
+  stream->outputEvent_ = fds[DAEMON_FD_OUTPUT_EVENT];
+
+  auto *base = stream->region_.map(fds[DAEMON_FD_REGION], reply.regionBytes)
+                   ? static_cast<uint8_t *>(stream->region_.data())
+                   : nullptr;
+  if (base == nullptr || reply.outRingOffset >= reply.regionBytes ||
+      !stream->input_.attach(base, reply.outRingOffset) ||
+      !stream->output_.attach(base + reply.outRingOffset,
+                              reply.regionBytes - reply.outRingOffset)) {
+    LOGE("Failed to map stream %d", reply.streamId);
+    closeStream(*stream);
+    if (status != nullptr) {
+      *status = DAEMON_ERR_INTERNAL;
+    }
+    return nullptr;
+  }
+  return stream;
+}
+
+bool DaemonClient::closeStream(DaemonStream &stream) {
+  DaemonRequest request = makeRequest(DAEMON_OP_CLOSE);
+  request.streamId = stream.id_;
+  DaemonReply reply{};
+  return transact(request, &reply, nullptr, nullptr) &&
+         reply.status == DAEMON_OK;
+}
+
+bool DaemonClient::getLatency(const DaemonStream &stream,
+                              DaemonLatency *latency) {
+  DaemonRequest request = makeRequest(DAEMON_OP_STATS);
+  request.streamId = stream.id_;
+  DaemonReply reply{};
+  if (!transact(request, &reply, nullptr, nullptr) ||
+      reply.status != DAEMON_OK) {
+    return false;
+  }
+  *latency = reply.latency;
+  return true;
+}
+
+} // namespace poise
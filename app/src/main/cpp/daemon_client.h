@@ -0,0 +1,95 @@
+/**
+ * Denoise Daemon Client - Header
+ *
+ * Client side of the daemon protocol for processes that want denoising
+ * without loading the model themselves.
+ */
+
+#ifndef DAEMON_CLIENT_H
+#define DAEMON_CLIENT_H
+
+#include "daemon_protocol.h"
+#include "shm_ring.h"
+#include <cstdint>
+#include <memory>
+
+namespace poise {
+
+/**
+ * One denoised stream. write()/read() may be called from different threads
+ * (one producer, one consumer); control calls go through DaemonClient.
+ */
+class DaemonStream {
+public:
+  ~DaemonStream();
+
+  /**
+   * Queue one input frame (frameSamples() floats) and wake the daemon.
+   * @param captureNs Steady-clock capture time; 0 = now
+   * @return false if the input ring is full
+   */
+  bool write(const float *frame, uint64_t captureNs = 0);
+
+  /**
+   * Fetch one denoised frame, waiting up to timeoutMs (0 = poll).
+   * @param latencyNs Optional capture-to-read latency of this frame
+   */
+  bool read(float *frame, int timeoutMs, uint64_t *latencyNs = nullptr);
+
+  int32_t id() const { return id_; }
+  int sampleRate() const { return sampleRate_; }
+  int frameSamples() const { return static_cast<int>(input_.frameSamples()); }
+  int latencyMs() const { return latencyMs_; }
+
+private:
+  friend class DaemonClient;
+  DaemonStream() = default;
+
+  int32_t id_ = 0;
+  int sampleRate_ = 0;
+  int latencyMs_ = 0;
+  SharedRegion region_;
+  ShmRing input_;
+  ShmRing output_;
+  int inputEvent_ = -1;
+  int outputEvent_ = -1;
+};
+
+class DaemonClient {
+public:
+  DaemonClient() = default;
+  ~DaemonClient();
+
+  DaemonClient(const DaemonClient &) = delete;
+  DaemonClient &operator=(const DaemonClient &) = delete;
+
+  // Same path syntax as DenoiseDaemon::start ("@name" = abstract)
+  bool connect(const char *socketPath);
+  void disconnect();
+  bool isConnected() const { return fd_ >= 0; }
+
+  /**
+   * Open a stream. sampleRate must match the daemon's model rate.
+   * @param latencyMs Capture-to-output budget used for deadline scheduling
+   *                  (0 = daemon default)
+   * @param status Optional DaemonStatus on failure
+   */
+  std::unique_ptr<DaemonStream> openStream(int sampleRate, int ringFrames = 0,
+                                           int latencyMs = 0,
+                                           int32_t *status = nullptr);
+
+  bool closeStream(DaemonStream &stream);
+
+  // Daemon-side latency report for one of our streams
+  bool getLatency(const DaemonStream &stream, DaemonLatency *latency);
+
+private:
+  bool transact(const DaemonRequest &request, DaemonReply *reply, int *fds,
+                int *fdCount);
+
+  int fd_ = -1;
+};
+
+} // namespace poise
+
+#endif // DAEMON_CLIENT_H
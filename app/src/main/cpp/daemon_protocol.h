@@ -0,0 +1,85 @@
+/**
+ * Denoise Daemon Protocol - Header
+ *
+ * Control messages exchanged over the daemon's Unix domain socket. Audio
+ * never travels over the socket: an OPEN reply carries, as SCM_RIGHTS, the
+ * shared region holding both rings plus one eventfd per direction.
+ *
+ * Region layout: [input ring (client -> daemon)][output ring (daemon -> client)]
+ * with the output ring at DaemonReply::outRingOffset.
+ */
+
+#ifndef DAEMON_PROTOCOL_H
+#define DAEMON_PROTOCOL_H
+
+#include <cstdint>
+
+namespace poise {
+
+constexpr uint32_t DAEMON_MAGIC = 0x504F4453; // "PODS"
+constexpr uint32_t DAEMON_VERSION = 1;
+
+enum DaemonOp : uint32_t {
+  DAEMON_OP_OPEN = 1,  // Create a stream; reply carries 3 fds
+  DAEMON_OP_CLOSE = 2, // Tear down streamId
+  DAEMON_OP_STATS = 3, // Latency for streamId
+};
+
+enum DaemonStatus : int32_t {
+  DAEMON_OK = 0,
+  DAEMON_ERR_PROTOCOL = -1,
+  DAEMON_ERR_FORMAT = -2, // Unsupported sample rate / frame size
+  DAEMON_ERR_BUSY = -3,   // Stream limit reached
+  DAEMON_ERR_NO_STREAM = -4,
+  DAEMON_ERR_INTERNAL = -5,
+};
+
+// File descriptors attached to a successful OPEN reply, in this order
+enum DaemonFd : int {
+  DAEMON_FD_REGION = 0,
+  DAEMON_FD_INPUT_EVENT = 1,  // Client signals after pushing input
+  DAEMON_FD_OUTPUT_EVENT = 2, // Daemon signals after pushing output
+  DAEMON_FD_COUNT = 3,
+};
+
+struct DaemonRequest {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t op;
+  int32_t streamId;     // CLOSE / STATS
+  int32_t sampleRate;   // OPEN: must match the daemon's model rate
+  int32_t frameSamples; // OPEN: 0 = daemon default
+  int32_t ringFrames;   // OPEN: 0 = daemon default, rounded to a power of 2
+  int32_t latencyMs;    // OPEN: capture-to-output budget, 0 = daemon default
+};
+
+/**
+ * Per-stream latency as seen by the daemon: from the client's capture
+ * timestamp on the input frame to the output frame being published.
+ */
+struct DaemonLatency {
+  uint64_t frames;
+  uint64_t dropped; // Output ring full, frame discarded
+  uint64_t shed;    // Would have missed the deadline; passed through dry
+  double avgMs;
+  double p99Ms; // Histogram bucket upper bound
+  double maxMs;
+  double avgProcessMs; // Model time only
+};
+
+struct DaemonReply {
+  uint32_t magic;
+  int32_t status;
+  int32_t streamId;
+  int32_t sampleRate;
+  int32_t frameSamples;
+  int32_t ringFrames;
+  int32_t latencyMs; // Budget the daemon schedules against
+  uint64_t regionBytes;
+  uint64_t outRingOffset;
+  DaemonLatency latency; // STATS only
+};
+
+} // namespace poise
+
+#endif // DAEMON_PROTOCOL_H
@@ -0,0 +1,645 @@
+/**
+ * Denoise Daemon - Implementation
+ */
+
+#include "denoise_daemon.h"
+#include "admission_control.h"
+#include "async_log.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define LOG_TAG "PoiseDaemon"
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) POISE_LOG(poise::LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) POISE_LOG(poise::LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+constexpr uint64_t WAKE_TOKEN = ~0ull;
+constexpr int MAX_EVENTS = 32;
+// The first runs of a model (allocation, kernel selection) are far slower
+// than steady state; they are never shed and stay out of the cost estimate
+constexpr uint32_t COST_WARMUP_FRAMES = 8;
+
+uint64_t nowNs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+size_t alignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint32_t roundUpPow2(uint32_t value) {
+  uint32_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+bool sendReply(int fd, const DaemonReply &reply, const int *fds, int fdCount) {
+  iovec iov{const_cast<DaemonReply *>(&reply), sizeof(reply)};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * DAEMON_FD_COUNT)];
+  if (fdCount > 0) {
+    std::memset(control, 0, sizeof(control));
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * fdCount);
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fdCount);
+  }
+
+  ssize_t n;
+  do {
+    n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+  } while (n < 0 && errno == EINTR);
+  return n == static_cast<ssize_t>(sizeof(reply));
+}
+
+} // namespace
+
+DenoiseDaemon::Stream::~Stream() {
+  if (inputEvent >= 0) {
+    close(inputEvent);
+  }
+  if (outputEvent >= 0) {
+    close(outputEvent);
+  }
+}
+
+DenoiseDaemon::DenoiseDaemon(DaemonBackend *backend)
+    : backend_(backend), allowedUids_{static_cast<uint32_t>(getuid())} {}
+
+DenoiseDaemon::~DenoiseDaemon() { stop(); }
+
+void DenoiseDaemon::allowUid(uint32_t uid) {
+  if (std::find(allowedUids_.begin(), allowedUids_.end(), uid) ==
+      allowedUids_.end()) {
+    allowedUids_.push_back(uid);
+  }
+}
+
+bool DenoiseDaemon::start(const char *socketPath) {
+  if (running_.load(std::memory_order_acquire) || backend_ == nullptr) {
+    return false;
+  }
+
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  size_t pathLen = std::strlen(socketPath);
+  if (pathLen == 0 || pathLen >= sizeof(addr.sun_path)) {
+    LOGE("Invalid socket path: %s", socketPath);
+    return false;
+  }
+  std::memcpy(addr.sun_path, socketPath, pathLen);
+  socklen_t addrLen = offsetof(sockaddr_un, sun_path) + pathLen;
+  bool abstractName = socketPath[0] == '@';
+  if (abstractName) {
+    addr.sun_path[0] = '\0';
+  } else {
+    unlink(socketPath);
+    addrLen += 1;
+  }
+
+  listenFd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (listenFd_ < 0) {
+    LOGE("socket() failed: %s", std::strerror(errno));
+    return false;
+  }
+  if (bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), addrLen) != 0 ||
+      listen(listenFd_, MAX_CLIENTS) != 0) {
+    LOGE("bind/listen(%s) failed: %s", socketPath, std::strerror(errno));
+    close(listenFd_);
+    listenFd_ = -1;
+    return false;
+  }
+
+  stopEvent_ = createEventFd();
+  wakeEvent_ = createEventFd();
+  epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (stopEvent_ < 0 || wakeEvent_ < 0 || epollFd_ < 0) {
+    LOGE("Failed to create daemon event fds: %s", std::strerror(errno));
+    running_.store(true, std::memory_order_release);
+    stop();
+    return false;
+  }
+  epoll_event wake{};
+  wake.events = EPOLLIN;
+  wake.data.u64 = WAKE_TOKEN;
+  epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeEvent_, &wake);
+
+  socketPath_ = abstractName ? std::string() : std::string(socketPath);
+  running_.store(true, std::memory_order_release);
+  controlThread_ = std::thread(&DenoiseDaemon::controlLoop, this);
+  workerThread_ = std::thread(&DenoiseDaemon::workerLoop, this);
+
+  LOGI("Daemon listening on %s (%d Hz, %d-sample frames)", socketPath,
+       backend_->sampleRate(), backend_->frameSamples());
+  return true;
+}
+
+void DenoiseDaemon::stop() {
+  if (!running_.exchange(false, std::memory_order_acq_rel)) {
+    return;
+  }
+
+  if (stopEvent_ >= 0) {
+    signalEventFd(stopEvent_);
+  }
+  if (wakeEvent_ >= 0) {
+    signalEventFd(wakeEvent_);
+  }
+  if (controlThread_.joinable()) {
+    controlThread_.join();
+  }
+  if (workerThread_.joinable()) {
+    workerThread_.join();
+  }
+
+  // Threads are gone; tear down what the clients left behind
+  std::unordered_map<int32_t, std::unique_ptr<Stream>> remaining;
+  {
+    std::lock_guard<std::mutex> lock(streamsMutex_);
+    remaining.swap(streams_);
+  }
+  for (auto &entry : remaining) {
+    destroyStream(std::move(entry.second));
+  }
+  for (int fd : clients_) {
+    close(fd);
+  }
+  clients_.clear();
+
+  for (int *fd : {&listenFd_, &stopEvent_, &wakeEvent_, &epollFd_}) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+  if (!socketPath_.empty()) {
+    unlink(socketPath_.c_str());
+    socketPath_.clear();
+  }
+  LOGI("Daemon stopped");
+}
+
+int DenoiseDaemon::streamCount() const {
+  std::lock_guard<std::mutex> lock(streamsMutex_);
+  return static_cast<int>(streams_.size());
+}
+
+// ============================================================================
+// Control thread
+// ============================================================================
+
+void DenoiseDaemon::controlLoop() {
+  std::vector<pollfd> fds;
+
+  while (running_.load(std::memory_order_acquire)) {
+    fds.clear();
+    fds.push_back({stopEvent_, POLLIN, 0});
+    fds.push_back({listenFd_, POLLIN, 0});
+    for (int fd : clients_) {
+      fds.push_back({fd, POLLIN, 0});
+    }
+
+    int rc = poll(fds.data(), fds.size(), -1);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOGE("poll() failed: %s", std::strerror(errno));
+      break;
+    }
+    if (fds[0].revents != 0) {
+      break;
+    }
+    if (fds[1].revents & POLLIN) {
+      acceptClient();
+    }
+    for (size_t i = 2; i < fds.size(); i++) {
+      if (fds[i].revents != 0 && !handleClient(fds[i].fd)) {
+        dropClient(fds[i].fd);
+      }
+    }
+  }
+
+  backend_->onThreadExit();
+}
+
+void DenoiseDaemon::acceptClient() {
+  int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+  if (fd < 0) {
+    LOGW("accept() failed: %s", std::strerror(errno));
+    return;
+  }
+  if (static_cast<int>(clients_.size()) >= MAX_CLIENTS) {
+    LOGW("Rejecting client: %d clients connected", MAX_CLIENTS);
+    close(fd);
+    return;
+  }
+
+  ucred cred{};
+  socklen_t credLen = sizeof(cred);
+  if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &credLen) != 0) {
+    LOGW("Rejecting client: no peer credentials (%s)", std::strerror(errno));
+    close(fd);
+    return;
+  }
+  if (std::find(allowedUids_.begin(), allowedUids_.end(),
+                static_cast<uint32_t>(cred.uid)) == allowedUids_.end()) {
+    LOGW("Rejecting client: pid=%d uid=%d not allowed", cred.pid, cred.uid);
+    close(fd);
+    return;
+  }
+  LOGI("Client connected: pid=%d uid=%d", cred.pid, cred.uid);
+  clients_.push_back(fd);
+}
+
+bool DenoiseDaemon::handleClient(int clientFd) {
+  DaemonRequest request{};
+  ssize_t n;
+  do {
+    n = recv(clientFd, &request, sizeof(request), 0);
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) {
+    return false;
+  }
+
+  DaemonReply reply{};
+  reply.magic = DAEMON_MAGIC;
+  int fds[DAEMON_FD_COUNT] = {-1, -1, -1};
+  int fdCount = 0;
+
+  if (n != static_cast<ssize_t>(sizeof(request)) ||
+      request.magic != DAEMON_MAGIC || request.version != DAEMON_VERSION) {
+    reply.status = DAEMON_ERR_PROTOCOL;
+    sendReply(clientFd, reply, nullptr, 0);
+    return false;
+  }
+
+  switch (request.op) {
+  case DAEMON_OP_OPEN:
+    reply.status = openStream(clientFd, request, reply, fds);
+    fdCount = reply.status == DAEMON_OK ? DAEMON_FD_COUNT : 0;
+    break;
+  case DAEMON_OP_CLOSE:
+    reply.streamId = request.streamId;
+    reply.status = closeStream(clientFd, request.streamId);
+    break;
+  case DAEMON_OP_STATS:
+    reply.streamId = request.streamId;
+    reply.status = streamLatency(clientFd, request.streamId, reply.latency);
+    break;
+  default:
+    reply.status = DAEMON_ERR_PROTOCOL;
+    break;
+  }
+
+  if (!sendReply(clientFd, reply, fds, fdCount)) {
+    if (fdCount > 0) {
+      closeStream(clientFd, reply.streamId);
+    }
+    return false;
+  }
+  return true;
+}
+
+void DenoiseDaemon::dropClient(int clientFd) {
+  std::vector<std::unique_ptr<Stream>> orphaned;
+  {
+    std::lock_guard<std::mutex> lock(streamsMutex_);
+    for (auto it = streams_.begin(); it != streams_.end();) {
+      if (it->second->clientFd == clientFd) {
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, it->second->inputEvent, nullptr);
+        orphaned.push_back(std::move(it->second));
+        it = streams_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  for (auto &stream : orphaned) {
+    destroyStream(std::move(stream));
+  }
+
+  clients_.erase(std::remove(clients_.begin(), clients_.end(), clientFd),
+                 clients_.end());
+  close(clientFd);
+  LOGI("Client disconnected (%zu streams closed)", orphaned.size());
+}
+
+int32_t DenoiseDaemon::openStream(int clientFd, const DaemonRequest &request,
+                                  DaemonReply &reply, int *fds) {
+  const int frameSamples = backend_->frameSamples();
+  if (request.sampleRate != backend_->sampleRate() ||
+      (request.frameSamples != 0 && request.frameSamples != frameSamples)) {
+    LOGW("Rejecting stream: %d Hz / %d samples (want %d Hz / %d)",
+         request.sampleRate, request.frameSamples, backend_->sampleRate(),
+         frameSamples);
+    return DAEMON_ERR_FORMAT;
+  }
+  if (streamCount() >= MAX_STREAMS) {
+    return DAEMON_ERR_BUSY;
+  }
+
+  uint32_t ringFrames =
+      request.ringFrames > 0 ? static_cast<uint32_t>(request.ringFrames)
+                             : DEFAULT_RING_FRAMES;
+  ringFrames = roundUpPow2(std::min<uint32_t>(
+      std::max<uint32_t>(ringFrames, 2), MAX_RING_FRAMES));
+
+  auto stream = std::make_unique<Stream>();
+  stream->clientFd = clientFd;
+
+  size_t ringBytes = ShmRing::bytesFor(ringFrames, frameSamples);
+  size_t outOffset = alignUp(ringBytes, 64);
+  size_t regionBytes = outOffset + ringBytes;
+  if (!stream->region.create("poise_daemon_stream", regionBytes)) {
+    return DAEMON_ERR_INTERNAL;
+  }
+  auto *base = static_cast<uint8_t *>(stream->region.data());
+  stream->input.init(base, ringFrames, frameSamples);
+  stream->output.init(base + outOffset, ringFrames, frameSamples);
+  stream->inputEvent = createEventFd();
+  stream->outputEvent = createEventFd();
+  if (stream->inputEvent < 0 || stream->outputEvent < 0) {
+    return DAEMON_ERR_INTERNAL;
+  }
+  stream->inputFrame.resize(frameSamples);
+  stream->outputFrame.resize(frameSamples);
+  stream->memory.set(regionBytes + (stream->inputFrame.capacity() +
+                                    stream->outputFrame.capacity()) *
+                                       sizeof(float));
+
+  int latencyMs = request.latencyMs > 0
+                      ? std::min<int>(request.latencyMs, MAX_LATENCY_MS)
+                      : DEFAULT_LATENCY_MS;
+  stream->budgetNs = static_cast<uint64_t>(latencyMs) * 1000000;
+
+  // The backend's stream constructor consumes this grant
+  if (AdmissionController::instance().request("gtcrn").decision ==
+      AdmissionDecision::REJECT) {
+    return DAEMON_ERR_BUSY;
+  }
+
+  int32_t id;
+  {
+    std::lock_guard<std::mutex> lock(streamsMutex_);
+    id = nextStreamId_++;
+  }
+  stream->id = id;
+  if (!backend_->openStream(id)) {
+    return DAEMON_ERR_INTERNAL;
+  }
+  stream->metrics = MetricsRegistry::instance().acquire(id, "daemon");
+  stream->memory.attach(stream->metrics);
+
+  fds[DAEMON_FD_REGION] = stream->region.fd();
+  fds[DAEMON_FD_INPUT_EVENT] = stream->inputEvent;
+  fds[DAEMON_FD_OUTPUT_EVENT] = stream->outputEvent;
+
+  reply.streamId = id;
+  reply.sampleRate = backend_->sampleRate();
+  reply.frameSamples = frameSamples;
+  reply.ringFrames = static_cast<int32_t>(ringFrames);
+  reply.latencyMs = latencyMs;
+  reply.regionBytes = regionBytes;
+  reply.outRingOffset = outOffset;
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.u64 = static_cast<uint64_t>(id);
+  {
+    std::lock_guard<std::mutex> lock(streamsMutex_);
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, stream->inputEvent, &event);
+    streams_[id] = std::move(stream);
+  }
+
+  LOGI("Opened stream %d (%u-frame rings, %zu bytes shared, %d ms budget)", id,
+       ringFrames, regionBytes, latencyMs);
+  return DAEMON_OK;
+}
+
+int32_t DenoiseDaemon::closeStream(int clientFd, int32_t streamId) {
+  std::unique_ptr<Stream> stream;
+  {
+    std::lock_guard<std::mutex> lock(streamsMutex_);
+    auto it = streams_.find(streamId);
+    if (it == streams_.end() || it->second->clientFd != clientFd) {
+      return DAEMON_ERR_NO_STREAM;
+    }
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, it->second->inputEvent, nullptr);
+    stream = std::move(it->second);
+    streams_.erase(it);
+  }
+  destroyStream(std::move(stream));
+  return DAEMON_OK;
+}
+
+void DenoiseDaemon::destroyStream(std::unique_ptr<Stream> stream) {
+  backend_->closeStream(stream->id);
+  if (stream->metrics != nullptr) {
+    stream->memory.attach(nullptr);
+    MetricsRegistry::instance().release(stream->metrics);
+  }
+  LOGI("Closed stream %d (%llu frames, %llu dropped, %llu shed)", stream->id,
+       static_cast<unsigned long long>(stream->latency.count()),
+       static_cast<unsigned long long>(
+           stream->dropped.load(std::memory_order_relaxed)),
+       static_cast<unsigned long long>(
+           stream->shed.load(std::memory_order_relaxed)));
+}
+
+int32_t DenoiseDaemon::streamLatency(int clientFd, int32_t streamId,
+                                     DaemonLatency &latency) const {
+  std::lock_guard<std::mutex> lock(streamsMutex_);
+  auto it = streams_.find(streamId);
+  if (it == streams_.end() || it->second->clientFd != clientFd) {
+    return DAEMON_ERR_NO_STREAM;
+  }
+  const Stream &stream = *it->second;
+  const LatencyHistogram &hist = stream.latency;
+
+  uint64_t count = hist.count();
+  latency.frames = count;
+  latency.dropped = stream.dropped.load(std::memory_order_relaxed);
+  latency.shed = stream.shed.load(std::memory_order_relaxed);
+  latency.maxMs =
+      stream.maxLatencyNs.load(std::memory_order_relaxed) / 1.0e6;
+  latency.avgMs = count > 0 ? hist.sumMs() / count : 0.0;
+  latency.avgProcessMs =
+      count > 0 ? stream.processNs.load(std::memory_order_relaxed) / 1.0e6 /
+                      count
+                : 0.0;
+
+  latency.p99Ms = 0.0;
+  uint64_t target = (count * 99 + 99) / 100;
+  uint64_t seen = 0;
+  for (int b = 0; b < LatencyHistogram::NUM_BUCKETS && count > 0; b++) {
+    seen += hist.bucketCount(b);
+    if (seen >= target) {
+      latency.p99Ms = b < LatencyHistogram::NUM_BUCKETS - 1
+                          ? LatencyHistogram::BOUNDS_MS[b]
+                          : latency.maxMs;
+      break;
+    }
+  }
+  return DAEMON_OK;
+}
+
+// ============================================================================
+// Worker thread
+// ============================================================================
+
+void DenoiseDaemon::workerLoop() {
+  epoll_event events[MAX_EVENTS];
+
+  while (running_.load(std::memory_order_acquire)) {
+    int n = epoll_wait(epollFd_, events, MAX_EVENTS, -1);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOGE("epoll_wait() failed: %s", std::strerror(errno));
+      break;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(streamsMutex_);
+      for (int i = 0; i < n; i++) {
+        if (events[i].data.u64 == WAKE_TOKEN) {
+          drainEventFd(wakeEvent_);
+          continue;
+        }
+        auto it = streams_.find(static_cast<int32_t>(events[i].data.u64));
+        if (it != streams_.end()) {
+          drainEventFd(it->second->inputEvent);
+        }
+      }
+    }
+
+    // The rings, not the wake-ups, say what is ready: keep taking the
+    // earliest deadline until every input ring is empty. Frames pushed
+    // meanwhile are picked up by the rescan; their wake-ups only cause
+    // one extra empty pass.
+    while (running_.load(std::memory_order_acquire)) {
+      // Holding the lock across the frame keeps close() from freeing the
+      // rings underneath us; control ops wait at most one frame.
+      std::lock_guard<std::mutex> lock(streamsMutex_);
+      uint64_t deadlineNs = 0;
+      Stream *next = earliestDeadline(&deadlineNs);
+      if (next == nullptr) {
+        break;
+      }
+      serviceFrame(*next, deadlineNs);
+    }
+  }
+
+  backend_->onThreadExit();
+}
+
+DenoiseDaemon::Stream *DenoiseDaemon::earliestDeadline(uint64_t *deadlineNs) {
+  Stream *best = nullptr;
+  uint64_t now = nowNs();
+
+  for (auto &entry : streams_) {
+    Stream &stream = *entry.second;
+    uint64_t captureNs;
+    if (!stream.input.peekCaptureNs(&captureNs)) {
+      continue;
+    }
+    // A client cannot buy priority with a capture time in the future
+    uint64_t deadline = std::min(captureNs, now) + stream.budgetNs;
+    if (best == nullptr || deadline < *deadlineNs) {
+      best = &stream;
+      *deadlineNs = deadline;
+    }
+  }
+  return best;
+}
+
+void DenoiseDaemon::serviceFrame(Stream &stream, uint64_t deadlineNs) {
+  uint64_t captureNs = 0;
+  if (!stream.input.pop(stream.inputFrame.data(), &captureNs)) {
+    return;
+  }
+
+  uint64_t startNs = nowNs();
+  bool warm = stream.warmFrames >= COST_WARMUP_FRAMES;
+  bool shed = warm && startNs + stream.costNs > deadlineNs;
+  bool processed = false;
+  if (!shed) {
+    processed = backend_->processFrame(stream.id, stream.inputFrame.data(),
+                                       stream.outputFrame.data());
+  }
+  const float *result =
+      processed ? stream.outputFrame.data() : stream.inputFrame.data();
+  uint64_t doneNs = nowNs();
+
+  if (shed) {
+    // Degrade to dry audio now rather than deliver denoised audio late
+    stream.shed.fetch_add(1, std::memory_order_relaxed);
+    if (stream.metrics != nullptr) {
+      metricsInc(stream.metrics->deadlineMisses);
+    }
+    // Shed frames measure nothing, so let the estimate decay until a frame
+    // is tried again; one slow frame must not shed the stream for good
+    stream.costNs -= stream.costNs / 8;
+  } else {
+    uint64_t cost = doneNs - startNs;
+    if (warm) {
+      stream.costNs = (stream.costNs * 7 + cost) / 8;
+    } else if (++stream.warmFrames == COST_WARMUP_FRAMES) {
+      stream.costNs = cost;
+    }
+    stream.processNs.fetch_add(cost, std::memory_order_relaxed);
+  }
+
+  if (!stream.output.push(result, captureNs)) {
+    // Client is not draining its output; drop rather than block
+    stream.dropped.fetch_add(1, std::memory_order_relaxed);
+    if (stream.metrics != nullptr) {
+      metricsInc(stream.metrics->underruns);
+    }
+    return;
+  }
+  signalEventFd(stream.outputEvent);
+
+  // A bogus client timestamp only skews its own latency report
+  uint64_t latencyNs = doneNs > captureNs ? doneNs - captureNs : 0;
+  stream.latency.observe(latencyNs / 1.0e6);
+  if (latencyNs > stream.maxLatencyNs.load(std::memory_order_relaxed)) {
+    stream.maxLatencyNs.store(latencyNs, std::memory_order_relaxed);
+  }
+
+  if (stream.metrics != nullptr) {
+    metricsInc(stream.metrics->framesTotal);
+    metricsInc(processed ? stream.metrics->framesInferred
+                         : stream.metrics->framesBypassed);
+    if (!shed) {
+      stream.metrics->inferenceLatency.observe((doneNs - startNs) / 1.0e6);
+    }
+  }
+}
+
+} // namespace poise
@@ -0,0 +1,162 @@
+/**
+ * Denoise Daemon - Header
+ *
+ * Serves denoising to other local processes. Clients connect over a Unix
+ * domain socket (SOCK_SEQPACKET) for control only; audio moves through
+ * per-stream shared-memory SPSC rings with eventfd wake-ups. One backend,
+ * and therefore one copy of the model weights, serves every stream.
+ *
+ * Ready frames from all streams are processed earliest-deadline-first,
+ * where a frame's deadline is its capture time plus its stream's latency
+ * budget. A frame that cannot finish before its deadline, given the
+ * stream's measured processing cost, is shed: its dry input is published
+ * at once instead of a late denoised frame.
+ *
+ * Abstract socket names carry no filesystem permissions, so clients are
+ * checked by SO_PEERCRED: only the daemon's own uid, plus any allowUid(),
+ * may connect.
+ */
+
+#ifndef DENOISE_DAEMON_H
+#define DENOISE_DAEMON_H
+
+#include "daemon_protocol.h"
+#include "shm_ring.h"
+#include "stream_metrics.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace poise {
+
+/**
+ * Model host shared by all daemon streams. Calls for one stream are
+ * serialized; openStream/closeStream run on the control thread and
+ * processFrame on the worker thread.
+ */
+class DaemonBackend {
+public:
+  virtual ~DaemonBackend() = default;
+
+  virtual int sampleRate() const = 0;
+  virtual int frameSamples() const = 0;
+
+  virtual bool openStream(int32_t streamId) = 0;
+  // Returns false to pass the input through unchanged
+  virtual bool processFrame(int32_t streamId, const float *input,
+                            float *output) = 0;
+  virtual void closeStream(int32_t streamId) = 0;
+
+  // Called by each daemon thread just before it exits
+  virtual void onThreadExit() {}
+};
+
+class DenoiseDaemon {
+public:
+  static constexpr int MAX_CLIENTS = 16;
+  static constexpr int MAX_STREAMS = 32;
+  static constexpr int DEFAULT_RING_FRAMES = 16;
+  static constexpr int MAX_RING_FRAMES = 256;
+  static constexpr int DEFAULT_LATENCY_MS = 40;
+  static constexpr int MAX_LATENCY_MS = 1000;
+
+  explicit DenoiseDaemon(DaemonBackend *backend);
+  ~DenoiseDaemon();
+
+  DenoiseDaemon(const DenoiseDaemon &) = delete;
+  DenoiseDaemon &operator=(const DenoiseDaemon &) = delete;
+
+  // Also accept clients running as uid; call before start()
+  void allowUid(uint32_t uid);
+
+  /**
+   * Bind the control socket and start the control and worker threads.
+   * @param socketPath Filesystem path, or "@name" for the abstract namespace
+   */
+  bool start(const char *socketPath);
+
+  // Close every stream and client, then join the threads
+  void stop();
+
+  bool isRunning() const { return running_.load(std::memory_order_acquire); }
+  int streamCount() const;
+
+private:
+  struct Stream {
+    int32_t id = 0;
+    int clientFd = -1;
+    SharedRegion region;
+    ShmRing input;
+    ShmRing output;
+    int inputEvent = -1;
+    int outputEvent = -1;
+    StreamMetrics *metrics = nullptr;
+    uint64_t budgetNs = 0;
+
+    // Worker-only EDF state
+    uint64_t costNs = 0;     // EMA of backend time per frame
+    uint32_t warmFrames = 0; // Processed frames, counted through warm-up
+
+    // Capture-to-publish latency, owned by the worker
+    LatencyHistogram latency;
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> shed{0};
+    std::atomic<uint64_t> maxLatencyNs{0};
+    std::atomic<uint64_t> processNs{0};
+
+    std::vector<float> inputFrame;
+    std::vector<float> outputFrame;
+
+    // Shared rings and frame buffers
+    MemoryCharge memory{MemoryComponent::DAEMON};
+
+    ~Stream();
+  };
+
+  void controlLoop();
+  void workerLoop();
+
+  void acceptClient();
+  // Returns false when the client hung up or misbehaved
+  bool handleClient(int clientFd);
+  void dropClient(int clientFd);
+
+  int32_t openStream(int clientFd, const DaemonRequest &request,
+                     DaemonReply &reply, int *fds);
+  int32_t closeStream(int clientFd, int32_t streamId);
+  int32_t streamLatency(int clientFd, int32_t streamId,
+                        DaemonLatency &latency) const;
+  void destroyStream(std::unique_ptr<Stream> stream);
+
+  // Caller holds streamsMutex_
+  Stream *earliestDeadline(uint64_t *deadlineNs);
+  void serviceFrame(Stream &stream, uint64_t deadlineNs);
+
+  DaemonBackend *backend_;
+
+  std::atomic<bool> running_{false};
+  int listenFd_ = -1;
+  int stopEvent_ = -1;
+  int epollFd_ = -1;
+  int wakeEvent_ = -1;
+  std::string socketPath_;
+
+  std::vector<int> clients_; // Control thread only
+  std::vector<uint32_t> allowedUids_;
+
+  mutable std::mutex streamsMutex_;
+  std::unordered_map<int32_t, std::unique_ptr<Stream>> streams_;
+  int32_t nextStreamId_ = 1;
+
+  std::thread controlThread_;
+  std::thread workerThread_;
+};
+
+} // namespace poise
+
+#endif // DENOISE_DAEMON_H
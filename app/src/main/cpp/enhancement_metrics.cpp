@@ -0,0 +1,152 @@
+/**
+ * Enhancement Metrics - Implementation
+ */
+
+#include "enhancement_metrics.h"
+#include "stream_metrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace poise {
+
+namespace {
+
+// Band edges for a 256-bin half spectrum (bin 0 = DC is skipped); at 16 kHz
+// 250, 500, 1k, 1.5k, 2k, 3k, 4k, 6k Hz. Scaled to the actual bin count.
+constexpr int BAND_EDGES_256[EnhancementMetrics::NUM_BANDS + 1] = {
+    1, 8, 16, 32, 48, 64, 96, 128, 192, 257};
+
+constexpr float FLOOR_RISE = 1.0116f;    // +0.05 dB per frame
+constexpr float NOISE_MARGIN = 2.0f;     // Within 3 dB of the floor: noise
+constexpr float SPEECH_MARGIN = 4.0f;    // 6 dB or more above it: speech
+constexpr float SILENCE_ENERGY = 1e-6f;  // Mean bin energy, about -85 dBFS
+constexpr float ENERGY_EPS = 1e-12f;
+constexpr float MIN_DB = -20.0f;
+constexpr float MAX_DB = 60.0f;
+constexpr float AVERAGE_ALPHA = 0.016f;  // ~1 s at 16 ms frames
+
+float ratioDb(float num, float den) {
+  float db = 10.0f * std::log10((num + ENERGY_EPS) / (den + ENERGY_EPS));
+  return std::min(std::max(db, MIN_DB), MAX_DB);
+}
+
+void average(float &avg, float value, bool first) {
+  avg = first ? value : avg + AVERAGE_ALPHA * (value - avg);
+}
+
+} // anonymous namespace
+
+EnhancementMetrics::EnhancementMetrics(int numBins) {
+  for (int b = 0; b <= NUM_BANDS; b++) {
+    bandStart_[b] = BAND_EDGES_256[b] * (numBins - 1) / 256;
+    if (b > 0) {
+      bandStart_[b] = std::max(bandStart_[b], bandStart_[b - 1]);
+    }
+  }
+  bandStart_[NUM_BANDS] = numBins;
+  reset();
+}
+
+void EnhancementMetrics::reset() {
+  std::fill(inputEnergy_, inputEnergy_ + NUM_BANDS, 0.0f);
+  std::fill(noiseFloor_, noiseFloor_ + NUM_BANDS, 0.0f);
+  inputPending_ = false;
+  noiseFrames_ = 0;
+  speechFrames_ = 0;
+  stats_ = EnhancementStats();
+}
+
+void EnhancementMetrics::bandEnergies(const float *real, const float *imag,
+                                      float *out) const {
+  for (int b = 0; b < NUM_BANDS; b++) {
+    int start = bandStart_[b];
+    int end = bandStart_[b + 1];
+    float sum = 0.0f;
+    for (int k = start; k < end; k++) {
+      sum += real[k] * real[k] + imag[k] * imag[k];
+    }
+    out[b] = end > start ? sum / static_cast<float>(end - start) : 0.0f;
+  }
+}
+
+void EnhancementMetrics::analyzeInput(const float *real, const float *imag) {
+  bandEnergies(real, imag, inputEnergy_);
+  for (int b = 0; b < NUM_BANDS; b++) {
+    // Minimum statistics with slow rise, as in ModelCascade
+    float energy = std::max(inputEnergy_[b], ENERGY_EPS);
+    noiseFloor_[b] = (noiseFloor_[b] <= 0.0f)
+                         ? energy
+                         : std::min(noiseFloor_[b] * FLOOR_RISE, energy);
+  }
+  inputPending_ = true;
+}
+
+EnhancementFrame EnhancementMetrics::analyzeOutput(const float *real,
+                                                   const float *imag) {
+  EnhancementFrame frame;
+  if (!inputPending_) {
+    return frame;
+  }
+  inputPending_ = false;
+
+  float outputEnergy[NUM_BANDS];
+  bandEnergies(real, imag, outputEnergy);
+
+  float noiseIn = 0.0f, noiseOut = 0.0f;
+  float speechClean = 0.0f, speechKept = 0.0f;
+  for (int b = 0; b < NUM_BANDS; b++) {
+    float in = inputEnergy_[b];
+    float floor = noiseFloor_[b];
+    if (in < SILENCE_ENERGY) {
+      continue;
+    }
+    if (in <= floor * NOISE_MARGIN) {
+      noiseIn += in;
+      noiseOut += outputEnergy[b];
+      frame.hasNoise = true;
+    } else if (in >= floor * SPEECH_MARGIN) {
+      // Output above the clean estimate is residual noise, not speech
+      float clean = in - floor;
+      speechClean += clean;
+      speechKept += std::min(outputEnergy[b], clean);
+      frame.hasSpeech = true;
+    }
+  }
+
+  if (frame.hasNoise) {
+    frame.noiseReductionDb = ratioDb(noiseIn, noiseOut);
+  }
+  if (frame.hasSpeech) {
+    frame.speechRetentionDb = ratioDb(speechKept, speechClean);
+  }
+  frame.lowBenefit =
+      !frame.hasNoise || frame.noiseReductionDb < LOW_BENEFIT_DB;
+
+  average(stats_.lowBenefitRatio, frame.lowBenefit ? 1.0f : 0.0f,
+          stats_.frames++ == 0);
+  if (frame.hasNoise) {
+    average(stats_.noiseReductionDb, frame.noiseReductionDb,
+            noiseFrames_++ == 0);
+    stats_.lastNoiseReductionDb = frame.noiseReductionDb;
+  }
+  if (frame.hasSpeech) {
+    average(stats_.speechRetentionDb, frame.speechRetentionDb,
+            speechFrames_++ == 0);
+    stats_.lastSpeechRetentionDb = frame.speechRetentionDb;
+  }
+
+  if (stream_ != nullptr) {
+    if (frame.lowBenefit) {
+      metricsInc(stream_->framesLowBenefit);
+    }
+    if (frame.hasNoise) {
+      stream_->noiseReduction.observe(frame.noiseReductionDb);
+    }
+    if (frame.hasSpeech) {
+      stream_->speechRetention.observe(frame.speechRetentionDb);
+    }
+  }
+  return frame;
+}
+
+} // namespace poise
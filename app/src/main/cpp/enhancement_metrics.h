@@ -0,0 +1,86 @@
+/**
+ * Enhancement Metrics - Header
+ *
+ * Cheap per-frame estimate of what inference did to a frame, from the STFT
+ * bins the pipeline already has before and after the model. Input and
+ * output energies are summed into a handful of bands; a minimum-statistics
+ * floor of the input separates noise-dominated from speech-dominated bands.
+ * Noise reduction is the input/output energy ratio over the noise bands,
+ * speech retention the output energy over the estimated clean speech
+ * energy in the speech bands. About one multiply-add per bin per side.
+ */
+
+#ifndef ENHANCEMENT_METRICS_H
+#define ENHANCEMENT_METRICS_H
+
+#include <cstdint>
+
+namespace poise {
+
+struct StreamMetrics;
+
+struct EnhancementFrame {
+  bool hasNoise = false;          // Any band classified as noise
+  bool hasSpeech = false;         // Any band classified as speech
+  float noiseReductionDb = 0.0f;  // Input over output energy, noise bands
+  float speechRetentionDb = 0.0f; // Output over clean estimate, speech bands
+  bool lowBenefit = false;        // Inference did little to this frame
+};
+
+struct EnhancementStats {
+  int64_t frames = 0;             // Inferred frames measured
+  float noiseReductionDb = 0.0f;  // ~1 s moving averages
+  float speechRetentionDb = 0.0f;
+  float lowBenefitRatio = 0.0f;   // Fraction of recent low-benefit frames
+  float lastNoiseReductionDb = 0.0f;
+  float lastSpeechRetentionDb = 0.0f;
+};
+
+class EnhancementMetrics {
+public:
+  static constexpr int NUM_BANDS = 9;
+  // Noise reduction below this on a frame counts as low benefit
+  static constexpr float LOW_BENEFIT_DB = 3.0f;
+
+  /**
+   * @param numBins Bins per frame (FFT_SIZE/2 + 1)
+   */
+  explicit EnhancementMetrics(int numBins);
+
+  /**
+   * Band energies of the model input. Call before inference.
+   */
+  void analyzeInput(const float *real, const float *imag);
+
+  /**
+   * Compare the model output against the last analyzed input and record
+   * the frame. Does nothing if no input is pending (bypassed frames).
+   */
+  EnhancementFrame analyzeOutput(const float *real, const float *imag);
+
+  // Drop the pending input (the frame was not inferred)
+  void skipFrame() { inputPending_ = false; }
+
+  EnhancementStats getStats() const { return stats_; }
+
+  void reset();
+
+  // Record per-frame estimates into a stream's histograms (nullptr detaches)
+  void attachMetrics(StreamMetrics *stream) { stream_ = stream; }
+
+private:
+  void bandEnergies(const float *real, const float *imag, float *out) const;
+
+  int bandStart_[NUM_BANDS + 1];
+  float inputEnergy_[NUM_BANDS];
+  float noiseFloor_[NUM_BANDS];
+  bool inputPending_;
+  int64_t noiseFrames_;
+  int64_t speechFrames_;
+  EnhancementStats stats_;
+  StreamMetrics *stream_ = nullptr;
+};
+
+} // namespace poise
+
+#endif // ENHANCEMENT_METRICS_H
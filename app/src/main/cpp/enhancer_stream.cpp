@@ -0,0 +1,351 @@
+/**
+ * Enhancer Stream - Implementation
+ */
+
+#include "enhancer_stream.h"
+#include "async_log.h"
+#include "stft_batch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define LOG_TAG "PoiseStream"
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) POISE_LOG(poise::LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+float dbToGain(float db) { return std::pow(10.0f, db / 20.0f); }
+
+// One batch transform per thread and width; a batch runs on the narrowest
+// width that holds it, so at most a few lanes idle
+template <int LANES> BatchSTFTProcessor<LANES> &batchStft() {
+  thread_local BatchSTFTProcessor<LANES> batch;
+  return batch;
+}
+
+uint32_t batchAnalyze(STFTProcessor *const *stfts, const float *const *audio,
+                      int count, float *const *real, float *const *imag) {
+  if (count > 8) {
+    return batchStft<16>().computeSTFT(stfts, audio, count, real, imag);
+  }
+  if (count > 4) {
+    return batchStft<8>().computeSTFT(stfts, audio, count, real, imag);
+  }
+  return batchStft<4>().computeSTFT(stfts, audio, count, real, imag);
+}
+
+uint32_t batchSynthesize(STFTProcessor *const *stfts, const float *const *real,
+                         const float *const *imag, int count,
+                         float *const *audio) {
+  if (count > 8) {
+    return batchStft<16>().reconstructAudio(stfts, real, imag, count, audio);
+  }
+  if (count > 4) {
+    return batchStft<8>().reconstructAudio(stfts, real, imag, count, audio);
+  }
+  return batchStft<4>().reconstructAudio(stfts, real, imag, count, audio);
+}
+
+} // anonymous namespace
+
+EnhancerStream::EnhancerStream()
+    : streamId_(MetricsRegistry::nextStreamId()),
+      metrics_(MetricsRegistry::instance().acquire(streamId_, "gtcrn")),
+      stft_(std::make_unique<STFTProcessor>()),
+      recorder_(std::make_unique<FlightRecorder>(streamId_, "gtcrn",
+                                                 FRAME_MS)),
+      enhancement_(NUM_BINS), stateGuard_(streamId_, metrics_),
+      analysisStartUs_(0), analysisDoneUs_(0),
+      pending_(false), inputNonFinite_(false),
+      bypassGainDb_(DEFAULT_BYPASS_GAIN_DB),
+      bypassGain_(dbToGain(DEFAULT_BYPASS_GAIN_DB)),
+      vadOn_(NeuralVad::DEFAULT_ON_THRESHOLD),
+      vadOff_(NeuralVad::DEFAULT_OFF_THRESHOLD),
+      vadHang_(NeuralVad::DEFAULT_HANG_FRAMES), deadlineMs_(FRAME_MS) {
+  std::memset(real_, 0, sizeof(real_));
+  std::memset(imag_, 0, sizeof(imag_));
+  stft_->attachMemory(metrics_);
+  recorder_->attachMemory(metrics_);
+  enhancement_.attachMetrics(metrics_);
+  LOGI("Enhancer stream %lld created", static_cast<long long>(streamId_));
+}
+
+EnhancerStream::~EnhancerStream() {
+  // Everything charged to the metrics slot is freed before the slot
+  neuralVad_.reset();
+  recorder_.reset();
+  stft_.reset();
+  enhancement_.attachMetrics(nullptr);
+  MetricsRegistry::instance().release(metrics_);
+  LOGI("Enhancer stream %lld destroyed", static_cast<long long>(streamId_));
+}
+
+bool EnhancerStream::analyze(const float *audio, float *real, float *imag) {
+  analysisStartUs_ = FlightRecorder::nowUs();
+
+  // NaN/Inf input is scrubbed
+  bool inputFinite = stft_->computeSTFT(audio, real_, imag_);
+  finishAnalysis(inputFinite);
+  if (real != nullptr && imag != nullptr) {
+    std::memcpy(real, real_, sizeof(real_));
+    std::memcpy(imag, imag_, sizeof(imag_));
+  }
+  return inputFinite;
+}
+
+void EnhancerStream::finishAnalysis(bool inputFinite) {
+  if (metrics_) {
+    metricsInc(metrics_->framesTotal);
+    if (!inputFinite) {
+      metricsInc(metrics_->nonFiniteEvents);
+    }
+  }
+  inputNonFinite_ = !inputFinite;
+  enhancement_.analyzeInput(real_, imag_);
+  if (neuralVad_) {
+    neuralVad_->process(real_, imag_, NUM_BINS);
+  }
+  analysisDoneUs_ = FlightRecorder::nowUs();
+  pending_ = true;
+}
+
+bool EnhancerStream::gateOpen() const {
+  return !neuralVad_ || neuralVad_->isSpeech();
+}
+
+bool EnhancerStream::synthesize(const float *real, const float *imag,
+                                float *audio) {
+  int64_t synthesisStartUs = FlightRecorder::nowUs();
+  bool outputFinite = stft_->reconstructAudio(real, imag, audio);
+  finishSynthesis(outputFinite, real, imag, synthesisStartUs);
+  return outputFinite;
+}
+
+void EnhancerStream::finishSynthesis(bool outputFinite, const float *real,
+                                     const float *imag,
+                                     int64_t synthesisStartUs) {
+  double inferMs = 0.0;
+  if (pending_) {
+    inferMs =
+        static_cast<double>(synthesisStartUs - analysisDoneUs_) / 1000.0;
+    if (metrics_) {
+      metricsInc(metrics_->framesInferred);
+      metrics_->inferenceLatency.observe(inferMs);
+    }
+  }
+
+  if (outputFinite) {
+    enhancement_.analyzeOutput(real, imag);
+  } else {
+    enhancement_.skipFrame();
+    LOGE("Enhancer stream %lld: non-finite model output, state reset",
+         static_cast<long long>(streamId_));
+    if (metrics_) {
+      metricsInc(metrics_->nonFiniteEvents);
+      metricsInc(metrics_->stateResets);
+    }
+  }
+
+  if (pending_) {
+    pending_ = false;
+    FrameRecord record;
+    record.timeUs = analysisStartUs_;
+    record.preMs =
+        static_cast<float>(analysisDoneUs_ - analysisStartUs_) / 1000.0f;
+    record.inferMs = static_cast<float>(inferMs);
+    record.postMs =
+        static_cast<float>(FlightRecorder::nowUs() - synthesisStartUs) /
+        1000.0f;
+    record.totalMs = record.preMs + record.inferMs + record.postMs;
+    record.vadSpeech = 1;
+    if (inputNonFinite_ || !outputFinite) {
+      record.flags |= FRAME_NON_FINITE;
+    }
+    uint8_t flags = recorder_->record(record);
+    if (metrics_ && (flags & FRAME_DEADLINE_MISS)) {
+      metricsInc(metrics_->deadlineMisses);
+    }
+    if (metrics_ && (flags & FRAME_UNDERRUN)) {
+      metricsInc(metrics_->underruns);
+    }
+  }
+}
+
+void EnhancerStream::synthesizeScaled(float gain, float *audio) {
+  float real[NUM_BINS];
+  float imag[NUM_BINS];
+  for (int i = 0; i < NUM_BINS; i++) {
+    real[i] = real_[i] * gain;
+    imag[i] = imag_[i] * gain;
+  }
+  stft_->reconstructAudio(real, imag, audio);
+  pending_ = false;
+  enhancement_.skipFrame();
+}
+
+void EnhancerStream::synthesizeBypass(float *audio) {
+  synthesizeScaled(bypassGain_, audio);
+  if (metrics_) {
+    metricsInc(metrics_->neuralVadBypassed);
+  }
+}
+
+void EnhancerStream::countSkipped(uint64_t frames) {
+  if (metrics_) {
+    metricsInc(metrics_->framesTotal, frames);
+    metricsInc(metrics_->framesBypassed, frames);
+  }
+}
+
+FrameResult EnhancerStream::process(const float *audio, float *out,
+                                    SpectrumInference infer, void *userData) {
+  analyze(audio, nullptr, nullptr);
+  if (!gateOpen()) {
+    synthesizeBypass(out);
+    return FrameResult::GATED;
+  }
+  // The callback enhances the stream's bins in place
+  if (infer == nullptr || infer(userData, real_, imag_, NUM_BINS) != 0) {
+    synthesizeScaled(1.0f, out);
+    return FrameResult::INFERENCE_FAILED;
+  }
+  return synthesize(real_, imag_, out) ? FrameResult::INFERRED
+                                       : FrameResult::NON_FINITE;
+}
+
+void EnhancerStream::processBatch(EnhancerStream *const *streams,
+                                  const float *const *audio,
+                                  float *const *out, int count,
+                                  const SpectrumInference *infer,
+                                  void *const *userData,
+                                  FrameResult *results) {
+  for (int first = 0; first < count; first += MAX_BATCH) {
+    int n = std::min(count - first, MAX_BATCH);
+    if (n == 1) {
+      results[first] = streams[first]->process(audio[first], out[first],
+                                               infer[first], userData[first]);
+      continue;
+    }
+    processLanes(streams + first, audio + first, out + first, n, infer + first,
+                 userData + first, results + first);
+  }
+}
+
+void EnhancerStream::processLanes(EnhancerStream *const *streams,
+                                  const float *const *audio,
+                                  float *const *out, int count,
+                                  const SpectrumInference *infer,
+                                  void *const *userData,
+                                  FrameResult *results) {
+  STFTProcessor *stfts[MAX_BATCH];
+  const float *realIn[MAX_BATCH];
+  const float *imagIn[MAX_BATCH];
+  float *real[MAX_BATCH];
+  float *imag[MAX_BATCH];
+  float *audioOut[MAX_BATCH];
+  int64_t inferDoneUs[MAX_BATCH];
+
+  int64_t startUs = FlightRecorder::nowUs();
+  for (int i = 0; i < count; i++) {
+    EnhancerStream &stream = *streams[i];
+    stream.analysisStartUs_ = startUs;
+    stfts[i] = stream.stft_.get();
+    real[i] = stream.real_;
+    imag[i] = stream.imag_;
+  }
+  uint32_t nonFinite = batchAnalyze(stfts, audio, count, real, imag);
+  for (int i = 0; i < count; i++) {
+    streams[i]->finishAnalysis((nonFinite & (1u << i)) == 0);
+  }
+
+  // Gates and models run per stream; the frames they enhance are then
+  // synthesized together
+  int synthesized = 0;
+  for (int i = 0; i < count; i++) {
+    EnhancerStream &stream = *streams[i];
+    if (!stream.gateOpen()) {
+      stream.synthesizeBypass(out[i]);
+      results[i] = FrameResult::GATED;
+      continue;
+    }
+    if (infer[i] == nullptr ||
+        infer[i](userData[i], stream.real_, stream.imag_, NUM_BINS) != 0) {
+      stream.synthesizeScaled(1.0f, out[i]);
+      results[i] = FrameResult::INFERENCE_FAILED;
+      continue;
+    }
+    int lane = synthesized++;
+    stfts[lane] = stream.stft_.get();
+    realIn[lane] = stream.real_;
+    imagIn[lane] = stream.imag_;
+    audioOut[lane] = out[i];
+    inferDoneUs[lane] = FlightRecorder::nowUs();
+    results[i] = FrameResult::INFERRED;
+  }
+  if (synthesized == 0) {
+    return;
+  }
+
+  nonFinite = batchSynthesize(stfts, realIn, imagIn, synthesized, audioOut);
+  for (int i = 0, lane = 0; i < count; i++) {
+    if (results[i] != FrameResult::INFERRED) {
+      continue;
+    }
+    EnhancerStream &stream = *streams[i];
+    bool finite = (nonFinite & (1u << lane)) == 0;
+    stream.finishSynthesis(finite, stream.real_, stream.imag_,
+                           inferDoneUs[lane]);
+    if (!finite) {
+      results[i] = FrameResult::NON_FINITE;
+    }
+    lane++;
+  }
+}
+
+bool EnhancerStream::loadNeuralVad(const float *weights, int count) {
+  auto vad = std::make_unique<NeuralVad>(SAMPLE_RATE, STFTProcessor::FFT_SIZE);
+  if (!vad->loadWeights(weights, count)) {
+    return false;
+  }
+  vad->setThresholds(vadOn_, vadOff_, vadHang_);
+  vad->attachMemory(metrics_);
+  neuralVad_ = std::move(vad);
+  return true;
+}
+
+void EnhancerStream::setBypassGainDb(float db) {
+  bypassGainDb_ = db;
+  bypassGain_ = dbToGain(db);
+}
+
+void EnhancerStream::setVadThresholds(float onThreshold, float offThreshold,
+                                      int hangFrames) {
+  // Same clamping as NeuralVad, so the getters report what is applied
+  vadOn_ = onThreshold;
+  vadOff_ = std::min(offThreshold, onThreshold);
+  vadHang_ = std::max(0, hangFrames);
+  if (neuralVad_) {
+    neuralVad_->setThresholds(vadOn_, vadOff_, vadHang_);
+  }
+}
+
+void EnhancerStream::setDeadlineMs(float deadlineMs) {
+  deadlineMs_ = deadlineMs;
+  recorder_->setDeadlineMs(deadlineMs);
+}
+
+void EnhancerStream::reset() {
+  stft_->reset();
+  enhancement_.reset();
+  if (neuralVad_) {
+    neuralVad_->reset();
+  }
+  stateGuard_.discard();
+  pending_ = false;
+  LOGI("Enhancer stream %lld reset", static_cast<long long>(streamId_));
+}
+
+} // namespace poise
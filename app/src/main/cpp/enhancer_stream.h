@@ -0,0 +1,199 @@
+/**
+ * Enhancer Stream - Header
+ *
+ * One GTCRN enhancement stream: STFT analysis, the optional neural VAD
+ * gate, overlap-add synthesis, and the stream's metrics slot, flight
+ * recorder and enhancement estimates. The model itself belongs to the
+ * host, which runs it either between analyze() and synthesize() (the JVM,
+ * where inference is in ONNX Runtime for Java) or through a callback on the
+ * stream's own bins in process() (native hosts).
+ *
+ * Not internally synchronized; see poise_api.h for the threading rules.
+ */
+
+#ifndef ENHANCER_STREAM_H
+#define ENHANCER_STREAM_H
+
+#include "enhancement_metrics.h"
+#include "flight_recorder.h"
+#include "model_state_guard.h"
+#include "neural_vad.h"
+#include "stft.h"
+#include "stream_metrics.h"
+#include <cstdint>
+#include <memory>
+
+namespace poise {
+
+/**
+ * Runs the model in place on one frame of bins.
+ * @return 0 on success
+ */
+using SpectrumInference = int (*)(void *userData, float *real, float *imag,
+                                  int numBins);
+
+enum class FrameResult {
+  INFERRED,         // Model output synthesized
+  GATED,            // Neural VAD skipped inference; input attenuated
+  NON_FINITE,       // Model output was NaN/Inf; silence, synthesis reset
+  INFERENCE_FAILED, // Callback failed; input passed through unprocessed
+};
+
+class EnhancerStream {
+public:
+  static constexpr int SAMPLE_RATE = 16000;
+  static constexpr int FRAME_SAMPLES = STFTProcessor::HOP_SIZE;
+  static constexpr int NUM_BINS = STFTProcessor::NUM_BINS;
+  static constexpr float FRAME_MS = 16.0f;
+  // Gain on frames the neural VAD gates off (noise-only frames would
+  // otherwise have been suppressed by the model)
+  static constexpr float DEFAULT_BYPASS_GAIN_DB = -24.0f;
+
+  EnhancerStream();
+  ~EnhancerStream();
+
+  EnhancerStream(const EnhancerStream &) = delete;
+  EnhancerStream &operator=(const EnhancerStream &) = delete;
+
+  /**
+   * Analyze FRAME_SAMPLES of input and run the neural VAD on the bins.
+   * @param real, imag NUM_BINS each, may be null (bins stay internal)
+   * @return false if the input contained NaN/Inf (scrubbed to zero)
+   */
+  bool analyze(const float *audio, float *real, float *imag);
+
+  // True while the model should run on the last analyzed frame
+  bool gateOpen() const;
+
+  /**
+   * Synthesize the model output for the last analyzed frame.
+   * @return false if the spectrum was non-finite; audio is then silence
+   *         and the overlap-add state reset, so the host must reset its
+   *         model state too
+   */
+  bool synthesize(const float *real, const float *imag, float *audio);
+
+  // Synthesize the last analyzed frame attenuated, without inference
+  void synthesizeBypass(float *audio);
+
+  /**
+   * Count frames the host's own silence gate passed through without
+   * analysis, so per-frame cost and bypass ratio (admission control) cover
+   * them.
+   */
+  void countSkipped(uint64_t frames);
+
+  /**
+   * analyze(), then the callback on the stream's bins unless the gate is
+   * closed, then synthesis into FRAME_SAMPLES of output.
+   */
+  FrameResult process(const float *audio, float *out, SpectrumInference infer,
+                      void *userData);
+
+  /**
+   * process() for count streams at once, each with its own callback and
+   * user data. Analysis and synthesis run across the streams in SIMD lanes
+   * (stft_batch.h), MAX_BATCH at a time; results[i] is what process()
+   * would have returned for stream i. The streams must be distinct.
+   */
+  static void processBatch(EnhancerStream *const *streams,
+                           const float *const *audio, float *const *out,
+                           int count, const SpectrumInference *infer,
+                           void *const *userData, FrameResult *results);
+  static constexpr int MAX_BATCH = 16;
+
+  /**
+   * Load neural VAD weights (NeuralVad layout); replaces any loaded gate.
+   * @return false if the size does not match
+   */
+  bool loadNeuralVad(const float *weights, int count);
+  bool hasNeuralVad() const { return neuralVad_ != nullptr; }
+
+  void setBypassGainDb(float db);
+  float bypassGainDb() const { return bypassGainDb_; }
+
+  // Applied to the current and any later neural VAD
+  void setVadThresholds(float onThreshold, float offThreshold,
+                        int hangFrames);
+  float vadOnThreshold() const { return vadOn_; }
+  float vadOffThreshold() const { return vadOff_; }
+  int vadHangFrames() const { return vadHang_; }
+
+  void setDeadlineMs(float deadlineMs);
+  float deadlineMs() const { return deadlineMs_; }
+
+  // Flag an output underrun for the flight recorder (any thread)
+  void reportUnderrun() { recorder_->reportUnderrun(); }
+
+  /**
+   * Periodic health check of the host's model state (NaN/Inf or runaway
+   * values are zeroed in place).
+   * @return true if the state was reset
+   */
+  bool checkState(float *state, size_t count) {
+    return stateGuard_.check(state, count);
+  }
+
+  // Park the host's model state in the cold pool while the stream is idle
+  size_t parkState(const float *state, size_t count) {
+    return stateGuard_.park(state, count);
+  }
+
+  // Parked state back into the host's buffer (zeroed if that fails)
+  bool restoreState(float *state, size_t count) {
+    return stateGuard_.restore(state, count);
+  }
+
+  // Also drops parked model state
+  void reset();
+
+  int64_t streamId() const { return streamId_; }
+  // Null if the registry was full
+  const StreamMetrics *metrics() const { return metrics_; }
+  EnhancementStats enhancementStats() const {
+    return enhancement_.getStats();
+  }
+
+private:
+  // Analysis and synthesis bookkeeping after the transform
+  void finishAnalysis(bool inputFinite);
+  void finishSynthesis(bool outputFinite, const float *real,
+                       const float *imag, int64_t synthesisStartUs);
+  void synthesizeScaled(float gain, float *audio);
+
+  // processBatch() for 2..MAX_BATCH streams
+  static void processLanes(EnhancerStream *const *streams,
+                           const float *const *audio, float *const *out,
+                           int count, const SpectrumInference *infer,
+                           void *const *userData, FrameResult *results);
+
+  int64_t streamId_;
+  StreamMetrics *metrics_;
+  std::unique_ptr<STFTProcessor> stft_;
+  std::unique_ptr<FlightRecorder> recorder_;
+  std::unique_ptr<NeuralVad> neuralVad_;
+  EnhancementMetrics enhancement_;
+  ModelStateGuard stateGuard_;
+
+  // Bins of the last analyzed frame
+  float real_[NUM_BINS];
+  float imag_[NUM_BINS];
+
+  // Inference runs between analysis and synthesis; that interval is
+  // recorded as the stream's inference latency
+  int64_t analysisStartUs_;
+  int64_t analysisDoneUs_;
+  bool pending_;
+  bool inputNonFinite_;
+
+  float bypassGainDb_;
+  float bypassGain_;
+  float vadOn_;
+  float vadOff_;
+  int vadHang_;
+  float deadlineMs_;
+};
+
+} // namespace poise
+
+#endif // ENHANCER_STREAM_H
@@ -0,0 +1,205 @@
+/**
+ * Flight Recorder - Implementation
+ */
+
+#include "flight_recorder.h"
+#include "async_log.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#define LOG_TAG "PoiseFlightRec"
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) POISE_LOG(poise::LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+constexpr int WRITER_POLL_MS = 100;
+std::atomic<int> minDumpIntervalMs{10000};
+
+} // anonymous namespace
+
+/**
+ * Background thread that writes frozen windows to disk. The audio thread
+ * only publishes snapshots through an atomic flag, so it never waits on
+ * this thread or on file I/O.
+ */
+class FlightRecorderWriter {
+public:
+  static FlightRecorderWriter &instance() {
+    static FlightRecorderWriter writer;
+    return writer;
+  }
+
+  void add(FlightRecorder *recorder) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    recorders_.push_back(recorder);
+    if (!thread_.joinable()) {
+      thread_ = std::thread(&FlightRecorderWriter::run, this);
+    }
+  }
+
+  void remove(FlightRecorder *recorder) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    recorders_.erase(
+        std::remove(recorders_.begin(), recorders_.end(), recorder),
+        recorders_.end());
+  }
+
+  void setDirectory(const std::string &dir) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = dir;
+  }
+
+private:
+  FlightRecorderWriter() = default;
+
+  ~FlightRecorderWriter() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+      cv_.wait_for(lock, std::chrono::milliseconds(WRITER_POLL_MS));
+      for (FlightRecorder *recorder : recorders_) {
+        if (!recorder->snapshotReady_.load(std::memory_order_acquire)) {
+          continue;
+        }
+        if (!directory_.empty()) {
+          recorder->writeSnapshot(directory_);
+        }
+        recorder->snapshotReady_.store(false, std::memory_order_release);
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+  std::vector<FlightRecorder *> recorders_;
+  std::string directory_;
+  bool stop_ = false;
+};
+
+FlightRecorder::FlightRecorder(int64_t streamId, const char *model,
+                               float frameMs, float windowSeconds)
+    : streamId_(streamId), model_(model), deadlineMs_(frameMs), head_(0),
+      filled_(0), snapshotSize_(0), snapshotReason_(0), lastFreezeUs_(0) {
+  size_t capacity = static_cast<size_t>(
+      std::max(1.0f, windowSeconds * 1000.0f / std::max(frameMs, 0.1f)));
+  ring_.resize(capacity);
+  snapshot_.resize(capacity);
+  memory_.set((ring_.capacity() + snapshot_.capacity()) * sizeof(FrameRecord));
+  FlightRecorderWriter::instance().add(this);
+}
+
+FlightRecorder::~FlightRecorder() {
+  FlightRecorderWriter::instance().remove(this);
+}
+
+int64_t FlightRecorder::nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void FlightRecorder::setDumpDirectory(const std::string &dir) {
+  FlightRecorderWriter::instance().setDirectory(dir);
+  LOGI("Flight recorder dumps -> %s", dir.c_str());
+}
+
+void FlightRecorder::setMinDumpIntervalMs(int intervalMs) {
+  minDumpIntervalMs.store(intervalMs);
+}
+
+uint8_t FlightRecorder::record(FrameRecord record) {
+  record.queueLevel = queueLevel_.load(std::memory_order_relaxed);
+  if (record.totalMs > deadlineMs_) {
+    record.flags |= FRAME_DEADLINE_MISS;
+  }
+  if (underrunPending_.exchange(false, std::memory_order_relaxed)) {
+    record.flags |= FRAME_UNDERRUN;
+  }
+
+  ring_[head_] = record;
+  head_ = (head_ + 1) % static_cast<uint32_t>(ring_.size());
+  filled_ = std::min<uint32_t>(filled_ + 1, static_cast<uint32_t>(ring_.size()));
+
+  if ((record.flags &
+       (FRAME_DEADLINE_MISS | FRAME_UNDERRUN | FRAME_NON_FINITE)) != 0) {
+    freeze(record.flags);
+  }
+  return record.flags;
+}
+
+void FlightRecorder::freeze(uint8_t reason) {
+  // Writer still owns the previous snapshot
+  if (snapshotReady_.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  int64_t now = nowUs();
+  int64_t intervalUs =
+      static_cast<int64_t>(minDumpIntervalMs.load(std::memory_order_relaxed)) *
+      1000;
+  if (lastFreezeUs_ != 0 && now - lastFreezeUs_ < intervalUs) {
+    return;
+  }
+  lastFreezeUs_ = now;
+
+  // Copy oldest..newest into the snapshot
+  uint32_t capacity = static_cast<uint32_t>(ring_.size());
+  uint32_t start = (head_ + capacity - filled_) % capacity;
+  for (uint32_t i = 0; i < filled_; i++) {
+    snapshot_[i] = ring_[(start + i) % capacity];
+  }
+  snapshotSize_ = filled_;
+  snapshotReason_ = reason;
+  snapshotReady_.store(true, std::memory_order_release);
+}
+
+void FlightRecorder::writeSnapshot(const std::string &dir) {
+  char path[512];
+  std::snprintf(path, sizeof(path), "%s/poise_flight_%s_%lld_%lld.csv",
+                dir.c_str(), model_, static_cast<long long>(streamId_),
+                static_cast<long long>(lastFreezeUs_));
+
+  FILE *file = std::fopen(path, "w");
+  if (file == nullptr) {
+    LOGE("Cannot write flight record %s", path);
+    return;
+  }
+
+  std::fprintf(file,
+               "# stream=%lld model=%s reason=%s%s%s deadline_ms=%.3f\n",
+               static_cast<long long>(streamId_), model_,
+               (snapshotReason_ & FRAME_DEADLINE_MISS) ? "deadline_miss " : "",
+               (snapshotReason_ & FRAME_UNDERRUN) ? "underrun " : "",
+               (snapshotReason_ & FRAME_NON_FINITE) ? "non_finite" : "",
+               deadlineMs_);
+  std::fprintf(file, "time_us,pre_ms,infer_ms,post_ms,total_ms,queue_level,"
+                     "vad_speech,flags\n");
+  for (uint32_t i = 0; i < snapshotSize_; i++) {
+    const FrameRecord &r = snapshot_[i];
+    std::fprintf(file, "%lld,%.3f,%.3f,%.3f,%.3f,%d,%u,%u\n",
+                 static_cast<long long>(r.timeUs), r.preMs, r.inferMs,
+                 r.postMs, r.totalMs, r.queueLevel, r.vadSpeech, r.flags);
+  }
+  std::fclose(file);
+  LOGI("Flight record written: %s (%u frames)", path, snapshotSize_);
+}
+
+} // namespace poise
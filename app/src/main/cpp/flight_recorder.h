@@ -0,0 +1,111 @@
+/**
+ * Flight Recorder - Header
+ *
+ * Always-on ring buffer of per-frame stage timings, VAD decisions and queue
+ * levels. A deadline miss, reported underrun or non-finite event freezes the
+ * window and hands
+ * it to a background thread that writes it out as CSV (rate-limited).
+ */
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include "memory_accounting.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace poise {
+
+struct FrameRecord {
+  int64_t timeUs = 0; // Monotonic timestamp of frame start
+  float preMs = 0.0f; // Framing / STFT analysis
+  float inferMs = 0.0f;
+  float postMs = 0.0f; // Post-processing / synthesis
+  float totalMs = 0.0f;
+  int32_t queueLevel = -1; // Samples queued downstream, -1 if unknown
+  uint8_t vadSpeech = 0;
+  uint8_t flags = 0;
+};
+
+enum FrameFlags : uint8_t {
+  FRAME_DEADLINE_MISS = 1 << 0,
+  FRAME_UNDERRUN = 1 << 1,
+  FRAME_NON_FINITE = 1 << 2,
+};
+
+class FlightRecorder {
+public:
+  /**
+   * @param streamId Stream identifier used in dump file names
+   * @param model Static model label
+   * @param frameMs Frame duration; also the default deadline
+   * @param windowSeconds History kept in the ring
+   */
+  FlightRecorder(int64_t streamId, const char *model, float frameMs,
+                 float windowSeconds = 4.0f);
+  ~FlightRecorder();
+
+  FlightRecorder(const FlightRecorder &) = delete;
+  FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+  /**
+   * Append a frame (audio thread; no allocation or locking). Freezes the
+   * window if the frame missed its deadline or an underrun is pending.
+   * @return Final flags of the recorded frame
+   */
+  uint8_t record(FrameRecord record);
+
+  // Flag an output underrun; picked up on the next record() (any thread)
+  void reportUnderrun() { underrunPending_.store(true); }
+
+  // Latest downstream queue level, attached to subsequent records
+  void setQueueLevel(int32_t samples) { queueLevel_.store(samples); }
+
+  void setDeadlineMs(float deadlineMs) { deadlineMs_ = deadlineMs; }
+
+  // Charge the ring memory to a stream (nullptr detaches)
+  void attachMemory(StreamMetrics *stream) { memory_.attach(stream); }
+
+  static int64_t nowUs();
+
+  /**
+   * Directory for dump files. Recording is always on; dumps are only
+   * written once a directory is set.
+   */
+  static void setDumpDirectory(const std::string &dir);
+
+  // Minimum spacing between dumps of the same stream
+  static void setMinDumpIntervalMs(int intervalMs);
+
+private:
+  friend class FlightRecorderWriter;
+
+  void freeze(uint8_t reason);
+  void writeSnapshot(const std::string &dir);
+
+  int64_t streamId_;
+  const char *model_;
+  float deadlineMs_;
+
+  std::vector<FrameRecord> ring_;
+  uint32_t head_; // Next write position (audio thread only)
+  uint32_t filled_;
+
+  std::atomic<int32_t> queueLevel_{-1};
+  std::atomic<bool> underrunPending_{false};
+
+  // Frozen window handed to the writer thread
+  std::vector<FrameRecord> snapshot_;
+  uint32_t snapshotSize_;
+  uint8_t snapshotReason_;
+  int64_t lastFreezeUs_;
+  std::atomic<bool> snapshotReady_{false};
+
+  MemoryCharge memory_{MemoryComponent::FLIGHT_RECORDER};
+};
+
+} // namespace poise
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,147 @@
+/**
+ * Idle Gate - Implementation
+ */
+
+#include "idle_gate.h"
+#include "async_log.h"
+#include <algorithm>
+#include <cmath>
+
+#define LOG_TAG "PoiseIdleGate"
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+// Microseconds, so gates running at different rates can be summed
+std::atomic<int64_t> globalIdleUs{0};
+std::atomic<int> globalIdleGates{0};
+
+// Index of the first sample above threshold, or count if none
+int firstAbove(const float *samples, int count, float threshold) {
+  // Blockwise max keeps the common all-silent case vectorizable
+  constexpr int BLOCK = 64;
+  for (int start = 0; start < count; start += BLOCK) {
+    int end = start + BLOCK < count ? start + BLOCK : count;
+    float peak = 0.0f;
+    for (int i = start; i < end; i++) {
+      float a = std::fabs(samples[i]);
+      peak = a > peak ? a : peak;
+    }
+    if (peak > threshold) {
+      for (int i = start; i < end; i++) {
+        if (std::fabs(samples[i]) > threshold) {
+          return i;
+        }
+      }
+    }
+  }
+  return count;
+}
+
+} // namespace
+
+IdleGate::IdleGate(int sampleRate, int frameSamples, IdleGateConfig config)
+    : sampleRate_(sampleRate), frameSamples_(frameSamples), activeFrames_(1),
+      idle_(false), silentSamples_(0), idleSamples_(0), idleEntries_(0),
+      wakeFrame_(0) {
+  int probeFrames = static_cast<int>(std::ceil(
+      config.probeIntervalMs * sampleRate / (1000.0f * frameSamples)));
+  probeSamples_ = (probeFrames > 1 ? probeFrames : 1) * frameSamples;
+  int burstFrames = static_cast<int>(
+      config.maxBurstMs * sampleRate / (1000.0f * frameSamples));
+  maxActiveFrames_ = burstFrames > 1 ? burstFrames : 1;
+  silenceLinear_ = std::pow(10.0f, config.silenceDb / 20.0f);
+  enterAfterSamples_ =
+      static_cast<int64_t>(config.enterAfterMs * sampleRate / 1000.0f);
+}
+
+IdleGate::~IdleGate() {
+  if (idle_) {
+    globalIdleGates.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+int IdleGate::maxReadSamples() const {
+  int active = frameSamples_ * maxActiveFrames_;
+  return probeSamples_ > active ? probeSamples_ : active;
+}
+
+int IdleGate::setActiveFrames(int frames) {
+  activeFrames_ = std::clamp(frames, 1, maxActiveFrames_);
+  return activeFrames_;
+}
+
+void IdleGate::reset() {
+  if (idle_) {
+    globalIdleGates.fetch_sub(1, std::memory_order_relaxed);
+  }
+  idle_ = false;
+  silentSamples_ = 0;
+  wakeFrame_ = 0;
+}
+
+IdleEvent IdleGate::observe(const float *samples, int count) {
+  int first = firstAbove(samples, count, silenceLinear_);
+
+  if (idle_) {
+    if (first == count) {
+      idleSamples_ += count;
+      globalIdleUs.fetch_add(static_cast<int64_t>(count) * 1000000 /
+                                 sampleRate_,
+                             std::memory_order_relaxed);
+      return IdleEvent::IDLE;
+    }
+
+    // Frames before the first non-silent one are still idle time
+    wakeFrame_ = first / frameSamples_;
+    int64_t idleTail = static_cast<int64_t>(wakeFrame_) * frameSamples_;
+    idleSamples_ += idleTail;
+    globalIdleUs.fetch_add(idleTail * 1000000 / sampleRate_,
+                           std::memory_order_relaxed);
+
+    idle_ = false;
+    silentSamples_ = 0;
+    globalIdleGates.fetch_sub(1, std::memory_order_relaxed);
+    LOGI("Waking from idle (%lld ms idle total)",
+         static_cast<long long>(idleSamples_ * 1000 / sampleRate_));
+    return IdleEvent::WAKE;
+  }
+
+  if (first < count) {
+    silentSamples_ = 0;
+    return IdleEvent::ACTIVE;
+  }
+
+  silentSamples_ += count;
+  if (silentSamples_ < enterAfterSamples_) {
+    return IdleEvent::SILENT;
+  }
+
+  idle_ = true;
+  idleEntries_++;
+  globalIdleGates.fetch_add(1, std::memory_order_relaxed);
+  LOGI("Entering idle after %lld ms of silence (probe every %d samples)",
+       static_cast<long long>(silentSamples_ * 1000 / sampleRate_),
+       probeSamples_);
+  return IdleEvent::ENTER_IDLE;
+}
+
+IdleGateStats IdleGate::getStats() const {
+  IdleGateStats stats;
+  stats.idle = idle_;
+  stats.idleMs = idleSamples_ * 1000 / sampleRate_;
+  stats.idleEntries = idleEntries_;
+  return stats;
+}
+
+int64_t IdleGate::totalIdleMs() {
+  return globalIdleUs.load(std::memory_order_relaxed) / 1000;
+}
+
+int IdleGate::idleGateCount() {
+  return globalIdleGates.load(std::memory_order_relaxed);
+}
+
+} // namespace poise
@@ -0,0 +1,102 @@
+/**
+ * Idle Gate - Header
+ *
+ * Detects sustained digital silence on the capture side and switches the
+ * capture loop into a low-rate probe: instead of waking every frame it
+ * reads one large block per probe interval and scans it for signal. Any
+ * non-silent sample wakes the full pipeline immediately, so processing
+ * resumes at the first frame that carries audio.
+ */
+
+#ifndef IDLE_GATE_H
+#define IDLE_GATE_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace poise {
+
+struct IdleGateConfig {
+  float silenceDb = -90.0f;      // Peak level treated as digital silence
+  float enterAfterMs = 2000.0f;  // Sustained silence before going idle
+  float probeIntervalMs = 100.0f; // Block length read while idle
+  float maxBurstMs = 200.0f;      // Longest active read (see PowerMode)
+};
+
+enum class IdleEvent : int {
+  ACTIVE = 0,     // Process this frame
+  SILENT = 1,     // Silent but not yet idle; process as usual
+  ENTER_IDLE = 2, // Just went idle; stop output, switch to probe reads
+  IDLE = 3,       // Probe block was silent; nothing to do
+  WAKE = 4,       // Probe block had signal; process from wakeOffset()
+};
+
+struct IdleGateStats {
+  bool idle = false;
+  int64_t idleMs = 0; // Total time spent idle, including the current span
+  int idleEntries = 0;
+};
+
+class IdleGate {
+public:
+  /**
+   * @param sampleRate Capture rate
+   * @param frameSamples Samples per pipeline read while active
+   */
+  IdleGate(int sampleRate, int frameSamples, IdleGateConfig config = {});
+  ~IdleGate();
+
+  /**
+   * Feed the block just read. count must be readSamples() as returned
+   * before the read.
+   */
+  IdleEvent observe(const float *samples, int count);
+
+  // Samples to read next: the active frames when active, a probe block when
+  // idle
+  int readSamples() const {
+    return idle_ ? probeSamples_ : frameSamples_ * activeFrames_;
+  }
+  int probeSamples() const { return probeSamples_; }
+
+  // Largest readSamples() can return; size capture buffers with this
+  int maxReadSamples() const;
+
+  /**
+   * Frames read per wake-up while active (1 unless bursting). Clamped to
+   * the configured maxBurstMs.
+   * @return The value applied
+   */
+  int setActiveFrames(int frames);
+
+  // After WAKE: first frame index (in frameSamples units) holding signal
+  int wakeOffset() const { return wakeFrame_; }
+
+  bool isIdle() const { return idle_; }
+  IdleGateStats getStats() const;
+
+  void reset();
+
+  // Process-wide totals for the metrics exporter
+  static int64_t totalIdleMs();
+  static int idleGateCount();
+
+private:
+  int sampleRate_;
+  int frameSamples_;
+  int probeSamples_; // Whole number of frames
+  int activeFrames_;
+  int maxActiveFrames_;
+  float silenceLinear_;
+  int64_t enterAfterSamples_;
+
+  bool idle_;
+  int64_t silentSamples_;
+  int64_t idleSamples_;
+  int idleEntries_;
+  int wakeFrame_;
+};
+
+} // namespace poise
+
+#endif // IDLE_GATE_H
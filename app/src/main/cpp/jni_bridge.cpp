@@ -6,30 +6,45 @@
  * with onnxruntime-android AAR package.
  */
 
-#include "poise_processor.h"
-#include "resampler.h"
-#include <android/log.h>
+#include "admission_control.h"
+#include "async_log.h"
+#include "poise_api.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <jni.h>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #define LOG_TAG "PoiseJNI"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) POISE_LOG(poise::LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
 namespace {
 
-// Store processor instances by handle
-std::unordered_map<jlong, std::unique_ptr<poise::PoiseProcessor>> processors;
-std::unordered_map<jlong, std::unique_ptr<poise::StreamingResampler>>
-    inputResamplers;
-std::unordered_map<jlong, std::unique_ptr<poise::StreamingResampler>>
-    outputResamplers;
+// Legacy processors are driven through the C API (poise_api.h); inference
+// runs on the Kotlin side between check_vad and finish_frame
+std::unordered_map<jlong, poise_processor *> processors;
 std::mutex processorMutex;
 jlong nextHandle = 1;
 
+// Caller holds processorMutex
+poise_processor *findProcessor(jlong handle) {
+  auto it = processors.find(handle);
+  return it != processors.end() ? it->second : nullptr;
+}
+
+// Copy a Kotlin frame into a full model frame, zero-padded
+void getFrame(JNIEnv *env, jfloatArray array,
+              float (&frame)[POISE_LEGACY_FRAME_SAMPLES]) {
+  jsize count = std::min<jsize>(env->GetArrayLength(array),
+                                POISE_LEGACY_FRAME_SAMPLES);
+  env->GetFloatArrayRegion(array, 0, count, frame);
+  std::fill(frame + count, frame + POISE_LEGACY_FRAME_SAMPLES, 0.0f);
+}
+
 } // anonymous namespace
 
 extern "C" {
@@ -40,11 +55,18 @@ extern "C" {
  */
 JNIEXPORT jlong JNICALL Java_com_poise_android_audio_PoiseProcessor_nativeInit(
     JNIEnv *env, jobject thiz, jfloat vadThresholdDb, jfloat attenLimDb) {
-  std::lock_guard<std::mutex> lock(processorMutex);
+  poise_processor_config config;
+  poise_processor_config_init(&config);
+  config.vad_threshold_db = vadThresholdDb;
+  config.atten_lim_db = attenLimDb;
+  poise_processor *processor = nullptr;
+  if (poise_processor_create(&config, &processor) != POISE_OK) {
+    return 0;
+  }
 
+  std::lock_guard<std::mutex> lock(processorMutex);
   jlong handle = nextHandle++;
-  processors[handle] =
-      std::make_unique<poise::PoiseProcessor>(vadThresholdDb, attenLimDb);
+  processors[handle] = processor;
 
   LOGI("Created processor with handle %lld", handle);
   return handle;
@@ -58,9 +80,14 @@ Java_com_poise_android_audio_PoiseProcessor_nativeSetupInputResampler(
     JNIEnv *env, jobject thiz, jlong handle, jint inputSr, jint targetSr) {
   std::lock_guard<std::mutex> lock(processorMutex);
 
-  if (inputSr != targetSr) {
-    inputResamplers[handle] =
-        std::make_unique<poise::StreamingResampler>(inputSr, targetSr);
+  if (targetSr != POISE_LEGACY_SAMPLE_RATE) {
+    LOGE("Model rate must be %d Hz, not %d", POISE_LEGACY_SAMPLE_RATE,
+         targetSr);
+    return;
+  }
+  if (inputSr != targetSr &&
+      poise_processor_set_capture_rate(findProcessor(handle), inputSr) ==
+          POISE_OK) {
     LOGI("Input resampler created: %d -> %d Hz", inputSr, targetSr);
   }
 }
@@ -73,16 +100,22 @@ Java_com_poise_android_audio_PoiseProcessor_nativeSetupOutputResampler(
     JNIEnv *env, jobject thiz, jlong handle, jint targetSr, jint outputSr) {
   std::lock_guard<std::mutex> lock(processorMutex);
 
-  if (targetSr != outputSr) {
-    outputResamplers[handle] =
-        std::make_unique<poise::StreamingResampler>(targetSr, outputSr);
+  if (targetSr != POISE_LEGACY_SAMPLE_RATE) {
+    LOGE("Model rate must be %d Hz, not %d", POISE_LEGACY_SAMPLE_RATE,
+         targetSr);
+    return;
+  }
+  if (targetSr != outputSr &&
+      poise_processor_set_playback_rate(findProcessor(handle), outputSr) ==
+          POISE_OK) {
     LOGI("Output resampler created: %d -> %d Hz", targetSr, outputSr);
   }
 }
 
 /**
- * Process a frame of audio through VAD and post-processing.
- * Returns the processed frame (or input if silence detected).
+ * Scrub and resample captured audio into a model frame.
+ * @return The 480-sample frame, or null until the input resampler has a
+ *         full frame
  *
  * Note: ONNX inference is done on Kotlin side, this method handles
  * VAD check and post-processing only.
@@ -92,8 +125,8 @@ Java_com_poise_android_audio_PoiseProcessor_nativeProcessPreInference(
     JNIEnv *env, jobject thiz, jlong handle, jfloatArray audioData) {
   std::lock_guard<std::mutex> lock(processorMutex);
 
-  auto it = processors.find(handle);
-  if (it == processors.end()) {
+  poise_processor *processor = findProcessor(handle);
+  if (processor == nullptr) {
     LOGE("Invalid processor handle: %lld", handle);
     return nullptr;
   }
@@ -103,26 +136,14 @@ Java_com_poise_android_audio_PoiseProcessor_nativeProcessPreInference(
   std::vector<float> input(len);
   env->GetFloatArrayRegion(audioData, 0, len, input.data());
 
-  // Apply input resampling if configured
-  auto resamplerIt = inputResamplers.find(handle);
-  if (resamplerIt != inputResamplers.end()) {
-    input = resamplerIt->second->process(input, 480);
-    if (input.empty()) {
-      return nullptr; // Not enough samples yet
-    }
-  }
-
-  // Normalize frame size to 480 samples
-  if (input.size() < 480) {
-    input.resize(480, 0.0f);
-  } else if (input.size() > 480) {
-    input.resize(480);
+  float frame[POISE_LEGACY_FRAME_SAMPLES];
+  if (poise_processor_begin_frame(processor, input.data(), len, frame) !=
+      POISE_OK) {
+    return nullptr; // Not enough samples yet; no frame was begun
   }
 
-  // Create output array
-  jfloatArray result = env->NewFloatArray(480);
-  env->SetFloatArrayRegion(result, 0, 480, input.data());
-
+  jfloatArray result = env->NewFloatArray(POISE_LEGACY_FRAME_SAMPLES);
+  env->SetFloatArrayRegion(result, 0, POISE_LEGACY_FRAME_SAMPLES, frame);
   return result;
 }
 
@@ -136,92 +157,63 @@ Java_com_poise_android_audio_PoiseProcessor_nativeCheckVAD(
     JNIEnv *env, jobject thiz, jlong handle, jfloatArray audioData) {
   std::lock_guard<std::mutex> lock(processorMutex);
 
-  auto it = processors.find(handle);
-  if (it == processors.end()) {
+  poise_processor *processor = findProcessor(handle);
+  if (processor == nullptr) {
     return JNI_TRUE; // Default to processing if handle invalid
   }
 
-  jsize len = env->GetArrayLength(audioData);
-  std::vector<float> audio(len);
-  env->GetFloatArrayRegion(audioData, 0, len, audio.data());
-
-  // Calculate RMS energy
-  float sumSquares = 0.0f;
-  for (float sample : audio) {
-    sumSquares += sample * sample;
-  }
-  float rms = std::sqrt(sumSquares / static_cast<float>(len));
-
-  // Convert to dB (with floor to avoid log(0))
-  float energyDb = -100.0f; // Default for silence
-  if (rms > 1e-10f) {
-    energyDb = 20.0f * std::log10(rms);
-  }
-
-  // Get threshold from processor (default -40 dB)
-  float vadThreshold = it->second->getVadThresholdDb();
+  float frame[POISE_LEGACY_FRAME_SAMPLES];
+  getFrame(env, audioData, frame);
 
-  // Return true if energy above threshold (speech), false if below (silence)
-  bool isSpeech = energyDb > vadThreshold;
-
-  return isSpeech ? JNI_TRUE : JNI_FALSE;
+  // Energy above the processor's threshold (default -40 dB) is speech
+  return poise_processor_check_vad(processor, frame) == POISE_OK ? JNI_TRUE
+                                                                 : JNI_FALSE;
 }
 
 /**
- * Apply post-processing (soft limiter, clipping, DC removal).
+ * Apply post-processing (soft limiter, clipping, DC removal) to the model
+ * output, or to the pre-processed frame when the VAD bypassed inference.
+ * @param states The model's new recurrent state (null if inference did not
+ *        run); zeroed in place if it is poisoned or has diverged
  */
 JNIEXPORT jfloatArray JNICALL
 Java_com_poise_android_audio_PoiseProcessor_nativePostProcess(
-    JNIEnv *env, jobject thiz, jlong handle, jfloatArray audioData) {
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray audioData,
+    jfloatArray states) {
   std::lock_guard<std::mutex> lock(processorMutex);
 
-  auto it = processors.find(handle);
-  if (it == processors.end()) {
+  poise_processor *processor = findProcessor(handle);
+  if (processor == nullptr) {
     LOGE("Invalid processor handle: %lld", handle);
     return audioData;
   }
 
-  jsize len = env->GetArrayLength(audioData);
-  std::vector<float> audio(len);
-  env->GetFloatArrayRegion(audioData, 0, len, audio.data());
-
-  // Apply soft limiter
-  float maxVal = 0.0f;
-  for (float sample : audio) {
-    maxVal = std::max(maxVal, std::abs(sample));
-  }
-  if (maxVal > 0.98f && maxVal > 0.0f) {
-    float scale = 0.98f / maxVal;
-    for (float &sample : audio) {
-      sample *= scale;
+  float audio[POISE_LEGACY_FRAME_SAMPLES];
+  getFrame(env, audioData, audio);
+
+  // Soft limiter, clipping and DC removal, then output resampling; closes
+  // the frame's metrics
+  std::vector<float> output(poise_processor_max_output(processor));
+  int written = 0;
+  poise_processor_finish_frame(processor, audio, output.data(),
+                               static_cast<int>(output.size()), &written);
+
+  // The state is only touched when it is due for a scan or known to be
+  // poisoned, and written back only if it was reset
+  if (poise_processor_state_due(processor) && states != nullptr) {
+    jsize stateCount = env->GetArrayLength(states);
+    auto *values =
+        static_cast<float *>(env->GetPrimitiveArrayCritical(states, nullptr));
+    if (values != nullptr) {
+      bool reset = poise_processor_check_state(processor, values,
+                                               stateCount) != POISE_OK;
+      env->ReleasePrimitiveArrayCritical(states, values, reset ? 0 : JNI_ABORT);
     }
   }
 
-  // Clip and remove DC
-  float mean = 0.0f;
-  for (float &sample : audio) {
-    sample = std::clamp(sample, -1.0f, 1.0f);
-    mean += sample;
-  }
-  mean /= static_cast<float>(audio.size());
-  for (float &sample : audio) {
-    sample -= mean;
-  }
-
-  // Apply output resampling if configured
-  auto resamplerIt = outputResamplers.find(handle);
-  if (resamplerIt != outputResamplers.end()) {
-    int outputSize =
-        static_cast<int>(480 * resamplerIt->second->getOutputSampleRate() /
-                         resamplerIt->second->getInputSampleRate());
-    audio = resamplerIt->second->process(audio, outputSize);
-  }
-
   // Create result array
-  jfloatArray result = env->NewFloatArray(static_cast<jsize>(audio.size()));
-  env->SetFloatArrayRegion(result, 0, static_cast<jsize>(audio.size()),
-                           audio.data());
-
+  jfloatArray result = env->NewFloatArray(written);
+  env->SetFloatArrayRegion(result, 0, written, output.data());
   return result;
 }
 
@@ -234,53 +226,117 @@ Java_com_poise_android_audio_PoiseProcessor_nativeGetStats(JNIEnv *env,
                                                            jlong handle) {
   std::lock_guard<std::mutex> lock(processorMutex);
 
-  auto it = processors.find(handle);
-  if (it == processors.end()) {
+  poise_processor_stats stats = poise_processor_stats();
+  stats.struct_size = sizeof(stats);
+  if (poise_processor_get_stats(findProcessor(handle), &stats) != POISE_OK) {
     return nullptr;
   }
 
-  auto stats = it->second->getStats();
-
-  // Find and create ProcessingStats class
+  // The full primary constructor of the Kotlin data class; the fields the
+  // legacy processor has no counterpart for take the Kotlin defaults
   jclass statsClass = env->FindClass("com/poise/android/audio/ProcessingStats");
-  if (statsClass == nullptr) {
+  jclass modeClass = env->FindClass("com/poise/android/audio/PowerMode");
+  if (statsClass == nullptr || modeClass == nullptr) {
     LOGE("Failed to find ProcessingStats class");
     return nullptr;
   }
 
-  jmethodID constructor = env->GetMethodID(statsClass, "<init>", "(IDFIIIF)V");
-  if (constructor == nullptr) {
+  jmethodID constructor = env->GetMethodID(
+      statsClass, "<init>",
+      "(IDFIIIFZZJIDZJFILcom/poise/android/audio/PowerMode;FJJJFFF)V");
+  jfieldID lowLatency = env->GetStaticFieldID(
+      modeClass, "LOW_LATENCY", "Lcom/poise/android/audio/PowerMode;");
+  if (constructor == nullptr || lowLatency == nullptr) {
     LOGE("Failed to find ProcessingStats constructor");
     return nullptr;
   }
 
-  return env->NewObject(statsClass, constructor, stats.frameCount,
-                        stats.avgTimeMs, stats.rtf, stats.vadTotal,
-                        stats.vadActive, static_cast<int>(stats.vadBypassed),
-                        stats.vadBypassRatio);
+  return env->NewObject(
+      statsClass, constructor, static_cast<jint>(stats.frames_inferred),
+      stats.inference_ms_avg, stats.rtf, static_cast<jint>(stats.vad_frames),
+      static_cast<jint>(stats.vad_speech),
+      static_cast<jint>(stats.vad_bypassed), stats.vad_bypass_ratio,
+      stats.vad_active ? JNI_TRUE : JNI_FALSE,
+      stats.state_parked ? JNI_TRUE : JNI_FALSE,
+      static_cast<jlong>(stats.cold_pool_saved_bytes), 0, 0.0, JNI_FALSE,
+      static_cast<jlong>(0), 0.0f, 0,
+      env->GetStaticObjectField(modeClass, lowLatency), 0.0f,
+      static_cast<jlong>(stats.memory_bytes),
+      static_cast<jlong>(stats.memory_peak_bytes), static_cast<jlong>(0), 0.0f,
+      0.0f, 0.0f);
 }
 
 /**
- * Reset processor state.
+ * Report an output underrun (feeds the flight recorder).
  */
-JNIEXPORT void JNICALL Java_com_poise_android_audio_PoiseProcessor_nativeReset(
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_PoiseProcessor_nativeReportUnderrun(
     JNIEnv *env, jobject thiz, jlong handle) {
   std::lock_guard<std::mutex> lock(processorMutex);
+  poise_processor_report_underrun(findProcessor(handle));
+}
 
-  auto it = processors.find(handle);
-  if (it != processors.end()) {
-    it->second->reset();
-    LOGI("Processor %lld reset", handle);
+/**
+ * Park the model state in the cold pool while the stream is silent; the
+ * caller then drops its copy.
+ * @return Bytes of state parked, 0 for an invalid handle
+ */
+JNIEXPORT jlong JNICALL
+Java_com_poise_android_audio_PoiseProcessor_nativeParkState(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray states) {
+  std::lock_guard<std::mutex> lock(processorMutex);
+
+  poise_processor *processor = findProcessor(handle);
+  if (processor == nullptr) {
+    return 0;
+  }
+  jsize count = env->GetArrayLength(states);
+  auto *values =
+      static_cast<float *>(env->GetPrimitiveArrayCritical(states, nullptr));
+  if (values == nullptr) {
+    return 0;
   }
+  poise_status status = poise_processor_park_state(processor, values, count);
+  env->ReleasePrimitiveArrayCritical(states, values, JNI_ABORT);
+  return status == POISE_OK ? static_cast<jlong>(count * sizeof(float)) : 0;
+}
+
+/**
+ * Restore parked model state into states.
+ * @return false if nothing matching was parked (states are zeroed)
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_audio_PoiseProcessor_nativeRestoreState(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray states) {
+  std::lock_guard<std::mutex> lock(processorMutex);
 
-  auto inputIt = inputResamplers.find(handle);
-  if (inputIt != inputResamplers.end()) {
-    inputIt->second->reset();
+  poise_processor *processor = findProcessor(handle);
+  if (processor == nullptr) {
+    return JNI_FALSE;
   }
+  jsize count = env->GetArrayLength(states);
+  auto *values =
+      static_cast<float *>(env->GetPrimitiveArrayCritical(states, nullptr));
+  if (values == nullptr) {
+    return JNI_FALSE;
+  }
+  bool restored =
+      poise_processor_restore_state(processor, values, count) == POISE_OK;
+  env->ReleasePrimitiveArrayCritical(states, values, 0);
+  return restored ? JNI_TRUE : JNI_FALSE;
+}
 
-  auto outputIt = outputResamplers.find(handle);
-  if (outputIt != outputResamplers.end()) {
-    outputIt->second->reset();
+/**
+ * Reset processor and resampler state.
+ */
+JNIEXPORT void JNICALL Java_com_poise_android_audio_PoiseProcessor_nativeReset(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(processorMutex);
+
+  poise_processor *processor = findProcessor(handle);
+  if (processor != nullptr) {
+    poise_processor_reset(processor);
+    LOGI("Processor %lld reset", handle);
   }
 }
 
@@ -293,26 +349,58 @@ Java_com_poise_android_audio_PoiseProcessor_nativeDestroy(JNIEnv *env,
                                                           jlong handle) {
   std::lock_guard<std::mutex> lock(processorMutex);
 
-  processors.erase(handle);
-  inputResamplers.erase(handle);
-  outputResamplers.erase(handle);
-
+  auto it = processors.find(handle);
+  if (it != processors.end()) {
+    poise_processor_destroy(it->second);
+    processors.erase(it);
+  }
   LOGI("Processor %lld destroyed", handle);
 }
 
+/**
+ * Native heap bytes charged to this stream.
+ * @return [current, peak], zeros if the stream has no metrics slot
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_poise_android_audio_PoiseProcessor_nativeMemoryUsage(JNIEnv *env,
+                                                              jobject thiz,
+                                                              jlong handle) {
+  std::lock_guard<std::mutex> lock(processorMutex);
+
+  jlong values[2] = {0, 0};
+  poise_processor_stats stats = poise_processor_stats();
+  stats.struct_size = sizeof(stats);
+  if (poise_processor_get_stats(findProcessor(handle), &stats) == POISE_OK) {
+    values[0] = stats.memory_bytes;
+    values[1] = stats.memory_peak_bytes;
+  }
+  jlongArray result = env->NewLongArray(2);
+  env->SetLongArrayRegion(result, 0, 2, values);
+  return result;
+}
+
 // ============================================================================
 // GTCRN STFT Processor JNI Methods
 // ============================================================================
 
 } // extern "C"
 
-// GTCRN STFT support
-#include "stft.h"
+// GTCRN streams are driven through the C API (poise_api.h); inference runs
+// on the Kotlin side between analyze and synthesize
+#include "stream_metrics.h"
 
 namespace {
-std::unordered_map<jlong, std::unique_ptr<poise::STFTProcessor>> stftProcessors;
+
+// Handles stay a map lookup so a stale handle from Kotlin is harmless
+std::unordered_map<jlong, poise_stream *> stftStreams;
 std::mutex stftMutex;
 jlong nextStftHandle = 1;
+
+// Caller holds stftMutex
+poise_stream *findStftStream(jlong handle) {
+  auto it = stftStreams.find(handle);
+  return it != stftStreams.end() ? it->second : nullptr;
+}
 } // namespace
 
 extern "C" {
@@ -323,10 +411,14 @@ extern "C" {
 JNIEXPORT jlong JNICALL
 Java_com_poise_android_audio_GTCRNProcessor_nativeSTFTInit(JNIEnv *env,
                                                            jobject thiz) {
-  std::lock_guard<std::mutex> lock(stftMutex);
+  poise_stream *stream = nullptr;
+  if (poise_stream_create(nullptr, &stream) != POISE_OK) {
+    return 0;
+  }
 
+  std::lock_guard<std::mutex> lock(stftMutex);
   jlong handle = nextStftHandle++;
-  stftProcessors[handle] = std::make_unique<poise::STFTProcessor>();
+  stftStreams[handle] = stream;
 
   LOGI("GTCRN STFT processor created, handle=%lld", handle);
   return handle;
@@ -342,65 +434,58 @@ Java_com_poise_android_audio_GTCRNProcessor_nativeComputeSTFT(
     JNIEnv *env, jobject thiz, jlong handle, jfloatArray audioChunk) {
   std::lock_guard<std::mutex> lock(stftMutex);
 
-  auto it = stftProcessors.find(handle);
-  if (it == stftProcessors.end()) {
+  poise_stream *stream = findStftStream(handle);
+  if (stream == nullptr) {
     LOGE("Invalid STFT handle: %lld", handle);
     return nullptr;
   }
 
-  // Get input audio
-  jfloat *audioData = env->GetFloatArrayElements(audioChunk, nullptr);
-
-  // Output buffers
-  float realOut[257];
-  float imagOut[257];
+  float audio[POISE_FRAME_SAMPLES] = {};
+  jsize count = std::min<jsize>(env->GetArrayLength(audioChunk),
+                                POISE_FRAME_SAMPLES);
+  env->GetFloatArrayRegion(audioChunk, 0, count, audio);
 
-  // Compute STFT
-  it->second->computeSTFT(audioData, realOut, imagOut);
-
-  env->ReleaseFloatArrayElements(audioChunk, audioData, 0);
-
-  // Create output array (257 real + 257 imag = 514 floats)
-  jfloatArray result = env->NewFloatArray(514);
-  env->SetFloatArrayRegion(result, 0, 257, realOut);
-  env->SetFloatArrayRegion(result, 257, 257, imagOut);
+  // The gate decision is read separately through nativeGateSpeech
+  float bins[2 * POISE_NUM_BINS];
+  poise_stream_analyze(stream, audio, bins, bins + POISE_NUM_BINS);
 
+  jfloatArray result = env->NewFloatArray(2 * POISE_NUM_BINS);
+  env->SetFloatArrayRegion(result, 0, 2 * POISE_NUM_BINS, bins);
   return result;
 }
 
 /**
  * Reconstruct audio from STFT frame.
  * @param stftData Float array with 514 values (257 real + 257 imag)
- * @return Float array with 256 audio samples
+ * @return Float array with 256 audio samples, or null if the model output
+ *         was non-finite (overlap-add state has been reset; the caller must
+ *         reset its model caches)
  */
 JNIEXPORT jfloatArray JNICALL
 Java_com_poise_android_audio_GTCRNProcessor_nativeReconstruct(
     JNIEnv *env, jobject thiz, jlong handle, jfloatArray stftData) {
   std::lock_guard<std::mutex> lock(stftMutex);
 
-  auto it = stftProcessors.find(handle);
-  if (it == stftProcessors.end()) {
+  poise_stream *stream = findStftStream(handle);
+  if (stream == nullptr) {
     LOGE("Invalid STFT handle: %lld", handle);
     return nullptr;
   }
+  if (env->GetArrayLength(stftData) < 2 * POISE_NUM_BINS) {
+    return nullptr;
+  }
 
-  // Get STFT data
-  jfloat *data = env->GetFloatArrayElements(stftData, nullptr);
-  float *realIn = data;
-  float *imagIn = data + 257;
-
-  // Output buffer
-  float audioOut[256];
-
-  // Reconstruct audio
-  it->second->reconstructAudio(realIn, imagIn, audioOut);
-
-  env->ReleaseFloatArrayElements(stftData, data, 0);
+  float bins[2 * POISE_NUM_BINS];
+  env->GetFloatArrayRegion(stftData, 0, 2 * POISE_NUM_BINS, bins);
 
-  // Create output array
-  jfloatArray result = env->NewFloatArray(256);
-  env->SetFloatArrayRegion(result, 0, 256, audioOut);
+  float audioOut[POISE_FRAME_SAMPLES];
+  if (poise_stream_synthesize(stream, bins, bins + POISE_NUM_BINS,
+                              audioOut) != POISE_OK) {
+    return nullptr;
+  }
 
+  jfloatArray result = env->NewFloatArray(POISE_FRAME_SAMPLES);
+  env->SetFloatArrayRegion(result, 0, POISE_FRAME_SAMPLES, audioOut);
   return result;
 }
 
@@ -412,12 +497,176 @@ Java_com_poise_android_audio_GTCRNProcessor_nativeSTFTReset(JNIEnv *env,
                                                             jobject thiz,
                                                             jlong handle) {
   std::lock_guard<std::mutex> lock(stftMutex);
+  poise_stream_reset(findStftStream(handle));
+}
 
-  auto it = stftProcessors.find(handle);
-  if (it != stftProcessors.end()) {
-    it->second->reset();
-    LOGI("STFT processor %lld reset", handle);
+/**
+ * Load neural VAD gate weights for a GTCRN stream.
+ * @param weights Flat float array in NeuralVad layout
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_audio_GTCRNProcessor_nativeLoadNeuralVad(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray weights) {
+  std::lock_guard<std::mutex> lock(stftMutex);
+
+  poise_stream *stream = findStftStream(handle);
+  if (stream == nullptr) {
+    return JNI_FALSE;
+  }
+
+  jsize len = env->GetArrayLength(weights);
+  std::vector<float> data(len);
+  env->GetFloatArrayRegion(weights, 0, len, data.data());
+  return poise_stream_load_neural_vad(stream, data.data(), len) == POISE_OK
+             ? JNI_TRUE
+             : JNI_FALSE;
+}
+
+/**
+ * Neural VAD decision for the last analyzed frame.
+ * Returns true (run the model) when no neural VAD is loaded.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_audio_GTCRNProcessor_nativeGateSpeech(JNIEnv *env,
+                                                             jobject thiz,
+                                                             jlong handle) {
+  std::lock_guard<std::mutex> lock(stftMutex);
+  return poise_stream_gate_open(findStftStream(handle)) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Synthesize the last analyzed frame without inference (neural VAD gated it
+ * off). The spectrum is attenuated and overlap-added so synthesis stays
+ * continuous with model-processed frames.
+ * @return Float array with 256 audio samples
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_poise_android_audio_GTCRNProcessor_nativeReconstructBypass(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(stftMutex);
+
+  poise_stream *stream = findStftStream(handle);
+  if (stream == nullptr) {
+    LOGE("Invalid STFT handle: %lld", handle);
+    return nullptr;
+  }
+
+  float audioOut[POISE_FRAME_SAMPLES];
+  poise_stream_synthesize_bypass(stream, audioOut);
+
+  jfloatArray result = env->NewFloatArray(POISE_FRAME_SAMPLES);
+  env->SetFloatArrayRegion(result, 0, POISE_FRAME_SAMPLES, audioOut);
+  return result;
+}
+
+/**
+ * Periodic health check of the model caches held on the Kotlin side.
+ * @return true if any cache held NaN/Inf or diverged values (that cache was
+ *         zeroed; the caller resets the others)
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_audio_GTCRNProcessor_nativeCheckCaches(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray convCache,
+    jfloatArray traCache, jfloatArray interCache) {
+  std::lock_guard<std::mutex> lock(stftMutex);
+
+  poise_stream *stream = findStftStream(handle);
+  if (stream == nullptr) {
+    return JNI_FALSE;
+  }
+
+  bool reset = false;
+  for (jfloatArray cache : {convCache, traCache, interCache}) {
+    jsize size = env->GetArrayLength(cache);
+    auto *values =
+        static_cast<float *>(env->GetPrimitiveArrayCritical(cache, nullptr));
+    if (values == nullptr) {
+      continue;
+    }
+    bool poisoned = poise_stream_check_state(stream, values, size) != POISE_OK;
+    env->ReleasePrimitiveArrayCritical(cache, values, poisoned ? 0 : JNI_ABORT);
+    reset = reset || poisoned;
+  }
+  return reset ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Park the model caches in the cold pool (as one entry) while the stream is
+ * silent; the caller then drops its copies.
+ * @return false for an invalid handle
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_audio_GTCRNProcessor_nativeParkCaches(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray convCache,
+    jfloatArray traCache, jfloatArray interCache) {
+  std::lock_guard<std::mutex> lock(stftMutex);
+
+  poise_stream *stream = findStftStream(handle);
+  if (stream == nullptr) {
+    return JNI_FALSE;
+  }
+  std::vector<float> state;
+  for (jfloatArray cache : {convCache, traCache, interCache}) {
+    size_t offset = state.size();
+    jsize size = env->GetArrayLength(cache);
+    state.resize(offset + size);
+    env->GetFloatArrayRegion(cache, 0, size, state.data() + offset);
+  }
+  return poise_stream_park_state(stream, state.data(), state.size()) ==
+                 POISE_OK
+             ? JNI_TRUE
+             : JNI_FALSE;
+}
+
+/**
+ * Restore parked caches into the given arrays.
+ * @return false if nothing matching was parked (caches are zeroed)
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_audio_GTCRNProcessor_nativeRestoreCaches(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray convCache,
+    jfloatArray traCache, jfloatArray interCache) {
+  std::lock_guard<std::mutex> lock(stftMutex);
+
+  poise_stream *stream = findStftStream(handle);
+  if (stream == nullptr) {
+    return JNI_FALSE;
+  }
+  jfloatArray caches[] = {convCache, traCache, interCache};
+  size_t total = 0;
+  for (jfloatArray cache : caches) {
+    total += env->GetArrayLength(cache);
   }
+  std::vector<float> state(total);
+  bool restored = poise_stream_restore_state(stream, state.data(), total) ==
+                  POISE_OK;
+  size_t offset = 0;
+  for (jfloatArray cache : caches) {
+    jsize size = env->GetArrayLength(cache);
+    env->SetFloatArrayRegion(cache, 0, size, state.data() + offset);
+    offset += size;
+  }
+  return restored ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Count frames the Kotlin energy gate passed through without analysis.
+ */
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_GTCRNProcessor_nativeCountSkipped(
+    JNIEnv *env, jobject thiz, jlong handle, jint frames) {
+  std::lock_guard<std::mutex> lock(stftMutex);
+  poise_stream_count_skipped(findStftStream(handle), frames);
+}
+
+/**
+ * Report an output underrun for a GTCRN stream (feeds the flight recorder).
+ */
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_GTCRNProcessor_nativeReportUnderrun(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(stftMutex);
+  poise_stream_report_underrun(findStftStream(handle));
 }
 
 /**
@@ -429,8 +678,1408 @@ Java_com_poise_android_audio_GTCRNProcessor_nativeSTFTDestroy(JNIEnv *env,
                                                               jlong handle) {
   std::lock_guard<std::mutex> lock(stftMutex);
 
-  stftProcessors.erase(handle);
+  auto it = stftStreams.find(handle);
+  if (it != stftStreams.end()) {
+    poise_stream_destroy(it->second);
+    stftStreams.erase(it);
+  }
   LOGI("STFT processor %lld destroyed", handle);
 }
 
+/**
+ * Native heap bytes charged to this stream.
+ * @return [current, peak], zeros if the stream has no metrics slot
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_poise_android_audio_GTCRNProcessor_nativeMemoryUsage(JNIEnv *env,
+                                                              jobject thiz,
+                                                              jlong handle) {
+  std::lock_guard<std::mutex> lock(stftMutex);
+
+  jlong values[2] = {0, 0};
+  poise_stream_stats stats = poise_stream_stats();
+  stats.struct_size = sizeof(stats);
+  if (poise_stream_get_stats(findStftStream(handle), &stats) == POISE_OK) {
+    values[0] = stats.memory_bytes;
+    values[1] = stats.memory_peak_bytes;
+  }
+  jlongArray result = env->NewLongArray(2);
+  env->SetLongArrayRegion(result, 0, 2, values);
+  return result;
+}
+
+/**
+ * Estimated enhancement of recently inferred frames.
+ * @return [frames, noiseReductionDb, speechRetentionDb, lowBenefitRatio];
+ *         dB values are ~1 s moving averages, null for an invalid handle
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_poise_android_audio_GTCRNProcessor_nativeEnhancementStats(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(stftMutex);
+
+  poise_stream_stats stats = poise_stream_stats();
+  stats.struct_size = sizeof(stats);
+  if (poise_stream_get_stats(findStftStream(handle), &stats) != POISE_OK) {
+    return nullptr;
+  }
+  jfloat values[4] = {static_cast<jfloat>(stats.frames_inferred),
+                      stats.noise_reduction_db, stats.speech_retention_db,
+                      stats.low_benefit_ratio};
+  jfloatArray result = env->NewFloatArray(4);
+  env->SetFloatArrayRegion(result, 0, 4, values);
+  return result;
+}
+
+// ============================================================================
+// Metrics export
+// ============================================================================
+
+} // extern "C"
+
+#include "metrics_exporter.h"
+
+extern "C" {
+
+/**
+ * Render OpenMetrics text for all native streams.
+ * Reads lock-free snapshots only; does not take the processor mutexes.
+ */
+JNIEXPORT jstring JNICALL
+Java_com_poise_android_audio_NativeMetrics_nativeRender(JNIEnv *env,
+                                                        jobject thiz) {
+  // Two passes: size, then render (streams may be added in between)
+  std::string text(4096, '\0');
+  size_t length = poise_metrics_render(&text[0], text.size());
+  if (length >= text.size()) {
+    text.assign(length + 1024, '\0');
+    poise_metrics_render(&text[0], text.size());
+  }
+  return env->NewStringUTF(text.c_str());
+}
+
+/**
+ * Write OpenMetrics text to a file (atomic replace).
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_audio_NativeMetrics_nativeExportToFile(JNIEnv *env,
+                                                              jobject thiz,
+                                                              jstring path) {
+  const char *cPath = env->GetStringUTFChars(path, nullptr);
+  bool ok = poise::MetricsExporter::exportToFile(cPath);
+  env->ReleaseStringUTFChars(path, cPath);
+  return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Set the directory for flight recorder dumps (enables dumping).
+ */
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_NativeMetrics_nativeSetFlightRecorderDir(
+    JNIEnv *env, jobject thiz, jstring dir) {
+  const char *cDir = env->GetStringUTFChars(dir, nullptr);
+  poise_set_flight_recorder_dir(cDir);
+  env->ReleaseStringUTFChars(dir, cDir);
+}
+
+/**
+ * Push OpenMetrics text to a Unix domain socket.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_audio_NativeMetrics_nativeExportToSocket(
+    JNIEnv *env, jobject thiz, jstring socketPath) {
+  const char *cPath = env->GetStringUTFChars(socketPath, nullptr);
+  bool ok = poise::MetricsExporter::exportToUnixSocket(cPath);
+  env->ReleaseStringUTFChars(socketPath, cPath);
+  return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+} // extern "C"
+
+// ============================================================================
+// Model Cascade JNI Methods
+// ============================================================================
+
+#include "model_cascade.h"
+
+namespace {
+std::unordered_map<jlong, std::unique_ptr<poise::ModelCascade>> cascades;
+std::mutex cascadeMutex;
+jlong nextCascadeHandle = 1;
+} // namespace
+
+extern "C" {
+
+/**
+ * Create a light/heavy model cascade controller.
+ * @param lightDelay Light path latency in samples, for output alignment
+ * @param heavyDelay Heavy path latency in samples
+ */
+JNIEXPORT jlong JNICALL
+Java_com_poise_android_audio_CascadeProcessor_nativeCascadeInit(
+    JNIEnv *env, jobject thiz, jfloat escalateDb, jint holdFrames,
+    jint warmDuty, jint lightDelay, jint heavyDelay) {
+  std::lock_guard<std::mutex> lock(cascadeMutex);
+
+  poise::CascadeConfig config;
+  config.escalateDb = escalateDb;
+  config.holdFrames = holdFrames;
+  config.warmDuty = warmDuty;
+  config.lightDelay = std::max(0, static_cast<int>(lightDelay));
+  config.heavyDelay = std::max(0, static_cast<int>(heavyDelay));
+
+  jlong handle = nextCascadeHandle++;
+  cascades[handle] = std::make_unique<poise::ModelCascade>(config);
+  LOGI("Model cascade created, handle=%lld", handle);
+  return handle;
+}
+
+/**
+ * Plan the next frame.
+ * @return true if the heavy model should run this frame
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_audio_CascadeProcessor_nativeCascadeDecide(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(cascadeMutex);
+
+  auto it = cascades.find(handle);
+  if (it == cascades.end()) {
+    return JNI_FALSE;
+  }
+  return it->second->decide().runHeavy ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Blend light and heavy outputs and update the residual noise estimate
+ * from the light output.
+ * @param heavy Heavy model output of the same length, or null
+ * @return Blended frame
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_poise_android_audio_CascadeProcessor_nativeCascadeMix(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray light,
+    jfloatArray heavy) {
+  std::lock_guard<std::mutex> lock(cascadeMutex);
+
+  auto it = cascades.find(handle);
+  if (it == cascades.end()) {
+    return light;
+  }
+
+  jsize len = env->GetArrayLength(light);
+  std::vector<float> lightData(len);
+  env->GetFloatArrayRegion(light, 0, len, lightData.data());
+  it->second->observeLightOutput(lightData.data(), len);
+
+  std::vector<float> heavyData;
+  if (heavy != nullptr && env->GetArrayLength(heavy) == len) {
+    heavyData.resize(len);
+    env->GetFloatArrayRegion(heavy, 0, len, heavyData.data());
+  }
+
+  std::vector<float> out(len);
+  it->second->mix(lightData.data(),
+                  heavyData.empty() ? nullptr : heavyData.data(), out.data(),
+                  len);
+
+  jfloatArray result = env->NewFloatArray(len);
+  env->SetFloatArrayRegion(result, 0, len, out.data());
+  return result;
+}
+
+/**
+ * Cascade state: [stage, residualNoiseDb, heavyDutyRatio, escalations].
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_poise_android_audio_CascadeProcessor_nativeCascadeGetStats(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(cascadeMutex);
+
+  auto it = cascades.find(handle);
+  if (it == cascades.end()) {
+    return nullptr;
+  }
+
+  auto stats = it->second->getStats();
+  float values[4] = {static_cast<float>(stats.stage), stats.residualNoiseDb,
+                     stats.heavyDutyRatio,
+                     static_cast<float>(stats.escalations)};
+  jfloatArray result = env->NewFloatArray(4);
+  env->SetFloatArrayRegion(result, 0, 4, values);
+  return result;
+}
+
+/**
+ * Reset cascade state.
+ */
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_CascadeProcessor_nativeCascadeReset(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(cascadeMutex);
+
+  auto it = cascades.find(handle);
+  if (it != cascades.end()) {
+    it->second->reset();
+  }
+}
+
+/**
+ * Destroy cascade controller.
+ */
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_CascadeProcessor_nativeCascadeDestroy(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(cascadeMutex);
+
+  cascades.erase(handle);
+  LOGI("Model cascade %lld destroyed", handle);
+}
+
+} // extern "C"
+
+// ============================================================================
+// Denoise Daemon JNI Methods
+// ============================================================================
+
+#include "denoise_daemon.h"
+
+namespace {
+
+/**
+ * Daemon backend that forwards to the Kotlin DenoiseDaemon host, which owns
+ * the single shared ONNX session. Daemon threads are attached to the VM on
+ * first use and detached when they exit.
+ */
+class JniDaemonBackend : public poise::DaemonBackend {
+public:
+  JniDaemonBackend(JNIEnv *env, jobject host, int sampleRate, int frameSamples)
+      : sampleRate_(sampleRate), frameSamples_(frameSamples) {
+    env->GetJavaVM(&vm_);
+    host_ = env->NewGlobalRef(host);
+    jclass hostClass = env->GetObjectClass(host);
+    onOpenedId_ = env->GetMethodID(hostClass, "onStreamOpened", "(I)Z");
+    processId_ = env->GetMethodID(hostClass, "processFrame", "(I[F[F)Z");
+    onClosedId_ = env->GetMethodID(hostClass, "onStreamClosed", "(I)V");
+    env->DeleteLocalRef(hostClass);
+
+    // Only the worker thread touches these
+    jfloatArray input = env->NewFloatArray(frameSamples);
+    jfloatArray output = env->NewFloatArray(frameSamples);
+    inputArray_ = static_cast<jfloatArray>(env->NewGlobalRef(input));
+    outputArray_ = static_cast<jfloatArray>(env->NewGlobalRef(output));
+    env->DeleteLocalRef(input);
+    env->DeleteLocalRef(output);
+  }
+
+  // Must be destroyed on a VM thread after the daemon has stopped
+  void releaseRefs(JNIEnv *env) {
+    env->DeleteGlobalRef(inputArray_);
+    env->DeleteGlobalRef(outputArray_);
+    env->DeleteGlobalRef(host_);
+  }
+
+  bool valid() const {
+    return onOpenedId_ != nullptr && processId_ != nullptr &&
+           onClosedId_ != nullptr;
+  }
+
+  int sampleRate() const override { return sampleRate_; }
+  int frameSamples() const override { return frameSamples_; }
+
+  bool openStream(int32_t streamId) override {
+    JNIEnv *env = threadEnv();
+    if (env == nullptr) {
+      return false;
+    }
+    jboolean ok = env->CallBooleanMethod(host_, onOpenedId_, streamId);
+    return !clearException(env) && ok == JNI_TRUE;
+  }
+
+  bool processFrame(int32_t streamId, const float *input,
+                    float *output) override {
+    JNIEnv *env = threadEnv();
+    if (env == nullptr) {
+      return false;
+    }
+    env->SetFloatArrayRegion(inputArray_, 0, frameSamples_, input);
+    jboolean ok = env->CallBooleanMethod(host_, processId_, streamId,
+                                         inputArray_, outputArray_);
+    if (clearException(env) || ok != JNI_TRUE) {
+      return false;
+    }
+    env->GetFloatArrayRegion(outputArray_, 0, frameSamples_, output);
+    return true;
+  }
+
+  void closeStream(int32_t streamId) override {
+    JNIEnv *env = threadEnv();
+    if (env == nullptr) {
+      return;
+    }
+    env->CallVoidMethod(host_, onClosedId_, streamId);
+    clearException(env);
+  }
+
+  void onThreadExit() override {
+    if (attachedHere) {
+      vm_->DetachCurrentThread();
+      attachedHere = false;
+    }
+  }
+
+private:
+  JNIEnv *threadEnv() {
+    JNIEnv *env = nullptr;
+    if (vm_->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) ==
+        JNI_OK) {
+      return env;
+    }
+    if (vm_->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+      LOGE("Failed to attach daemon thread to the VM");
+      return nullptr;
+    }
+    attachedHere = true;
+    return env;
+  }
+
+  static bool clearException(JNIEnv *env) {
+    if (env->ExceptionCheck()) {
+      env->ExceptionDescribe();
+      env->ExceptionClear();
+      return true;
+    }
+    return false;
+  }
+
+  static thread_local bool attachedHere;
+
+  JavaVM *vm_ = nullptr;
+  jobject host_ = nullptr;
+  jmethodID onOpenedId_ = nullptr;
+  jmethodID processId_ = nullptr;
+  jmethodID onClosedId_ = nullptr;
+  jfloatArray inputArray_ = nullptr;
+  jfloatArray outputArray_ = nullptr;
+  int sampleRate_;
+  int frameSamples_;
+};
+
+thread_local bool JniDaemonBackend::attachedHere = false;
+
+struct DaemonInstance {
+  std::unique_ptr<JniDaemonBackend> backend;
+  std::unique_ptr<poise::DenoiseDaemon> daemon;
+};
+
+std::unordered_map<jlong, DaemonInstance> daemons;
+std::mutex daemonMutex;
+jlong nextDaemonHandle = 1;
+
+} // namespace
+
+extern "C" {
+
+/**
+ * Start a daemon serving the given Kotlin host on socketPath. Clients must
+ * run as this process's uid or one of allowedUids (may be null).
+ * Returns 0 if the socket could not be bound.
+ */
+JNIEXPORT jlong JNICALL Java_com_poise_android_audio_DenoiseDaemon_nativeStart(
+    JNIEnv *env, jobject thiz, jstring socketPath, jint sampleRate,
+    jint frameSamples, jintArray allowedUids) {
+  DaemonInstance instance;
+  instance.backend = std::make_unique<JniDaemonBackend>(env, thiz, sampleRate,
+                                                        frameSamples);
+  if (!instance.backend->valid()) {
+    LOGE("DenoiseDaemon host is missing callback methods");
+    env->ExceptionClear();
+    instance.backend->releaseRefs(env);
+    return 0;
+  }
+  instance.daemon =
+      std::make_unique<poise::DenoiseDaemon>(instance.backend.get());
+  if (allowedUids != nullptr) {
+    jsize count = env->GetArrayLength(allowedUids);
+    std::vector<jint> uids(count);
+    env->GetIntArrayRegion(allowedUids, 0, count, uids.data());
+    for (jint uid : uids) {
+      instance.daemon->allowUid(static_cast<uint32_t>(uid));
+    }
+  }
+
+  const char *cPath = env->GetStringUTFChars(socketPath, nullptr);
+  bool started = instance.daemon->start(cPath);
+  env->ReleaseStringUTFChars(socketPath, cPath);
+  if (!started) {
+    instance.backend->releaseRefs(env);
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(daemonMutex);
+  jlong handle = nextDaemonHandle++;
+  daemons[handle] = std::move(instance);
+  return handle;
+}
+
+/**
+ * Number of open daemon streams.
+ */
+JNIEXPORT jint JNICALL
+Java_com_poise_android_audio_DenoiseDaemon_nativeStreamCount(JNIEnv *env,
+                                                             jobject thiz,
+                                                             jlong handle) {
+  std::lock_guard<std::mutex> lock(daemonMutex);
+  auto it = daemons.find(handle);
+  return it != daemons.end() ? it->second.daemon->streamCount() : 0;
+}
+
+/**
+ * Stop the daemon; closes all client streams (onStreamClosed is called for
+ * each) before returning.
+ */
+JNIEXPORT void JNICALL Java_com_poise_android_audio_DenoiseDaemon_nativeStop(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  DaemonInstance instance;
+  {
+    std::lock_guard<std::mutex> lock(daemonMutex);
+    auto it = daemons.find(handle);
+    if (it == daemons.end()) {
+      return;
+    }
+    instance = std::move(it->second);
+    daemons.erase(it);
+  }
+  instance.daemon->stop();
+  instance.backend->releaseRefs(env);
+}
+
+} // extern "C"
+
+// ============================================================================
+// Native Logging JNI Methods
+// ============================================================================
+
+extern "C" {
+
+/**
+ * Route native logs: 0 = logcat, 1 = stderr, 2 = file at path.
+ */
+JNIEXPORT void JNICALL Java_com_poise_android_audio_NativeLog_nativeSetSink(
+    JNIEnv *env, jobject thiz, jint sink, jstring path) {
+  const char *cPath =
+      path != nullptr ? env->GetStringUTFChars(path, nullptr) : nullptr;
+  poise::AsyncLog::setSink(static_cast<poise::LogSink>(sink), cPath);
+  if (cPath != nullptr) {
+    env->ReleaseStringUTFChars(path, cPath);
+  }
+}
+
+JNIEXPORT void JNICALL Java_com_poise_android_audio_NativeLog_nativeSetMinLevel(
+    JNIEnv *env, jobject thiz, jint level) {
+  poise::AsyncLog::setMinLevel(static_cast<poise::LogLevel>(level));
+}
+
+/**
+ * Create the calling thread's log ring (call once from audio threads).
+ */
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_NativeLog_nativePrepareThread(JNIEnv *env,
+                                                           jobject thiz) {
+  poise::AsyncLog::prepareThread();
+}
+
+JNIEXPORT void JNICALL Java_com_poise_android_audio_NativeLog_nativeFlush(
+    JNIEnv *env, jobject thiz) {
+  poise::AsyncLog::flush();
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_poise_android_audio_NativeLog_nativeDroppedRecords(JNIEnv *env,
+                                                            jobject thiz) {
+  return static_cast<jlong>(poise::AsyncLog::droppedRecords());
+}
+
+} // extern "C"
+
+// ============================================================================
+// Idle Gate JNI Methods
+// ============================================================================
+
+#include "idle_gate.h"
+
+namespace {
+std::unordered_map<jlong, std::unique_ptr<poise::IdleGate>> idleGates;
+std::mutex idleGateMutex;
+jlong nextIdleGateHandle = 1;
+} // namespace
+
+extern "C" {
+
+/**
+ * Create an idle gate for a capture loop reading frameSamples per frame.
+ */
+JNIEXPORT jlong JNICALL Java_com_poise_android_audio_IdleGate_nativeInit(
+    JNIEnv *env, jobject thiz, jint sampleRate, jint frameSamples,
+    jfloat silenceDb, jfloat enterAfterMs, jfloat probeIntervalMs) {
+  std::lock_guard<std::mutex> lock(idleGateMutex);
+
+  poise::IdleGateConfig config;
+  config.silenceDb = silenceDb;
+  config.enterAfterMs = enterAfterMs;
+  config.probeIntervalMs = probeIntervalMs;
+
+  jlong handle = nextIdleGateHandle++;
+  idleGates[handle] =
+      std::make_unique<poise::IdleGate>(sampleRate, frameSamples, config);
+  return handle;
+}
+
+/**
+ * Observe the block just read; returns an IdleEvent ordinal.
+ */
+JNIEXPORT jint JNICALL Java_com_poise_android_audio_IdleGate_nativeObserve(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray samples, jint count) {
+  std::lock_guard<std::mutex> lock(idleGateMutex);
+  auto it = idleGates.find(handle);
+  if (it == idleGates.end() || count > env->GetArrayLength(samples)) {
+    return static_cast<jint>(poise::IdleEvent::ACTIVE);
+  }
+
+  jfloat *data = static_cast<jfloat *>(
+      env->GetPrimitiveArrayCritical(samples, nullptr));
+  poise::IdleEvent event = it->second->observe(data, count);
+  env->ReleasePrimitiveArrayCritical(samples, data, JNI_ABORT);
+  return static_cast<jint>(event);
+}
+
+JNIEXPORT jint JNICALL Java_com_poise_android_audio_IdleGate_nativeReadSamples(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(idleGateMutex);
+  auto it = idleGates.find(handle);
+  return it != idleGates.end() ? it->second->readSamples() : 0;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_poise_android_audio_IdleGate_nativeProbeSamples(JNIEnv *env,
+                                                         jobject thiz,
+                                                         jlong handle) {
+  std::lock_guard<std::mutex> lock(idleGateMutex);
+  auto it = idleGates.find(handle);
+  return it != idleGates.end() ? it->second->probeSamples() : 0;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_poise_android_audio_IdleGate_nativeMaxReadSamples(JNIEnv *env,
+                                                           jobject thiz,
+                                                           jlong handle) {
+  std::lock_guard<std::mutex> lock(idleGateMutex);
+  auto it = idleGates.find(handle);
+  return it != idleGates.end() ? it->second->maxReadSamples() : 0;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_poise_android_audio_IdleGate_nativeSetActiveFrames(JNIEnv *env,
+                                                            jobject thiz,
+                                                            jlong handle,
+                                                            jint frames) {
+  std::lock_guard<std::mutex> lock(idleGateMutex);
+  auto it = idleGates.find(handle);
+  return it != idleGates.end() ? it->second->setActiveFrames(frames) : 1;
+}
+
+JNIEXPORT jint JNICALL Java_com_poise_android_audio_IdleGate_nativeWakeOffset(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(idleGateMutex);
+  auto it = idleGates.find(handle);
+  return it != idleGates.end() ? it->second->wakeOffset() : 0;
+}
+
+/**
+ * Returns [idle (0/1), idleMs, idleEntries].
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_poise_android_audio_IdleGate_nativeGetStats(JNIEnv *env,
+                                                     jobject thiz,
+                                                     jlong handle) {
+  std::lock_guard<std::mutex> lock(idleGateMutex);
+  auto it = idleGates.find(handle);
+  if (it == idleGates.end()) {
+    return nullptr;
+  }
+
+  poise::IdleGateStats stats = it->second->getStats();
+  jfloat values[3] = {stats.idle ? 1.0f : 0.0f,
+                      static_cast<jfloat>(stats.idleMs),
+                      static_cast<jfloat>(stats.idleEntries)};
+  jfloatArray result = env->NewFloatArray(3);
+  env->SetFloatArrayRegion(result, 0, 3, values);
+  return result;
+}
+
+JNIEXPORT void JNICALL Java_com_poise_android_audio_IdleGate_nativeDestroy(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(idleGateMutex);
+  idleGates.erase(handle);
+}
+
+} // extern "C"
+
+// ============================================================================
+// Playout Buffer JNI Methods
+// ============================================================================
+
+#include "playout_buffer.h"
+
+namespace {
+std::unordered_map<jlong, std::shared_ptr<poise::PlayoutBuffer>>
+    playoutBuffers;
+std::mutex playoutMutex;
+jlong nextPlayoutHandle = 1;
+
+// Push and pull run concurrently on two threads, so the map lock is only held
+// for the lookup. The reference keeps the buffer alive for the rest of the
+// call if nativeDestroy races with it.
+std::shared_ptr<poise::PlayoutBuffer> findPlayout(jlong handle) {
+  std::lock_guard<std::mutex> lock(playoutMutex);
+  auto it = playoutBuffers.find(handle);
+  return it != playoutBuffers.end() ? it->second : nullptr;
+}
+} // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_poise_android_audio_PlayoutBuffer_nativeInit(
+    JNIEnv *env, jobject thiz, jint sampleRate, jfloat underrunProbability,
+    jfloat maxDepthMs) {
+  poise::PlayoutConfig config;
+  config.underrunProbability = underrunProbability;
+  config.maxDepthMs = maxDepthMs;
+
+  std::lock_guard<std::mutex> lock(playoutMutex);
+  jlong handle = nextPlayoutHandle++;
+  playoutBuffers[handle] =
+      std::make_shared<poise::PlayoutBuffer>(sampleRate, config);
+  return handle;
+}
+
+/**
+ * Queue processed audio (processing thread).
+ */
+JNIEXPORT void JNICALL Java_com_poise_android_audio_PlayoutBuffer_nativePush(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray samples, jint count) {
+  std::shared_ptr<poise::PlayoutBuffer> buffer = findPlayout(handle);
+  if (buffer == nullptr || count > env->GetArrayLength(samples)) {
+    return;
+  }
+  jfloat *data = static_cast<jfloat *>(
+      env->GetPrimitiveArrayCritical(samples, nullptr));
+  buffer->push(data, count);
+  env->ReleasePrimitiveArrayCritical(samples, data, JNI_ABORT);
+}
+
+/**
+ * Fill exactly count samples for playback (playback thread).
+ * Returns how many were real audio.
+ */
+JNIEXPORT jint JNICALL Java_com_poise_android_audio_PlayoutBuffer_nativePull(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray out, jint count) {
+  std::shared_ptr<poise::PlayoutBuffer> buffer = findPlayout(handle);
+  if (buffer == nullptr || count > env->GetArrayLength(out)) {
+    return 0;
+  }
+  jfloat *data =
+      static_cast<jfloat *>(env->GetPrimitiveArrayCritical(out, nullptr));
+  int real = buffer->pull(data, count);
+  env->ReleasePrimitiveArrayCritical(out, data, 0);
+  return real;
+}
+
+/**
+ * Measure arrival jitter from a fresh baseline (processing thread, after the
+ * producer paused).
+ */
+JNIEXPORT void JNICALL Java_com_poise_android_audio_PlayoutBuffer_nativeResync(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::shared_ptr<poise::PlayoutBuffer> buffer = findPlayout(handle);
+  if (buffer != nullptr) {
+    buffer->resync();
+  }
+}
+
+/**
+ * Returns [depthMs, targetMs, jitterMs, avgLatencyMs, underruns,
+ *          concealedMs, droppedMs, insertedMs].
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_poise_android_audio_PlayoutBuffer_nativeGetStats(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jlong handle) {
+  std::shared_ptr<poise::PlayoutBuffer> buffer = findPlayout(handle);
+  if (buffer == nullptr) {
+    return nullptr;
+  }
+
+  poise::PlayoutStats stats = buffer->getStats();
+  jfloat values[8] = {stats.depthMs,
+                      stats.targetMs,
+                      stats.jitterMs,
+                      stats.avgLatencyMs,
+                      static_cast<jfloat>(stats.underruns),
+                      stats.concealedMs,
+                      stats.droppedMs,
+                      stats.insertedMs};
+  jfloatArray result = env->NewFloatArray(8);
+  env->SetFloatArrayRegion(result, 0, 8, values);
+  return result;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_poise_android_audio_PlayoutBuffer_nativeUnderruns(JNIEnv *env,
+                                                           jobject thiz,
+                                                           jlong handle) {
+  std::shared_ptr<poise::PlayoutBuffer> buffer = findPlayout(handle);
+  return buffer != nullptr ? buffer->getStats().underruns : 0;
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_PlayoutBuffer_nativeDestroy(JNIEnv *env,
+                                                         jobject thiz,
+                                                         jlong handle) {
+  std::lock_guard<std::mutex> lock(playoutMutex);
+  playoutBuffers.erase(handle);
+}
+
+} // extern "C"
+
+// ============================================================================
+// Admission Control JNI Methods
+// ============================================================================
+
+extern "C" {
+
+/**
+ * Ask whether a stream of model may be created, falling back to fallback
+ * (may be null) if only that fits. Returns the AdmissionDecision.
+ */
+JNIEXPORT jint JNICALL
+Java_com_poise_android_audio_AdmissionControl_nativeRequest(JNIEnv *env,
+                                                            jobject thiz,
+                                                            jstring model,
+                                                            jstring fallback) {
+  const char *modelChars = env->GetStringUTFChars(model, nullptr);
+  const char *fallbackChars =
+      fallback != nullptr ? env->GetStringUTFChars(fallback, nullptr) : nullptr;
+  poise::AdmissionResult result =
+      poise::AdmissionController::instance().request(modelChars,
+                                                     fallbackChars);
+  if (fallbackChars != nullptr) {
+    env->ReleaseStringUTFChars(fallback, fallbackChars);
+  }
+  env->ReleaseStringUTFChars(model, modelChars);
+  return static_cast<jint>(result.decision);
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_AdmissionControl_nativeSetTargetUtilization(
+    JNIEnv *env, jobject thiz, jfloat fraction) {
+  poise::AdmissionController::instance().setTargetUtilization(fraction);
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_AdmissionControl_nativeSetEnabled(
+    JNIEnv *env, jobject thiz, jboolean enabled) {
+  poise::AdmissionController::instance().setEnabled(enabled);
+}
+
+/**
+ * @return [utilizationCores, streamLoadCores, budgetCores, onlineCores]
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_poise_android_audio_AdmissionControl_nativeGetStats(JNIEnv *env,
+                                                             jobject thiz) {
+  poise::AdmissionStats stats =
+      poise::AdmissionController::instance().getStats();
+  jfloat values[4] = {stats.utilizationCores, stats.streamLoadCores,
+                      stats.budgetCores,
+                      static_cast<jfloat>(stats.onlineCores)};
+  jfloatArray result = env->NewFloatArray(4);
+  env->SetFloatArrayRegion(result, 0, 4, values);
+  return result;
+}
+
+} // extern "C"
+
+// ============================================================================
+// Benchmark Support JNI Methods
+// ============================================================================
+
+#include <sched.h>
+#include <unistd.h>
+
+extern "C" {
+
+/**
+ * Pin the calling thread to one CPU. Threads it creates afterwards (e.g.
+ * ONNX Runtime pools) inherit the mask.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_bench_BenchNative_nativePinCurrentThread(JNIEnv *env,
+                                                                jobject thiz,
+                                                                jint cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+    LOGE("Cannot pin thread to CPU %d", cpu);
+    return JNI_FALSE;
+  }
+  return JNI_TRUE;
+}
+
+/**
+ * Undo nativePinCurrentThread: allow every online CPU again.
+ */
+JNIEXPORT void JNICALL
+Java_com_poise_android_bench_BenchNative_nativeUnpinCurrentThread(
+    JNIEnv *env, jobject thiz) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  long cpus = sysconf(_SC_NPROCESSORS_CONF);
+  for (long cpu = 0; cpu < cpus && cpu < CPU_SETSIZE; cpu++) {
+    CPU_SET(cpu, &set);
+  }
+  sched_setaffinity(0, sizeof(set), &set);
+}
+
+} // extern "C"
+
+// ============================================================================
+// Packed State JNI Methods
+// ============================================================================
+
+#include "state_codec.h"
+
+namespace {
+std::unordered_map<jlong, std::shared_ptr<poise::PackedState>> packedStates;
+std::mutex packedStateMutex;
+jlong nextPackedStateHandle = 1;
+
+// The map lock is only held for the lookup; the reference keeps the store
+// alive for the rest of the call if nativeDestroy races with it
+std::shared_ptr<poise::PackedState> findPackedState(jlong handle) {
+  std::lock_guard<std::mutex> lock(packedStateMutex);
+  auto it = packedStates.find(handle);
+  return it != packedStates.end() ? it->second : nullptr;
+}
+
+// Copy between a Java float[] and a slot without an intermediate buffer
+bool transferSlot(JNIEnv *env, jlong handle, jint slot, jfloatArray values,
+                  bool store) {
+  std::shared_ptr<poise::PackedState> state = findPackedState(handle);
+  if (state == nullptr || slot < 0 || slot >= state->numSlots() ||
+      static_cast<size_t>(env->GetArrayLength(values)) <
+          state->slotSize(slot)) {
+    return false;
+  }
+  auto *data =
+      static_cast<float *>(env->GetPrimitiveArrayCritical(values, nullptr));
+  if (data == nullptr) {
+    return false;
+  }
+  if (store) {
+    state->store(slot, data);
+  } else {
+    state->load(slot, data);
+  }
+  env->ReleasePrimitiveArrayCritical(values, data, store ? JNI_ABORT : 0);
+  return true;
+}
+} // namespace
+
+extern "C" {
+
+/**
+ * Create packed state storage.
+ * @param format StateFormat (0 = FP32, 1 = FP16, 2 = BF16)
+ * @param slotSizes Floats per state tensor
+ */
+JNIEXPORT jlong JNICALL Java_com_poise_android_audio_StateStore_nativeCreate(
+    JNIEnv *env, jobject thiz, jint format, jintArray slotSizes) {
+  if (format < 0 || format > static_cast<jint>(poise::StateFormat::BF16)) {
+    LOGE("Invalid state format %d", format);
+    return 0;
+  }
+  jsize numSlots = env->GetArrayLength(slotSizes);
+  std::vector<jint> sizes(numSlots);
+  env->GetIntArrayRegion(slotSizes, 0, numSlots, sizes.data());
+  std::vector<size_t> slotSizesVec(sizes.begin(), sizes.end());
+
+  std::lock_guard<std::mutex> lock(packedStateMutex);
+  jlong handle = nextPackedStateHandle++;
+  packedStates[handle] = std::make_shared<poise::PackedState>(
+      static_cast<poise::StateFormat>(format), slotSizesVec.data(), numSlots);
+  return handle;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_poise_android_audio_StateStore_nativeStore(
+    JNIEnv *env, jobject thiz, jlong handle, jint slot, jfloatArray values) {
+  return transferSlot(env, handle, slot, values, true) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_poise_android_audio_StateStore_nativeLoad(
+    JNIEnv *env, jobject thiz, jlong handle, jint slot, jfloatArray values) {
+  return transferSlot(env, handle, slot, values, false) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_com_poise_android_audio_StateStore_nativeClear(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::shared_ptr<poise::PackedState> state = findPackedState(handle);
+  if (state != nullptr) {
+    state->clear();
+  }
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_poise_android_audio_StateStore_nativeResidentBytes(JNIEnv *env,
+                                                            jobject thiz,
+                                                            jlong handle) {
+  std::shared_ptr<poise::PackedState> state = findPackedState(handle);
+  return state != nullptr ? static_cast<jlong>(state->residentBytes()) : 0;
+}
+
+JNIEXPORT void JNICALL Java_com_poise_android_audio_StateStore_nativeDestroy(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(packedStateMutex);
+  packedStates.erase(handle);
+}
+
+} // extern "C"
+
+// ============================================================================
+// Native Memory JNI Methods
+// ============================================================================
+
+#include "memory_accounting.h"
+
+namespace {
+// Model weights live in ONNX Runtime sessions owned by Kotlin, which reports
+// their size here so totals cover the whole pipeline
+poise::MemoryCharge onnxModelMemory(poise::MemoryComponent::ONNX_MODEL);
+std::mutex onnxModelMutex;
+} // namespace
+
+extern "C" {
+
+/**
+ * Component names, in the order nativeUsage reports them.
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_com_poise_android_audio_NativeMemory_nativeComponentNames(JNIEnv *env,
+                                                               jobject thiz) {
+  jclass stringClass = env->FindClass("java/lang/String");
+  jobjectArray names =
+      env->NewObjectArray(poise::NUM_MEMORY_COMPONENTS, stringClass, nullptr);
+  for (int c = 0; c < poise::NUM_MEMORY_COMPONENTS; c++) {
+    jstring name = env->NewStringUTF(poise::MemoryAccounting::componentName(c));
+    env->SetObjectArrayElement(names, c, name);
+    env->DeleteLocalRef(name);
+  }
+  return names;
+}
+
+/**
+ * Process-wide usage.
+ * @return [current, peak] per component, then [current, peak] for the total
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_poise_android_audio_NativeMemory_nativeUsage(JNIEnv *env,
+                                                      jobject thiz) {
+  constexpr int count = (poise::NUM_MEMORY_COMPONENTS + 1) * 2;
+  jlong values[count];
+  for (int c = 0; c < poise::NUM_MEMORY_COMPONENTS; c++) {
+    auto usage = poise::MemoryAccounting::usage(
+        static_cast<poise::MemoryComponent>(c));
+    values[c * 2] = usage.currentBytes;
+    values[c * 2 + 1] = usage.peakBytes;
+  }
+  auto total = poise::MemoryAccounting::total();
+  values[count - 2] = total.currentBytes;
+  values[count - 1] = total.peakBytes;
+
+  jlongArray result = env->NewLongArray(count);
+  env->SetLongArrayRegion(result, 0, count, values);
+  return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_NativeMemory_nativeResetPeaks(JNIEnv *env,
+                                                           jobject thiz) {
+  poise::MemoryAccounting::resetPeaks();
+}
+
+/**
+ * Bytes of model weights currently loaded by ONNX Runtime.
+ */
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_NativeMemory_nativeSetModelBytes(JNIEnv *env,
+                                                              jobject thiz,
+                                                              jlong bytes) {
+  std::lock_guard<std::mutex> lock(onnxModelMutex);
+  onnxModelMemory.set(static_cast<size_t>(bytes > 0 ? bytes : 0));
+}
+
+} // extern "C"
+
+// ============================================================================
+// Model Crossfade JNI Methods
+// ============================================================================
+
+#include "model_crossfade.h"
+
+namespace {
+std::unordered_map<jlong, std::shared_ptr<poise::ModelCrossfade>> crossfades;
+std::mutex crossfadeMutex;
+jlong nextCrossfadeHandle = 1;
+
+// Created and destroyed off the processing thread, so the map lock is only
+// held for the lookup; the reference keeps the crossfade alive for the rest
+// of the call if nativeDestroy races with it
+std::shared_ptr<poise::ModelCrossfade> findCrossfade(jlong handle) {
+  std::lock_guard<std::mutex> lock(crossfadeMutex);
+  auto it = crossfades.find(handle);
+  return it != crossfades.end() ? it->second : nullptr;
+}
+
+void pushCrossfade(JNIEnv *env, jlong handle, jfloatArray samples, jint count,
+                   bool incoming) {
+  std::shared_ptr<poise::ModelCrossfade> fade = findCrossfade(handle);
+  if (fade == nullptr || count > env->GetArrayLength(samples)) {
+    return;
+  }
+  jfloat *data = static_cast<jfloat *>(
+      env->GetPrimitiveArrayCritical(samples, nullptr));
+  if (incoming) {
+    fade->pushIncoming(data, count);
+  } else {
+    fade->pushOutgoing(data, count);
+  }
+  env->ReleasePrimitiveArrayCritical(samples, data, JNI_ABORT);
+}
+} // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_poise_android_audio_ModelCrossfade_nativeInit(
+    JNIEnv *env, jobject thiz, jint sampleRate, jfloat fadeMs, jint maxBlock) {
+  std::lock_guard<std::mutex> lock(crossfadeMutex);
+  jlong handle = nextCrossfadeHandle++;
+  crossfades[handle] =
+      std::make_shared<poise::ModelCrossfade>(sampleRate, fadeMs, maxBlock);
+  return handle;
+}
+
+JNIEXPORT void JNICALL Java_com_poise_android_audio_ModelCrossfade_nativeStart(
+    JNIEnv *env, jobject thiz, jlong handle, jint skipIncoming) {
+  std::shared_ptr<poise::ModelCrossfade> fade = findCrossfade(handle);
+  if (fade != nullptr) {
+    fade->start(skipIncoming);
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_ModelCrossfade_nativePushOutgoing(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray samples, jint count) {
+  pushCrossfade(env, handle, samples, count, false);
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_ModelCrossfade_nativePushIncoming(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray samples, jint count) {
+  pushCrossfade(env, handle, samples, count, true);
+}
+
+/**
+ * Release mixed (then incoming-only) output into out.
+ * Returns the number of samples written.
+ */
+JNIEXPORT jint JNICALL Java_com_poise_android_audio_ModelCrossfade_nativePull(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray out) {
+  std::shared_ptr<poise::ModelCrossfade> fade = findCrossfade(handle);
+  if (fade == nullptr) {
+    return 0;
+  }
+  jsize capacity = env->GetArrayLength(out);
+  jfloat *data =
+      static_cast<jfloat *>(env->GetPrimitiveArrayCritical(out, nullptr));
+  int count = fade->pull(data, capacity);
+  env->ReleasePrimitiveArrayCritical(out, data, 0);
+  return count;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_audio_ModelCrossfade_nativeIsDone(JNIEnv *env,
+                                                         jobject thiz,
+                                                         jlong handle) {
+  std::shared_ptr<poise::ModelCrossfade> fade = findCrossfade(handle);
+  return (fade != nullptr && fade->isDone()) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_poise_android_audio_ModelCrossfade_nativeDroppedSamples(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::shared_ptr<poise::ModelCrossfade> fade = findCrossfade(handle);
+  return fade != nullptr ? fade->droppedSamples() : 0;
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_ModelCrossfade_nativeDestroy(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jlong handle) {
+  std::lock_guard<std::mutex> lock(crossfadeMutex);
+  crossfades.erase(handle);
+}
+
+} // extern "C"
+
+// ============================================================================
+// Resampler JNI Methods
+// ============================================================================
+
+namespace {
+// Destroyed through poise_resampler_destroy once the last call holding it
+// returns
+using ResamplerRef = std::shared_ptr<poise_resampler>;
+
+std::unordered_map<jlong, ResamplerRef> resamplers;
+std::mutex resamplerMutex;
+jlong nextResamplerHandle = 1;
+
+// One resampler per model slot, used by its processing thread; the map lock
+// is only held for the lookup, and the reference keeps the resampler alive
+// for the rest of the call if nativeDestroy races with it
+ResamplerRef findResampler(jlong handle) {
+  std::lock_guard<std::mutex> lock(resamplerMutex);
+  auto it = resamplers.find(handle);
+  return it != resamplers.end() ? it->second : nullptr;
+}
+} // namespace
+
+extern "C" {
+
+/**
+ * Create a streaming resampler from the cached plan for this ratio.
+ * quality: ResampleQuality ordinal (0 fast, 1 balanced, 2 high).
+ */
+JNIEXPORT jlong JNICALL Java_com_poise_android_audio_Resampler_nativeInit(
+    JNIEnv *env, jobject thiz, jint inputRate, jint outputRate, jint quality) {
+  poise_resampler *resampler = poise_resampler_create(
+      inputRate, outputRate, static_cast<poise_resample_quality>(quality));
+  if (resampler == nullptr) {
+    return 0;
+  }
+  ResamplerRef ref(resampler, poise_resampler_destroy);
+  std::lock_guard<std::mutex> lock(resamplerMutex);
+  jlong handle = nextResamplerHandle++;
+  resamplers[handle] = std::move(ref);
+  return handle;
+}
+
+/**
+ * Resample count samples of input into output.
+ * Returns the number of samples written.
+ */
+JNIEXPORT jint JNICALL Java_com_poise_android_audio_Resampler_nativeProcess(
+    JNIEnv *env, jobject thiz, jlong handle, jfloatArray input, jint count,
+    jfloatArray output) {
+  ResamplerRef resampler = findResampler(handle);
+  if (resampler == nullptr || count > env->GetArrayLength(input)) {
+    return 0;
+  }
+  jsize capacity = env->GetArrayLength(output);
+  jfloat *in =
+      static_cast<jfloat *>(env->GetPrimitiveArrayCritical(input, nullptr));
+  jfloat *out =
+      static_cast<jfloat *>(env->GetPrimitiveArrayCritical(output, nullptr));
+  int written =
+      poise_resampler_process(resampler.get(), in, count, out, capacity);
+  env->ReleasePrimitiveArrayCritical(output, out, 0);
+  env->ReleasePrimitiveArrayCritical(input, in, JNI_ABORT);
+  return std::max(written, 0);
+}
+
+JNIEXPORT jint JNICALL Java_com_poise_android_audio_Resampler_nativeMaxOutput(
+    JNIEnv *env, jobject thiz, jlong handle, jint count) {
+  return poise_resampler_max_output(findResampler(handle).get(), count);
+}
+
+/**
+ * Plan summary: [macsPerOutput, directMacsPerOutput, delaySamples, stages].
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_poise_android_audio_Resampler_nativePlanInfo(JNIEnv *env,
+                                                      jobject thiz,
+                                                      jlong handle) {
+  poise_resampler_info plan = poise_resampler_info();
+  plan.struct_size = sizeof(plan);
+  if (poise_resampler_get_info(findResampler(handle).get(), &plan) !=
+      POISE_OK) {
+    return nullptr;
+  }
+  jfloat info[4] = {static_cast<jfloat>(plan.macs_per_output),
+                    static_cast<jfloat>(plan.direct_macs_per_output),
+                    static_cast<jfloat>(plan.delay_samples),
+                    static_cast<jfloat>(plan.stages)};
+  jfloatArray result = env->NewFloatArray(4);
+  env->SetFloatArrayRegion(result, 0, 4, info);
+  return result;
+}
+
+JNIEXPORT jstring JNICALL Java_com_poise_android_audio_Resampler_nativeDescribe(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  ResamplerRef resampler = findResampler(handle);
+  if (resampler == nullptr) {
+    return nullptr;
+  }
+  std::string text(poise_resampler_describe(resampler.get(), nullptr, 0) + 1,
+                   '\0');
+  poise_resampler_describe(resampler.get(), &text[0], text.size());
+  return env->NewStringUTF(text.c_str());
+}
+
+JNIEXPORT void JNICALL Java_com_poise_android_audio_Resampler_nativeReset(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  poise_resampler_reset(findResampler(handle).get());
+}
+
+JNIEXPORT void JNICALL Java_com_poise_android_audio_Resampler_nativeDestroy(
+    JNIEnv *env, jobject thiz, jlong handle) {
+  std::lock_guard<std::mutex> lock(resamplerMutex);
+  resamplers.erase(handle);
+}
+
+} // extern "C"
+
+// ============================================================================
+// Power Mode JNI Methods
+// ============================================================================
+
+#include "power_mode.h"
+
+namespace {
+std::unordered_map<jlong, std::unique_ptr<poise::BurstScheduler>>
+    burstSchedulers;
+std::mutex burstMutex;
+jlong nextBurstHandle = 1;
+} // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_poise_android_audio_BurstScheduler_nativeInit(
+    JNIEnv *env, jobject thiz, jint sampleRate, jfloat burstMs) {
+  std::lock_guard<std::mutex> lock(burstMutex);
+
+  poise::BurstConfig config;
+  config.burstMs = burstMs;
+
+  jlong handle = nextBurstHandle++;
+  burstSchedulers[handle] =
+      std::make_unique<poise::BurstScheduler>(sampleRate, config);
+  return handle;
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_BurstScheduler_nativeSetMode(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jlong handle,
+                                                          jint mode) {
+  std::lock_guard<std::mutex> lock(burstMutex);
+  auto it = burstSchedulers.find(handle);
+  if (it != burstSchedulers.end()) {
+    it->second->setMode(mode == static_cast<jint>(
+                                    poise::PowerMode::RACE_TO_IDLE)
+                            ? poise::PowerMode::RACE_TO_IDLE
+                            : poise::PowerMode::LOW_LATENCY);
+  }
+}
+
+JNIEXPORT jint JNICALL
+Java_com_poise_android_audio_BurstScheduler_nativeBurstFrames(
+    JNIEnv *env, jobject thiz, jlong handle, jint frameSamples) {
+  std::lock_guard<std::mutex> lock(burstMutex);
+  auto it = burstSchedulers.find(handle);
+  return it != burstSchedulers.end() ? it->second->burstFrames(frameSamples)
+                                     : 1;
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_BurstScheduler_nativeBeginBurst(JNIEnv *env,
+                                                             jobject thiz,
+                                                             jlong handle) {
+  std::lock_guard<std::mutex> lock(burstMutex);
+  auto it = burstSchedulers.find(handle);
+  if (it != burstSchedulers.end()) {
+    it->second->beginBurst();
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_BurstScheduler_nativeEndBurst(JNIEnv *env,
+                                                           jobject thiz,
+                                                           jlong handle,
+                                                           jint samples) {
+  std::lock_guard<std::mutex> lock(burstMutex);
+  auto it = burstSchedulers.find(handle);
+  if (it != burstSchedulers.end()) {
+    it->second->endBurst(samples);
+  }
+}
+
+/**
+ * Returns [mode, bursts, audioMs, wakeupsPerSecond, busyRatio,
+ * cpuMsPerAudioSecond, avgBusyMs, maxBusyMs].
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_poise_android_audio_BurstScheduler_nativeGetStats(JNIEnv *env,
+                                                           jobject thiz,
+                                                           jlong handle) {
+  std::lock_guard<std::mutex> lock(burstMutex);
+  auto it = burstSchedulers.find(handle);
+  if (it == burstSchedulers.end()) {
+    return nullptr;
+  }
+
+  poise::BurstStats stats = it->second->getStats();
+  jfloat values[8] = {static_cast<jfloat>(stats.mode),
+                      static_cast<jfloat>(stats.bursts),
+                      stats.audioMs,
+                      stats.wakeupsPerSecond,
+                      stats.busyRatio,
+                      stats.cpuMsPerAudioSecond,
+                      stats.avgBusyMs,
+                      stats.maxBusyMs};
+  jfloatArray result = env->NewFloatArray(8);
+  env->SetFloatArrayRegion(result, 0, 8, values);
+  return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_BurstScheduler_nativeResetStats(JNIEnv *env,
+                                                             jobject thiz,
+                                                             jlong handle) {
+  std::lock_guard<std::mutex> lock(burstMutex);
+  auto it = burstSchedulers.find(handle);
+  if (it != burstSchedulers.end()) {
+    it->second->resetStats();
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_audio_BurstScheduler_nativeDestroy(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jlong handle) {
+  std::lock_guard<std::mutex> lock(burstMutex);
+  burstSchedulers.erase(handle);
+}
+
 } // extern "C"
@@ -0,0 +1,101 @@
+/**
+ * Memory Accounting - Implementation
+ */
+
+#include "memory_accounting.h"
+#include "stream_metrics.h"
+#include <atomic>
+
+namespace poise {
+
+namespace {
+
+const char *const COMPONENT_NAMES[NUM_MEMORY_COMPONENTS] = {
+    "model_state",     "resampler", "stft",         "neural_vad",
+    "flight_recorder", "playout",   "packed_state", "cold_pool",
+    "daemon",          "onnx_model", "model_switch"};
+
+std::atomic<int64_t> currentBytes[NUM_MEMORY_COMPONENTS];
+std::atomic<int64_t> peakBytes[NUM_MEMORY_COMPONENTS];
+std::atomic<int64_t> totalBytes{0};
+std::atomic<int64_t> totalPeakBytes{0};
+
+void raisePeak(std::atomic<int64_t> &peak, int64_t value) {
+  int64_t seen = peak.load(std::memory_order_relaxed);
+  while (value > seen &&
+         !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+  }
+}
+
+// Add delta to current and return the new value
+int64_t addTo(std::atomic<int64_t> &current, int64_t delta) {
+  return current.fetch_add(delta, std::memory_order_relaxed) + delta;
+}
+
+} // anonymous namespace
+
+const char *MemoryAccounting::componentName(int component) {
+  return (component >= 0 && component < NUM_MEMORY_COMPONENTS)
+             ? COMPONENT_NAMES[component]
+             : "";
+}
+
+void MemoryAccounting::add(MemoryComponent component, StreamMetrics *stream,
+                           int64_t delta) {
+  int c = static_cast<int>(component);
+  raisePeak(peakBytes[c], addTo(currentBytes[c], delta));
+  raisePeak(totalPeakBytes, addTo(totalBytes, delta));
+  if (stream != nullptr) {
+    raisePeak(stream->memoryPeakBytes[c], addTo(stream->memoryBytes[c], delta));
+    raisePeak(stream->memoryPeakTotalBytes,
+              addTo(stream->memoryTotalBytes, delta));
+  }
+}
+
+MemoryUsage MemoryAccounting::usage(MemoryComponent component) {
+  int c = static_cast<int>(component);
+  MemoryUsage usage;
+  usage.currentBytes = currentBytes[c].load(std::memory_order_relaxed);
+  usage.peakBytes = peakBytes[c].load(std::memory_order_relaxed);
+  return usage;
+}
+
+MemoryUsage MemoryAccounting::total() {
+  MemoryUsage usage;
+  usage.currentBytes = totalBytes.load(std::memory_order_relaxed);
+  usage.peakBytes = totalPeakBytes.load(std::memory_order_relaxed);
+  return usage;
+}
+
+void MemoryAccounting::resetPeaks() {
+  for (int c = 0; c < NUM_MEMORY_COMPONENTS; c++) {
+    peakBytes[c].store(currentBytes[c].load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+  }
+  totalPeakBytes.store(totalBytes.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+  MetricsRegistry::instance().resetMemoryPeaks();
+}
+
+void MemoryCharge::attach(StreamMetrics *stream) {
+  if (stream == stream_) {
+    return;
+  }
+  int64_t bytes = static_cast<int64_t>(bytes_);
+  if (bytes != 0) {
+    // Process-wide totals are unchanged; only the stream attribution moves
+    int c = static_cast<int>(component_);
+    if (stream_ != nullptr) {
+      addTo(stream_->memoryBytes[c], -bytes);
+      addTo(stream_->memoryTotalBytes, -bytes);
+    }
+    if (stream != nullptr) {
+      raisePeak(stream->memoryPeakBytes[c], addTo(stream->memoryBytes[c], bytes));
+      raisePeak(stream->memoryPeakTotalBytes,
+                addTo(stream->memoryTotalBytes, bytes));
+    }
+  }
+  stream_ = stream;
+}
+
+} // namespace poise
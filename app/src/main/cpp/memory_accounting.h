@@ -0,0 +1,104 @@
+/**
+ * Memory Accounting - Header
+ *
+ * Native heap bytes by component, process-wide and per stream, with current
+ * and peak values. Owners report their footprint through a MemoryCharge
+ * member whenever it changes; collectors read atomics without locking.
+ */
+
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace poise {
+
+struct StreamMetrics;
+
+enum class MemoryComponent : int {
+  MODEL_STATE = 0, // Native FP32 model state (none: the JVM holds it)
+  RESAMPLER,       // Resampler accumulators
+  STFT,            // STFT analysis/synthesis buffers
+  NEURAL_VAD,      // Neural VAD gate weights
+  FLIGHT_RECORDER, // Per-frame history rings
+  PLAYOUT,         // Playout buffer rings
+  PACKED_STATE,    // FP16/BF16 state stores
+  COLD_POOL,       // Parked idle state
+  DAEMON,          // Daemon stream frames
+  ONNX_MODEL,      // Model weights held by ONNX Runtime (reported by Kotlin)
+  MODEL_SWITCH,    // Crossfade queues during a hot model switch
+  NUM_COMPONENTS
+};
+
+constexpr int NUM_MEMORY_COMPONENTS =
+    static_cast<int>(MemoryComponent::NUM_COMPONENTS);
+
+struct MemoryUsage {
+  int64_t currentBytes = 0;
+  int64_t peakBytes = 0;
+};
+
+class MemoryAccounting {
+public:
+  static const char *componentName(int component);
+
+  /**
+   * Adjust a component's bytes, and the stream's if stream is not null.
+   * Prefer MemoryCharge, which keeps the adjustments balanced.
+   */
+  static void add(MemoryComponent component, StreamMetrics *stream,
+                  int64_t delta);
+
+  static MemoryUsage usage(MemoryComponent component);
+  static MemoryUsage total();
+
+  // Restart peak tracking from current values (e.g. between benchmark runs)
+  static void resetPeaks();
+};
+
+/**
+ * Bytes charged to one component by one owner. The owner calls set() or
+ * track() after allocating or resizing; destruction releases the charge.
+ *
+ * A charge attached to a stream must be detached (or destroyed) before the
+ * stream's metrics slot is released.
+ */
+class MemoryCharge {
+public:
+  explicit MemoryCharge(MemoryComponent component,
+                        StreamMetrics *stream = nullptr)
+      : component_(component), stream_(stream) {}
+  ~MemoryCharge() { set(0); }
+
+  MemoryCharge(const MemoryCharge &) = delete;
+  MemoryCharge &operator=(const MemoryCharge &) = delete;
+
+  void set(size_t bytes) {
+    if (bytes != bytes_) {
+      MemoryAccounting::add(component_, stream_,
+                            static_cast<int64_t>(bytes) -
+                                static_cast<int64_t>(bytes_));
+      bytes_ = bytes;
+    }
+  }
+
+  template <typename T> void track(const std::vector<T> &buffer) {
+    set(buffer.capacity() * sizeof(T));
+  }
+
+  // Move the charge to another stream (nullptr: process-wide only)
+  void attach(StreamMetrics *stream);
+
+  size_t bytes() const { return bytes_; }
+
+private:
+  MemoryComponent component_;
+  StreamMetrics *stream_;
+  size_t bytes_ = 0;
+};
+
+} // namespace poise
+
+#endif // MEMORY_ACCOUNTING_H
@@ -0,0 +1,428 @@
+/**
+ * OpenMetrics Exporter - Implementation
+ */
+
+#include "metrics_exporter.h"
+#include "admission_control.h"
+#include "async_log.h"
+#include "cold_state_pool.h"
+#include "idle_gate.h"
+#include "memory_accounting.h"
+#include "stream_metrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define LOG_TAG "PoiseMetrics"
+#define LOGE(...) POISE_LOG(poise::LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+/**
+ * snprintf-style appender that keeps counting once the buffer is full.
+ */
+class TextWriter {
+public:
+  TextWriter(char *buffer, size_t capacity)
+      : buffer_(buffer), capacity_(capacity), length_(0) {
+    if (capacity_ > 0) {
+      buffer_[0] = '\0';
+    }
+  }
+
+  void printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, fmt);
+    size_t remaining = (length_ < capacity_) ? capacity_ - length_ : 0;
+    int n = std::vsnprintf(remaining > 0 ? buffer_ + length_ : nullptr,
+                           remaining, fmt, args);
+    va_end(args);
+    if (n > 0) {
+      length_ += static_cast<size_t>(n);
+    }
+  }
+
+  size_t length() const { return length_; }
+
+private:
+  char *buffer_;
+  size_t capacity_;
+  size_t length_;
+};
+
+struct DbSnapshot {
+  uint64_t buckets[DbHistogram::NUM_BUCKETS];
+  uint64_t count;
+  double sumDb;
+};
+
+struct Snapshot {
+  int64_t streamId;
+  const char *model;
+  uint64_t framesTotal;
+  uint64_t framesInferred;
+  uint64_t framesBypassed;
+  uint64_t neuralVadBypassed;
+  uint64_t stateEvictions;
+  uint64_t deadlineMisses;
+  uint64_t underruns;
+  uint64_t nonFiniteEvents;
+  uint64_t stateResets;
+  uint64_t framesLowBenefit;
+  int64_t stateResidentBytes;
+  int64_t memoryBytes[NUM_MEMORY_COMPONENTS];
+  uint64_t buckets[LatencyHistogram::NUM_BUCKETS];
+  uint64_t latencyCount;
+  double latencySumMs;
+  DbSnapshot noiseReduction;
+  DbSnapshot speechRetention;
+};
+
+void takeDbSnapshot(const DbHistogram &histogram, DbSnapshot &out) {
+  for (int b = 0; b < DbHistogram::NUM_BUCKETS; b++) {
+    out.buckets[b] = histogram.bucketCount(b);
+  }
+  out.count = histogram.count();
+  out.sumDb = histogram.sumDb();
+}
+
+int takeSnapshots(Snapshot *out) {
+  auto &registry = MetricsRegistry::instance();
+  int n = 0;
+  for (int i = 0; i < MetricsRegistry::MAX_STREAMS; i++) {
+    const StreamMetrics &m = registry.slot(i);
+    if (!m.inUse.load(std::memory_order_acquire)) {
+      continue;
+    }
+    Snapshot &s = out[n++];
+    s.streamId = m.streamId.load(std::memory_order_relaxed);
+    s.model = m.model.load(std::memory_order_acquire);
+    s.framesTotal = m.framesTotal.load(std::memory_order_relaxed);
+    s.framesInferred = m.framesInferred.load(std::memory_order_relaxed);
+    s.framesBypassed = m.framesBypassed.load(std::memory_order_relaxed);
+    s.neuralVadBypassed = m.neuralVadBypassed.load(std::memory_order_relaxed);
+    s.stateEvictions = m.stateEvictions.load(std::memory_order_relaxed);
+    s.deadlineMisses = m.deadlineMisses.load(std::memory_order_relaxed);
+    s.underruns = m.underruns.load(std::memory_order_relaxed);
+    s.nonFiniteEvents = m.nonFiniteEvents.load(std::memory_order_relaxed);
+    s.stateResets = m.stateResets.load(std::memory_order_relaxed);
+    s.framesLowBenefit = m.framesLowBenefit.load(std::memory_order_relaxed);
+    s.stateResidentBytes = m.stateResidentBytes.load(std::memory_order_relaxed);
+    for (int c = 0; c < NUM_MEMORY_COMPONENTS; c++) {
+      s.memoryBytes[c] = m.memoryBytes[c].load(std::memory_order_relaxed);
+    }
+    for (int b = 0; b < LatencyHistogram::NUM_BUCKETS; b++) {
+      s.buckets[b] = m.inferenceLatency.bucketCount(b);
+    }
+    s.latencyCount = m.inferenceLatency.count();
+    s.latencySumMs = m.inferenceLatency.sumMs();
+    takeDbSnapshot(m.noiseReduction, s.noiseReduction);
+    takeDbSnapshot(m.speechRetention, s.speechRetention);
+  }
+  return n;
+}
+
+void writeCounter(TextWriter &w, const char *name, const char *help,
+                  const Snapshot *snaps, int n,
+                  uint64_t Snapshot::*field) {
+  w.printf("# TYPE %s counter\n# HELP %s %s\n", name, name, help);
+  for (int i = 0; i < n; i++) {
+    w.printf("%s_total{stream=\"%lld\",model=\"%s\"} %llu\n", name,
+             static_cast<long long>(snaps[i].streamId), snaps[i].model,
+             static_cast<unsigned long long>(snaps[i].*field));
+  }
+}
+
+void writeDbHistogram(TextWriter &w, const char *name, const char *help,
+                      const double *bounds, const Snapshot *snaps, int n,
+                      DbSnapshot Snapshot::*field) {
+  w.printf("# TYPE %s histogram\n# HELP %s %s\n", name, name, help);
+  for (int i = 0; i < n; i++) {
+    const DbSnapshot &h = snaps[i].*field;
+    long long stream = static_cast<long long>(snaps[i].streamId);
+    uint64_t cumulative = 0;
+    for (int b = 0; b < DbHistogram::NUM_BUCKETS; b++) {
+      cumulative += h.buckets[b];
+      if (b < DbHistogram::NUM_BUCKETS - 1) {
+        w.printf("%s_bucket{stream=\"%lld\",model=\"%s\",le=\"%g\"} %llu\n",
+                 name, stream, snaps[i].model, bounds[b],
+                 static_cast<unsigned long long>(cumulative));
+      } else {
+        w.printf("%s_bucket{stream=\"%lld\",model=\"%s\",le=\"+Inf\"} %llu\n",
+                 name, stream, snaps[i].model,
+                 static_cast<unsigned long long>(cumulative));
+      }
+    }
+    w.printf("%s_sum{stream=\"%lld\",model=\"%s\"} %.3f\n", name, stream,
+             snaps[i].model, h.sumDb);
+    w.printf("%s_count{stream=\"%lld\",model=\"%s\"} %llu\n", name, stream,
+             snaps[i].model, static_cast<unsigned long long>(h.count));
+  }
+}
+
+} // anonymous namespace
+
+size_t MetricsExporter::render(char *buffer, size_t capacity) {
+  Snapshot snaps[MetricsRegistry::MAX_STREAMS];
+  int n = takeSnapshots(snaps);
+
+  TextWriter w(buffer, capacity);
+
+  w.printf("# TYPE poise_streams gauge\n"
+           "# HELP poise_streams Active native streams.\n"
+           "poise_streams %d\n",
+           n);
+
+  writeCounter(w, "poise_frames", "Frames seen by the stream.", snaps, n,
+               &Snapshot::framesTotal);
+  writeCounter(w, "poise_frames_inferred", "Frames that ran model inference.",
+               snaps, n, &Snapshot::framesInferred);
+  writeCounter(w, "poise_frames_bypassed", "Frames bypassed by VAD.", snaps, n,
+               &Snapshot::framesBypassed);
+  writeCounter(w, "poise_neural_vad_bypassed",
+               "Inferences skipped by the neural VAD gate.", snaps, n,
+               &Snapshot::neuralVadBypassed);
+  writeCounter(w, "poise_state_evictions",
+               "Times the recurrent state was parked in the cold pool.", snaps,
+               n, &Snapshot::stateEvictions);
+  writeCounter(w, "poise_deadline_misses",
+               "Frames that took longer than their deadline.", snaps, n,
+               &Snapshot::deadlineMisses);
+  writeCounter(w, "poise_underruns", "Output underruns reported by the host.",
+               snaps, n, &Snapshot::underruns);
+  writeCounter(w, "poise_non_finite_events",
+               "NaN/Inf values detected in input, output or state.", snaps, n,
+               &Snapshot::nonFiniteEvents);
+  writeCounter(w, "poise_state_resets",
+               "Recurrent state resets after a failed health check.", snaps, n,
+               &Snapshot::stateResets);
+  writeCounter(w, "poise_frames_low_benefit",
+               "Inferred frames where the model removed little noise.",
+               snaps, n, &Snapshot::framesLowBenefit);
+
+  w.printf("# TYPE poise_state_resident_bytes gauge\n"
+           "# HELP poise_state_resident_bytes Resident FP32 recurrent state.\n");
+  for (int i = 0; i < n; i++) {
+    w.printf("poise_state_resident_bytes{stream=\"%lld\",model=\"%s\"} %lld\n",
+             static_cast<long long>(snaps[i].streamId), snaps[i].model,
+             static_cast<long long>(snaps[i].stateResidentBytes));
+  }
+
+  w.printf("# TYPE poise_stream_memory_bytes gauge\n"
+           "# HELP poise_stream_memory_bytes Native heap charged to a stream "
+           "by component.\n");
+  for (int i = 0; i < n; i++) {
+    for (int c = 0; c < NUM_MEMORY_COMPONENTS; c++) {
+      if (snaps[i].memoryBytes[c] != 0) {
+        w.printf("poise_stream_memory_bytes{stream=\"%lld\",model=\"%s\","
+                 "component=\"%s\"} %lld\n",
+                 static_cast<long long>(snaps[i].streamId), snaps[i].model,
+                 MemoryAccounting::componentName(c),
+                 static_cast<long long>(snaps[i].memoryBytes[c]));
+      }
+    }
+  }
+
+  w.printf("# TYPE poise_inference_latency_seconds histogram\n"
+           "# HELP poise_inference_latency_seconds Model inference time per "
+           "frame.\n");
+  for (int i = 0; i < n; i++) {
+    const Snapshot &s = snaps[i];
+    uint64_t cumulative = 0;
+    for (int b = 0; b < LatencyHistogram::NUM_BUCKETS; b++) {
+      cumulative += s.buckets[b];
+      if (b < LatencyHistogram::NUM_BUCKETS - 1) {
+        w.printf("poise_inference_latency_seconds_bucket{stream=\"%lld\","
+                 "model=\"%s\",le=\"%g\"} %llu\n",
+                 static_cast<long long>(s.streamId), s.model,
+                 LatencyHistogram::BOUNDS_MS[b] / 1000.0,
+                 static_cast<unsigned long long>(cumulative));
+      } else {
+        w.printf("poise_inference_latency_seconds_bucket{stream=\"%lld\","
+                 "model=\"%s\",le=\"+Inf\"} %llu\n",
+                 static_cast<long long>(s.streamId), s.model,
+                 static_cast<unsigned long long>(cumulative));
+      }
+    }
+    w.printf("poise_inference_latency_seconds_sum{stream=\"%lld\",model=\"%s\"}"
+             " %.6f\n",
+             static_cast<long long>(s.streamId), s.model,
+             s.latencySumMs / 1000.0);
+    w.printf("poise_inference_latency_seconds_count{stream=\"%lld\","
+             "model=\"%s\"} %llu\n",
+             static_cast<long long>(s.streamId), s.model,
+             static_cast<unsigned long long>(s.latencyCount));
+  }
+
+  writeDbHistogram(w, "poise_noise_reduction_db",
+                   "Estimated noise reduction per inferred frame.",
+                   DbHistogram::NOISE_REDUCTION_BOUNDS_DB, snaps, n,
+                   &Snapshot::noiseReduction);
+  writeDbHistogram(w, "poise_speech_retention_db",
+                   "Estimated speech energy kept per inferred frame.",
+                   DbHistogram::SPEECH_RETENTION_BOUNDS_DB, snaps, n,
+                   &Snapshot::speechRetention);
+
+  auto pool = ColdStatePool::instance().getStats();
+  w.printf("# TYPE poise_cold_pool_streams gauge\n"
+           "poise_cold_pool_streams %d\n"
+           "# TYPE poise_cold_pool_bytes gauge\n"
+           "poise_cold_pool_bytes %lld\n"
+           "# TYPE poise_cold_pool_saved_bytes gauge\n"
+           "# HELP poise_cold_pool_saved_bytes Memory released by parking "
+           "idle state.\n"
+           "poise_cold_pool_saved_bytes %lld\n",
+           pool.parkedStreams, static_cast<long long>(pool.coldBytes),
+           static_cast<long long>(pool.savedBytes));
+
+  w.printf("# TYPE poise_memory_bytes gauge\n"
+           "# HELP poise_memory_bytes Native heap by component.\n");
+  for (int c = 0; c < NUM_MEMORY_COMPONENTS; c++) {
+    w.printf("poise_memory_bytes{component=\"%s\"} %lld\n",
+             MemoryAccounting::componentName(c),
+             static_cast<long long>(
+                 MemoryAccounting::usage(static_cast<MemoryComponent>(c))
+                     .currentBytes));
+  }
+  w.printf("# TYPE poise_memory_peak_bytes gauge\n"
+           "# HELP poise_memory_peak_bytes Highest native heap by component "
+           "since start or the last peak reset.\n");
+  for (int c = 0; c < NUM_MEMORY_COMPONENTS; c++) {
+    w.printf("poise_memory_peak_bytes{component=\"%s\"} %lld\n",
+             MemoryAccounting::componentName(c),
+             static_cast<long long>(
+                 MemoryAccounting::usage(static_cast<MemoryComponent>(c))
+                     .peakBytes));
+  }
+
+  w.printf("# TYPE poise_capture_idle gauge\n"
+           "# HELP poise_capture_idle Capture loops currently in idle probe "
+           "mode.\n"
+           "poise_capture_idle %d\n"
+           "# TYPE poise_capture_idle_seconds counter\n"
+           "poise_capture_idle_seconds_total %.3f\n",
+           IdleGate::idleGateCount(), IdleGate::totalIdleMs() / 1000.0);
+
+  auto &admission = AdmissionController::instance();
+  AdmissionStats load = admission.getStats();
+  w.printf("# TYPE poise_cpu_utilization_cores gauge\n"
+           "# HELP poise_cpu_utilization_cores Process CPU use in cores.\n"
+           "poise_cpu_utilization_cores %.3f\n"
+           "# TYPE poise_admission_load_cores gauge\n"
+           "# HELP poise_admission_load_cores Estimated cores used by live "
+           "streams.\n"
+           "poise_admission_load_cores %.3f\n"
+           "# TYPE poise_admission_budget_cores gauge\n"
+           "poise_admission_budget_cores %.3f\n",
+           load.utilizationCores, load.streamLoadCores, load.budgetCores);
+  w.printf("# TYPE poise_admission_stream_cost_cores gauge\n"
+           "# HELP poise_admission_stream_cost_cores Estimated cores per "
+           "stream.\n");
+  for (int m = 0; m < AdmissionController::NUM_MODELS; m++) {
+    const char *model = AdmissionController::modelName(m);
+    w.printf("poise_admission_stream_cost_cores{model=\"%s\"} %.4f\n", model,
+             admission.streamCost(model));
+  }
+  w.printf("# TYPE poise_admission_bypass_ratio gauge\n");
+  for (int m = 0; m < AdmissionController::NUM_MODELS; m++) {
+    const char *model = AdmissionController::modelName(m);
+    w.printf("poise_admission_bypass_ratio{model=\"%s\"} %.4f\n", model,
+             admission.bypassRatio(model));
+  }
+  w.printf("# TYPE poise_admission_decisions counter\n"
+           "# HELP poise_admission_decisions Stream admission decisions by "
+           "requested model.\n");
+  for (int m = 0; m < AdmissionController::NUM_MODELS; m++) {
+    for (int d = 0; d < AdmissionController::NUM_DECISIONS; d++) {
+      w.printf("poise_admission_decisions_total{model=\"%s\",decision=\"%s\"}"
+               " %llu\n",
+               AdmissionController::modelName(m),
+               AdmissionController::decisionName(d),
+               static_cast<unsigned long long>(admission.decisionCount(m, d)));
+    }
+  }
+
+  w.printf("# TYPE poise_log_dropped_records counter\n"
+           "poise_log_dropped_records_total %llu\n",
+           static_cast<unsigned long long>(AsyncLog::droppedRecords()));
+
+  w.printf("# EOF\n");
+  return w.length();
+}
+
+std::string MetricsExporter::render() {
+  std::string text(4096, '\0');
+  size_t length = render(&text[0], text.size());
+  if (length >= text.size()) {
+    // Streams may be added between passes; the second pass truncates
+    text.assign(length + 1024, '\0');
+    length = std::min(render(&text[0], text.size()), text.size() - 1);
+  }
+  text.resize(length);
+  return text;
+}
+
+bool MetricsExporter::exportToFile(const char *path) {
+  std::string text = render();
+  std::string tmpPath = std::string(path) + ".tmp";
+
+  FILE *file = std::fopen(tmpPath.c_str(), "w");
+  if (file == nullptr) {
+    LOGE("Cannot open %s: %s", tmpPath.c_str(), std::strerror(errno));
+    return false;
+  }
+  bool ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+  ok = (std::fclose(file) == 0) && ok;
+  if (!ok || std::rename(tmpPath.c_str(), path) != 0) {
+    LOGE("Failed to write metrics to %s", path);
+    std::remove(tmpPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool MetricsExporter::exportToUnixSocket(const char *socketPath) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (std::strlen(socketPath) >= sizeof(addr.sun_path)) {
+    LOGE("Socket path too long: %s", socketPath);
+    return false;
+  }
+  std::strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    LOGE("socket() failed: %s", std::strerror(errno));
+    return false;
+  }
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    LOGE("connect(%s) failed: %s", socketPath, std::strerror(errno));
+    close(fd);
+    return false;
+  }
+
+  std::string text = render();
+  size_t sent = 0;
+  while (sent < text.size()) {
+    ssize_t n = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOGE("send() failed: %s", std::strerror(errno));
+      break;
+    }
+    sent += static_cast<size_t>(n);
+  }
+  close(fd);
+  return sent == text.size();
+}
+
+} // namespace poise
@@ -0,0 +1,42 @@
+/**
+ * OpenMetrics Exporter - Header
+ *
+ * Renders native pipeline metrics for all streams in OpenMetrics
+ * (Prometheus text) format. Rendering only reads atomic snapshots and
+ * never blocks audio threads; call it from a non-audio thread.
+ */
+
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <cstddef>
+#include <string>
+
+namespace poise {
+
+class MetricsExporter {
+public:
+  /**
+   * Render into a caller-provided buffer (NUL-terminated if capacity > 0).
+   * @return Full length of the exposition, like snprintf. If it is >=
+   *         capacity the output was truncated.
+   */
+  static size_t render(char *buffer, size_t capacity);
+
+  // Render into a string
+  static std::string render();
+
+  /**
+   * Write the exposition to a file atomically (temp file + rename).
+   */
+  static bool exportToFile(const char *path);
+
+  /**
+   * Connect to a Unix domain stream socket and write the exposition.
+   */
+  static bool exportToUnixSocket(const char *socketPath);
+};
+
+} // namespace poise
+
+#endif // METRICS_EXPORTER_H
@@ -0,0 +1,224 @@
+/**
+ * Model Cascade - Implementation
+ *
+ * Residual noise is estimated as the ratio (dB) between a minimum-statistics
+ * noise floor and a peak-hold speech level of the light model output. A
+ * clean output has a floor far below its level; stationary noise the light
+ * model fails to remove keeps the floor close to the level.
+ */
+
+#include "model_cascade.h"
+#include "async_log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#define LOG_TAG "PoiseCascade"
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+constexpr float FLOOR_RISE = 1.0593f;   // +0.25 dB per frame
+constexpr float LEVEL_DECAY = 0.9772f;  // -0.1 dB per frame
+constexpr float SILENCE_ENERGY = 1e-6f; // -60 dBFS: nothing to denoise
+constexpr float ENERGY_EPS = 1e-12f;
+
+} // anonymous namespace
+
+ModelCascade::ModelCascade(const CascadeConfig &config)
+    : config_(config), delayLight_(config.lightDelay < config.heavyDelay),
+      alignLine_(static_cast<size_t>(
+          std::abs(config.heavyDelay - config.lightDelay))) {
+  reset();
+}
+
+void ModelCascade::reset() {
+  stage_ = CascadeStage::LIGHT;
+  stageFrames_ = 0;
+  aboveFrames_ = 0;
+  belowFrames_ = 0;
+  noiseFloor_ = 0.0f;
+  level_ = 0.0f;
+  residualNoiseDb_ = -100.0f;
+  heavyWeight_ = 0.0f;
+  heavyTarget_ = 0.0f;
+  std::fill(alignLine_.begin(), alignLine_.end(), 0.0f);
+  alignPos_ = 0;
+  heavyFrame_.clear();
+  frames_ = 0;
+  heavyFrames_ = 0;
+  escalations_ = 0;
+}
+
+CascadeDecision ModelCascade::decide() {
+  advanceStage();
+
+  CascadeDecision decision;
+  switch (stage_) {
+  case CascadeStage::LIGHT:
+    // Low-duty warm keeping; also while fading out of HEAVY
+    decision.runHeavy = heavyWeight_ > 0.0f ||
+                        (config_.warmDuty > 0 &&
+                         frames_ % config_.warmDuty == 0);
+    break;
+  case CascadeStage::WARMING:
+  case CascadeStage::HEAVY:
+    decision.runHeavy = true;
+    break;
+  }
+
+  frames_++;
+  if (decision.runHeavy) {
+    heavyFrames_++;
+  }
+  stageFrames_++;
+  return decision;
+}
+
+void ModelCascade::advanceStage() {
+  float escalateDb = config_.escalateDb;
+  float releaseDb = config_.escalateDb - config_.hysteresisDb;
+
+  switch (stage_) {
+  case CascadeStage::LIGHT:
+    if (aboveFrames_ >= config_.escalateFrames) {
+      stage_ = CascadeStage::WARMING;
+      stageFrames_ = 0;
+      LOGI("Escalating: residual noise %.1f dB > %.1f dB", residualNoiseDb_,
+           escalateDb);
+    }
+    break;
+  case CascadeStage::WARMING:
+    if (belowFrames_ >= config_.escalateFrames) {
+      // Noise went away while warming; stay light
+      stage_ = CascadeStage::LIGHT;
+      stageFrames_ = 0;
+    } else if (stageFrames_ >= config_.warmupFrames) {
+      stage_ = CascadeStage::HEAVY;
+      stageFrames_ = 0;
+      heavyTarget_ = 1.0f;
+      escalations_++;
+    }
+    break;
+  case CascadeStage::HEAVY:
+    if (belowFrames_ >= config_.holdFrames) {
+      stage_ = CascadeStage::LIGHT;
+      stageFrames_ = 0;
+      heavyTarget_ = 0.0f;
+      LOGI("De-escalating: residual noise %.1f dB < %.1f dB", residualNoiseDb_,
+           releaseDb);
+    }
+    break;
+  }
+}
+
+void ModelCascade::observeLightOutput(const float *output, int count) {
+  if (count <= 0) {
+    return;
+  }
+
+  float energy = 0.0f;
+  for (int i = 0; i < count; i++) {
+    energy += output[i] * output[i];
+  }
+  energy /= static_cast<float>(count);
+
+  // Minimum statistics with slow rise, peak hold with slow decay
+  noiseFloor_ = (noiseFloor_ <= 0.0f) ? energy
+                                      : std::min(noiseFloor_ * FLOOR_RISE,
+                                                 std::max(energy, ENERGY_EPS));
+  level_ = std::max(level_ * LEVEL_DECAY, energy);
+
+  if (level_ < SILENCE_ENERGY) {
+    residualNoiseDb_ = -100.0f;
+  } else {
+    residualNoiseDb_ =
+        10.0f * std::log10((noiseFloor_ + ENERGY_EPS) / (level_ + ENERGY_EPS));
+  }
+
+  if (residualNoiseDb_ > config_.escalateDb) {
+    aboveFrames_++;
+    belowFrames_ = 0;
+  } else if (residualNoiseDb_ < config_.escalateDb - config_.hysteresisDb) {
+    belowFrames_++;
+    aboveFrames_ = 0;
+  }
+}
+
+void ModelCascade::align(const float *in, float *out, int count) {
+  if (alignLine_.empty()) {
+    std::copy(in, in + count, out);
+    return;
+  }
+  for (int i = 0; i < count; i++) {
+    float delayed = alignLine_[alignPos_];
+    alignLine_[alignPos_] = in[i];
+    out[i] = delayed;
+    alignPos_ = (alignPos_ + 1) % alignLine_.size();
+  }
+}
+
+void ModelCascade::mix(const float *light, const float *heavy, float *out,
+                       int count) {
+  // The light path runs every frame, so its delay line never skips
+  const float *alignedLight = light;
+  if (delayLight_) {
+    align(light, out, count);
+    alignedLight = out;
+  }
+  if (heavy != nullptr) {
+    heavyFrame_.resize(static_cast<size_t>(count));
+    if (delayLight_) {
+      std::copy(heavy, heavy + count, heavyFrame_.begin());
+    } else {
+      align(heavy, heavyFrame_.data(), count);
+    }
+  } else if (!delayLight_ && heavyFrame_.size() == static_cast<size_t>(count)) {
+    // Keep the heavy delay line moving: its real samples come out first
+    align(heavyFrame_.data(), heavyFrame_.data(), count);
+  }
+
+  // Without heavy output, fade the last heavy frame out at the crossfade
+  // rate rather than dropping it
+  float start = heavyWeight_;
+  float target = heavy != nullptr ? heavyTarget_ : 0.0f;
+  float step = 1.0f / static_cast<float>(std::max(1, config_.crossfadeFrames));
+  float end = (target > start) ? std::min(target, start + step)
+                               : std::max(target, start - step);
+  if (heavyFrame_.size() != static_cast<size_t>(count)) {
+    end = 0.0f;
+    start = 0.0f;
+  }
+  heavyWeight_ = end;
+
+  if (start == 0.0f && end == 0.0f) {
+    if (alignedLight != out) {
+      std::copy(light, light + count, out);
+    }
+    return;
+  }
+
+  const float *h = heavyFrame_.data();
+  float delta = (end - start) / static_cast<float>(count);
+  float w = start;
+  for (int i = 0; i < count; i++) {
+    w += delta;
+    out[i] = alignedLight[i] + w * (h[i] - alignedLight[i]);
+  }
+}
+
+CascadeStats ModelCascade::getStats() const {
+  CascadeStats stats;
+  stats.stage = stage_;
+  stats.residualNoiseDb = residualNoiseDb_;
+  stats.frames = frames_;
+  stats.heavyFrames = heavyFrames_;
+  stats.escalations = escalations_;
+  stats.heavyDutyRatio =
+      (frames_ > 0) ? static_cast<float>(heavyFrames_) / frames_ : 0.0f;
+  return stats;
+}
+
+} // namespace poise
@@ -0,0 +1,105 @@
+/**
+ * Model Cascade - Header
+ *
+ * Content-adaptive light/heavy model selection. The light model (GTCRN)
+ * runs every frame; the heavy model (legacy DeepFilterNet) is escalated to
+ * only while the estimated residual noise in the light output stays high,
+ * and otherwise runs at a low duty cycle so its recurrent state stays warm.
+ */
+
+#ifndef MODEL_CASCADE_H
+#define MODEL_CASCADE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace poise {
+
+struct CascadeConfig {
+  float escalateDb = -30.0f;  // Residual noise (floor vs level) to escalate
+  float hysteresisDb = 3.0f;  // De-escalate below escalateDb - hysteresisDb
+  int escalateFrames = 30;    // Sustained frames above threshold
+  int warmupFrames = 25;      // Heavy runs every frame before taking over
+  int holdFrames = 300;       // Sustained frames below threshold to drop back
+  int crossfadeFrames = 4;    // Output crossfade length
+  int warmDuty = 8;           // While light-only, run heavy 1 in N frames
+  int lightDelay = 0;         // Light path latency (samples)
+  int heavyDelay = 0;         // Heavy path latency (samples)
+};
+
+enum class CascadeStage { LIGHT, WARMING, HEAVY };
+
+struct CascadeDecision {
+  bool runHeavy = false;
+};
+
+struct CascadeStats {
+  CascadeStage stage = CascadeStage::LIGHT;
+  float residualNoiseDb = 0.0f;
+  int frames = 0;
+  int heavyFrames = 0;
+  int escalations = 0;
+  float heavyDutyRatio = 0.0f;
+};
+
+class ModelCascade {
+public:
+  explicit ModelCascade(const CascadeConfig &config = CascadeConfig());
+
+  /**
+   * Plan the current frame. Call once per frame before inference.
+   */
+  CascadeDecision decide();
+
+  /**
+   * Update the residual-noise estimate from the light model output.
+   */
+  void observeLightOutput(const float *output, int count);
+
+  /**
+   * Blend light and heavy outputs. The path with less latency is delayed to
+   * line up with the other, and the heavy weight ramps across the frame
+   * toward the current target so stage changes are click-free.
+   * @param heavy May be null when the heavy model did not produce output;
+   *        the last heavy frame is then faded out over the crossfade
+   */
+  void mix(const float *light, const float *heavy, float *out, int count);
+
+  CascadeStats getStats() const;
+
+  void reset();
+
+private:
+  void advanceStage();
+  void align(const float *in, float *out, int count);
+
+  CascadeConfig config_;
+  CascadeStage stage_;
+  int stageFrames_;
+  int aboveFrames_;
+  int belowFrames_;
+
+  // Minimum-statistics noise floor and peak level (linear energy)
+  float noiseFloor_;
+  float level_;
+  float residualNoiseDb_;
+
+  // Output blend
+  float heavyWeight_;
+  float heavyTarget_;
+
+  // Delay line for the earlier path, and the last aligned heavy frame
+  bool delayLight_;
+  std::vector<float> alignLine_;
+  size_t alignPos_;
+  std::vector<float> heavyFrame_;
+
+  // Statistics
+  int frames_;
+  int heavyFrames_;
+  int escalations_;
+};
+
+} // namespace poise
+
+#endif // MODEL_CASCADE_H
@@ -0,0 +1,105 @@
+/**
+ * Model Crossfade - Implementation
+ */
+
+#include "model_crossfade.h"
+#include <algorithm>
+
+namespace poise {
+
+namespace {
+
+uint32_t roundUpPow2(uint32_t value) {
+  uint32_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+} // namespace
+
+int ModelCrossfade::Queue::push(const float *samples, int count) {
+  int space = static_cast<int>(ring.size()) - size();
+  int accepted = std::min(count, space);
+  for (int i = 0; i < accepted; i++) {
+    ring[(writeIndex + i) & mask] = samples[i];
+  }
+  writeIndex += accepted;
+  return count - accepted;
+}
+
+ModelCrossfade::ModelCrossfade(int sampleRate, float fadeMs, int maxBlock)
+    : fadeSamples_(
+          std::max(1, static_cast<int>(fadeMs * sampleRate / 1000.0f))) {
+  // Each side runs at most one frame ahead of the other, so a few of the
+  // largest blocks cover any alignment of the two frame sizes
+  uint32_t capacity =
+      roundUpPow2(static_cast<uint32_t>(std::max(maxBlock, 1) * 4));
+  for (Queue *queue : {&outgoing_, &incoming_}) {
+    queue->ring.assign(capacity, 0.0f);
+    queue->mask = capacity - 1;
+  }
+  memory_.set(2 * capacity * sizeof(float));
+  reset();
+}
+
+void ModelCrossfade::start(int skipIncoming) {
+  started_ = true;
+  skipIncoming_ = std::max(0, skipIncoming);
+}
+
+void ModelCrossfade::pushOutgoing(const float *samples, int count) {
+  // After the fade the outgoing model has nothing left to contribute
+  if (started_ && !done_) {
+    dropped_ += outgoing_.push(samples, count);
+  }
+}
+
+void ModelCrossfade::pushIncoming(const float *samples, int count) {
+  if (!started_) {
+    return;
+  }
+  int skip = std::min(skipIncoming_, count);
+  skipIncoming_ -= skip;
+  dropped_ += incoming_.push(samples + skip, count - skip);
+}
+
+int ModelCrossfade::pull(float *out, int capacity) {
+  int n = 0;
+  if (started_ && !done_) {
+    // Linear in amplitude: both models enhance the same signal, so their
+    // outputs are strongly correlated and constant-gain summing is right
+    int mixed = std::min({capacity, outgoing_.size(), incoming_.size(),
+                          fadeSamples_ - position_});
+    for (; n < mixed; n++) {
+      float w = static_cast<float>(++position_) /
+                static_cast<float>(fadeSamples_);
+      float from = outgoing_.pop();
+      out[n] = from + w * (incoming_.pop() - from);
+    }
+    if (position_ >= fadeSamples_) {
+      done_ = true;
+      outgoing_.readIndex = outgoing_.writeIndex;
+    }
+  }
+  if (done_) {
+    int count = std::min(capacity - n, incoming_.size());
+    for (int i = 0; i < count; i++) {
+      out[n++] = incoming_.pop();
+    }
+  }
+  return n;
+}
+
+void ModelCrossfade::reset() {
+  position_ = 0;
+  started_ = false;
+  done_ = false;
+  skipIncoming_ = 0;
+  dropped_ = 0;
+  outgoing_.readIndex = outgoing_.writeIndex = 0;
+  incoming_.readIndex = incoming_.writeIndex = 0;
+}
+
+} // namespace poise
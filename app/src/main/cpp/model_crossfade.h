@@ -0,0 +1,85 @@
+/**
+ * Model Crossfade - Header
+ *
+ * Hands the output over from one model to another during a hot switch.
+ * For the length of the fade both models run and their outputs are queued
+ * side by side, indexed by the input sample they came from. The two models
+ * may use different frame sizes, so output is only released where both
+ * sides have produced it; the fade is therefore sample-aligned however the
+ * frames line up, at the cost of up to one frame of extra buffering while
+ * it runs. After the fade only the incoming queue drains, continuing
+ * exactly where the mix left off.
+ *
+ * Storage is allocated up front; every call after construction is
+ * allocation-free. Used from the processing thread only.
+ */
+
+#ifndef MODEL_CROSSFADE_H
+#define MODEL_CROSSFADE_H
+
+#include "memory_accounting.h"
+#include <cstdint>
+#include <vector>
+
+namespace poise {
+
+class ModelCrossfade {
+public:
+  /**
+   * @param fadeMs Fade length
+   * @param maxBlock Largest block either model produces, in samples
+   */
+  ModelCrossfade(int sampleRate, float fadeMs, int maxBlock);
+
+  /**
+   * Begin the fade. The next outgoing block starts at a hop boundary; the
+   * incoming model has already consumed skipIncoming samples before that
+   * boundary (a partial frame), so that much of its next output is dropped
+   * to line the two up.
+   */
+  void start(int skipIncoming);
+
+  // Queue output of either model (drops what does not fit)
+  void pushOutgoing(const float *samples, int count);
+  void pushIncoming(const float *samples, int count);
+
+  /**
+   * Release output: mixed while fading, then incoming only.
+   * @return Samples written (at most capacity)
+   */
+  int pull(float *out, int capacity);
+
+  bool isStarted() const { return started_; }
+  bool isDone() const { return done_; }
+  int droppedSamples() const { return dropped_; }
+
+  void reset();
+
+private:
+  struct Queue {
+    std::vector<float> ring;
+    uint32_t mask = 0;
+    uint64_t writeIndex = 0;
+    uint64_t readIndex = 0;
+
+    int size() const { return static_cast<int>(writeIndex - readIndex); }
+    int push(const float *samples, int count);
+    float pop() { return ring[readIndex++ & mask]; }
+  };
+
+  int fadeSamples_;
+  int position_; // Fade samples released so far
+  bool started_;
+  bool done_;
+  int skipIncoming_;
+  int dropped_;
+
+  Queue outgoing_;
+  Queue incoming_;
+
+  MemoryCharge memory_{MemoryComponent::MODEL_SWITCH};
+};
+
+} // namespace poise
+
+#endif // MODEL_CROSSFADE_H
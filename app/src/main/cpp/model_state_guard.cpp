@@ -0,0 +1,102 @@
+/**
+ * Model State Guard - Implementation
+ */
+
+#include "model_state_guard.h"
+#include "async_log.h"
+#include "cold_state_pool.h"
+#include "numeric_guard.h"
+#include <algorithm>
+#include <cmath>
+
+#define LOG_TAG "PoiseState"
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) POISE_LOG(poise::LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+ModelStateGuard::ModelStateGuard(int64_t streamId, StreamMetrics *metrics)
+    : streamId_(streamId), metrics_(metrics), nonFiniteEvents_(0),
+      stateResets_(0), parked_(false), evictions_(0), residentBytes_(0) {}
+
+ModelStateGuard::~ModelStateGuard() {
+  // The metrics slot may already be released; only the pool entry goes
+  if (parked_) {
+    ColdStatePool::instance().discard(streamId_);
+  }
+}
+
+bool ModelStateGuard::check(float *state, size_t count) {
+  float maxAbs = maxAbsOrInf(state, count);
+  if (!std::isfinite(maxAbs)) {
+    nonFiniteEvents_++;
+    if (metrics_) {
+      metricsInc(metrics_->nonFiniteEvents);
+    }
+    reset(state, count, "non-finite state");
+    return true;
+  }
+  if (maxAbs > STATE_ABS_LIMIT) {
+    reset(state, count, "state magnitude out of range");
+    return true;
+  }
+  return false;
+}
+
+void ModelStateGuard::reset(float *state, size_t count, const char *reason) {
+  // Keep the allocation; only the contents are suspect
+  std::fill(state, state + count, 0.0f);
+  stateResets_++;
+  if (metrics_) {
+    metricsInc(metrics_->stateResets);
+  }
+  LOGE("Stream %lld: recurrent state reset (%s)",
+       static_cast<long long>(streamId_), reason);
+}
+
+size_t ModelStateGuard::park(const float *state, size_t count) {
+  size_t packedSize = ColdStatePool::instance().park(streamId_, state, count);
+  if (!parked_) {
+    parked_ = true;
+    evictions_++;
+    if (metrics_) {
+      residentBytes_ =
+          metrics_->stateResidentBytes.load(std::memory_order_relaxed);
+      metricsInc(metrics_->stateEvictions);
+      metricsSet(metrics_->stateResidentBytes, 0);
+    }
+  }
+  LOGI("Stream %lld state parked: %zu -> %zu bytes",
+       static_cast<long long>(streamId_), count * sizeof(float), packedSize);
+  return packedSize;
+}
+
+bool ModelStateGuard::restore(float *state, size_t count) {
+  bool restored =
+      parked_ && ColdStatePool::instance().restore(streamId_, state, count);
+  if (!restored) {
+    LOGE("Stream %lld state restore failed, starting from zero state",
+         static_cast<long long>(streamId_));
+    std::fill(state, state + count, 0.0f);
+  }
+  if (parked_) {
+    parked_ = false;
+    if (metrics_) {
+      metricsSet(metrics_->stateResidentBytes, residentBytes_);
+    }
+  }
+  return restored;
+}
+
+void ModelStateGuard::discard() {
+  if (!parked_) {
+    return;
+  }
+  ColdStatePool::instance().discard(streamId_);
+  parked_ = false;
+  if (metrics_) {
+    metricsSet(metrics_->stateResidentBytes, residentBytes_);
+  }
+}
+
+} // namespace poise
@@ -0,0 +1,76 @@
+/**
+ * Model State Guard - Header
+ *
+ * Numeric health and idle parking of the recurrent model state a host
+ * keeps between frames. The state itself lives next to the host's
+ * inference session (FloatArrays or a StateStore on the Kotlin side); the
+ * guard inspects it, parks it in the cold state pool while the stream is
+ * silent, and accounts for both in the stream's metrics.
+ */
+
+#ifndef MODEL_STATE_GUARD_H
+#define MODEL_STATE_GUARD_H
+
+#include "stream_metrics.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace poise {
+
+class ModelStateGuard {
+public:
+  // Recurrent state beyond this magnitude is treated as diverged
+  static constexpr float STATE_ABS_LIMIT = 1.0e6f;
+
+  ModelStateGuard(int64_t streamId, StreamMetrics *metrics);
+  ~ModelStateGuard();
+
+  ModelStateGuard(const ModelStateGuard &) = delete;
+  ModelStateGuard &operator=(const ModelStateGuard &) = delete;
+
+  /**
+   * Scan state for NaN/Inf or runaway magnitude and zero it in place if
+   * either is found.
+   * @return true if the state was reset
+   */
+  bool check(float *state, size_t count);
+
+  // Zero state the caller knows is poisoned (e.g. non-finite model output)
+  void reset(float *state, size_t count, const char *reason);
+
+  /**
+   * Compress the state into the cold pool (FP16 + PackBits) so the host
+   * can free its copy. Parking again replaces the parked state.
+   * @return Packed bytes
+   */
+  size_t park(const float *state, size_t count);
+
+  /**
+   * Take parked state back into count floats.
+   * @return false if nothing matching was parked (state is then zeroed)
+   */
+  bool restore(float *state, size_t count);
+
+  // Drop parked state, e.g. when the host resets its model
+  void discard();
+
+  bool parked() const { return parked_; }
+  int evictions() const { return evictions_; }
+  int nonFiniteEvents() const { return nonFiniteEvents_; }
+  int stateResets() const { return stateResets_; }
+
+private:
+  int64_t streamId_;
+  StreamMetrics *metrics_;
+  int nonFiniteEvents_;
+  int stateResets_;
+
+  bool parked_;
+  int evictions_;
+  // stateResidentBytes gauge before parking, put back on restore
+  int64_t residentBytes_;
+};
+
+} // namespace poise
+
+#endif // MODEL_STATE_GUARD_H
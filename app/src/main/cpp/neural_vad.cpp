@@ -0,0 +1,197 @@
+/**
+ * Neural VAD - Implementation
+ */
+
+#include "neural_vad.h"
+#include "async_log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define LOG_TAG "PoiseNeuralVAD"
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) POISE_LOG(poise::LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+// Analysis range: 60 Hz .. 8 kHz, mel-spaced
+constexpr float MIN_FREQ_HZ = 60.0f;
+constexpr float MAX_FREQ_HZ = 8000.0f;
+
+// Running band mean (~1 s at 16 ms frames) for stationary-noise normalization
+constexpr float MEAN_ALPHA = 0.016f;
+
+float hzToMel(float hz) { return 2595.0f * std::log10(1.0f + hz / 700.0f); }
+float melToHz(float mel) {
+  return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+inline float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+} // anonymous namespace
+
+NeuralVad::NeuralVad(int sampleRate, int fftSize)
+    : sampleRate_(sampleRate), fftSize_(fftSize), loaded_(false),
+      inB_(nullptr), gruBx_(nullptr), gruBh_(nullptr), outW_(nullptr),
+      outB_(nullptr),
+      onThreshold_(DEFAULT_ON_THRESHOLD), offThreshold_(DEFAULT_OFF_THRESHOLD),
+      hangFrames_(DEFAULT_HANG_FRAMES) {
+  int numBins = fftSize / 2 + 1;
+  float binHz = static_cast<float>(sampleRate) / static_cast<float>(fftSize);
+  float maxHz = std::min(MAX_FREQ_HZ, sampleRate * 0.5f);
+  float melLo = hzToMel(MIN_FREQ_HZ);
+  float melHi = hzToMel(maxHz);
+
+  bandEdges_.resize(NUM_BANDS + 1);
+  for (int b = 0; b <= NUM_BANDS; b++) {
+    float hz = melToHz(melLo + (melHi - melLo) * b / NUM_BANDS);
+    bandEdges_[b] = std::min(numBins - 1, static_cast<int>(hz / binHz + 0.5f));
+    // Every band covers at least one bin
+    if (b > 0 && bandEdges_[b] <= bandEdges_[b - 1]) {
+      bandEdges_[b] = std::min(numBins - 1, bandEdges_[b - 1] + 1);
+    }
+  }
+  reset();
+}
+
+bool NeuralVad::loadWeights(const float *weights, int count) {
+  if (count != PARAM_COUNT) {
+    LOGE("Weight count mismatch: got %d, expected %d", count, PARAM_COUNT);
+    return false;
+  }
+  const float *p = weights;
+  inW_ = BlockSparseMatrix::pack(p, HIDDEN, NUM_BANDS);
+  p += HIDDEN * NUM_BANDS;
+  const float *bias = p;
+  p += HIDDEN;
+  gruWx_ = BlockSparseMatrix::pack(p, 3 * HIDDEN, HIDDEN);
+  p += 3 * HIDDEN * HIDDEN;
+  gruWh_ = BlockSparseMatrix::pack(p, 3 * HIDDEN, HIDDEN);
+  p += 3 * HIDDEN * HIDDEN;
+
+  // Only the vectors stay in weights_; the matrices live in their packing
+  weights_.assign(bias, bias + HIDDEN);
+  weights_.insert(weights_.end(), p, weights + count);
+  memory_.set(weights_.capacity() * sizeof(float) +
+              bandEdges_.capacity() * sizeof(int) + inW_.bytes() +
+              gruWx_.bytes() + gruWh_.bytes());
+
+  p = weights_.data();
+  inB_ = p;
+  p += HIDDEN;
+  gruBx_ = p;
+  p += 3 * HIDDEN;
+  gruBh_ = p;
+  p += 3 * HIDDEN;
+  outW_ = p;
+  p += HIDDEN;
+  outB_ = p;
+
+  loaded_ = true;
+  reset();
+  LOGI("Neural VAD loaded: %d params; in %s, Wx %s %.0f%%, Wh %s %.0f%% "
+       "dense, %d MACs",
+       PARAM_COUNT, blockShapeName(inW_.shape()),
+       blockShapeName(gruWx_.shape()), gruWx_.density() * 100.0f,
+       blockShapeName(gruWh_.shape()), gruWh_.density() * 100.0f,
+       matrixMacs());
+  return true;
+}
+
+int NeuralVad::matrixMacs() const {
+  auto macs = [](const BlockSparseMatrix &m) {
+    return static_cast<int>(m.density() * m.rows() * m.cols() + 0.5f);
+  };
+  return macs(inW_) + macs(gruWx_) + macs(gruWh_);
+}
+
+void NeuralVad::setThresholds(float onThreshold, float offThreshold,
+                              int hangFrames) {
+  onThreshold_ = onThreshold;
+  offThreshold_ = std::min(offThreshold, onThreshold);
+  hangFrames_ = std::max(0, hangFrames);
+}
+
+void NeuralVad::reset() {
+  std::memset(hidden_, 0, sizeof(hidden_));
+  std::memset(bandMean_, 0, sizeof(bandMean_));
+  meanPrimed_ = false;
+  framesBelow_ = hangFrames_;
+  speech_ = true; // Fail open until the first decision
+}
+
+void NeuralVad::computeFeatures(const float *real, const float *imag,
+                                int numBins, float *features) {
+  for (int b = 0; b < NUM_BANDS; b++) {
+    int lo = bandEdges_[b];
+    int hi = std::min(bandEdges_[b + 1], numBins);
+    float energy = 0.0f;
+    for (int k = lo; k < hi; k++) {
+      energy += real[k] * real[k] + imag[k] * imag[k];
+    }
+    float logEnergy = std::log10(energy / std::max(1, hi - lo) + 1e-10f);
+
+    if (!meanPrimed_) {
+      bandMean_[b] = logEnergy;
+    } else {
+      bandMean_[b] += MEAN_ALPHA * (logEnergy - bandMean_[b]);
+    }
+    features[b] = logEnergy - bandMean_[b];
+  }
+  meanPrimed_ = true;
+}
+
+float NeuralVad::process(const float *real, const float *imag, int numBins) {
+  if (!loaded_) {
+    speech_ = true;
+    return 1.0f;
+  }
+
+  float features[NUM_BANDS];
+  computeFeatures(real, imag, numBins, features);
+
+  // Input projection
+  float x[HIDDEN];
+  std::memcpy(x, inB_, sizeof(x));
+  inW_.multiplyAccumulate(features, x);
+  for (int i = 0; i < HIDDEN; i++) {
+    x[i] = std::tanh(x[i]);
+  }
+
+  // GRU (PyTorch gate convention: n = tanh(Wx x + bx + r * (Wh h + bh)))
+  float gx[3][HIDDEN];
+  float gh[3][HIDDEN];
+  std::memcpy(gx, gruBx_, sizeof(gx));
+  std::memcpy(gh, gruBh_, sizeof(gh));
+  gruWx_.multiplyAccumulate(x, gx[0]);
+  gruWh_.multiplyAccumulate(hidden_, gh[0]);
+  for (int i = 0; i < HIDDEN; i++) {
+    float r = sigmoid(gx[0][i] + gh[0][i]);
+    float z = sigmoid(gx[1][i] + gh[1][i]);
+    float n = std::tanh(gx[2][i] + r * gh[2][i]);
+    hidden_[i] = (1.0f - z) * n + z * hidden_[i];
+  }
+
+  // Output
+  float logit = outB_[0];
+  for (int i = 0; i < HIDDEN; i++) {
+    logit += outW_[i] * hidden_[i];
+  }
+  float prob = sigmoid(logit);
+
+  // Hysteresis + hang time
+  if (prob >= onThreshold_) {
+    speech_ = true;
+    framesBelow_ = 0;
+  } else if (prob < offThreshold_) {
+    framesBelow_++;
+    if (framesBelow_ > hangFrames_) {
+      speech_ = false;
+    }
+  }
+  return prob;
+}
+
+} // namespace poise
@@ -0,0 +1,128 @@
+/**
+ * Neural VAD - Header
+ *
+ * Tiny streaming speech detector that gates the denoiser. Runs on the STFT
+ * bins the GTCRN path already computes, so its features are nearly free:
+ * 16 log band energies (normalized against a running mean) -> dense 24
+ * (tanh) -> GRU 24 -> dense 1 (sigmoid). About 4K parameters, i.e. a few
+ * thousand MACs per frame.
+ *
+ * Weight matrices pruned in whole 4x4 or 1x8 blocks (tools/vad_prune) are
+ * detected at load and run on the block-sparse kernels.
+ *
+ * This is opt-in infrastructure: no trained weights ship with the app, and
+ * a stream has no gate until weights are loaded into it. tools/vad_prune
+ * builds a training set, trains, exports and prunes them.
+ */
+
+#ifndef NEURAL_VAD_H
+#define NEURAL_VAD_H
+
+#include "block_sparse.h"
+#include "memory_accounting.h"
+#include <vector>
+
+namespace poise {
+
+class NeuralVad {
+public:
+  static constexpr int NUM_BANDS = 16;
+  static constexpr int HIDDEN = 24;
+
+  // Gate defaults (see setThresholds)
+  static constexpr float DEFAULT_ON_THRESHOLD = 0.6f;
+  static constexpr float DEFAULT_OFF_THRESHOLD = 0.4f;
+  static constexpr int DEFAULT_HANG_FRAMES = 12; // ~200 ms at 16 kHz / 256 hop
+
+  // Flat weight layout, in order:
+  //   inW[HIDDEN][NUM_BANDS], inB[HIDDEN],
+  //   gruWx[3][HIDDEN][HIDDEN], gruWh[3][HIDDEN][HIDDEN] (gates r, z, n),
+  //   gruBx[3][HIDDEN], gruBh[3][HIDDEN],
+  //   outW[HIDDEN], outB[1]
+  // The GRU blocks are torch.nn.GRU's weight_ih_l0, weight_hh_l0, bias_ih_l0
+  // and bias_hh_l0 as stored, so a checkpoint flattens without reordering.
+  static constexpr int PARAM_COUNT = HIDDEN * NUM_BANDS + HIDDEN +
+                                     2 * 3 * HIDDEN * HIDDEN + 2 * 3 * HIDDEN +
+                                     HIDDEN + 1;
+
+  /**
+   * @param sampleRate Rate of the analyzed audio
+   * @param fftSize FFT length that produced the bins
+   */
+  NeuralVad(int sampleRate, int fftSize);
+
+  /**
+   * Load weights in the layout above.
+   * @return false if the size does not match PARAM_COUNT
+   */
+  bool loadWeights(const float *weights, int count);
+
+  bool isLoaded() const { return loaded_; }
+
+  // Multiply-adds per frame in the three weight matrices, after pruning
+  int matrixMacs() const;
+
+  /**
+   * Run one frame on complex bins (numBins = fftSize/2 + 1).
+   * @return Speech probability in [0, 1]
+   */
+  float process(const float *real, const float *imag, int numBins);
+
+  /**
+   * Gate decision with hysteresis and hang time around the last
+   * probability. True while the main model should run.
+   */
+  bool isSpeech() const { return speech_; }
+
+  void setThresholds(float onThreshold, float offThreshold, int hangFrames);
+
+  /**
+   * The NUM_BANDS normalized log band energies process() feeds the network;
+   * advances the running band mean. Public so training features come from
+   * this exact code (tools/vad_prune/vad_features).
+   */
+  void computeFeatures(const float *real, const float *imag, int numBins,
+                       float *features);
+
+  void reset();
+
+  // Charge the weights to a stream (nullptr detaches)
+  void attachMemory(StreamMetrics *stream) { memory_.attach(stream); }
+
+private:
+  int sampleRate_;
+  int fftSize_;
+  bool loaded_;
+
+  // Band edges in bins (NUM_BANDS + 1 entries)
+  std::vector<int> bandEdges_;
+
+  std::vector<float> weights_;
+  MemoryCharge memory_{MemoryComponent::NEURAL_VAD};
+  const float *inB_;
+  const float *gruBx_;
+  const float *gruBh_;
+  const float *outW_;
+  const float *outB_;
+
+  // Packed from weights_; gates r, z, n stacked as 3 * HIDDEN rows
+  BlockSparseMatrix inW_;
+  BlockSparseMatrix gruWx_;
+  BlockSparseMatrix gruWh_;
+
+  // Streaming state
+  float hidden_[HIDDEN];
+  float bandMean_[NUM_BANDS];
+  bool meanPrimed_;
+
+  // Gate
+  float onThreshold_;
+  float offThreshold_;
+  int hangFrames_;
+  int framesBelow_;
+  bool speech_;
+};
+
+} // namespace poise
+
+#endif // NEURAL_VAD_H
@@ -0,0 +1,78 @@
+/**
+ * Numeric Guard - Implementation
+ *
+ * A float is non-finite when all exponent bits are set, so the check is a
+ * mask-and-compare on the raw bits that vectorizes cleanly.
+ */
+
+#include "numeric_guard.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace poise {
+
+namespace {
+
+constexpr uint32_t EXPONENT_MASK = 0x7F800000u;
+
+inline uint32_t floatBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+} // anonymous namespace
+
+bool allFinite(const float *data, size_t count) {
+  size_t i = 0;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint32x4_t mask = vdupq_n_u32(EXPONENT_MASK);
+  uint32x4_t bad = vdupq_n_u32(0);
+  for (; i + 4 <= count; i += 4) {
+    uint32x4_t bits = vreinterpretq_u32_f32(vld1q_f32(data + i));
+    bad = vorrq_u32(bad, vceqq_u32(vandq_u32(bits, mask), mask));
+  }
+  uint32x2_t folded = vorr_u32(vget_low_u32(bad), vget_high_u32(bad));
+  if ((vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) != 0) {
+    return false;
+  }
+#endif
+
+  uint32_t bad32 = 0;
+  for (; i < count; i++) {
+    bad32 |= static_cast<uint32_t>((floatBits(data[i]) & EXPONENT_MASK) ==
+                                   EXPONENT_MASK);
+  }
+  return bad32 == 0;
+}
+
+float maxAbsOrInf(const float *data, size_t count) {
+  if (!allFinite(data, count)) {
+    return std::numeric_limits<float>::infinity();
+  }
+  float maxAbs = 0.0f;
+  for (size_t i = 0; i < count; i++) {
+    maxAbs = std::fmax(maxAbs, std::fabs(data[i]));
+  }
+  return maxAbs;
+}
+
+size_t scrubNonFinite(float *data, size_t count) {
+  size_t replaced = 0;
+  for (size_t i = 0; i < count; i++) {
+    if ((floatBits(data[i]) & EXPONENT_MASK) == EXPONENT_MASK) {
+      data[i] = 0.0f;
+      replaced++;
+    }
+  }
+  return replaced;
+}
+
+} // namespace poise
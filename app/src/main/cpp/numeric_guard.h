@@ -0,0 +1,35 @@
+/**
+ * Numeric Guard - Header
+ *
+ * Vectorized NaN/Inf detection and scrubbing for audio buffers and
+ * recurrent model state.
+ */
+
+#ifndef NUMERIC_GUARD_H
+#define NUMERIC_GUARD_H
+
+#include <cstddef>
+
+namespace poise {
+
+/**
+ * True if every value is finite. Branch-free over the buffer (NEON on ARM,
+ * auto-vectorized bit test elsewhere).
+ */
+bool allFinite(const float *data, size_t count);
+
+/**
+ * Largest absolute value, or +Inf if any value is not finite.
+ * Used by the periodic state health check.
+ */
+float maxAbsOrInf(const float *data, size_t count);
+
+/**
+ * Replace NaN/Inf with 0.
+ * @return Number of values replaced
+ */
+size_t scrubNonFinite(float *data, size_t count);
+
+} // namespace poise
+
+#endif // NUMERIC_GUARD_H
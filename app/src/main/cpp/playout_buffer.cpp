@@ -0,0 +1,349 @@
+/**
+ * Adaptive Playout Buffer - Implementation
+ */
+
+#include "playout_buffer.h"
+#include "async_log.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#define LOG_TAG "PoisePlayout"
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+constexpr int TARGET_UPDATE_INTERVAL = 8; // Pushes between quantile updates
+constexpr int CROSSFADE_SAMPLES = 32;
+constexpr float CONCEAL_DECAY = 0.5f;    // Gain per concealed block
+constexpr float REBUFFER_AFTER_MS = 100.0f;
+
+int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint32_t roundUpPow2(uint32_t value) {
+  uint32_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+} // namespace
+
+PlayoutBuffer::PlayoutBuffer(int sampleRate, PlayoutConfig config)
+    : sampleRate_(sampleRate), config_(config) {
+  // Room for the deepest target plus a burst of late blocks
+  uint32_t capacity = roundUpPow2(
+      static_cast<uint32_t>(2.0f * config_.maxDepthMs * sampleRate / 1000.0f));
+  ring_.assign(capacity, 0.0f);
+  mask_ = capacity - 1;
+  offsetsMs_.assign(std::max(config_.historyBlocks, 8), 0.0f);
+  lateness_.assign(offsetsMs_.size(), 0.0f);
+  resyncGapNs_ = static_cast<int64_t>(config_.maxDepthMs * 1.0e6f);
+  scratch_.reserve(capacity);
+  silenceLinear_ = std::pow(10.0f, config_.silenceDb / 20.0f);
+  reset();
+  chargeMemory();
+}
+
+void PlayoutBuffer::chargeMemory() {
+  memory_.set((ring_.capacity() + offsetsMs_.capacity() +
+               lateness_.capacity() + lastBlock_.capacity() +
+               scratch_.capacity()) *
+              sizeof(float));
+}
+
+void PlayoutBuffer::reset() {
+  writeIndex_.store(0, std::memory_order_relaxed);
+  readIndex_.store(0, std::memory_order_relaxed);
+
+  firstArrivalNs_ = 0;
+  lastArrivalNs_ = 0;
+  resyncPending_ = false;
+  pushedSamples_ = 0;
+  historyPos_ = 0;
+  historyCount_ = 0;
+  pushesSinceUpdate_ = 0;
+  targetSamples_.store(
+      static_cast<int>(config_.minDepthMs * sampleRate_ / 1000.0f),
+      std::memory_order_relaxed);
+  jitterMs_.store(0.0f, std::memory_order_relaxed);
+
+  prebuffering_ = true;
+  concealRun_ = 0;
+  windowMinDepth_ = std::numeric_limits<int>::max();
+  windowPullCount_ = 0;
+  lastWindowMin_ = -1;
+  adjustPending_ = false;
+  lastBlock_.clear();
+  depthSumMs_ = 0.0;
+  pulls_ = 0;
+
+  underruns_.store(0, std::memory_order_relaxed);
+  concealedSamples_.store(0, std::memory_order_relaxed);
+  droppedSamples_.store(0, std::memory_order_relaxed);
+  insertedSamples_.store(0, std::memory_order_relaxed);
+  overflowSamples_.store(0, std::memory_order_relaxed);
+  avgLatencyMs_.store(0.0f, std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Producer
+// ============================================================================
+
+void PlayoutBuffer::push(const float *samples, int count) {
+  int64_t now = nowNs();
+  pushBlock_.store(count, std::memory_order_relaxed);
+  // A gap no depth could bridge means the producer was idle, not late;
+  // counting it as jitter would pin the target at maxDepthMs
+  if (pushedSamples_ > 0 &&
+      (resyncPending_ || now - lastArrivalNs_ > resyncGapNs_)) {
+    resyncArrivals(now);
+  }
+  if (pushedSamples_ == 0) {
+    firstArrivalNs_ = now;
+  }
+  lastArrivalNs_ = now;
+  pushedSamples_ += count;
+
+  // How far behind its media time this block arrived; the window minimum
+  // is the on-time baseline, so clock drift only shifts the baseline
+  double mediaMs = pushedSamples_ * 1000.0 / sampleRate_;
+  double arrivalMs = (now - firstArrivalNs_) / 1.0e6;
+  offsetsMs_[historyPos_] = static_cast<float>(arrivalMs - mediaMs);
+  historyPos_ = (historyPos_ + 1) % static_cast<int>(offsetsMs_.size());
+  historyCount_ = std::min(historyCount_ + 1,
+                           static_cast<int>(offsetsMs_.size()));
+
+  if (++pushesSinceUpdate_ >= TARGET_UPDATE_INTERVAL) {
+    pushesSinceUpdate_ = 0;
+    updateTarget();
+    // Target is the floor the depth may touch just before a block arrives
+    int target = static_cast<int>(
+        (jitterMs_.load(std::memory_order_relaxed) + config_.minDepthMs) *
+        sampleRate_ / 1000.0f);
+    int minTarget = static_cast<int>(config_.minDepthMs * sampleRate_ / 1000);
+    int maxTarget = static_cast<int>(config_.maxDepthMs * sampleRate_ / 1000);
+    targetSamples_.store(std::clamp(target, minTarget, maxTarget),
+                         std::memory_order_relaxed);
+  }
+
+  uint64_t write = writeIndex_.load(std::memory_order_relaxed);
+  uint64_t read = readIndex_.load(std::memory_order_acquire);
+  int space = static_cast<int>(ring_.size() - (write - read));
+  if (count > space) {
+    overflowSamples_.fetch_add(count - space, std::memory_order_relaxed);
+    count = space;
+  }
+  for (int i = 0; i < count; i++) {
+    ring_[(write + i) & mask_] = samples[i];
+  }
+  writeIndex_.store(write + count, std::memory_order_release);
+}
+
+void PlayoutBuffer::resync() { resyncPending_ = true; }
+
+void PlayoutBuffer::resyncArrivals(int64_t now) {
+  // The learned target stays until the fresh history replaces it
+  LOGI("Arrival gap of %.0f ms, resyncing jitter baseline",
+       (now - lastArrivalNs_) / 1.0e6);
+  pushedSamples_ = 0;
+  historyPos_ = 0;
+  historyCount_ = 0;
+  pushesSinceUpdate_ = 0;
+  resyncPending_ = false;
+}
+
+void PlayoutBuffer::updateTarget() {
+  // Preallocated: this runs on the producer's audio thread
+  auto first = lateness_.begin();
+  auto last = first + historyCount_;
+  std::copy(offsetsMs_.begin(), offsetsMs_.begin() + historyCount_, first);
+  float baseline = *std::min_element(first, last);
+
+  // Depth needed so that only underrunProbability of blocks arrive later
+  size_t size = static_cast<size_t>(historyCount_);
+  size_t rank = static_cast<size_t>(
+      std::ceil((1.0f - config_.underrunProbability) * size));
+  rank = std::min(std::max<size_t>(rank, 1), size) - 1;
+  std::nth_element(first, first + rank, last);
+  jitterMs_.store(first[rank] - baseline, std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Consumer
+// ============================================================================
+
+int PlayoutBuffer::available() const {
+  uint64_t write = writeIndex_.load(std::memory_order_acquire);
+  uint64_t read = readIndex_.load(std::memory_order_relaxed);
+  return static_cast<int>(write - read);
+}
+
+void PlayoutBuffer::readSamples(float *out, int count) {
+  uint64_t read = readIndex_.load(std::memory_order_relaxed);
+  for (int i = 0; i < count; i++) {
+    out[i] = ring_[(read + i) & mask_];
+  }
+  readIndex_.store(read + count, std::memory_order_release);
+}
+
+float PlayoutBuffer::peekRms(int count) const {
+  uint64_t read = readIndex_.load(std::memory_order_relaxed);
+  float sum = 0.0f;
+  for (int i = 0; i < count; i++) {
+    float x = ring_[(read + i) & mask_];
+    sum += x * x;
+  }
+  return count > 0 ? std::sqrt(sum / count) : 0.0f;
+}
+
+void PlayoutBuffer::conceal(float *out, int from, int count) {
+  if (lastBlock_.empty()) {
+    std::fill(out + from, out + count, 0.0f);
+    return;
+  }
+
+  // Repeat the last real block, fading further on every concealed pull
+  float gain = std::pow(CONCEAL_DECAY, static_cast<float>(concealRun_ + 1));
+  int period = static_cast<int>(lastBlock_.size());
+  for (int i = from; i < count; i++) {
+    out[i] = lastBlock_[i % period] * gain;
+  }
+  // Smooth the seam with the real samples before it
+  int fade = std::min(CROSSFADE_SAMPLES, count - from);
+  if (from > 0) {
+    for (int i = 0; i < fade; i++) {
+      float t = static_cast<float>(i + 1) / (fade + 1);
+      out[from + i] = out[from - 1] * (1.0f - t) + out[from + i] * t;
+    }
+  }
+}
+
+int PlayoutBuffer::pull(float *out, int count) {
+  int avail = available();
+  int target = targetSamples_.load(std::memory_order_relaxed);
+
+  int pushBlock = pushBlock_.load(std::memory_order_relaxed);
+
+  if (prebuffering_) {
+    if (avail < target + std::max(pushBlock, count)) {
+      std::fill(out, out + count, 0.0f);
+      return 0;
+    }
+    prebuffering_ = false;
+  }
+
+  pulls_++;
+  depthSumMs_ += avail * 1000.0 / sampleRate_;
+  avgLatencyMs_.store(static_cast<float>(depthSumMs_ / pulls_),
+                      std::memory_order_relaxed);
+
+  if (avail < count) {
+    // Underrun: play what we have and conceal the rest
+    if (avail > 0) {
+      readSamples(out, avail);
+    }
+    conceal(out, avail, count);
+    if (concealRun_ == 0) {
+      underruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+    concealRun_++;
+    concealedSamples_.fetch_add(count - avail, std::memory_order_relaxed);
+
+    // A long gap means the producer stalled; refill to target first
+    if (concealRun_ * count >= REBUFFER_AFTER_MS * sampleRate_ / 1000.0f) {
+      prebuffering_ = true;
+      LOGI("Producer stalled, rebuffering to %d samples", target);
+    }
+    return avail;
+  }
+
+  concealRun_ = 0;
+
+  // Depth saw-tooths by one pushed block between arrivals, so steer on its
+  // minimum over a window spanning at least one push, once per window
+  int depthAfter = avail - count;
+  windowMinDepth_ = std::min(windowMinDepth_, depthAfter);
+  int windowPulls = (pushBlock + count - 1) / count + 1;
+  if (++windowPullCount_ >= windowPulls) {
+    lastWindowMin_ = windowMinDepth_;
+    windowMinDepth_ = depthAfter;
+    windowPullCount_ = 0;
+    adjustPending_ = true;
+  }
+
+  int hysteresis = std::max(count / 2, target / 4);
+  int maxAdjust = static_cast<int>(count * config_.maxAdjustRatio);
+  int fade = std::min(CROSSFADE_SAMPLES, count / 4);
+  bool canAdjust = adjustPending_ && lastWindowMin_ >= 0 && maxAdjust > fade &&
+                   peekRms(count) < silenceLinear_;
+  int excess = lastWindowMin_ - target;
+
+  if (canAdjust && excess > hysteresis && avail >= count + excess) {
+    // Too deep: drop k samples inside this silent block with a crossfade
+    int k = std::min(excess, maxAdjust - fade);
+    adjustPending_ = false;
+    lastWindowMin_ -= k;
+    scratch_.resize(count + k);
+    readSamples(scratch_.data(), count + k);
+    std::memcpy(out, scratch_.data(), (count - fade) * sizeof(float));
+    for (int i = 0; i < fade; i++) {
+      float t = static_cast<float>(i + 1) / (fade + 1);
+      out[count - fade + i] = scratch_[count - fade + i] * (1.0f - t) +
+                              scratch_[count - fade + i + k] * t;
+    }
+    droppedSamples_.fetch_add(k, std::memory_order_relaxed);
+  } else if (canAdjust && -excess > hysteresis) {
+    // Too shallow: stretch this silent block by repeating its tail
+    int k = std::min(-excess, maxAdjust - fade);
+    adjustPending_ = false;
+    lastWindowMin_ += k;
+    readSamples(out, count - k);
+    for (int i = 0; i < k; i++) {
+      out[count - k + i] = out[count - 2 * k + i];
+    }
+    for (int i = 0; i < fade; i++) {
+      float t = static_cast<float>(i + 1) / (fade + 1);
+      out[count - k + i] =
+          out[count - k - 1] * (1.0f - t) + out[count - k + i] * t;
+    }
+    insertedSamples_.fetch_add(k, std::memory_order_relaxed);
+  } else {
+    readSamples(out, count);
+  }
+
+  lastBlock_.assign(out, out + count);
+  chargeMemory();
+  return count;
+}
+
+PlayoutStats PlayoutBuffer::getStats() const {
+  PlayoutStats stats;
+  float msPerSample = 1000.0f / sampleRate_;
+  uint64_t write = writeIndex_.load(std::memory_order_acquire);
+  uint64_t read = readIndex_.load(std::memory_order_acquire);
+  stats.depthMs = static_cast<float>(write - read) * msPerSample;
+  stats.targetMs =
+      targetSamples_.load(std::memory_order_relaxed) * msPerSample;
+  stats.jitterMs = jitterMs_.load(std::memory_order_relaxed);
+  stats.avgLatencyMs = avgLatencyMs_.load(std::memory_order_relaxed);
+  stats.underruns = underruns_.load(std::memory_order_relaxed);
+  stats.concealedMs =
+      concealedSamples_.load(std::memory_order_relaxed) * msPerSample;
+  stats.droppedMs =
+      droppedSamples_.load(std::memory_order_relaxed) * msPerSample;
+  stats.insertedMs =
+      insertedSamples_.load(std::memory_order_relaxed) * msPerSample;
+  return stats;
+}
+
+} // namespace poise
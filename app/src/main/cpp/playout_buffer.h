@@ -0,0 +1,126 @@
+/**
+ * Adaptive Playout Buffer - Header
+ *
+ * Sits between processing and playback. The processing thread pushes
+ * processed audio and the playback thread pulls fixed-size blocks. The
+ * target depth follows the observed arrival jitter of pushed blocks, sized
+ * so that the chance of an underrun stays below a configured probability.
+ * Excess depth is trimmed, and missing depth is stretched, only during
+ * silence. Underruns are filled with faded repeats of the last output.
+ *
+ * Single producer / single consumer; neither side takes a lock.
+ */
+
+#ifndef PLAYOUT_BUFFER_H
+#define PLAYOUT_BUFFER_H
+
+#include "memory_accounting.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace poise {
+
+struct PlayoutConfig {
+  float underrunProbability = 0.01f; // Target per pushed block
+  float minDepthMs = 4.0f;
+  float maxDepthMs = 200.0f;
+  int historyBlocks = 256;    // Arrival jitter window
+  float silenceDb = -50.0f;   // RMS below which depth may be adjusted
+  float maxAdjustRatio = 0.5f; // Max fraction of a pull dropped/inserted
+};
+
+struct PlayoutStats {
+  float depthMs = 0.0f;
+  float targetMs = 0.0f;
+  float jitterMs = 0.0f;     // Arrival-lateness quantile behind the target
+  float avgLatencyMs = 0.0f; // Mean depth seen by pulls
+  int underruns = 0;
+  float concealedMs = 0.0f;
+  float droppedMs = 0.0f;  // Removed by time-scale modification
+  float insertedMs = 0.0f; // Added by time-scale modification
+};
+
+class PlayoutBuffer {
+public:
+  PlayoutBuffer(int sampleRate, PlayoutConfig config = {});
+
+  // Producer: queue processed samples (drops what does not fit)
+  void push(const float *samples, int count);
+
+  /**
+   * Producer: the next push starts a new arrival baseline, e.g. after the
+   * producer paused. Gaps longer than maxDepthMs do this on their own.
+   */
+  void resync();
+
+  /**
+   * Consumer: always writes exactly count samples.
+   * @return Samples that came from real audio (the rest is concealment or
+   *         prebuffering silence)
+   */
+  int pull(float *out, int count);
+
+  PlayoutStats getStats() const;
+
+  // Only while neither side is running
+  void reset();
+
+private:
+  int available() const;
+  void readSamples(float *out, int count);
+  float peekRms(int count) const;
+  void updateTarget();
+  void resyncArrivals(int64_t now);
+  void conceal(float *out, int from, int count);
+  void chargeMemory();
+
+  int sampleRate_;
+  PlayoutConfig config_;
+
+  // Sample ring
+  std::vector<float> ring_;
+  uint32_t mask_;
+  std::atomic<uint64_t> writeIndex_{0};
+  std::atomic<uint64_t> readIndex_{0};
+
+  // Producer-side jitter tracking
+  int64_t firstArrivalNs_;
+  int64_t lastArrivalNs_;
+  int64_t resyncGapNs_;
+  bool resyncPending_;
+  uint64_t pushedSamples_;
+  std::vector<float> offsetsMs_; // Arrival time minus media time
+  std::vector<float> lateness_;  // Quantile scratch, same size
+  int historyPos_;
+  int historyCount_;
+  int pushesSinceUpdate_;
+  std::atomic<int> targetSamples_;
+  std::atomic<float> jitterMs_{0.0f};
+  std::atomic<int> pushBlock_{0};
+
+  // Consumer state
+  bool prebuffering_;
+  int concealRun_;
+  int windowMinDepth_;
+  int windowPullCount_;
+  int lastWindowMin_;
+  bool adjustPending_;
+  std::vector<float> lastBlock_;
+  std::vector<float> scratch_;
+  MemoryCharge memory_{MemoryComponent::PLAYOUT};
+  float silenceLinear_;
+  double depthSumMs_;
+  uint64_t pulls_;
+
+  std::atomic<int> underruns_{0};
+  std::atomic<int64_t> concealedSamples_{0};
+  std::atomic<int64_t> droppedSamples_{0};
+  std::atomic<int64_t> insertedSamples_{0};
+  std::atomic<int64_t> overflowSamples_{0};
+  std::atomic<float> avgLatencyMs_{0.0f};
+};
+
+} // namespace poise
+
+#endif // PLAYOUT_BUFFER_H
@@ -0,0 +1,807 @@
+/**
+ * Poise C API - Implementation
+ *
+ * Thin C shims over EnhancerStream, PoiseProcessor, CascadeResampler and
+ * DaemonClient. Each stream and processor has its own lock so stats and parameters can be read from other
+ * threads; the frame path takes it uncontended.
+ */
+
+#include "poise_api.h"
+#include "admission_control.h"
+#include "daemon_client.h"
+#include "enhancer_stream.h"
+#include "metrics_exporter.h"
+#include "poise_processor.h"
+#include "resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+static_assert(POISE_SAMPLE_RATE == poise::EnhancerStream::SAMPLE_RATE,
+              "POISE_SAMPLE_RATE");
+static_assert(POISE_FRAME_SAMPLES == poise::EnhancerStream::FRAME_SAMPLES,
+              "POISE_FRAME_SAMPLES");
+static_assert(POISE_NUM_BINS == poise::EnhancerStream::NUM_BINS,
+              "POISE_NUM_BINS");
+
+struct poise_stream {
+  mutable std::mutex mutex;
+  poise::EnhancerStream core;
+  poise_infer_fn infer = nullptr;
+  void *userData = nullptr;
+};
+
+struct poise_processor {
+  poise_processor(float vadThresholdDb, float attenLimDb)
+      : core(vadThresholdDb, attenLimDb) {}
+
+  mutable std::mutex mutex;
+  poise::PoiseProcessor core;
+  // Verdict of the last finished frame, for check_state
+  poise::PoiseProcessor::StateCheck check =
+      poise::PoiseProcessor::StateCheck::NONE;
+  // Declared after core: they charge its metrics slot, so go first
+  std::unique_ptr<poise::StreamingResampler> capture;
+  std::unique_ptr<poise::StreamingResampler> playback;
+};
+
+struct poise_resampler {
+  explicit poise_resampler(int inputRate, int outputRate,
+                           poise::ResampleQuality quality)
+      : core(inputRate, outputRate, quality) {}
+
+  poise::CascadeResampler core;
+};
+
+struct poise_daemon_stream {
+  poise::DaemonClient client;
+  std::unique_ptr<poise::DaemonStream> stream;
+};
+
+namespace {
+
+// Read a caller struct that may be older (smaller) than ours
+template <typename T> bool copyIn(const T *in, T &out) {
+  if (in->struct_size < sizeof(uint32_t)) {
+    return false;
+  }
+  std::memcpy(&out, in, std::min<size_t>(in->struct_size, sizeof(T)));
+  out.struct_size = sizeof(T);
+  return true;
+}
+
+// Write only the part of the struct the caller knows about
+template <typename T> poise_status copyOut(T &full, T *out) {
+  if (out == nullptr || out->struct_size < sizeof(uint32_t)) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  size_t size = std::min<size_t>(out->struct_size, sizeof(T));
+  full.struct_size = static_cast<uint32_t>(size);
+  std::memcpy(out, &full, size);
+  return POISE_OK;
+}
+
+poise_status toStatus(poise::FrameResult result) {
+  switch (result) {
+  case poise::FrameResult::INFERRED:
+    return POISE_OK;
+  case poise::FrameResult::GATED:
+    return POISE_GATED;
+  case poise::FrameResult::NON_FINITE:
+    return POISE_ERROR_NON_FINITE;
+  case poise::FrameResult::INFERENCE_FAILED:
+    break;
+  }
+  return POISE_ERROR_INFERENCE_FAILED;
+}
+
+uint64_t load(const std::atomic<uint64_t> &counter) {
+  return counter.load(std::memory_order_relaxed);
+}
+
+// Caller holds the processor lock
+poise_status setRate(poise_processor *processor,
+                     std::unique_ptr<poise::StreamingResampler> &resampler,
+                     int inputRate, int outputRate) {
+  if (inputRate <= 0 || outputRate <= 0) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  resampler.reset();
+  if (inputRate != outputRate) {
+    resampler.reset(new (std::nothrow)
+                        poise::StreamingResampler(inputRate, outputRate));
+    if (!resampler) {
+      return POISE_ERROR_OUT_OF_MEMORY;
+    }
+    resampler->attachMemory(processor->core.metrics());
+  }
+  return POISE_OK;
+}
+
+int playbackSamples(const poise_processor *processor) {
+  if (!processor->playback) {
+    return POISE_LEGACY_FRAME_SAMPLES;
+  }
+  return static_cast<int>(static_cast<int64_t>(POISE_LEGACY_FRAME_SAMPLES) *
+                          processor->playback->getOutputSampleRate() /
+                          processor->playback->getInputSampleRate());
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+uint32_t poise_api_version(void) { return POISE_API_VERSION; }
+
+// ============================================================================
+// Streams
+// ============================================================================
+
+void poise_stream_config_init(poise_stream_config *config) {
+  if (config != nullptr) {
+    *config = poise_stream_config();
+    config->struct_size = sizeof(poise_stream_config);
+  }
+}
+
+poise_status poise_stream_create(const poise_stream_config *config,
+                                 poise_stream **stream) {
+  if (stream == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  *stream = nullptr;
+  poise_stream_config settings;
+  poise_stream_config_init(&settings);
+  if (config != nullptr && !copyIn(config, settings)) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  if (!poise::AdmissionController::instance().acquire("gtcrn")) {
+    return POISE_ERROR_REJECTED;
+  }
+
+  poise_stream *created = new (std::nothrow) poise_stream();
+  if (created == nullptr) {
+    poise::AdmissionController::instance().release("gtcrn");
+    return POISE_ERROR_OUT_OF_MEMORY;
+  }
+  created->infer = settings.infer;
+  created->userData = settings.user_data;
+  *stream = created;
+  return POISE_OK;
+}
+
+void poise_stream_destroy(poise_stream *stream) { delete stream; }
+
+poise_status poise_stream_process(poise_stream *stream, const float *input,
+                                  float *output) {
+  if (stream == nullptr || input == nullptr || output == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  return toStatus(stream->core.process(input, output, stream->infer,
+                                       stream->userData));
+}
+
+poise_status poise_stream_process_batch(poise_stream *const *streams,
+                                        int count, const float *const *inputs,
+                                        float *const *outputs,
+                                        poise_status *results) {
+  static_assert(POISE_MAX_BATCH == poise::EnhancerStream::MAX_BATCH,
+                "POISE_MAX_BATCH");
+  if (streams == nullptr || inputs == nullptr || outputs == nullptr ||
+      results == nullptr || count < 1 || count > POISE_MAX_BATCH) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  for (int i = 0; i < count; i++) {
+    if (streams[i] == nullptr || inputs[i] == nullptr ||
+        outputs[i] == nullptr) {
+      return POISE_ERROR_INVALID_ARGUMENT;
+    }
+  }
+
+  // Lock in address order so overlapping batches on two threads cannot
+  // deadlock; a stream listed twice would deadlock on itself
+  poise_stream *order[POISE_MAX_BATCH];
+  std::copy(streams, streams + count, order);
+  std::sort(order, order + count);
+  if (std::adjacent_find(order, order + count) != order + count) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  for (int i = 0; i < count; i++) {
+    order[i]->mutex.lock();
+  }
+
+  poise::EnhancerStream *cores[POISE_MAX_BATCH];
+  poise::SpectrumInference infer[POISE_MAX_BATCH];
+  void *userData[POISE_MAX_BATCH];
+  poise::FrameResult frames[POISE_MAX_BATCH];
+  for (int i = 0; i < count; i++) {
+    cores[i] = &streams[i]->core;
+    infer[i] = streams[i]->infer;
+    userData[i] = streams[i]->userData;
+  }
+  poise::EnhancerStream::processBatch(cores, inputs, outputs, count, infer,
+                                      userData, frames);
+
+  for (int i = count - 1; i >= 0; i--) {
+    order[i]->mutex.unlock();
+  }
+  for (int i = 0; i < count; i++) {
+    results[i] = toStatus(frames[i]);
+  }
+  return POISE_OK;
+}
+
+poise_status poise_stream_analyze(poise_stream *stream, const float *input,
+                                  float *real, float *imag) {
+  if (stream == nullptr || input == nullptr || real == nullptr ||
+      imag == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  stream->core.analyze(input, real, imag);
+  return stream->core.gateOpen() ? POISE_OK : POISE_GATED;
+}
+
+poise_status poise_stream_synthesize(poise_stream *stream, const float *real,
+                                     const float *imag, float *output) {
+  if (stream == nullptr || real == nullptr || imag == nullptr ||
+      output == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  return stream->core.synthesize(real, imag, output) ? POISE_OK
+                                                     : POISE_ERROR_NON_FINITE;
+}
+
+poise_status poise_stream_synthesize_bypass(poise_stream *stream,
+                                            float *output) {
+  if (stream == nullptr || output == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  stream->core.synthesizeBypass(output);
+  return POISE_OK;
+}
+
+int poise_stream_gate_open(const poise_stream *stream) {
+  if (stream == nullptr) {
+    return 1;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  return stream->core.gateOpen() ? 1 : 0;
+}
+
+void poise_stream_reset(poise_stream *stream) {
+  if (stream != nullptr) {
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    stream->core.reset();
+  }
+}
+
+poise_status poise_stream_load_neural_vad(poise_stream *stream,
+                                          const float *weights, int count) {
+  if (stream == nullptr || weights == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  return stream->core.loadNeuralVad(weights, count)
+             ? POISE_OK
+             : POISE_ERROR_INVALID_ARGUMENT;
+}
+
+void poise_stream_count_skipped(poise_stream *stream, int frames) {
+  if (stream == nullptr || frames <= 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  stream->core.countSkipped(static_cast<uint64_t>(frames));
+}
+
+void poise_stream_report_underrun(poise_stream *stream) {
+  // Atomic in the flight recorder; no need to wait for the frame lock
+  if (stream != nullptr) {
+    stream->core.reportUnderrun();
+  }
+}
+
+poise_status poise_stream_check_state(poise_stream *stream, float *state,
+                                      size_t count) {
+  if (stream == nullptr || state == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  return stream->core.checkState(state, count) ? POISE_ERROR_NON_FINITE
+                                               : POISE_OK;
+}
+
+poise_status poise_stream_park_state(poise_stream *stream, const float *state,
+                                     size_t count) {
+  if (stream == nullptr || state == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  stream->core.parkState(state, count);
+  return POISE_OK;
+}
+
+poise_status poise_stream_restore_state(poise_stream *stream, float *state,
+                                        size_t count) {
+  if (stream == nullptr || state == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  return stream->core.restoreState(state, count)
+             ? POISE_OK
+             : POISE_ERROR_INVALID_ARGUMENT;
+}
+
+poise_status poise_stream_set_param(poise_stream *stream, poise_param param,
+                                    float value) {
+  if (stream == nullptr || !std::isfinite(value)) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  poise::EnhancerStream &core = stream->core;
+  switch (param) {
+  case POISE_PARAM_BYPASS_GAIN_DB:
+    core.setBypassGainDb(value);
+    return POISE_OK;
+  case POISE_PARAM_VAD_ON_THRESHOLD:
+    core.setVadThresholds(value, core.vadOffThreshold(), core.vadHangFrames());
+    return POISE_OK;
+  case POISE_PARAM_VAD_OFF_THRESHOLD:
+    core.setVadThresholds(core.vadOnThreshold(), value, core.vadHangFrames());
+    return POISE_OK;
+  case POISE_PARAM_VAD_HANG_FRAMES:
+    core.setVadThresholds(core.vadOnThreshold(), core.vadOffThreshold(),
+                          static_cast<int>(value));
+    return POISE_OK;
+  case POISE_PARAM_DEADLINE_MS:
+    if (value <= 0.0f) {
+      break;
+    }
+    core.setDeadlineMs(value);
+    return POISE_OK;
+  }
+  return POISE_ERROR_INVALID_ARGUMENT;
+}
+
+poise_status poise_stream_get_param(const poise_stream *stream,
+                                    poise_param param, float *value) {
+  if (stream == nullptr || value == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(stream->mutex);
+  const poise::EnhancerStream &core = stream->core;
+  switch (param) {
+  case POISE_PARAM_BYPASS_GAIN_DB:
+    *value = core.bypassGainDb();
+    return POISE_OK;
+  case POISE_PARAM_VAD_ON_THRESHOLD:
+    *value = core.vadOnThreshold();
+    return POISE_OK;
+  case POISE_PARAM_VAD_OFF_THRESHOLD:
+    *value = core.vadOffThreshold();
+    return POISE_OK;
+  case POISE_PARAM_VAD_HANG_FRAMES:
+    *value = static_cast<float>(core.vadHangFrames());
+    return POISE_OK;
+  case POISE_PARAM_DEADLINE_MS:
+    *value = core.deadlineMs();
+    return POISE_OK;
+  }
+  return POISE_ERROR_INVALID_ARGUMENT;
+}
+
+poise_status poise_stream_get_stats(const poise_stream *stream,
+                                    poise_stream_stats *stats) {
+  if (stream == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  poise_stream_stats full = poise_stream_stats();
+  poise::EnhancementStats enhancement;
+  {
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    full.stream_id = stream->core.streamId();
+    enhancement = stream->core.enhancementStats();
+  }
+  full.noise_reduction_db = enhancement.noiseReductionDb;
+  full.speech_retention_db = enhancement.speechRetentionDb;
+  full.low_benefit_ratio = enhancement.lowBenefitRatio;
+
+  // The metrics slot is lock-free and lives as long as the stream
+  const poise::StreamMetrics *m = stream->core.metrics();
+  if (m != nullptr) {
+    full.frames = load(m->framesTotal);
+    full.frames_inferred = load(m->framesInferred);
+    full.frames_gated = load(m->neuralVadBypassed);
+    full.frames_low_benefit = load(m->framesLowBenefit);
+    full.deadline_misses = load(m->deadlineMisses);
+    full.underruns = load(m->underruns);
+    full.non_finite_events = load(m->nonFiniteEvents);
+    full.state_resets = load(m->stateResets);
+    full.inference_ms_total = m->inferenceLatency.sumMs();
+    full.memory_bytes = m->memoryTotalBytes.load(std::memory_order_relaxed);
+    full.memory_peak_bytes =
+        m->memoryPeakTotalBytes.load(std::memory_order_relaxed);
+  }
+  return copyOut(full, stats);
+}
+
+// ============================================================================
+// Legacy processor
+// ============================================================================
+
+void poise_processor_config_init(poise_processor_config *config) {
+  if (config != nullptr) {
+    *config = poise_processor_config();
+    config->struct_size = sizeof(poise_processor_config);
+    config->vad_threshold_db = -40.0f;
+    config->atten_lim_db = -60.0f;
+  }
+}
+
+poise_status poise_processor_create(const poise_processor_config *config,
+                                    poise_processor **processor) {
+  if (processor == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  *processor = nullptr;
+  poise_processor_config settings;
+  poise_processor_config_init(&settings);
+  if (config != nullptr && !copyIn(config, settings)) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  if (!std::isfinite(settings.vad_threshold_db) ||
+      !std::isfinite(settings.atten_lim_db)) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  if (!poise::AdmissionController::instance().acquire("legacy")) {
+    return POISE_ERROR_REJECTED;
+  }
+
+  poise_processor *created = new (std::nothrow)
+      poise_processor(settings.vad_threshold_db, settings.atten_lim_db);
+  if (created == nullptr) {
+    poise::AdmissionController::instance().release("legacy");
+    return POISE_ERROR_OUT_OF_MEMORY;
+  }
+  *processor = created;
+  return POISE_OK;
+}
+
+void poise_processor_destroy(poise_processor *processor) { delete processor; }
+
+poise_status poise_processor_set_capture_rate(poise_processor *processor,
+                                              int rate) {
+  if (processor == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  return setRate(processor, processor->capture, rate,
+                 POISE_LEGACY_SAMPLE_RATE);
+}
+
+poise_status poise_processor_set_playback_rate(poise_processor *processor,
+                                               int rate) {
+  if (processor == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  return setRate(processor, processor->playback, POISE_LEGACY_SAMPLE_RATE,
+                 rate);
+}
+
+int poise_processor_max_output(const poise_processor *processor) {
+  if (processor == nullptr) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  return playbackSamples(processor);
+}
+
+poise_status poise_processor_begin_frame(poise_processor *processor,
+                                         float *input, int count,
+                                         float *frame) {
+  if (processor == nullptr || input == nullptr || frame == nullptr ||
+      count < 0) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  processor->core.scrubInput(input, count);
+
+  const float *samples = input;
+  int available = count;
+  std::vector<float> resampled;
+  if (processor->capture) {
+    resampled = processor->capture->process(
+        std::vector<float>(input, input + count), POISE_LEGACY_FRAME_SAMPLES);
+    if (resampled.empty()) {
+      return POISE_ERROR_AGAIN;
+    }
+    samples = resampled.data();
+    available = static_cast<int>(resampled.size());
+  }
+
+  // Exactly one model frame: truncate or zero-pad
+  int keep = std::min(available, POISE_LEGACY_FRAME_SAMPLES);
+  std::copy(samples, samples + keep, frame);
+  std::fill(frame + keep, frame + POISE_LEGACY_FRAME_SAMPLES, 0.0f);
+  processor->core.beginFrame();
+  return POISE_OK;
+}
+
+poise_status poise_processor_check_vad(poise_processor *processor,
+                                       const float *frame) {
+  if (processor == nullptr || frame == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  return processor->core.checkVad(frame, POISE_LEGACY_FRAME_SAMPLES)
+             ? POISE_OK
+             : POISE_GATED;
+}
+
+poise_status poise_processor_finish_frame(poise_processor *processor,
+                                          float *audio, float *output,
+                                          int capacity, int *written) {
+  if (processor == nullptr || audio == nullptr || output == nullptr ||
+      written == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  *written = 0;
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  if (capacity < playbackSamples(processor)) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+
+  processor->check =
+      processor->core.finishFrame(audio, POISE_LEGACY_FRAME_SAMPLES);
+  if (processor->playback) {
+    std::vector<float> resampled = processor->playback->process(
+        std::vector<float>(audio, audio + POISE_LEGACY_FRAME_SAMPLES),
+        playbackSamples(processor));
+    std::copy(resampled.begin(), resampled.end(), output);
+    *written = static_cast<int>(resampled.size());
+  } else {
+    std::copy(audio, audio + POISE_LEGACY_FRAME_SAMPLES, output);
+    *written = POISE_LEGACY_FRAME_SAMPLES;
+  }
+  return processor->check == poise::PoiseProcessor::StateCheck::RESET
+             ? POISE_ERROR_NON_FINITE
+             : POISE_OK;
+}
+
+int poise_processor_state_due(const poise_processor *processor) {
+  if (processor == nullptr) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  return processor->check != poise::PoiseProcessor::StateCheck::NONE ? 1 : 0;
+}
+
+poise_status poise_processor_check_state(poise_processor *processor,
+                                         float *state, size_t count) {
+  if (processor == nullptr || state == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  bool reset = processor->core.checkStates(processor->check, state, count);
+  processor->check = poise::PoiseProcessor::StateCheck::NONE;
+  return reset ? POISE_ERROR_NON_FINITE : POISE_OK;
+}
+
+poise_status poise_processor_park_state(poise_processor *processor,
+                                        const float *state, size_t count) {
+  if (processor == nullptr || state == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  processor->core.parkState(state, count);
+  return POISE_OK;
+}
+
+poise_status poise_processor_restore_state(poise_processor *processor,
+                                           float *state, size_t count) {
+  if (processor == nullptr || state == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  return processor->core.restoreState(state, count)
+             ? POISE_OK
+             : POISE_ERROR_INVALID_ARGUMENT;
+}
+
+void poise_processor_reset(poise_processor *processor) {
+  if (processor == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(processor->mutex);
+  processor->core.reset();
+  processor->check = poise::PoiseProcessor::StateCheck::NONE;
+  if (processor->capture) {
+    processor->capture->reset();
+  }
+  if (processor->playback) {
+    processor->playback->reset();
+  }
+}
+
+void poise_processor_report_underrun(poise_processor *processor) {
+  // Atomic in the flight recorder; no need to wait for the frame lock
+  if (processor != nullptr) {
+    processor->core.reportUnderrun();
+  }
+}
+
+poise_status poise_processor_get_stats(const poise_processor *processor,
+                                       poise_processor_stats *stats) {
+  if (processor == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  poise::ProcessingStats core;
+  {
+    std::lock_guard<std::mutex> lock(processor->mutex);
+    core = processor->core.getStats();
+  }
+  poise_processor_stats full = poise_processor_stats();
+  full.frames_inferred = static_cast<uint64_t>(core.frameCount);
+  full.inference_ms_avg = core.avgTimeMs;
+  full.rtf = core.rtf;
+  full.vad_frames = static_cast<uint64_t>(core.vadTotal);
+  full.vad_speech = static_cast<uint64_t>(core.vadActive);
+  full.vad_bypassed = static_cast<uint64_t>(core.vadBypassed);
+  full.vad_bypass_ratio = core.vadBypassRatio;
+  full.vad_active = core.vadDetected ? 1 : 0;
+  full.state_parked = core.stateParked ? 1 : 0;
+  full.cold_pool_saved_bytes = core.coldPoolSaved;
+  full.non_finite_events = static_cast<uint64_t>(core.nonFiniteEvents);
+  full.state_resets = static_cast<uint64_t>(core.stateResets);
+
+  // The metrics slot is lock-free and lives as long as the processor
+  const poise::StreamMetrics *m = processor->core.metrics();
+  if (m != nullptr) {
+    full.memory_bytes = m->memoryTotalBytes.load(std::memory_order_relaxed);
+    full.memory_peak_bytes =
+        m->memoryPeakTotalBytes.load(std::memory_order_relaxed);
+  }
+  return copyOut(full, stats);
+}
+
+// ============================================================================
+// Resampling
+// ============================================================================
+
+poise_resampler *poise_resampler_create(int input_rate, int output_rate,
+                                        poise_resample_quality quality) {
+  if (input_rate <= 0 || output_rate <= 0 || quality < 0 ||
+      quality >= static_cast<int>(poise::ResampleQuality::NUM_QUALITIES)) {
+    return nullptr;
+  }
+  return new (std::nothrow) poise_resampler(
+      input_rate, output_rate, static_cast<poise::ResampleQuality>(quality));
+}
+
+void poise_resampler_destroy(poise_resampler *resampler) { delete resampler; }
+
+int poise_resampler_max_output(const poise_resampler *resampler, int count) {
+  return resampler != nullptr && count >= 0
+             ? resampler->core.maxOutput(count)
+             : 0;
+}
+
+int poise_resampler_process(poise_resampler *resampler, const float *input,
+                            int count, float *output, int capacity) {
+  if (resampler == nullptr || input == nullptr || output == nullptr ||
+      count < 0 || capacity < 0) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  return resampler->core.process(input, count, output, capacity);
+}
+
+void poise_resampler_reset(poise_resampler *resampler) {
+  if (resampler != nullptr) {
+    resampler->core.reset();
+  }
+}
+
+poise_status poise_resampler_get_info(const poise_resampler *resampler,
+                                      poise_resampler_info *info) {
+  if (resampler == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  const poise::ResamplePlan &plan = resampler->core.plan();
+  poise_resampler_info full = poise_resampler_info();
+  full.macs_per_output = plan.macsPerOutput;
+  full.direct_macs_per_output = plan.directMacsPerOutput;
+  full.delay_samples = plan.delaySamples;
+  full.stages = static_cast<int>(plan.stages.size());
+  return copyOut(full, info);
+}
+
+size_t poise_resampler_describe(const poise_resampler *resampler,
+                                char *buffer, size_t capacity) {
+  std::string text =
+      resampler != nullptr ? resampler->core.plan().describe() : "";
+  if (capacity > 0) {
+    size_t n = std::min(text.size(), capacity - 1);
+    std::memcpy(buffer, text.data(), n);
+    buffer[n] = '\0';
+  }
+  return text.size();
+}
+
+// ============================================================================
+// Daemon client
+// ============================================================================
+
+poise_status poise_daemon_stream_open(const char *socket_path, int latency_ms,
+                                      poise_daemon_stream **stream) {
+  if (socket_path == nullptr || stream == nullptr || latency_ms < 0) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  *stream = nullptr;
+  std::unique_ptr<poise_daemon_stream> created(new (std::nothrow)
+                                                   poise_daemon_stream());
+  if (!created || !created->client.connect(socket_path)) {
+    return POISE_ERROR_UNAVAILABLE;
+  }
+  created->stream =
+      created->client.openStream(POISE_SAMPLE_RATE, 0, latency_ms);
+  if (!created->stream ||
+      created->stream->frameSamples() != POISE_FRAME_SAMPLES) {
+    return POISE_ERROR_UNAVAILABLE;
+  }
+  *stream = created.release();
+  return POISE_OK;
+}
+
+void poise_daemon_stream_close(poise_daemon_stream *stream) {
+  if (stream == nullptr) {
+    return;
+  }
+  if (stream->stream) {
+    stream->client.closeStream(*stream->stream);
+  }
+  delete stream;
+}
+
+poise_status poise_daemon_stream_write(poise_daemon_stream *stream,
+                                       const float *frame,
+                                       uint64_t capture_ns) {
+  if (stream == nullptr || frame == nullptr) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  return stream->stream->write(frame, capture_ns) ? POISE_OK
+                                                  : POISE_ERROR_AGAIN;
+}
+
+poise_status poise_daemon_stream_read(poise_daemon_stream *stream,
+                                      float *frame, int timeout_ms) {
+  if (stream == nullptr || frame == nullptr || timeout_ms < 0) {
+    return POISE_ERROR_INVALID_ARGUMENT;
+  }
+  return stream->stream->read(frame, timeout_ms) ? POISE_OK
+                                                 : POISE_ERROR_AGAIN;
+}
+
+// ============================================================================
+// Process-wide
+// ============================================================================
+
+size_t poise_metrics_render(char *buffer, size_t capacity) {
+  return poise::MetricsExporter::render(buffer, capacity);
+}
+
+void poise_set_flight_recorder_dir(const char *directory) {
+  if (directory != nullptr) {
+    poise::FlightRecorder::setDumpDirectory(directory);
+  }
+}
+
+} // extern "C"
@@ -0,0 +1,509 @@
+/**
+ * Poise C API - Header
+ *
+ * Stable, versioned C ABI over the native core, for hosts that embed it
+ * directly (e.g. native media servers) instead of going through the JVM.
+ * The JNI bridge is a thin wrapper over the same functions.
+ *
+ * A stream enhances 16 kHz mono audio in 256-sample frames (16 ms). The
+ * model is supplied by the host in one of two ways:
+ *
+ *   - poise_stream_process() with a poise_infer_fn callback, which gets the
+ *     stream's own spectrum and enhances it in place (no copies);
+ *   - split phase: poise_stream_analyze(), the host's model on the bins,
+ *     then poise_stream_synthesize() (or poise_stream_synthesize_bypass()
+ *     when the neural VAD gate is closed).
+ *
+ * Hosts running the legacy 48 kHz model use poise_processor, which
+ * supplies the same pre- and post-processing around it.
+ *
+ * All audio and spectrum buffers are caller-owned; nothing allocates on the
+ * per-frame path, except a poise_processor's own rate conversion. Other
+ * rates can be converted with poise_resampler.
+ *
+ * Threading: a stream, processor or resampler may be used from one thread
+ * at a time. The get_stats, get_param and report_underrun functions may be
+ * called from any thread while it is in use, but not concurrently with its
+ * destroy.
+ *
+ * ABI rules: functions and enum values are only ever added. Structs carry
+ * struct_size, set by the caller to sizeof() of the struct it was compiled
+ * against; the library reads and writes only that much, so hosts built
+ * against an older header keep working. A host can check the library it
+ * loaded with poise_api_version().
+ *
+ * Linking: libpoise_native exports only these functions (and the JNI entry
+ * points); `cmake --install` puts it under lib/ and this header under
+ * include/. Hosts without a JVM can link the poise_core object library
+ * instead, which builds on any platform.
+ */
+
+#ifndef POISE_API_H
+#define POISE_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define POISE_API_VERSION_MAJOR 1
+#define POISE_API_VERSION_MINOR 3
+#define POISE_API_VERSION                                                      \
+  ((POISE_API_VERSION_MAJOR << 16) | POISE_API_VERSION_MINOR)
+
+#define POISE_API __attribute__((visibility("default")))
+
+#define POISE_SAMPLE_RATE 16000
+#define POISE_FRAME_SAMPLES 256
+#define POISE_NUM_BINS 257
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum poise_status {
+  POISE_OK = 0,
+  POISE_GATED = 1,                  /* Neural VAD skipped inference */
+  POISE_ERROR_INVALID_ARGUMENT = -1,
+  POISE_ERROR_REJECTED = -2,        /* Admission control: over CPU budget */
+  POISE_ERROR_NON_FINITE = -3,      /* Model output NaN/Inf, see below */
+  POISE_ERROR_INFERENCE_FAILED = -4, /* Callback failed; input passed through */
+  POISE_ERROR_UNAVAILABLE = -5,      /* Daemon unreachable or refused */
+  POISE_ERROR_AGAIN = -6,            /* Daemon ring full / no frame yet */
+  POISE_ERROR_OUT_OF_MEMORY = -7     /* Allocation failed; nothing created */
+} poise_status;
+
+/** Version of the loaded library, as POISE_API_VERSION. */
+POISE_API uint32_t poise_api_version(void);
+
+/* ========================================================================
+ * Streams
+ * ======================================================================== */
+
+typedef struct poise_stream poise_stream;
+
+/**
+ * Runs the model on one frame. real and imag (num_bins values each) belong
+ * to the stream and are enhanced in place; they are valid for the call
+ * only. Return 0 on success; anything else passes the frame through.
+ */
+typedef int (*poise_infer_fn)(void *user_data, float *real, float *imag,
+                              int num_bins);
+
+typedef struct poise_stream_config {
+  uint32_t struct_size;
+  poise_infer_fn infer; /* For poise_stream_process(); may be NULL */
+  void *user_data;      /* Passed to infer */
+} poise_stream_config;
+
+/** Fill a config with defaults (and struct_size). */
+POISE_API void poise_stream_config_init(poise_stream_config *config);
+
+/**
+ * Create a stream. config may be NULL (split phase only).
+ * @return POISE_ERROR_REJECTED when admission control turns it away,
+ *         POISE_ERROR_OUT_OF_MEMORY if the stream could not be allocated
+ */
+POISE_API poise_status poise_stream_create(const poise_stream_config *config,
+                                           poise_stream **stream);
+
+POISE_API void poise_stream_destroy(poise_stream *stream);
+
+/**
+ * Enhance POISE_FRAME_SAMPLES of input into output (may alias) through the
+ * config's infer callback.
+ * @return POISE_OK, POISE_GATED (attenuated input), or
+ *         POISE_ERROR_NON_FINITE: output is silence and synthesis was
+ *         reset, so the host must reset its model state as well
+ */
+POISE_API poise_status poise_stream_process(poise_stream *stream,
+                                            const float *input, float *output);
+
+/** Most streams poise_stream_process_batch() takes per call. */
+#define POISE_MAX_BATCH 16
+
+/**
+ * poise_stream_process() for several streams at once, for hosts serving
+ * many streams from one thread: analysis and synthesis run across the
+ * streams in SIMD lanes, each stream's infer callback on its own bins. The
+ * streams may not be in use on another thread meanwhile.
+ * @param streams count distinct streams, 1 <= count <= POISE_MAX_BATCH
+ * @param results Per stream, what poise_stream_process() would return
+ * @return POISE_OK, or POISE_ERROR_INVALID_ARGUMENT (nothing processed)
+ */
+POISE_API poise_status poise_stream_process_batch(poise_stream *const *streams,
+                                                  int count,
+                                                  const float *const *inputs,
+                                                  float *const *outputs,
+                                                  poise_status *results);
+
+/**
+ * Split phase, step 1: analyze POISE_FRAME_SAMPLES of input into
+ * POISE_NUM_BINS real and imaginary values.
+ * @return POISE_OK to run the model, POISE_GATED to skip it and call
+ *         poise_stream_synthesize_bypass()
+ */
+POISE_API poise_status poise_stream_analyze(poise_stream *stream,
+                                            const float *input, float *real,
+                                            float *imag);
+
+/**
+ * Split phase, step 2: synthesize the enhanced spectrum into
+ * POISE_FRAME_SAMPLES of output.
+ * @return POISE_OK or POISE_ERROR_NON_FINITE (as for process)
+ */
+POISE_API poise_status poise_stream_synthesize(poise_stream *stream,
+                                               const float *real,
+                                               const float *imag,
+                                               float *output);
+
+/** Synthesize the last analyzed frame without inference, attenuated. */
+POISE_API poise_status poise_stream_synthesize_bypass(poise_stream *stream,
+                                                      float *output);
+
+/** Nonzero while the model should run on the last analyzed frame. */
+POISE_API int poise_stream_gate_open(const poise_stream *stream);
+
+/**
+ * Clear analysis, synthesis and gate state for a new signal, and drop any
+ * parked model state.
+ */
+POISE_API void poise_stream_reset(poise_stream *stream);
+
+/**
+ * Load neural VAD gate weights (flat float32, NeuralVad layout). The gate
+ * then skips inference on frames without speech.
+ */
+POISE_API poise_status poise_stream_load_neural_vad(poise_stream *stream,
+                                                    const float *weights,
+                                                    int count);
+
+/**
+ * Count frames the host skipped without analysis (its own silence gate), so
+ * the stream's cost estimate and bypass ratio include them.
+ */
+POISE_API void poise_stream_count_skipped(poise_stream *stream, int frames);
+
+/** Flag an output underrun for the flight recorder. */
+POISE_API void poise_stream_report_underrun(poise_stream *stream);
+
+/**
+ * Health check for recurrent model state the host keeps between frames;
+ * call it every ~0.5 s of inferred frames, per state tensor. State holding
+ * NaN/Inf or diverged values is zeroed in place and counted in the stats.
+ * @return POISE_OK, or POISE_ERROR_NON_FINITE if the state was reset (the
+ *         host should reset the rest of its model state too)
+ */
+POISE_API poise_status poise_stream_check_state(poise_stream *stream,
+                                                float *state, size_t count);
+
+/**
+ * Park the host's model state while the stream is idle: it is compressed
+ * (FP16 + lossless packing) into a process-wide pool and the host may free
+ * its copy. Parking again replaces the parked state.
+ */
+POISE_API poise_status poise_stream_park_state(poise_stream *stream,
+                                               const float *state,
+                                               size_t count);
+
+/**
+ * Take parked model state back into count floats.
+ * @return POISE_OK, or POISE_ERROR_INVALID_ARGUMENT if no state of that
+ *         size was parked (state is then zeroed)
+ */
+POISE_API poise_status poise_stream_restore_state(poise_stream *stream,
+                                                  float *state, size_t count);
+
+typedef enum poise_param {
+  POISE_PARAM_BYPASS_GAIN_DB = 1,    /* Gated frames, default -24 */
+  POISE_PARAM_VAD_ON_THRESHOLD = 2,  /* Speech probability, default 0.6 */
+  POISE_PARAM_VAD_OFF_THRESHOLD = 3, /* Default 0.4 */
+  POISE_PARAM_VAD_HANG_FRAMES = 4,   /* Default 12 */
+  POISE_PARAM_DEADLINE_MS = 5        /* Flight recorder deadline, 16 */
+} poise_param;
+
+POISE_API poise_status poise_stream_set_param(poise_stream *stream,
+                                              poise_param param, float value);
+
+POISE_API poise_status poise_stream_get_param(const poise_stream *stream,
+                                              poise_param param, float *value);
+
+typedef struct poise_stream_stats {
+  uint32_t struct_size;
+  int64_t stream_id; /* Label in exported metrics */
+  uint64_t frames;
+  uint64_t frames_inferred;
+  uint64_t frames_gated;
+  uint64_t frames_low_benefit;
+  uint64_t deadline_misses;
+  uint64_t underruns;
+  uint64_t non_finite_events;
+  uint64_t state_resets;
+  double inference_ms_total;
+  int64_t memory_bytes;
+  int64_t memory_peak_bytes;
+  /* ~1 s moving averages of the per-frame enhancement estimates */
+  float noise_reduction_db;
+  float speech_retention_db;
+  float low_benefit_ratio;
+} poise_stream_stats;
+
+/**
+ * Counters are zero if the process-wide metrics registry was full when the
+ * stream was created.
+ */
+POISE_API poise_status poise_stream_get_stats(const poise_stream *stream,
+                                              poise_stream_stats *stats);
+
+/* ========================================================================
+ * Legacy processor
+ *
+ * Pre- and post-processing around the legacy model, which the host runs
+ * itself on POISE_LEGACY_FRAME_SAMPLES frames at POISE_LEGACY_SAMPLE_RATE,
+ * keeping its recurrent state. For each captured chunk:
+ *
+ *   - poise_processor_begin_frame() scrubs and resamples it into a model
+ *     frame (POISE_ERROR_AGAIN until a full frame is available);
+ *   - poise_processor_check_vad() on the frame: POISE_OK runs the model,
+ *     POISE_GATED skips it;
+ *   - poise_processor_finish_frame() on the model output, or the frame
+ *     itself when gated, resamples it to the playback rate;
+ *   - if poise_processor_state_due(), poise_processor_check_state() on the
+ *     model's new state before the host keeps it.
+ * ======================================================================== */
+
+#define POISE_LEGACY_SAMPLE_RATE 48000
+#define POISE_LEGACY_FRAME_SAMPLES 480
+
+typedef struct poise_processor poise_processor;
+
+typedef struct poise_processor_config {
+  uint32_t struct_size;
+  float vad_threshold_db; /* Energy gate, default -40 */
+  float atten_lim_db;     /* Default -60 */
+} poise_processor_config;
+
+/** Fill a config with defaults (and struct_size). */
+POISE_API void poise_processor_config_init(poise_processor_config *config);
+
+/**
+ * Create a legacy processor. config may be NULL for the defaults.
+ * @return POISE_ERROR_REJECTED when admission control turns it away,
+ *         POISE_ERROR_OUT_OF_MEMORY if it could not be allocated
+ */
+POISE_API poise_status poise_processor_create(
+    const poise_processor_config *config, poise_processor **processor);
+
+POISE_API void poise_processor_destroy(poise_processor *processor);
+
+/**
+ * Rate of the captured audio passed to begin_frame, and of the audio
+ * finish_frame produces. Both default to POISE_LEGACY_SAMPLE_RATE (no
+ * resampling).
+ */
+POISE_API poise_status poise_processor_set_capture_rate(
+    poise_processor *processor, int rate);
+POISE_API poise_status poise_processor_set_playback_rate(
+    poise_processor *processor, int rate);
+
+/** Samples finish_frame produces per frame at the playback rate. */
+POISE_API int poise_processor_max_output(const poise_processor *processor);
+
+/**
+ * Scrub NaN/Inf from count captured samples in place and resample them
+ * into POISE_LEGACY_FRAME_SAMPLES of frame.
+ * @return POISE_OK with a frame begun, or POISE_ERROR_AGAIN while the
+ *         capture resampler has less than a frame (nothing begun)
+ */
+POISE_API poise_status poise_processor_begin_frame(poise_processor *processor,
+                                                   float *input, int count,
+                                                   float *frame);
+
+/**
+ * Energy gate on the begun frame (POISE_LEGACY_FRAME_SAMPLES).
+ * @return POISE_OK to run the model, POISE_GATED to skip it
+ */
+POISE_API poise_status poise_processor_check_vad(poise_processor *processor,
+                                                 const float *frame);
+
+/**
+ * Soft limiter, clipping and DC removal in place on
+ * POISE_LEGACY_FRAME_SAMPLES of audio, then resampling into output; closes
+ * the frame's metrics.
+ * @param capacity At least poise_processor_max_output()
+ * @param written Samples written to output; 0 while the playback
+ *        resampler fills up
+ * @return POISE_OK, or POISE_ERROR_NON_FINITE if the model output held
+ *         NaN/Inf: the model input is output instead, and the state must
+ *         go through poise_processor_check_state()
+ */
+POISE_API poise_status poise_processor_finish_frame(poise_processor *processor,
+                                                    float *audio,
+                                                    float *output,
+                                                    int capacity,
+                                                    int *written);
+
+/**
+ * Nonzero if the last finished frame's model state needs
+ * poise_processor_check_state(): its output was non-finite, or the periodic
+ * health scan is due.
+ */
+POISE_API int poise_processor_state_due(const poise_processor *processor);
+
+/**
+ * Apply the last finished frame's check to the model's new state.
+ * @return POISE_OK, or POISE_ERROR_NON_FINITE if the state was zeroed
+ */
+POISE_API poise_status poise_processor_check_state(poise_processor *processor,
+                                                   float *state, size_t count);
+
+/** As poise_stream_park_state(). */
+POISE_API poise_status poise_processor_park_state(poise_processor *processor,
+                                                  const float *state,
+                                                  size_t count);
+
+/** As poise_stream_restore_state(). */
+POISE_API poise_status poise_processor_restore_state(
+    poise_processor *processor, float *state, size_t count);
+
+/**
+ * Clear gate, timing and resampler state for a new signal, and drop any
+ * parked model state.
+ */
+POISE_API void poise_processor_reset(poise_processor *processor);
+
+/** Flag an output underrun for the flight recorder. */
+POISE_API void poise_processor_report_underrun(poise_processor *processor);
+
+typedef struct poise_processor_stats {
+  uint32_t struct_size;
+  uint64_t frames_inferred;
+  double inference_ms_avg;
+  float rtf; /* Average inference time over the frame duration */
+  uint64_t vad_frames;
+  uint64_t vad_speech;
+  uint64_t vad_bypassed;
+  float vad_bypass_ratio;
+  int vad_active; /* Last frame was speech */
+  int state_parked;
+  int64_t cold_pool_saved_bytes; /* Process-wide */
+  uint64_t non_finite_events;
+  uint64_t state_resets;
+  int64_t memory_bytes;
+  int64_t memory_peak_bytes;
+} poise_processor_stats;
+
+POISE_API poise_status poise_processor_get_stats(
+    const poise_processor *processor, poise_processor_stats *stats);
+
+/* ========================================================================
+ * Resampling
+ * ======================================================================== */
+
+typedef struct poise_resampler poise_resampler;
+
+typedef enum poise_resample_quality {
+  POISE_RESAMPLE_FAST = 0,
+  POISE_RESAMPLE_BALANCED = 1,
+  POISE_RESAMPLE_HIGH = 2
+} poise_resample_quality;
+
+/** @return NULL for invalid rates or quality */
+POISE_API poise_resampler *poise_resampler_create(
+    int input_rate, int output_rate, poise_resample_quality quality);
+
+POISE_API void poise_resampler_destroy(poise_resampler *resampler);
+
+/** Output capacity needed for count input samples. */
+POISE_API int poise_resampler_max_output(const poise_resampler *resampler,
+                                         int count);
+
+/**
+ * @param capacity At least poise_resampler_max_output(count)
+ * @return Samples written, or a negative poise_status
+ */
+POISE_API int poise_resampler_process(poise_resampler *resampler,
+                                      const float *input, int count,
+                                      float *output, int capacity);
+
+POISE_API void poise_resampler_reset(poise_resampler *resampler);
+
+typedef struct poise_resampler_info {
+  uint32_t struct_size;
+  double macs_per_output;
+  double direct_macs_per_output; /* Single-stage design, for comparison */
+  double delay_samples;          /* Group delay in output samples */
+  int stages;
+} poise_resampler_info;
+
+POISE_API poise_status poise_resampler_get_info(
+    const poise_resampler *resampler, poise_resampler_info *info);
+
+/**
+ * Human-readable plan, like snprintf.
+ * @return Full length; the text was truncated if it is >= capacity
+ */
+POISE_API size_t poise_resampler_describe(const poise_resampler *resampler,
+                                          char *buffer, size_t capacity);
+
+/* ========================================================================
+ * Daemon client
+ *
+ * For processes that want denoising without loading a model: frames go to
+ * a running denoise daemon through shared-memory rings. Same frame format
+ * as a stream (POISE_SAMPLE_RATE, POISE_FRAME_SAMPLES). write and read may
+ * run on different threads (one each).
+ * ======================================================================== */
+
+typedef struct poise_daemon_stream poise_daemon_stream;
+
+/**
+ * Connect to the daemon at socket_path ("@name" for the abstract
+ * namespace) and open a stream.
+ * @param latency_ms Capture-to-output budget, 0 for the daemon default
+ * @return POISE_ERROR_UNAVAILABLE if the daemon is not running, does not
+ *         accept this process, or has no room for the stream
+ */
+POISE_API poise_status poise_daemon_stream_open(const char *socket_path,
+                                                int latency_ms,
+                                                poise_daemon_stream **stream);
+
+POISE_API void poise_daemon_stream_close(poise_daemon_stream *stream);
+
+/**
+ * Queue one input frame.
+ * @param capture_ns Steady-clock capture time for latency accounting,
+ *                   0 for now
+ * @return POISE_ERROR_AGAIN if the input ring is full
+ */
+POISE_API poise_status poise_daemon_stream_write(poise_daemon_stream *stream,
+                                                 const float *frame,
+                                                 uint64_t capture_ns);
+
+/**
+ * Fetch one denoised frame, waiting up to timeout_ms (0 polls).
+ * @return POISE_ERROR_AGAIN if none arrived in time
+ */
+POISE_API poise_status poise_daemon_stream_read(poise_daemon_stream *stream,
+                                                float *frame, int timeout_ms);
+
+/* ========================================================================
+ * Process-wide
+ * ======================================================================== */
+
+/**
+ * Render all native metrics in OpenMetrics text format, like snprintf.
+ * Never blocks audio threads; call it from a non-audio thread.
+ * @return Full length; the text was truncated if it is >= capacity
+ */
+POISE_API size_t poise_metrics_render(char *buffer, size_t capacity);
+
+/**
+ * Directory for flight recorder dumps (written on deadline misses,
+ * underruns and non-finite events). Dumping is off until this is set.
+ */
+POISE_API void poise_set_flight_recorder_dir(const char *directory);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* POISE_API_H */
@@ -6,13 +6,15 @@
  */
 
 #include "poise_processor.h"
+#include "async_log.h"
+#include "cold_state_pool.h"
+#include "numeric_guard.h"
 #include <cmath>
 #include <algorithm>
-#include <android/log.h>
 
 #define LOG_TAG "PoiseProcessor"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) POISE_LOG(poise::LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
 namespace poise {
 
@@ -24,6 +26,10 @@ constexpr float SOFT_LIMITER_THRESHOLD = 0.98f;
 constexpr float AUDIO_CLIP_MIN = -1.0f;
 constexpr float AUDIO_CLIP_MAX = 1.0f;
 
+// State health check: every 50 inferred frames (~0.5 s), a full scan of
+// the 45K-float state costs well under 1% of frame time.
+constexpr int STATE_HEALTH_INTERVAL = 50;
+
 PoiseProcessor::PoiseProcessor(float vadThresholdDb, float attenLimDb)
     : vadThresholdDb_(vadThresholdDb)
     , attenLimDb_(attenLimDb)
@@ -31,115 +37,168 @@ PoiseProcessor::PoiseProcessor(float vadThresholdDb, float attenLimDb)
     , sampleRate_(DEFAULT_SAMPLE_RATE)
     , frameCount_(0)
     , totalProcessingTimeMs_(0.0)
-    , vad_(vadThresholdDb, 300.0f, DEFAULT_SAMPLE_RATE) // 300ms hang time
+    , vadDoneUs_(0)
+    , inferencePending_(false)
+    , inputNonFinite_(false)
+    , dryFrame_(DEFAULT_FRAME_SIZE, 0.0f)
+    , streamId_(MetricsRegistry::nextStreamId())
+    , nonFiniteEvents_(0)
+    , framesSinceHealthCheck_(0)
+    , metrics_(MetricsRegistry::instance().acquire(streamId_, "legacy"))
+    , stateGuard_(streamId_, metrics_)
+    , recorder_(streamId_, "legacy",
+                DEFAULT_FRAME_SIZE * 1000.0f / DEFAULT_SAMPLE_RATE)
+    , vad_(vadThresholdDb, 0.0f, DEFAULT_SAMPLE_RATE) // Frame-by-frame, no hang time
 {
-    // Initialize ONNX state buffer
-    states_.resize(ONNX_STATE_SIZE, 0.0f);
+    // The recurrent state itself lives with the ONNX session on the Kotlin side
+    recorder_.attachMemory(metrics_);
+    if (metrics_) {
+        metricsSet(metrics_->stateResidentBytes, ONNX_STATE_SIZE * sizeof(float));
+    }
     LOGI("PoiseProcessor initialized: VAD threshold=%.1f dB, atten limit=%.1f dB",
          vadThresholdDb, attenLimDb);
 }
 
 PoiseProcessor::~PoiseProcessor() {
+    // Charges must leave the slot before it can be reused
+    recorder_.attachMemory(nullptr);
+    MetricsRegistry::instance().release(metrics_);
     LOGI("PoiseProcessor destroyed. Processed %d frames, avg time: %.2f ms",
          frameCount_, getAverageProcessingTimeMs());
 }
 
 void PoiseProcessor::reset() {
-    std::fill(states_.begin(), states_.end(), 0.0f);
+    // The Kotlin side starts again from zero state
+    stateGuard_.discard();
+    framesSinceHealthCheck_ = 0;
     frameCount_ = 0;
     totalProcessingTimeMs_ = 0.0;
     vad_.reset();
+    inputNonFinite_ = false;
     LOGI("PoiseProcessor state reset");
 }
 
-std::vector<float> PoiseProcessor::processFrame(
-    const std::vector<float>& inputFrame,
-    OnnxInferenceCallback inferenceCallback)
-{
-    // Normalize frame size
-    std::vector<float> frame = normalizeFrameSize(inputFrame);
-    
-    // VAD check - bypass processing if silence
-    if (!vad_.isSpeech(frame)) {
-        return frame; // Pass through unprocessed
+void PoiseProcessor::scrubInput(float* input, int count) {
+    // Scrub NaN/Inf before it reaches the resampler, the VAD or the model
+    if (!allFinite(input, static_cast<size_t>(count))) {
+        scrubNonFinite(input, static_cast<size_t>(count));
+        onNonFinite("input");
+        inputNonFinite_ = true;
     }
-    
-    // Run ONNX inference via callback
-    auto startTime = std::chrono::high_resolution_clock::now();
-    
-    std::vector<float> enhancedFrame = inferenceCallback(frame, states_, attenLimDb_);
-    
-    auto endTime = std::chrono::high_resolution_clock::now();
-    double processingTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
-    
-    // Update statistics
-    frameCount_++;
-    totalProcessingTimeMs_ += processingTimeMs;
-    
-    // Normalize output shape
-    enhancedFrame = normalizeOutputShape(enhancedFrame, frame);
-    
-    // Post-processing
-    postprocessAudio(enhancedFrame);
-    
-    return enhancedFrame;
 }
 
-std::vector<float> PoiseProcessor::normalizeFrameSize(const std::vector<float>& audio) {
-    std::vector<float> result(frameSize_, 0.0f);
-    
-    size_t copySize = std::min(audio.size(), static_cast<size_t>(frameSize_));
-    std::copy(audio.begin(), audio.begin() + copySize, result.begin());
-    
-    return result;
+void PoiseProcessor::beginFrame() {
+    // A short read leaves no frame open, so each frame is counted once
+    frame_ = FrameRecord();
+    frame_.timeUs = FlightRecorder::nowUs();
+    inferencePending_ = false;
+    if (inputNonFinite_) {
+        frame_.flags |= FRAME_NON_FINITE;
+        inputNonFinite_ = false;
+    }
 }
 
-std::vector<float> PoiseProcessor::normalizeOutputShape(
-    const std::vector<float>& output, 
-    const std::vector<float>& fallback)
-{
-    if (output.empty()) {
-        return fallback;
+bool PoiseProcessor::checkVad(const float* frame, int count) {
+    vadDoneUs_ = FlightRecorder::nowUs();
+    frame_.preMs = static_cast<float>(vadDoneUs_ - frame_.timeUs) / 1000.0f;
+    if (!vad_.isSpeech(frame, static_cast<size_t>(count))) {
+        if (metrics_) {
+            metricsInc(metrics_->framesBypassed);
+        }
+        return false;
     }
-    
-    std::vector<float> result(frameSize_, 0.0f);
-    size_t copySize = std::min(output.size(), static_cast<size_t>(frameSize_));
-    std::copy(output.begin(), output.begin() + copySize, result.begin());
-    
-    return result;
+    frame_.vadSpeech = 1;
+    inferencePending_ = true;
+    int keep = std::min(count, frameSize_);
+    std::copy(frame, frame + keep, dryFrame_.begin());
+    std::fill(dryFrame_.begin() + keep, dryFrame_.end(), 0.0f);
+    return true;
+}
+
+PoiseProcessor::StateCheck PoiseProcessor::finishFrame(float* audio, int count) {
+    int64_t postStartUs = FlightRecorder::nowUs();
+    StateCheck check = StateCheck::NONE;
+    if (metrics_) {
+        metricsInc(metrics_->framesTotal);
+    }
+    if (inferencePending_) {
+        inferencePending_ = false;
+        double inferenceMs = static_cast<double>(postStartUs - vadDoneUs_) / 1000.0;
+        frameCount_++;
+        totalProcessingTimeMs_ += inferenceMs;
+        frame_.inferMs = static_cast<float>(inferenceMs);
+        if (metrics_) {
+            metricsInc(metrics_->framesInferred);
+            metrics_->inferenceLatency.observe(inferenceMs);
+        }
+
+        // A non-finite output means the state is poisoned as well
+        if (!allFinite(audio, static_cast<size_t>(count))) {
+            onNonFinite("output");
+            int keep = std::min(count, frameSize_);
+            std::copy(dryFrame_.begin(), dryFrame_.begin() + keep, audio);
+            std::fill(audio + keep, audio + count, 0.0f);
+            check = StateCheck::RESET;
+        } else if (++framesSinceHealthCheck_ >= STATE_HEALTH_INTERVAL) {
+            check = StateCheck::SCAN;
+        }
+    }
+
+    postprocessAudio(audio, count);
+
+    int64_t endUs = FlightRecorder::nowUs();
+    frame_.postMs = static_cast<float>(endUs - postStartUs) / 1000.0f;
+    frame_.totalMs = static_cast<float>(endUs - frame_.timeUs) / 1000.0f;
+    recordFrame(frame_);
+    return check;
 }
 
-void PoiseProcessor::postprocessAudio(std::vector<float>& audio) {
-    if (audio.empty()) return;
+bool PoiseProcessor::checkStates(StateCheck check, float* states, size_t count) {
+    switch (check) {
+    case StateCheck::RESET:
+        framesSinceHealthCheck_ = 0;
+        stateGuard_.reset(states, count, "non-finite model output");
+        return true;
+    case StateCheck::SCAN:
+        framesSinceHealthCheck_ = 0;
+        return stateGuard_.check(states, count);
+    case StateCheck::NONE:
+        break;
+    }
+    return false;
+}
+
+void PoiseProcessor::postprocessAudio(float* audio, int count) {
+    if (count <= 0) return;
     
     // Find max value for soft limiter
     float maxVal = 0.0f;
-    for (float sample : audio) {
-        maxVal = std::max(maxVal, std::abs(sample));
+    for (int i = 0; i < count; i++) {
+        maxVal = std::max(maxVal, std::abs(audio[i]));
     }
     
     // Apply soft limiter
     if (maxVal > SOFT_LIMITER_THRESHOLD && maxVal > 0.0f) {
         float scale = SOFT_LIMITER_THRESHOLD / maxVal;
-        for (float& sample : audio) {
-            sample *= scale;
+        for (int i = 0; i < count; i++) {
+            audio[i] *= scale;
         }
     }
     
     // Clip to valid range
-    for (float& sample : audio) {
-        sample = std::clamp(sample, AUDIO_CLIP_MIN, AUDIO_CLIP_MAX);
+    for (int i = 0; i < count; i++) {
+        audio[i] = std::clamp(audio[i], AUDIO_CLIP_MIN, AUDIO_CLIP_MAX);
     }
     
     // Remove DC offset
     float mean = 0.0f;
-    for (float sample : audio) {
-        mean += sample;
+    for (int i = 0; i < count; i++) {
+        mean += audio[i];
     }
-    mean /= static_cast<float>(audio.size());
+    mean /= static_cast<float>(count);
     
-    for (float& sample : audio) {
-        sample -= mean;
+    for (int i = 0; i < count; i++) {
+        audio[i] -= mean;
     }
 }
 
@@ -158,6 +217,17 @@ ProcessingStats PoiseProcessor::getStats() const {
     stats.vadActive = vadStats.active;
     stats.vadBypassed = vadStats.bypassed;
     stats.vadBypassRatio = vadStats.bypassRatio;
+    stats.vadDetected = vad_.isActive();
+
+    // Idle eviction
+    auto poolStats = ColdStatePool::instance().getStats();
+    stats.stateParked = stateGuard_.parked();
+    stats.stateResidentBytes = stateGuard_.parked() ? 0 : ONNX_STATE_SIZE * sizeof(float);
+    stats.stateEvictions = stateGuard_.evictions();
+    stats.coldPoolBytes = poolStats.coldBytes;
+    stats.coldPoolSaved = poolStats.savedBytes;
+    stats.nonFiniteEvents = nonFiniteEvents_ + stateGuard_.nonFiniteEvents();
+    stats.stateResets = stateGuard_.stateResets();
     
     return stats;
 }
@@ -166,10 +236,29 @@ double PoiseProcessor::getAverageProcessingTimeMs() const {
     return (frameCount_ > 0) ? (totalProcessingTimeMs_ / frameCount_) : 0.0;
 }
 
-void PoiseProcessor::updateStates(const std::vector<float>& newStates) {
-    if (newStates.size() == states_.size()) {
-        states_ = newStates;
+void PoiseProcessor::reportUnderrun() {
+    recorder_.reportUnderrun();
+}
+
+void PoiseProcessor::recordFrame(const FrameRecord& record) {
+    uint8_t flags = recorder_.record(record);
+    if (metrics_ && flags != 0) {
+        if (flags & FRAME_DEADLINE_MISS) {
+            metricsInc(metrics_->deadlineMisses);
+        }
+        if (flags & FRAME_UNDERRUN) {
+            metricsInc(metrics_->underruns);
+        }
+    }
+}
+
+void PoiseProcessor::onNonFinite(const char* where) {
+    nonFiniteEvents_++;
+    frame_.flags |= FRAME_NON_FINITE;
+    if (metrics_) {
+        metricsInc(metrics_->nonFiniteEvents);
     }
+    LOGE("Stream %lld: non-finite values in %s", static_cast<long long>(streamId_), where);
 }
 
 } // namespace poise
@@ -5,9 +5,11 @@
 #ifndef POISE_PROCESSOR_H
 #define POISE_PROCESSOR_H
 
+#include "flight_recorder.h"
+#include "model_state_guard.h"
+#include "stream_metrics.h"
 #include "vad.h"
-#include <chrono>
-#include <functional>
+#include <cstdint>
 #include <vector>
 
 namespace poise {
@@ -20,22 +22,53 @@ struct ProcessingStats {
   int vadActive = 0;
   int vadBypassed = 0;
   float vadBypassRatio = 0.0f;
+  bool vadDetected = false;
+
+  // Idle state eviction
+  bool stateParked = false;
+  int64_t stateResidentBytes = 0;
+  int stateEvictions = 0;
+  int64_t coldPoolBytes = 0;  // Process-wide packed bytes
+  int64_t coldPoolSaved = 0;  // Process-wide bytes saved by parking
+
+  // Numeric health
+  int nonFiniteEvents = 0;
+  int stateResets = 0;
 };
 
-// Callback type for ONNX inference (called from native to Kotlin/Java)
-using OnnxInferenceCallback = std::function<std::vector<float>(
-    const std::vector<float> &inputFrame, std::vector<float> &states,
-    float attenLimDb)>;
-
 class PoiseProcessor {
 public:
   PoiseProcessor(float vadThresholdDb = -40.0f, float attenLimDb = -60.0f);
   ~PoiseProcessor();
 
-  // Process a single audio frame
-  // inferenceCallback is called to run ONNX model (implemented in Kotlin)
-  std::vector<float> processFrame(const std::vector<float> &inputFrame,
-                                  OnnxInferenceCallback inferenceCallback);
+  // Frames are driven from JNI around inference on the Kotlin side:
+  // scrubInput() -> [resampling] -> beginFrame() -> checkVad() ->
+  // [inference] -> finishFrame()
+
+  // Scrub NaN/Inf from captured input in place, before input resampling.
+  // The event is flagged on the next frame begun.
+  void scrubInput(float *input, int count);
+
+  // Start timing a frame, once a full model frame is available
+  void beginFrame();
+
+  // Energy gate; false means the frame bypasses inference
+  bool checkVad(const float *frame, int count);
+
+  // What the model state returned with a frame needs before it is kept
+  enum class StateCheck { NONE, SCAN, RESET };
+
+  // Soft limiter, clipping and DC removal in place; closes the frame's
+  // metrics and flight recorder entry. After a speech frame the time since
+  // checkVad() is recorded as inference, and a non-finite model output is
+  // replaced by the checkVad() frame (the state must then be reset).
+  StateCheck finishFrame(float *audio, int count);
+
+  /**
+   * Apply finishFrame()'s verdict to the model's new state.
+   * @return true if the state was zeroed
+   */
+  bool checkStates(StateCheck check, float *states, size_t count);
 
   // Reset processor state
   void reset();
@@ -43,33 +76,67 @@ public:
   // Get processing statistics
   ProcessingStats getStats() const;
 
-  // Update ONNX model states (called after inference)
-  void updateStates(const std::vector<float> &newStates);
+  // Park the Kotlin-held model state in the cold pool while the stream is
+  // idle; it is restored (or zeroed if that fails) before the next inference
+  size_t parkState(const float *states, size_t count) {
+    return stateGuard_.park(states, count);
+  }
+  bool restoreState(float *states, size_t count) {
+    return stateGuard_.restore(states, count);
+  }
+
+  // Flag an output underrun for the flight recorder (any thread)
+  void reportUnderrun();
+
+  // Samples queued between this processor and playback, for diagnostics
+  void setQueueLevel(int samples) { recorder_.setQueueLevel(samples); }
 
   // Getters
   int getFrameSize() const { return frameSize_; }
   int getSampleRate() const { return sampleRate_; }
   float getVadThresholdDb() const { return vadThresholdDb_; }
-  const std::vector<float> &getStates() const { return states_; }
+  float getAttenLimDb() const { return attenLimDb_; }
+  bool isStateParked() const { return stateGuard_.parked(); }
+  // Null if the registry was full
+  StreamMetrics *metrics() const { return metrics_; }
 
 private:
-  std::vector<float> normalizeFrameSize(const std::vector<float> &audio);
-  std::vector<float> normalizeOutputShape(const std::vector<float> &output,
-                                          const std::vector<float> &fallback);
-  void postprocessAudio(std::vector<float> &audio);
+  void postprocessAudio(float *audio, int count);
   double getAverageProcessingTimeMs() const;
+  void recordFrame(const FrameRecord &record);
+  void onNonFinite(const char *where);
 
   float vadThresholdDb_;
   float attenLimDb_;
   int frameSize_;
   int sampleRate_;
 
-  std::vector<float> states_;
-
   // Statistics
   int frameCount_;
   double totalProcessingTimeMs_;
 
+  // Live path: inference runs between checkVad() and finishFrame()
+  FrameRecord frame_;
+  int64_t vadDoneUs_;
+  bool inferencePending_;
+  bool inputNonFinite_; // Scrubbed input not yet in a frame
+  std::vector<float> dryFrame_; // Model input, the fallback output
+
+  int64_t streamId_;
+
+  // Numeric health
+  int nonFiniteEvents_;
+  int framesSinceHealthCheck_;
+
+  // Exported metrics slot (may be null if the registry is full)
+  StreamMetrics *metrics_;
+
+  // Health and idle parking of the model state held on the Kotlin side
+  ModelStateGuard stateGuard_;
+
+  // Per-frame history dumped on deadline miss / underrun
+  FlightRecorder recorder_;
+
   // VAD
   VoiceActivityDetector vad_;
 };
@@ -0,0 +1,96 @@
+/**
+ * Power Mode - Implementation
+ */
+
+#include "power_mode.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <sys/resource.h>
+
+namespace poise {
+
+namespace {
+
+int64_t monotonicNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// All threads: inference runs on ORT's pool and playback on its own thread
+int64_t processCpuUs() {
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  return (static_cast<int64_t>(usage.ru_utime.tv_sec) +
+          usage.ru_stime.tv_sec) *
+             1000000 +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+} // anonymous namespace
+
+BurstScheduler::BurstScheduler(int sampleRate, BurstConfig config)
+    : sampleRate_(sampleRate), config_(config),
+      mode_(PowerMode::LOW_LATENCY) {
+  resetStats();
+}
+
+int BurstScheduler::burstFrames(int frameSamples) const {
+  if (mode_ == PowerMode::LOW_LATENCY || frameSamples <= 0) {
+    return 1;
+  }
+  int frames = static_cast<int>(std::lround(
+      config_.burstMs * sampleRate_ / (1000.0f * frameSamples)));
+  return std::max(frames, 1);
+}
+
+void BurstScheduler::beginBurst() {
+  beginNs_ = monotonicNs();
+  if (cpuStartUs_ < 0) {
+    cpuStartUs_ = processCpuUs();
+  }
+}
+
+void BurstScheduler::endBurst(int samples) {
+  if (beginNs_ == 0) {
+    return;
+  }
+  int64_t busy = monotonicNs() - beginNs_;
+  beginNs_ = 0;
+  bursts_++;
+  samples_ += samples;
+  busyNs_ += busy;
+  maxBusyNs_ = std::max(maxBusyNs_, busy);
+}
+
+BurstStats BurstScheduler::getStats() const {
+  BurstStats stats;
+  stats.mode = mode_;
+  stats.bursts = bursts_;
+  if (samples_ == 0) {
+    return stats;
+  }
+  double audioSeconds = static_cast<double>(samples_) / sampleRate_;
+  stats.audioMs = static_cast<float>(audioSeconds * 1000.0);
+  stats.wakeupsPerSecond = static_cast<float>(bursts_ / audioSeconds);
+  stats.busyRatio = static_cast<float>(busyNs_ / 1e9 / audioSeconds);
+  stats.cpuMsPerAudioSecond = static_cast<float>(
+      (processCpuUs() - cpuStartUs_) / 1000.0 / audioSeconds);
+  stats.avgBusyMs = static_cast<float>(busyNs_ / 1e6 / bursts_);
+  stats.maxBusyMs = static_cast<float>(maxBusyNs_ / 1e6);
+  return stats;
+}
+
+void BurstScheduler::resetStats() {
+  beginNs_ = 0;
+  cpuStartUs_ = -1;
+  bursts_ = 0;
+  samples_ = 0;
+  busyNs_ = 0;
+  maxBusyNs_ = 0;
+}
+
+} // namespace poise
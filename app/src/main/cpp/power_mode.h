@@ -0,0 +1,77 @@
+/**
+ * Power Mode - Header
+ *
+ * Chooses how much capture the processing loop reads per wake-up. In
+ * LOW_LATENCY mode that is one model frame (10-16 ms), as before. In
+ * RACE_TO_IDLE mode it is a burst of frames (~160 ms): the loop sleeps in
+ * the capture read until the burst is complete, processes every frame back
+ * to back at full speed and goes back to sleep, so the CPU spends most of
+ * each burst in a deep idle state instead of waking 60-100 times a second.
+ * The playout buffer absorbs the resulting push pattern at the cost of
+ * roughly one burst of output latency.
+ *
+ * The scheduler also measures what the mode costs: wake-ups, busy time and
+ * process CPU time per second of audio.
+ */
+
+#ifndef POWER_MODE_H
+#define POWER_MODE_H
+
+#include <cstdint>
+
+namespace poise {
+
+enum class PowerMode : int {
+  LOW_LATENCY = 0,  // One frame per wake-up
+  RACE_TO_IDLE = 1, // One burst per wake-up
+};
+
+struct BurstConfig {
+  float burstMs = 160.0f; // Capture per wake-up in RACE_TO_IDLE
+};
+
+struct BurstStats {
+  PowerMode mode = PowerMode::LOW_LATENCY;
+  int64_t bursts = 0;
+  float audioMs = 0.0f;              // Audio processed since resetStats()
+  float wakeupsPerSecond = 0.0f;     // Per second of audio
+  float busyRatio = 0.0f;            // Busy wall time / audio time
+  float cpuMsPerAudioSecond = 0.0f;  // Process CPU, all threads
+  float avgBusyMs = 0.0f;            // Per burst
+  float maxBusyMs = 0.0f;
+};
+
+class BurstScheduler {
+public:
+  BurstScheduler(int sampleRate, BurstConfig config = {});
+
+  void setMode(PowerMode mode) { mode_ = mode; }
+  PowerMode mode() const { return mode_; }
+
+  // Frames to read per wake-up for a model of frameSamples per frame
+  int burstFrames(int frameSamples) const;
+
+  // Bracket the processing of one read: begin when the read returns, end
+  // once its output has been pushed
+  void beginBurst();
+  void endBurst(int samples);
+
+  BurstStats getStats() const;
+  void resetStats();
+
+private:
+  int sampleRate_;
+  BurstConfig config_;
+  PowerMode mode_;
+
+  int64_t beginNs_;
+  int64_t cpuStartUs_; // Process CPU at the first burst, -1 before
+  int64_t bursts_;
+  int64_t samples_;
+  int64_t busyNs_;
+  int64_t maxBusyNs_;
+};
+
+} // namespace poise
+
+#endif // POWER_MODE_H
@@ -0,0 +1,361 @@
+/**
+ * Resample Plan - C++ Implementation
+ *
+ * Filters are Kaiser-windowed sincs sized with Kaiser's length estimate.
+ * With passband edge fp and the lower of the stage's two rates Rmin, every
+ * stage puts its stopband at Rmin - fp: aliases (or images) of anything
+ * above that land above fp, so the passband stays clean while the
+ * transition band is allowed to fold. A halfband stage between R and R/2
+ * therefore has a wide transition band (R/2 - 2fp) and needs only a few
+ * taps, half of them zero; the narrow transition is left to one polyphase
+ * stage running at the lowest rate the cascade allows.
+ */
+
+#include "resample_plan.h"
+#include "async_log.h"
+#include "memory_accounting.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+
+#define LOG_TAG "PoiseResamplePlan"
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Above this many phases the polyphase bank quantizes the phase instead
+constexpr int MAX_PHASES = 512;
+
+struct QualitySpec {
+  double passFraction; // Passband edge as a fraction of the lower Nyquist
+  double attenuationDb;
+};
+
+const QualitySpec QUALITY_SPECS[] = {
+    {0.80, 50.0}, // FAST
+    {0.90, 70.0}, // BALANCED
+    {0.95, 90.0}, // HIGH
+};
+
+double kaiserBeta(double attenuationDb) {
+  if (attenuationDb > 50.0) {
+    return 0.1102 * (attenuationDb - 8.7);
+  }
+  if (attenuationDb > 21.0) {
+    return 0.5842 * std::pow(attenuationDb - 21.0, 0.4) +
+           0.07886 * (attenuationDb - 21.0);
+  }
+  return 0.0;
+}
+
+// Taps for a transition band of width transition at sample rate rate
+int kaiserLength(double attenuationDb, double transition, double rate) {
+  double normalized = 2.0 * PI * transition / rate;
+  return static_cast<int>(
+             std::ceil((attenuationDb - 7.95) / (2.285 * normalized))) +
+         1;
+}
+
+double besselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 50; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12) {
+      break;
+    }
+  }
+  return sum;
+}
+
+/**
+ * Lowpass with cutoff (cycles per sample) and DC gain, length taps,
+ * centered at (length - 1) / 2.
+ */
+std::vector<double> windowedSinc(int length, double cutoff, double gain,
+                                 double beta) {
+  std::vector<double> h(length);
+  double center = (length - 1) / 2.0;
+  double i0Beta = besselI0(beta);
+  double sum = 0.0;
+  for (int n = 0; n < length; n++) {
+    double t = n - center;
+    double x = 2.0 * cutoff * t;
+    double sinc = t == 0.0 ? 1.0 : std::sin(PI * x) / (PI * x);
+    double r = center > 0.0 ? t / center : 0.0;
+    double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) /
+                    i0Beta;
+    h[n] = 2.0 * cutoff * sinc * window;
+    sum += h[n];
+  }
+  for (double &tap : h) {
+    tap *= gain / sum;
+  }
+  return h;
+}
+
+/**
+ * Halfband filter at rate filterRate with passband edge fp: 4k+3 taps, the
+ * even offsets from the center exactly zero.
+ */
+std::vector<float> designHalfband(double fp, double filterRate,
+                                  const QualitySpec &spec) {
+  double transition = filterRate / 2.0 - 2.0 * fp;
+  int length = kaiserLength(spec.attenuationDb, transition, filterRate);
+  length = std::max(length, 3);
+  length += (3 - length % 4 + 4) % 4; // Round up to 4k + 3
+
+  std::vector<double> h =
+      windowedSinc(length, 0.25, 1.0, kaiserBeta(spec.attenuationDb));
+  // Exact zeros and center, and side taps summing to the other half of DC
+  int center = (length - 1) / 2;
+  double side = 0.0;
+  for (int n = 0; n < length; n++) {
+    if ((n - center) % 2 != 0) {
+      side += h[n];
+    }
+  }
+  std::vector<float> taps(length, 0.0f);
+  for (int n = 0; n < length; n++) {
+    if ((n - center) % 2 != 0) {
+      taps[n] = static_cast<float>(h[n] * 0.5 / side);
+    }
+  }
+  taps[center] = 0.5f;
+  return taps;
+}
+
+ResampleStage halfbandStage(ResampleStageKind kind, int inputRate,
+                            double fp, const QualitySpec &spec) {
+  ResampleStage stage;
+  stage.kind = kind;
+  stage.inputRate = inputRate;
+  bool down = kind == ResampleStageKind::HALFBAND_DOWN;
+  stage.outputRate = down ? inputRate / 2 : inputRate * 2;
+  double filterRate = down ? inputRate : stage.outputRate;
+  stage.taps = designHalfband(fp, filterRate, spec);
+
+  // Symmetric pairs of non-zero taps, folded: k + 1 for 4k + 3 taps
+  int pairs = (static_cast<int>(stage.taps.size()) + 1) / 4;
+  // Down: pairs plus the center per output. Up: every other output is the
+  // center tap alone (a delayed copy), the rest cost the pairs.
+  stage.macsPerOutput = down ? pairs + 1.0 : pairs / 2.0;
+  return stage;
+}
+
+ResampleStage polyphaseStage(int inputRate, int outputRate, double fp,
+                             const QualitySpec &spec) {
+  ResampleStage stage;
+  stage.kind = ResampleStageKind::POLYPHASE;
+  stage.inputRate = inputRate;
+  stage.outputRate = outputRate;
+  int divisor = std::gcd(inputRate, outputRate);
+  stage.up = outputRate / divisor;
+  stage.down = inputRate / divisor;
+
+  int phases = std::min(stage.up, MAX_PHASES);
+  double filterRate = static_cast<double>(inputRate) * phases;
+  double stop = std::min(inputRate, outputRate) - fp;
+  int length = kaiserLength(spec.attenuationDb, stop - fp, filterRate);
+  stage.tapsPerPhase = (length + phases - 1) / phases;
+  length = stage.tapsPerPhase * phases;
+
+  std::vector<double> h =
+      windowedSinc(length, (fp + stop) / 2.0 / filterRate, phases,
+                   kaiserBeta(spec.attenuationDb));
+  stage.taps.resize(length);
+  for (int p = 0; p < phases; p++) {
+    for (int k = 0; k < stage.tapsPerPhase; k++) {
+      stage.taps[p * stage.tapsPerPhase + k] =
+          static_cast<float>(h[k * phases + p]);
+    }
+  }
+  stage.macsPerOutput = stage.tapsPerPhase;
+  return stage;
+}
+
+// Group delay of one stage in seconds
+double stageDelaySeconds(const ResampleStage &stage) {
+  double length = static_cast<double>(stage.taps.size());
+  switch (stage.kind) {
+  case ResampleStageKind::HALFBAND_DOWN:
+    return (length - 1) / 2.0 / stage.inputRate;
+  case ResampleStageKind::HALFBAND_UP:
+    return (length - 1) / 2.0 / stage.outputRate;
+  case ResampleStageKind::POLYPHASE: {
+    int phases = static_cast<int>(stage.taps.size()) / stage.tapsPerPhase;
+    return (length - 1) / 2.0 / (static_cast<double>(stage.inputRate) * phases);
+  }
+  }
+  return 0.0;
+}
+
+void finish(ResamplePlan &plan) {
+  plan.macsPerOutput = 0.0;
+  double delay = 0.0;
+  for (const ResampleStage &stage : plan.stages) {
+    plan.macsPerOutput += stage.macsPerOutput *
+                          static_cast<double>(stage.outputRate) /
+                          plan.outputRate;
+    delay += stageDelaySeconds(stage);
+  }
+  plan.delaySamples = delay * plan.outputRate;
+}
+
+/**
+ * The cascade with `halfbands` integer stages on the high-rate side, or an
+ * empty plan if that many do not divide the rates evenly.
+ */
+ResamplePlan candidate(int inputRate, int outputRate, int halfbands,
+                       double fp, const QualitySpec &spec) {
+  ResamplePlan plan;
+  plan.inputRate = inputRate;
+  plan.outputRate = outputRate;
+
+  bool down = inputRate > outputRate;
+  int high = down ? inputRate : outputRate;
+  int low = down ? outputRate : inputRate;
+  int scale = 1 << halfbands;
+  if (high % scale != 0 || high / scale < low) {
+    return plan;
+  }
+  int middle = high / scale;
+
+  if (down) {
+    for (int rate = inputRate; rate > middle; rate /= 2) {
+      plan.stages.push_back(
+          halfbandStage(ResampleStageKind::HALFBAND_DOWN, rate, fp, spec));
+    }
+    if (middle != outputRate) {
+      plan.stages.push_back(polyphaseStage(middle, outputRate, fp, spec));
+    }
+  } else {
+    if (inputRate != middle) {
+      plan.stages.push_back(polyphaseStage(inputRate, middle, fp, spec));
+    }
+    for (int rate = middle; rate < outputRate; rate *= 2) {
+      plan.stages.push_back(
+          halfbandStage(ResampleStageKind::HALFBAND_UP, rate, fp, spec));
+    }
+  }
+  finish(plan);
+  return plan;
+}
+
+std::shared_ptr<const ResamplePlan> design(int inputRate, int outputRate,
+                                           ResampleQuality quality) {
+  auto best = std::make_shared<ResamplePlan>();
+  best->inputRate = inputRate;
+  best->outputRate = outputRate;
+  best->quality = quality;
+  if (inputRate == outputRate) {
+    return best;
+  }
+
+  const QualitySpec &spec = QUALITY_SPECS[static_cast<int>(quality)];
+  double fp = spec.passFraction * std::min(inputRate, outputRate) / 2.0;
+  int high = std::max(inputRate, outputRate);
+  int low = std::min(inputRate, outputRate);
+
+  bool found = false;
+  double direct = 0.0;
+  for (int halfbands = 0; (high >> halfbands) >= low; halfbands++) {
+    ResamplePlan plan = candidate(inputRate, outputRate, halfbands, fp, spec);
+    if (plan.stages.empty()) {
+      continue;
+    }
+    if (halfbands == 0) {
+      direct = plan.macsPerOutput;
+    }
+    if (!found || plan.macsPerOutput < best->macsPerOutput) {
+      *best = std::move(plan);
+      found = true;
+    }
+  }
+  best->quality = quality;
+  best->directMacsPerOutput = direct;
+  return best;
+}
+
+const char *kindName(ResampleStageKind kind) {
+  switch (kind) {
+  case ResampleStageKind::HALFBAND_DOWN:
+  case ResampleStageKind::HALFBAND_UP:
+    return "hb";
+  case ResampleStageKind::POLYPHASE:
+    return "pp";
+  }
+  return "?";
+}
+
+std::mutex cacheMutex;
+std::map<std::tuple<int, int, int>, std::shared_ptr<const ResamplePlan>>
+    cache;
+MemoryCharge cacheMemory{MemoryComponent::RESAMPLER};
+
+} // anonymous namespace
+
+std::string ResamplePlan::describe() const {
+  if (stages.empty()) {
+    return "passthrough";
+  }
+  std::string text;
+  char part[96];
+  for (const ResampleStage &stage : stages) {
+    if (stage.kind == ResampleStageKind::POLYPHASE) {
+      snprintf(part, sizeof(part), "%s%d->%d %s %d/%dx%d",
+               text.empty() ? "" : " | ", stage.inputRate, stage.outputRate,
+               kindName(stage.kind), stage.up, stage.down, stage.tapsPerPhase);
+    } else {
+      snprintf(part, sizeof(part), "%s%d->%d %s(%zu)",
+               text.empty() ? "" : " | ", stage.inputRate, stage.outputRate,
+               kindName(stage.kind), stage.taps.size());
+    }
+    text += part;
+  }
+  return text;
+}
+
+std::shared_ptr<const ResamplePlan>
+ResamplePlanner::plan(int inputRate, int outputRate, ResampleQuality quality) {
+  auto key = std::make_tuple(inputRate, outputRate, static_cast<int>(quality));
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  auto it = cache.find(key);
+  if (it != cache.end()) {
+    return it->second;
+  }
+
+  std::shared_ptr<const ResamplePlan> plan =
+      design(inputRate, outputRate, quality);
+  cache[key] = plan;
+
+  size_t bytes = 0;
+  for (const auto &entry : cache) {
+    for (const ResampleStage &stage : entry.second->stages) {
+      bytes += stage.taps.capacity() * sizeof(float);
+    }
+  }
+  cacheMemory.set(bytes);
+
+  LOGI("Plan %d -> %d Hz: %s, %.1f MAC/sample (single stage %.1f), "
+       "delay %.1f samples",
+       inputRate, outputRate, plan->describe().c_str(), plan->macsPerOutput,
+       plan->directMacsPerOutput, plan->delaySamples);
+  return plan;
+}
+
+int ResamplePlanner::cachedPlans() {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  return static_cast<int>(cache.size());
+}
+
+} // namespace poise
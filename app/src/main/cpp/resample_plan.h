@@ -0,0 +1,91 @@
+/**
+ * Resample Plan - Header
+ *
+ * Decomposes a sample-rate conversion into a cascade of cheap stages:
+ * integer halfband stages on the high-rate side (decimating first when
+ * going down, interpolating last when going up) and one short fractional
+ * polyphase stage in between. Every candidate cascade is designed to the
+ * same quality target (passband edge and stopband attenuation, with aliases
+ * and images kept out of the passband); the planner keeps the one with the
+ * fewest multiply-adds per output sample.
+ *
+ * Plans are immutable and cached per (input rate, output rate, quality), so
+ * streams sharing a ratio share the filter design and coefficients.
+ */
+
+#ifndef RESAMPLE_PLAN_H
+#define RESAMPLE_PLAN_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace poise {
+
+enum class ResampleQuality : int {
+  FAST = 0, // 80% of the lower Nyquist, 50 dB
+  BALANCED, // 90%, 70 dB
+  HIGH,     // 95%, 90 dB
+  NUM_QUALITIES
+};
+
+enum class ResampleStageKind : int {
+  HALFBAND_DOWN = 0, // Rate / 2
+  HALFBAND_UP,       // Rate * 2
+  POLYPHASE,         // Rate * up / down
+};
+
+struct ResampleStage {
+  ResampleStageKind kind;
+  int inputRate;
+  int outputRate;
+  int up = 1;   // Interpolation factor (polyphase)
+  int down = 1; // Decimation factor (polyphase)
+
+  /**
+   * Halfband: the full symmetric filter (4k+3 taps, gain 1 at DC).
+   * Polyphase: the prototype at inputRate * up, stored phase-major as
+   * taps[phase * tapsPerPhase + k], gain up.
+   */
+  std::vector<float> taps;
+  int tapsPerPhase = 0;
+
+  double macsPerOutput = 0.0; // Multiply-adds per output sample of the stage
+};
+
+struct ResamplePlan {
+  int inputRate = 0;
+  int outputRate = 0;
+  ResampleQuality quality = ResampleQuality::BALANCED;
+  std::vector<ResampleStage> stages; // Empty when the rates are equal
+
+  // Multiply-adds per final output sample, across all stages
+  double macsPerOutput = 0.0;
+
+  // Cost of the single-stage polyphase design, for comparison
+  double directMacsPerOutput = 0.0;
+
+  // Group delay of the cascade, in output samples
+  double delaySamples = 0.0;
+
+  // E.g. "96000->48000 hb(11) | 48000->24000 hb(23) | 24000->16000 pp 2/3x52"
+  std::string describe() const;
+};
+
+class ResamplePlanner {
+public:
+  /**
+   * Plan a conversion, designing it on first use and returning the cached
+   * plan afterwards. Thread-safe; the returned plan is never modified.
+   */
+  static std::shared_ptr<const ResamplePlan>
+  plan(int inputRate, int outputRate,
+       ResampleQuality quality = ResampleQuality::BALANCED);
+
+  // Plans designed so far (for tests and diagnostics)
+  static int cachedPlans();
+};
+
+} // namespace poise
+
+#endif // RESAMPLE_PLAN_H
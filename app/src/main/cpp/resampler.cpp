@@ -1,82 +1,250 @@
 /**
  * Audio Resampler - C++ Implementation
  *
- * Streaming resampler for handling sample rate differences.
- * Uses linear interpolation for simplicity (Android devices typically use
- * 48kHz).
+ * Streaming resamplers built on ResamplePlanner cascades. Each stage keeps
+ * a line of (history + current block) samples so filters run over
+ * contiguous memory; halfband stages fold their symmetric taps and skip the
+ * zero ones.
  */
 
 #include "resampler.h"
-#include <android/log.h>
-#include <cmath>
+#include "async_log.h"
+#include <algorithm>
+#include <cstring>
 
 #define LOG_TAG "PoiseResampler"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
 
 namespace poise {
 
-StreamingResampler::StreamingResampler(int inputSr, int outputSr)
-    : inputSampleRate_(inputSr), outputSampleRate_(outputSr),
-      ratio_(static_cast<double>(outputSr) / static_cast<double>(inputSr)),
-      phase_(0.0) {
-  LOGI("Resampler created: %d Hz -> %d Hz (ratio: %.4f)", inputSr, outputSr,
-       ratio_);
+// ============================================================================
+// CascadeResampler
+// ============================================================================
+
+CascadeResampler::CascadeResampler(int inputSr, int outputSr,
+                                   ResampleQuality quality)
+    : CascadeResampler(ResamplePlanner::plan(inputSr, outputSr, quality)) {}
+
+CascadeResampler::CascadeResampler(std::shared_ptr<const ResamplePlan> plan)
+    : plan_(std::move(plan)) {
+  for (const ResampleStage &stage : plan_->stages) {
+    StageState state{};
+    state.stage = &stage;
+    int length = static_cast<int>(stage.taps.size());
+    switch (stage.kind) {
+    case ResampleStageKind::HALFBAND_DOWN:
+      state.history = length - 1;
+      break;
+    case ResampleStageKind::HALFBAND_UP:
+      state.history = (length + 1) / 2 - 1; // Even-tap subfilter
+      break;
+    case ResampleStageKind::POLYPHASE:
+      state.history = stage.tapsPerPhase - 1;
+      state.phases = length / stage.tapsPerPhase;
+      break;
+    }
+    stages_.push_back(std::move(state));
+  }
+  reset();
 }
 
-std::vector<float> StreamingResampler::process(const std::vector<float> &input,
-                                               int outputSize) {
-  if (inputSampleRate_ == outputSampleRate_) {
-    // No resampling needed
-    return input;
+int CascadeResampler::maxOutput(int count) const {
+  if (stages_.empty()) {
+    return count;
   }
+  // Each stage releases at most one output more than the exact ratio
+  int64_t bound = count;
+  for (const ResampleStage &stage : plan_->stages) {
+    bound = bound * stage.outputRate / stage.inputRate + 1;
+  }
+  return static_cast<int>(bound);
+}
 
-  // Add input to accumulator
-  accumulator_.insert(accumulator_.end(), input.begin(), input.end());
+void CascadeResampler::reset() {
+  for (StageState &state : stages_) {
+    state.line.assign(state.history, 0.0f);
+    state.next = state.history;
+    state.phase = 0;
+  }
+  track();
+}
 
-  // Calculate how many output samples we can generate
-  int availableOutputSamples =
-      static_cast<int>((accumulator_.size() - 1) * ratio_);
+void CascadeResampler::track() {
+  size_t bytes = 0;
+  for (const StageState &state : stages_) {
+    bytes += (state.line.capacity() + state.out.capacity()) * sizeof(float);
+  }
+  memory_.set(bytes);
+}
 
-  if (availableOutputSamples < outputSize) {
-    // Not enough samples yet
-    return {};
+int CascadeResampler::process(const float *input, int count, float *output,
+                              int capacity) {
+  if (stages_.empty()) {
+    int n = std::min(count, capacity);
+    std::memcpy(output, input, n * sizeof(float));
+    return n;
   }
 
-  // Generate output samples using linear interpolation
-  std::vector<float> output(outputSize);
+  bool grew = false;
+  const float *in = input;
+  int n = count;
+  for (size_t s = 0; s < stages_.size(); s++) {
+    StageState &state = stages_[s];
+    const ResampleStage &stage = *state.stage;
+    bool last = s + 1 == stages_.size();
+
+    size_t lineCapacity = state.line.capacity();
+    state.line.resize(state.history + n);
+    std::memcpy(state.line.data() + state.history, in, n * sizeof(float));
+    grew |= state.line.capacity() != lineCapacity;
+
+    int bound = static_cast<int>(static_cast<int64_t>(n) * stage.outputRate /
+                                 stage.inputRate) +
+                1;
+    float *out;
+    if (last) {
+      if (bound > capacity) {
+        // Caller sized the output for a smaller block; keep what fits
+        bound = capacity;
+      }
+      out = output;
+    } else {
+      if (static_cast<int>(state.out.size()) < bound) {
+        state.out.resize(bound);
+        grew = true;
+      }
+      out = state.out.data();
+    }
 
-  for (int i = 0; i < outputSize; i++) {
-    double srcPos = (i + phase_) / ratio_;
-    int srcIndex = static_cast<int>(srcPos);
-    float frac = static_cast<float>(srcPos - srcIndex);
+    n = runStage(state, n, out, bound);
+    in = out;
+  }
+  if (grew) {
+    track();
+  }
+  return n;
+}
 
-    if (srcIndex + 1 < static_cast<int>(accumulator_.size())) {
-      output[i] = accumulator_[srcIndex] * (1.0f - frac) +
-                  accumulator_[srcIndex + 1] * frac;
-    } else if (srcIndex < static_cast<int>(accumulator_.size())) {
-      output[i] = accumulator_[srcIndex];
-    } else {
-      output[i] = 0.0f;
+int CascadeResampler::runStage(StageState &state, int count, float *output,
+                               int capacity) {
+  const ResampleStage &stage = *state.stage;
+  const float *line = state.line.data();
+  const float *taps = stage.taps.data();
+  int lineLength = state.history + count;
+  int produced = 0;
+
+  // Past capacity the stage still advances, so its timing stays intact, but
+  // the output is dropped
+  switch (stage.kind) {
+  case ResampleStageKind::HALFBAND_DOWN: {
+    int center = (static_cast<int>(stage.taps.size()) - 1) / 2;
+    for (; state.next < lineLength; state.next += 2) {
+      if (produced == capacity) {
+        continue;
+      }
+      const float *x = line + state.next - center; // x[0] is the center tap
+      float sum = 0.5f * x[0];
+      for (int m = 1; m <= center; m += 2) {
+        sum += taps[center + m] * (x[-m] + x[m]);
+      }
+      output[produced++] = sum;
     }
+    break;
   }
+  case ResampleStageKind::HALFBAND_UP: {
+    // Even outputs: the even taps (doubled) over the input; odd outputs:
+    // the center tap alone, a delayed copy
+    int length = static_cast<int>(stage.taps.size());
+    int sub = (length + 1) / 2;
+    int delay = (length - 3) / 4;
+    for (; state.next < lineLength; state.next++) {
+      if (produced + 2 > capacity) {
+        continue;
+      }
+      const float *x = line + state.next;
+      float sum = 0.0f;
+      for (int i = 0; i < sub / 2; i++) {
+        sum += taps[2 * i] * (x[-i] + x[-(sub - 1 - i)]);
+      }
+      output[produced++] = 2.0f * sum;
+      output[produced++] = x[-delay];
+    }
+    break;
+  }
+  case ResampleStageKind::POLYPHASE: {
+    int tapsPerPhase = stage.tapsPerPhase;
+    while (state.next < lineLength) {
+      if (produced < capacity) {
+        int phase = state.phases == stage.up
+                        ? state.phase
+                        : static_cast<int>(static_cast<int64_t>(state.phase) *
+                                           state.phases / stage.up);
+        const float *h = taps + phase * tapsPerPhase;
+        const float *x = line + state.next;
+        float sum = 0.0f;
+        for (int k = 0; k < tapsPerPhase; k++) {
+          sum += h[k] * x[-k];
+        }
+        output[produced++] = sum;
+      }
+      state.phase += stage.down;
+      state.next += state.phase / stage.up;
+      state.phase %= stage.up;
+    }
+    break;
+  }
+  }
+
+  // Keep the newest history samples for the next block
+  std::memmove(state.line.data(), state.line.data() + count,
+               state.history * sizeof(float));
+  state.next -= count;
+  return produced;
+}
+
+// ============================================================================
+// StreamingResampler
+// ============================================================================
+
+StreamingResampler::StreamingResampler(int inputSr, int outputSr)
+    : inputSampleRate_(inputSr), outputSampleRate_(outputSr),
+      cascade_(inputSr, outputSr), accumulated_(0) {
+  LOGI("Resampler created: %d Hz -> %d Hz (%s)", inputSr, outputSr,
+       cascade_.plan().describe().c_str());
+}
 
-  // Update phase and remove consumed samples
-  double consumedInputSamples = outputSize / ratio_;
-  int samplesToRemove = static_cast<int>(consumedInputSamples);
-  phase_ = std::fmod(phase_ + consumedInputSamples - samplesToRemove, 1.0);
+std::vector<float> StreamingResampler::process(const std::vector<float> &input,
+                                               int outputSize) {
+  if (inputSampleRate_ == outputSampleRate_) {
+    // No resampling needed
+    return input;
+  }
+
+  // Resample into the accumulator
+  int room = cascade_.maxOutput(static_cast<int>(input.size()));
+  if (static_cast<int>(accumulator_.size()) < accumulated_ + room) {
+    accumulator_.resize(accumulated_ + room);
+  }
+  accumulated_ += cascade_.process(input.data(), static_cast<int>(input.size()),
+                                   accumulator_.data() + accumulated_, room);
+  memory_.track(accumulator_);
 
-  if (samplesToRemove > 0 &&
-      samplesToRemove <= static_cast<int>(accumulator_.size())) {
-    accumulator_.erase(accumulator_.begin(),
-                       accumulator_.begin() + samplesToRemove);
+  if (accumulated_ < outputSize) {
+    // Not enough samples yet
+    return {};
   }
 
+  std::vector<float> output(accumulator_.begin(),
+                            accumulator_.begin() + outputSize);
+  accumulated_ -= outputSize;
+  std::memmove(accumulator_.data(), accumulator_.data() + outputSize,
+               accumulated_ * sizeof(float));
   return output;
 }
 
 void StreamingResampler::reset() {
-  accumulator_.clear();
-  phase_ = 0.0;
+  cascade_.reset();
+  accumulated_ = 0;
 }
 
 } // namespace poise
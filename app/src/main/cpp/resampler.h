@@ -5,10 +5,62 @@
 #ifndef RESAMPLER_H
 #define RESAMPLER_H
 
+#include "memory_accounting.h"
+#include "resample_plan.h"
+#include <memory>
 #include <vector>
 
 namespace poise {
 
+/**
+ * Runs a ResamplePlan on a stream: block in, whatever output that block
+ * completes out. All stages are causal, so the output count depends only
+ * on how much input has arrived (e.g. exactly 256 out per 768 in for
+ * 48 -> 16 kHz). Scratch grows to the largest block seen and is then
+ * reused.
+ */
+class CascadeResampler {
+public:
+  CascadeResampler(int inputSr, int outputSr,
+                   ResampleQuality quality = ResampleQuality::BALANCED);
+  explicit CascadeResampler(std::shared_ptr<const ResamplePlan> plan);
+
+  // Upper bound on the output of process() for count input samples
+  int maxOutput(int count) const;
+
+  /**
+   * @param capacity Must be at least maxOutput(count)
+   * @return Samples written
+   */
+  int process(const float *input, int count, float *output, int capacity);
+
+  void reset();
+
+  const ResamplePlan &plan() const { return *plan_; }
+
+  // Charge the filter lines and scratch to a stream (nullptr detaches)
+  void attachMemory(StreamMetrics *stream) { memory_.attach(stream); }
+
+private:
+  struct StageState {
+    const ResampleStage *stage;
+    std::vector<float> line; // history, then the current block
+    int history;             // Samples kept between blocks
+    int next;                // Line index of the next output's newest input
+    int phase;               // Polyphase: output time within next, in 1/up
+    int phases;              // Polyphase: filter bank size
+    std::vector<float> out;  // Output scratch (unused by the last stage)
+  };
+
+  // Filter the count samples just appended to the line
+  int runStage(StageState &state, int count, float *output, int capacity);
+  void track();
+
+  std::shared_ptr<const ResamplePlan> plan_;
+  std::vector<StageState> stages_;
+  MemoryCharge memory_{MemoryComponent::RESAMPLER};
+};
+
 class StreamingResampler {
 public:
   StreamingResampler(int inputSr, int outputSr);
@@ -23,12 +75,19 @@ public:
   int getInputSampleRate() const { return inputSampleRate_; }
   int getOutputSampleRate() const { return outputSampleRate_; }
 
+  // Charge the accumulator to a stream (nullptr detaches)
+  void attachMemory(StreamMetrics *stream) {
+    memory_.attach(stream);
+    cascade_.attachMemory(stream);
+  }
+
 private:
   int inputSampleRate_;
   int outputSampleRate_;
-  double ratio_;
-  double phase_;
-  std::vector<float> accumulator_;
+  CascadeResampler cascade_;
+  std::vector<float> accumulator_; // Resampled, not yet returned
+  int accumulated_;
+  MemoryCharge memory_{MemoryComponent::RESAMPLER};
 };
 
 } // namespace poise
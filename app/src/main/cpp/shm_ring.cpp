@@ -0,0 +1,237 @@
+/**
+ * Shared-Memory Audio Ring - Implementation
+ */
+
+#include "shm_ring.h"
+#include "async_log.h"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __ANDROID__
+#include <android/sharedmem.h>
+#else
+#include <sys/syscall.h>
+#endif
+
+#define LOG_TAG "PoiseShm"
+#define LOGE(...) POISE_LOG(poise::LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace poise {
+
+namespace {
+
+size_t alignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+size_t slotBytesFor(uint32_t frameSamples) {
+  return alignUp(sizeof(ShmFrameHeader) + frameSamples * sizeof(float), 64);
+}
+
+} // namespace
+
+// ============================================================================
+// ShmRing
+// ============================================================================
+
+size_t ShmRing::bytesFor(uint32_t capacity, uint32_t frameSamples) {
+  return alignUp(sizeof(ShmRingHeader), 64) +
+         static_cast<size_t>(capacity) * slotBytesFor(frameSamples);
+}
+
+bool ShmRing::init(void *base, uint32_t capacity, uint32_t frameSamples) {
+  if (base == nullptr || capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+      frameSamples == 0) {
+    return false;
+  }
+
+  header_ = new (base) ShmRingHeader();
+  header_->magic = SHM_RING_MAGIC;
+  header_->capacity = capacity;
+  header_->frameSamples = frameSamples;
+  header_->reserved = 0;
+  header_->writeIndex.store(0, std::memory_order_relaxed);
+  header_->readIndex.store(0, std::memory_order_release);
+
+  capacity_ = capacity;
+  frameSamples_ = frameSamples;
+  slotBytes_ = slotBytesFor(frameSamples);
+  slots_ = static_cast<uint8_t *>(base) + alignUp(sizeof(ShmRingHeader), 64);
+  sequence_ = 0;
+  return true;
+}
+
+bool ShmRing::attach(void *base, size_t size) {
+  if (base == nullptr || size < sizeof(ShmRingHeader)) {
+    return false;
+  }
+  auto *header = static_cast<ShmRingHeader *>(base);
+  uint32_t capacity = header->capacity;
+  uint32_t frameSamples = header->frameSamples;
+  if (header->magic != SHM_RING_MAGIC || capacity == 0 ||
+      (capacity & (capacity - 1)) != 0 || frameSamples == 0 ||
+      bytesFor(capacity, frameSamples) > size) {
+    LOGE("Rejecting shared ring: bad header");
+    return false;
+  }
+
+  header_ = header;
+  capacity_ = capacity;
+  frameSamples_ = frameSamples;
+  slotBytes_ = slotBytesFor(frameSamples);
+  slots_ = static_cast<uint8_t *>(base) + alignUp(sizeof(ShmRingHeader), 64);
+  sequence_ = 0;
+  return true;
+}
+
+ShmFrameHeader *ShmRing::slot(uint64_t index) const {
+  return reinterpret_cast<ShmFrameHeader *>(
+      slots_ + (index & (capacity_ - 1)) * slotBytes_);
+}
+
+bool ShmRing::push(const float *samples, uint64_t captureNs) {
+  uint64_t write = header_->writeIndex.load(std::memory_order_relaxed);
+  uint64_t read = header_->readIndex.load(std::memory_order_acquire);
+  if (write - read >= capacity_) {
+    return false;
+  }
+
+  ShmFrameHeader *frame = slot(write);
+  frame->captureNs = captureNs;
+  frame->sequence = sequence_++;
+  std::memcpy(frame + 1, samples, frameSamples_ * sizeof(float));
+
+  header_->writeIndex.store(write + 1, std::memory_order_release);
+  return true;
+}
+
+bool ShmRing::pop(float *samples, uint64_t *captureNs) {
+  uint64_t read = header_->readIndex.load(std::memory_order_relaxed);
+  uint64_t write = header_->writeIndex.load(std::memory_order_acquire);
+  // The peer owns writeIndex; never trust it to be sane
+  if (write == read || write - read > capacity_) {
+    return false;
+  }
+
+  const ShmFrameHeader *frame = slot(read);
+  if (captureNs != nullptr) {
+    *captureNs = frame->captureNs;
+  }
+  std::memcpy(samples, frame + 1, frameSamples_ * sizeof(float));
+
+  header_->readIndex.store(read + 1, std::memory_order_release);
+  return true;
+}
+
+bool ShmRing::peekCaptureNs(uint64_t *captureNs) const {
+  uint64_t read = header_->readIndex.load(std::memory_order_relaxed);
+  uint64_t write = header_->writeIndex.load(std::memory_order_acquire);
+  if (write == read || write - read > capacity_) {
+    return false;
+  }
+  *captureNs = slot(read)->captureNs;
+  return true;
+}
+
+uint32_t ShmRing::available() const {
+  uint64_t read = header_->readIndex.load(std::memory_order_relaxed);
+  uint64_t write = header_->writeIndex.load(std::memory_order_acquire);
+  uint64_t count = write - read;
+  return count > capacity_ ? 0 : static_cast<uint32_t>(count);
+}
+
+// ============================================================================
+// SharedRegion
+// ============================================================================
+
+SharedRegion::~SharedRegion() { release(); }
+
+bool SharedRegion::create(const char *name, size_t size) {
+  release();
+
+#ifdef __ANDROID__
+  int fd = ASharedMemory_create(name, size);
+  if (fd < 0) {
+    LOGE("ASharedMemory_create(%zu) failed", size);
+    return false;
+  }
+#else
+  int fd = static_cast<int>(syscall(SYS_memfd_create, name, MFD_CLOEXEC));
+  if (fd < 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    LOGE("memfd_create(%zu) failed: %s", size, std::strerror(errno));
+    if (fd >= 0) {
+      close(fd);
+    }
+    return false;
+  }
+#endif
+
+  return map(fd, size);
+}
+
+bool SharedRegion::map(int fd, size_t size) {
+  release();
+
+  void *data =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    LOGE("mmap(%zu) failed: %s", size, std::strerror(errno));
+    close(fd);
+    return false;
+  }
+
+  fd_ = fd;
+  data_ = data;
+  size_ = size;
+  return true;
+}
+
+void SharedRegion::release() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    data_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  size_ = 0;
+}
+
+// ============================================================================
+// eventfd helpers
+// ============================================================================
+
+int createEventFd() { return eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC); }
+
+void signalEventFd(int fd) {
+  uint64_t one = 1;
+  ssize_t n;
+  do {
+    n = write(fd, &one, sizeof(one));
+  } while (n < 0 && errno == EINTR);
+}
+
+bool drainEventFd(int fd) {
+  uint64_t value = 0;
+  return read(fd, &value, sizeof(value)) == sizeof(value);
+}
+
+bool waitEventFd(int fd, int timeoutMs) {
+  if (drainEventFd(fd)) {
+    return true;
+  }
+  pollfd pfd{fd, POLLIN, 0};
+  int rc;
+  do {
+    rc = poll(&pfd, 1, timeoutMs);
+  } while (rc < 0 && errno == EINTR);
+  return rc > 0 && drainEventFd(fd);
+}
+
+} // namespace poise
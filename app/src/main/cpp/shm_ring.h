@@ -0,0 +1,126 @@
+/**
+ * Shared-Memory Audio Ring - Header
+ *
+ * Single-producer / single-consumer ring of fixed-size audio frames placed
+ * in a shared memory region, so two processes can exchange audio without
+ * copying it through a socket. Each direction is paired with an eventfd
+ * for wake-ups.
+ */
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace poise {
+
+constexpr uint32_t SHM_RING_MAGIC = 0x50524E47; // "PRNG"
+
+/**
+ * Ring header at the start of the ring's memory. Indices are free-running;
+ * the slot is index & (capacity - 1).
+ */
+struct ShmRingHeader {
+  uint32_t magic;
+  uint32_t capacity; // Frames, power of two
+  uint32_t frameSamples;
+  uint32_t reserved;
+  alignas(64) std::atomic<uint64_t> writeIndex;
+  alignas(64) std::atomic<uint64_t> readIndex;
+};
+
+// Per-slot metadata preceding the samples
+struct ShmFrameHeader {
+  uint64_t captureNs; // Producer's steady clock when the frame was captured
+  uint64_t sequence;
+};
+
+class ShmRing {
+public:
+  ShmRing() = default;
+
+  // Bytes needed for a ring (64-byte multiple)
+  static size_t bytesFor(uint32_t capacity, uint32_t frameSamples);
+
+  /**
+   * Initialize a new ring in zeroed memory (owner side).
+   * @return false if capacity is not a power of two or frameSamples is 0
+   */
+  bool init(void *base, uint32_t capacity, uint32_t frameSamples);
+
+  /**
+   * Attach to a ring created by the peer. Geometry is read once and checked
+   * against the mapped size; later header writes by the peer are ignored.
+   */
+  bool attach(void *base, size_t size);
+
+  // Producer side. Returns false when full.
+  bool push(const float *samples, uint64_t captureNs);
+
+  // Consumer side. Returns false when empty or when the indices are corrupt.
+  bool pop(float *samples, uint64_t *captureNs);
+
+  // Frames ready to read (consumer view)
+  uint32_t available() const;
+
+  // Capture time of the next frame to pop; false when empty
+  bool peekCaptureNs(uint64_t *captureNs) const;
+
+  bool valid() const { return header_ != nullptr; }
+  uint32_t capacity() const { return capacity_; }
+  uint32_t frameSamples() const { return frameSamples_; }
+
+private:
+  ShmFrameHeader *slot(uint64_t index) const;
+
+  ShmRingHeader *header_ = nullptr;
+  uint8_t *slots_ = nullptr;
+  uint32_t capacity_ = 0;
+  uint32_t frameSamples_ = 0;
+  size_t slotBytes_ = 0;
+  uint64_t sequence_ = 0;
+};
+
+/**
+ * Owned mapping of a shareable memory fd (ASharedMemory on Android,
+ * memfd elsewhere).
+ */
+class SharedRegion {
+public:
+  SharedRegion() = default;
+  ~SharedRegion();
+
+  SharedRegion(const SharedRegion &) = delete;
+  SharedRegion &operator=(const SharedRegion &) = delete;
+
+  // Allocate and map a new zeroed region
+  bool create(const char *name, size_t size);
+
+  // Map a region received from a peer; takes ownership of fd
+  bool map(int fd, size_t size);
+
+  void release();
+
+  void *data() const { return data_; }
+  size_t size() const { return size_; }
+  int fd() const { return fd_; }
+
+private:
+  int fd_ = -1;
+  void *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// eventfd helpers (non-blocking, close-on-exec)
+int createEventFd();
+void signalEventFd(int fd);
+// Clears the counter; returns false if nothing was pending
+bool drainEventFd(int fd);
+// Waits up to timeoutMs (-1 = forever) and drains; false on timeout
+bool waitEventFd(int fd, int timeoutMs);
+
+} // namespace poise
+
+#endif // SHM_RING_H
@@ -0,0 +1,339 @@
+/**
+ * Recurrent State Codec - Implementation
+ *
+ * FP16 quantization + byte-plane shuffle + PackBits run-length coding for
+ * parked state; vectorized FP16/BF16 packing for resident state.
+ */
+
+#include "state_codec.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace poise {
+
+namespace {
+
+// PackBits: control byte n in [0, 127] -> n + 1 literal bytes follow,
+// n in [129, 255] -> next byte repeated 257 - n times (2..128).
+constexpr int MAX_RUN = 128;
+
+void packBits(const uint8_t *data, size_t size, std::vector<uint8_t> &out) {
+  size_t i = 0;
+  while (i < size) {
+    // Measure run at i
+    size_t run = 1;
+    while (i + run < size && run < MAX_RUN && data[i + run] == data[i]) {
+      run++;
+    }
+
+    if (run >= 2) {
+      out.push_back(static_cast<uint8_t>(257 - run));
+      out.push_back(data[i]);
+      i += run;
+      continue;
+    }
+
+    // Literal span until the next run of at least 2
+    size_t start = i;
+    size_t len = 0;
+    while (i < size && len < MAX_RUN) {
+      if (i + 1 < size && data[i + 1] == data[i]) {
+        break;
+      }
+      i++;
+      len++;
+    }
+    out.push_back(static_cast<uint8_t>(len - 1));
+    out.insert(out.end(), data + start, data + start + len);
+  }
+}
+
+bool unpackBits(const uint8_t *data, size_t size, uint8_t *out,
+                size_t outSize) {
+  size_t i = 0;
+  size_t o = 0;
+  while (i < size) {
+    uint8_t control = data[i++];
+    if (control < 128) {
+      size_t len = static_cast<size_t>(control) + 1;
+      if (i + len > size || o + len > outSize) {
+        return false;
+      }
+      std::memcpy(out + o, data + i, len);
+      i += len;
+      o += len;
+    } else if (control > 128) {
+      size_t len = 257 - static_cast<size_t>(control);
+      if (i >= size || o + len > outSize) {
+        return false;
+      }
+      std::memset(out + o, data[i++], len);
+      o += len;
+    }
+  }
+  return o == outSize;
+}
+
+} // anonymous namespace
+
+uint16_t floatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  uint32_t sign = (bits >> 16) & 0x8000u;
+  uint32_t exponent = (bits >> 23) & 0xFFu;
+  uint32_t mantissa = bits & 0x7FFFFFu;
+
+  if (exponent == 0xFFu) {
+    // Inf / NaN (keep NaN quiet)
+    return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+  }
+
+  int32_t halfExp = static_cast<int32_t>(exponent) - 127 + 15;
+  if (halfExp >= 31) {
+    return static_cast<uint16_t>(sign | 0x7C00u); // Overflow -> Inf
+  }
+
+  if (halfExp <= 0) {
+    // Subnormal or zero
+    if (halfExp < -10) {
+      return static_cast<uint16_t>(sign);
+    }
+    mantissa |= 0x800000u;
+    uint32_t shift = static_cast<uint32_t>(14 - halfExp);
+    uint32_t halfMant = mantissa >> shift;
+    uint32_t rem = mantissa & ((1u << shift) - 1u);
+    uint32_t halfway = 1u << (shift - 1);
+    if (rem > halfway || (rem == halfway && (halfMant & 1u))) {
+      halfMant++;
+    }
+    return static_cast<uint16_t>(sign | halfMant);
+  }
+
+  uint32_t half = sign | (static_cast<uint32_t>(halfExp) << 10) |
+                  (mantissa >> 13);
+  uint32_t rem = mantissa & 0x1FFFu;
+  if (rem > 0x1000u || (rem == 0x1000u && (half & 1u))) {
+    half++; // May carry into exponent, which rounds up correctly
+  }
+  return static_cast<uint16_t>(half);
+}
+
+float halfToFloat(uint16_t value) {
+  uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+  uint32_t exponent = (value >> 10) & 0x1Fu;
+  uint32_t mantissa = value & 0x3FFu;
+  uint32_t bits;
+
+  if (exponent == 0) {
+    if (mantissa == 0) {
+      bits = sign;
+    } else {
+      // Normalize subnormal
+      int32_t e = -1;
+      do {
+        e++;
+        mantissa <<= 1;
+      } while ((mantissa & 0x400u) == 0);
+      bits = sign | (static_cast<uint32_t>(127 - 15 - e) << 23) |
+             ((mantissa & 0x3FFu) << 13);
+    }
+  } else if (exponent == 0x1Fu) {
+    bits = sign | 0x7F800000u | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  }
+
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+uint16_t floatToBFloat16(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+    return static_cast<uint16_t>((bits >> 16) | 0x40u); // Quiet NaN
+  }
+  bits += 0x7FFFu + ((bits >> 16) & 1u);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+float bfloat16ToFloat(uint16_t value) {
+  uint32_t bits = static_cast<uint32_t>(value) << 16;
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+namespace {
+
+constexpr float HALF_MAX = 65504.0f;
+
+void packHalf(const float *src, uint16_t *dst, size_t count) {
+  size_t i = 0;
+#if defined(__aarch64__)
+  const float32x4_t hi = vdupq_n_f32(HALF_MAX);
+  const float32x4_t lo = vdupq_n_f32(-HALF_MAX);
+  for (; i + 8 <= count; i += 8) {
+    float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(src + i), lo), hi);
+    float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(src + i + 4), lo), hi);
+    float16x8_t h = vcvt_high_f16_f32(vcvt_f16_f32(a), b);
+    vst1q_u16(dst + i, vreinterpretq_u16_f16(h));
+  }
+#endif
+  for (; i < count; i++) {
+    // NaN passes through the clamp unchanged
+    float v = src[i] != src[i] ? src[i]
+                               : std::min(std::max(src[i], -HALF_MAX), HALF_MAX);
+    dst[i] = floatToHalf(v);
+  }
+}
+
+void unpackHalf(const uint16_t *src, float *dst, size_t count) {
+  size_t i = 0;
+#if defined(__aarch64__)
+  for (; i + 8 <= count; i += 8) {
+    float16x8_t h = vreinterpretq_f16_u16(vld1q_u16(src + i));
+    vst1q_f32(dst + i, vcvt_f32_f16(vget_low_f16(h)));
+    vst1q_f32(dst + i + 4, vcvt_high_f32_f16(h));
+  }
+#endif
+  for (; i < count; i++) {
+    dst[i] = halfToFloat(src[i]);
+  }
+}
+
+void packBFloat16(const float *src, uint16_t *dst, size_t count) {
+  size_t i = 0;
+#if defined(__aarch64__)
+  const uint32x4_t bias = vdupq_n_u32(0x7FFFu);
+  const uint32x4_t one = vdupq_n_u32(1u);
+  const uint16x4_t quietNaN = vdup_n_u16(0x7FC0u);
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t v = vld1q_f32(src + i);
+    uint32x4_t bits = vreinterpretq_u32_f32(v);
+    uint32x4_t lsb = vandq_u32(vshrq_n_u32(bits, 16), one);
+    uint16x4_t rounded = vshrn_n_u32(vaddq_u32(bits, vaddq_u32(bias, lsb)), 16);
+    uint16x4_t isNumber = vmovn_u32(vceqq_f32(v, v));
+    vst1_u16(dst + i, vbsl_u16(isNumber, rounded, quietNaN));
+  }
+#endif
+  for (; i < count; i++) {
+    dst[i] = floatToBFloat16(src[i]);
+  }
+}
+
+void unpackBFloat16(const uint16_t *src, float *dst, size_t count) {
+  size_t i = 0;
+#if defined(__aarch64__)
+  for (; i + 4 <= count; i += 4) {
+    uint32x4_t bits = vshll_n_u16(vld1_u16(src + i), 16);
+    vst1q_f32(dst + i, vreinterpretq_f32_u32(bits));
+  }
+#endif
+  for (; i < count; i++) {
+    dst[i] = bfloat16ToFloat(src[i]);
+  }
+}
+
+} // anonymous namespace
+
+void packState(StateFormat format, const float *src, uint16_t *dst,
+               size_t count) {
+  switch (format) {
+  case StateFormat::FP16:
+    packHalf(src, dst, count);
+    break;
+  case StateFormat::BF16:
+    packBFloat16(src, dst, count);
+    break;
+  case StateFormat::FP32:
+    std::memcpy(dst, src, count * sizeof(float));
+    break;
+  }
+}
+
+void unpackState(StateFormat format, const uint16_t *src, float *dst,
+                 size_t count) {
+  switch (format) {
+  case StateFormat::FP16:
+    unpackHalf(src, dst, count);
+    break;
+  case StateFormat::BF16:
+    unpackBFloat16(src, dst, count);
+    break;
+  case StateFormat::FP32:
+    std::memcpy(dst, src, count * sizeof(float));
+    break;
+  }
+}
+
+PackedState::PackedState(StateFormat format, const size_t *slotSizes,
+                         int numSlots)
+    : format_(format), slotSizes_(slotSizes, slotSizes + numSlots) {
+  // FP32 slots take two words per value
+  size_t wordsPerValue = (format == StateFormat::FP32) ? 2 : 1;
+  size_t offset = 0;
+  for (size_t size : slotSizes_) {
+    slotOffsets_.push_back(offset);
+    offset += size * wordsPerValue;
+  }
+  words_.assign(offset, 0);
+  memory_.track(words_);
+}
+
+void PackedState::store(int slot, const float *values) {
+  packState(format_, values, words_.data() + slotOffsets_[slot],
+            slotSizes_[slot]);
+}
+
+void PackedState::load(int slot, float *values) const {
+  unpackState(format_, words_.data() + slotOffsets_[slot], values,
+              slotSizes_[slot]);
+}
+
+void PackedState::clear() {
+  // All-zero words decode to +0.0 in every format
+  std::fill(words_.begin(), words_.end(), 0);
+}
+
+void StateCodec::encode(const float *state, size_t count,
+                        std::vector<uint8_t> &out) {
+  // Saturating conversion, as for resident FP16 state
+  std::vector<uint16_t> words(count);
+  packState(StateFormat::FP16, state, words.data(), count);
+
+  // Byte planes: [high bytes][low bytes]
+  std::vector<uint8_t> planes(count * 2);
+  for (size_t i = 0; i < count; i++) {
+    uint16_t h = words[i];
+    planes[i] = static_cast<uint8_t>(h >> 8);
+    planes[count + i] = static_cast<uint8_t>(h & 0xFFu);
+  }
+
+  out.clear();
+  out.reserve(planes.size() / 2);
+  packBits(planes.data(), planes.size(), out);
+  out.shrink_to_fit();
+}
+
+bool StateCodec::decode(const std::vector<uint8_t> &in, float *state,
+                        size_t count) {
+  std::vector<uint8_t> planes(count * 2);
+  if (!unpackBits(in.data(), in.size(), planes.data(), planes.size())) {
+    return false;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    uint16_t h = static_cast<uint16_t>((planes[i] << 8) | planes[count + i]);
+    state[i] = halfToFloat(h);
+  }
+  return true;
+}
+
+} // namespace poise
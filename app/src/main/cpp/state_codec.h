@@ -0,0 +1,102 @@
+/**
+ * Recurrent State Codec - Header
+ *
+ * Compact encoding for model state that is parked while a stream is idle,
+ * and FP16/BF16 storage for state that stays resident between frames.
+ */
+
+#ifndef STATE_CODEC_H
+#define STATE_CODEC_H
+
+#include "memory_accounting.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace poise {
+
+// IEEE 754 binary16 conversion (round to nearest even)
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+// bfloat16 conversion (round to nearest even, NaN stays NaN)
+uint16_t floatToBFloat16(float value);
+float bfloat16ToFloat(uint16_t value);
+
+enum class StateFormat : int {
+  FP32 = 0,
+  FP16 = 1, // 11-bit precision, saturates at +-65504
+  BF16 = 2, // 8-bit precision, full FP32 range
+};
+
+/**
+ * Bulk conversion between FP32 and FP16/BF16 words, NEON-vectorized on
+ * AArch64. FP16 saturates instead of overflowing so that large but finite
+ * state never comes back as Inf.
+ */
+void packState(StateFormat format, const float *src, uint16_t *dst,
+               size_t count);
+void unpackState(StateFormat format, const uint16_t *src, float *dst,
+                 size_t count);
+
+/**
+ * Recurrent model state kept between frames in a compact format.
+ *
+ * The state is split into slots (one per model state tensor). The model
+ * reads and writes FP32; values are converted on store() and load() at the
+ * inference boundary, so only the compact copy stays resident.
+ */
+class PackedState {
+public:
+  PackedState(StateFormat format, const size_t *slotSizes, int numSlots);
+
+  void store(int slot, const float *values);
+  void load(int slot, float *values) const;
+  void clear();
+
+  StateFormat format() const { return format_; }
+  int numSlots() const { return static_cast<int>(slotSizes_.size()); }
+  size_t slotSize(int slot) const { return slotSizes_[slot]; }
+  size_t residentBytes() const { return words_.size() * sizeof(uint16_t); }
+
+  // Charge the words to a stream (nullptr detaches)
+  void attachMemory(StreamMetrics *stream) { memory_.attach(stream); }
+
+private:
+  StateFormat format_;
+  std::vector<size_t> slotSizes_;
+  std::vector<size_t> slotOffsets_; // In 16-bit words
+  std::vector<uint16_t> words_;
+  MemoryCharge memory_{MemoryComponent::PACKED_STATE};
+};
+
+/**
+ * Encodes float state as FP16 followed by lossless packing. Values beyond
+ * +-65504 saturate as in packState(), so they never decode to Inf.
+ *
+ * The FP16 words are split into high and low byte planes so that the
+ * sign/exponent bytes form long runs, then run-length packed (PackBits).
+ * Decoding is exact with respect to the FP16 values.
+ */
+class StateCodec {
+public:
+  /**
+   * Encode a state buffer.
+   * @param state Source values
+   * @param count Number of floats
+   * @param out Packed bytes (replaced)
+   */
+  static void encode(const float *state, size_t count,
+                     std::vector<uint8_t> &out);
+
+  /**
+   * Decode a state buffer produced by encode().
+   * @return false if the packed data does not describe count values
+   */
+  static bool decode(const std::vector<uint8_t> &in, float *state,
+                     size_t count);
+};
+
+} // namespace poise
+
+#endif // STATE_CODEC_H
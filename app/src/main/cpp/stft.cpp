@@ -5,17 +5,19 @@
  */
 
 #include "stft.h"
-#include <android/log.h>
+#include "async_log.h"
+#include "numeric_guard.h"
 #include <cstring>
 
 #define LOG_TAG "STFT"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGI(...) POISE_LOG(poise::LOG_INFO, LOG_TAG, __VA_ARGS__)
 
 namespace poise {
 
 STFTProcessor::STFTProcessor() {
   initWindow();
   reset();
+  memory_.set(sizeof(STFTProcessor));
   LOGI("STFTProcessor initialized: FFT=%d, hop=%d", FFT_SIZE, HOP_SIZE);
 }
 
@@ -78,15 +80,20 @@ void STFTProcessor::fft(std::complex<float> *data, int n, bool inverse) {
   }
 }
 
-void STFTProcessor::computeSTFT(const float *audioChunk, float *realOut,
+bool STFTProcessor::computeSTFT(const float *audioChunk, float *realOut,
                                 float *imagOut) {
   // Shift buffer left by HOP_SIZE
   std::memmove(stftBuffer_, stftBuffer_ + HOP_SIZE,
                (FFT_SIZE - HOP_SIZE) * sizeof(float));
 
-  // Add new samples at the end
-  std::memcpy(stftBuffer_ + FFT_SIZE - HOP_SIZE, audioChunk,
-              HOP_SIZE * sizeof(float));
+  // Add new samples at the end, scrubbing NaN/Inf so they cannot linger in
+  // the analysis window
+  float *newSamples = stftBuffer_ + FFT_SIZE - HOP_SIZE;
+  std::memcpy(newSamples, audioChunk, HOP_SIZE * sizeof(float));
+  bool finite = allFinite(newSamples, HOP_SIZE);
+  if (!finite) {
+    scrubNonFinite(newSamples, HOP_SIZE);
+  }
 
   // Apply window and copy to FFT buffer
   for (int i = 0; i < FFT_SIZE; i++) {
@@ -102,10 +109,18 @@ void STFTProcessor::computeSTFT(const float *audioChunk, float *realOut,
     realOut[i] = fftBuffer_[i].real();
     imagOut[i] = fftBuffer_[i].imag();
   }
+  return finite;
 }
 
-void STFTProcessor::reconstructAudio(const float *realIn, const float *imagIn,
+bool STFTProcessor::reconstructAudio(const float *realIn, const float *imagIn,
                                      float *audioOut) {
+  // Never let a poisoned spectrum into the overlap-add buffer
+  if (!allFinite(realIn, NUM_BINS) || !allFinite(imagIn, NUM_BINS)) {
+    std::memset(overlapBuffer_, 0, sizeof(overlapBuffer_));
+    std::memset(audioOut, 0, HOP_SIZE * sizeof(float));
+    return false;
+  }
+
   // Reconstruct full spectrum with Hermitian symmetry
   for (int i = 0; i < NUM_BINS; i++) {
     fftBuffer_[i] = std::complex<float>(realIn[i], imagIn[i]);
@@ -133,6 +148,7 @@ void STFTProcessor::reconstructAudio(const float *realIn, const float *imagIn,
                (FFT_SIZE - HOP_SIZE) * sizeof(float));
   std::memset(overlapBuffer_ + FFT_SIZE - HOP_SIZE, 0,
               HOP_SIZE * sizeof(float));
+  return true;
 }
 
 } // namespace poise
@@ -8,6 +8,7 @@
 #ifndef STFT_H
 #define STFT_H
 
+#include "memory_accounting.h"
 #include <cmath>
 #include <complex>
 #include <vector>
@@ -32,16 +33,20 @@ public:
    * @param audioChunk Input audio samples (HOP_SIZE = 256 samples)
    * @param realOut Output real parts (NUM_BINS = 257 values)
    * @param imagOut Output imaginary parts (NUM_BINS = 257 values)
+   * @return false if the input contained NaN/Inf (scrubbed to zero)
    */
-  void computeSTFT(const float *audioChunk, float *realOut, float *imagOut);
+  bool computeSTFT(const float *audioChunk, float *realOut, float *imagOut);
 
   /**
    * Reconstruct audio from STFT frame using overlap-add.
    * @param realIn Input real parts (NUM_BINS = 257 values)
    * @param imagIn Input imaginary parts (NUM_BINS = 257 values)
    * @param audioOut Output audio samples (HOP_SIZE = 256 samples)
+   * @return false if the spectrum contained NaN/Inf. The overlap-add
+   *         buffer is then reset and audioOut is silence, so the caller
+   *         should reset its model state as well.
    */
-  void reconstructAudio(const float *realIn, const float *imagIn,
+  bool reconstructAudio(const float *realIn, const float *imagIn,
                         float *audioOut);
 
   /**
@@ -49,7 +54,13 @@ public:
    */
   void reset();
 
+  // Charge the buffers to a stream (nullptr detaches)
+  void attachMemory(StreamMetrics *stream) { memory_.attach(stream); }
+
 private:
+  // Runs this stream's transforms in a lane of a multi-stream pass
+  template <int LANES> friend class BatchSTFTProcessor;
+
   // Sqrt-Hanning window
   float window_[FFT_SIZE];
 
@@ -62,6 +73,8 @@ private:
   // FFT working buffers
   std::complex<float> fftBuffer_[FFT_SIZE];
 
+  MemoryCharge memory_{MemoryComponent::STFT};
+
   // Initialize window
   void initWindow();
 
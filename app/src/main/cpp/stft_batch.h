@@ -0,0 +1,74 @@
+/**
+ * Cross-Stream Batched STFT - Header
+ *
+ * Lane-per-stream STFT/iSTFT for multi-stream hosts: up to LANES streams
+ * with the same FFT size, hop and window are transformed together, each
+ * SIMD lane holding one stream's sample. Work buffers use a transposed SoA
+ * layout, buffer[index][lane], so every inner loop runs over lanes with
+ * shared twiddles and is branch-free.
+ *
+ * The streams keep their own STFTProcessor state: it is gathered into the
+ * lanes before a pass and written back after, so a stream can move between
+ * batches, or run alone, from one frame to the next.
+ *
+ * Instantiated for 4, 8 and 16 lanes.
+ */
+
+#ifndef STFT_BATCH_H
+#define STFT_BATCH_H
+
+#include "stft.h"
+#include <cstdint>
+
+namespace poise {
+
+/**
+ * Batched equivalent of STFTProcessor::computeSTFT/reconstructAudio. Output
+ * matches the single-stream transform to float rounding (~1e-4 per bin).
+ * Holds only shared tables and scratch; one instance per thread.
+ */
+template <int LANES> class BatchSTFTProcessor {
+public:
+  static constexpr int FFT_SIZE = STFTProcessor::FFT_SIZE;
+  static constexpr int HOP_SIZE = STFTProcessor::HOP_SIZE;
+  static constexpr int NUM_BINS = STFTProcessor::NUM_BINS;
+
+  BatchSTFTProcessor();
+
+  /**
+   * Forward STFT of one hop for count (<= LANES) streams.
+   * @param streams Analysis state of each stream, advanced by one hop
+   * @param audio HOP_SIZE samples per stream
+   * @param real, imag NUM_BINS outputs per stream
+   * @return Bit l set if stream l's input contained NaN/Inf (scrubbed)
+   */
+  uint32_t computeSTFT(STFTProcessor *const *streams,
+                       const float *const *audio, int count,
+                       float *const *real, float *const *imag);
+
+  /**
+   * Inverse STFT with overlap-add for count (<= LANES) streams.
+   * @return Bit l set if stream l's spectrum contained NaN/Inf; as with
+   *         reconstructAudio, its overlap-add state is reset and its
+   *         output is silence
+   */
+  uint32_t reconstructAudio(STFTProcessor *const *streams,
+                            const float *const *real,
+                            const float *const *imag, int count,
+                            float *const *audio);
+
+private:
+  void fft(bool inverse);
+
+  float window_[FFT_SIZE];
+  float twiddleRe_[FFT_SIZE / 2];
+  float twiddleIm_[FFT_SIZE / 2];
+  int bitReverse_[FFT_SIZE];
+
+  alignas(64) float re_[FFT_SIZE][LANES];
+  alignas(64) float im_[FFT_SIZE][LANES];
+};
+
+} // namespace poise
+
+#endif // STFT_BATCH_H
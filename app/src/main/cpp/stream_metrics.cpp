@@ -0,0 +1,118 @@
+/**
+ * Stream Metrics - Implementation
+ */
+
+#include "stream_metrics.h"
+
+namespace poise {
+
+constexpr double LatencyHistogram::BOUNDS_MS[];
+
+void LatencyHistogram::observe(double ms) {
+  int bucket = 0;
+  while (bucket < NUM_BUCKETS - 1 && ms > BOUNDS_MS[bucket]) {
+    bucket++;
+  }
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sumNs_.fetch_add(static_cast<uint64_t>(ms * 1.0e6),
+                   std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sumNs_.store(0, std::memory_order_relaxed);
+}
+
+constexpr double DbHistogram::NOISE_REDUCTION_BOUNDS_DB[];
+constexpr double DbHistogram::SPEECH_RETENTION_BOUNDS_DB[];
+
+void DbHistogram::observe(double db) {
+  int bucket = 0;
+  while (bucket < NUM_BUCKETS - 1 && db > bounds_[bucket]) {
+    bucket++;
+  }
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sumMilliDb_.fetch_add(static_cast<int64_t>(db * 1000.0),
+                        std::memory_order_relaxed);
+}
+
+void DbHistogram::reset() {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sumMilliDb_.store(0, std::memory_order_relaxed);
+}
+
+void StreamMetrics::clear() {
+  framesTotal.store(0, std::memory_order_relaxed);
+  framesInferred.store(0, std::memory_order_relaxed);
+  framesBypassed.store(0, std::memory_order_relaxed);
+  neuralVadBypassed.store(0, std::memory_order_relaxed);
+  stateEvictions.store(0, std::memory_order_relaxed);
+  deadlineMisses.store(0, std::memory_order_relaxed);
+  underruns.store(0, std::memory_order_relaxed);
+  nonFiniteEvents.store(0, std::memory_order_relaxed);
+  stateResets.store(0, std::memory_order_relaxed);
+  framesLowBenefit.store(0, std::memory_order_relaxed);
+  stateResidentBytes.store(0, std::memory_order_relaxed);
+  for (int c = 0; c < NUM_MEMORY_COMPONENTS; c++) {
+    memoryBytes[c].store(0, std::memory_order_relaxed);
+    memoryPeakBytes[c].store(0, std::memory_order_relaxed);
+  }
+  memoryTotalBytes.store(0, std::memory_order_relaxed);
+  memoryPeakTotalBytes.store(0, std::memory_order_relaxed);
+  inferenceLatency.reset();
+  noiseReduction.reset();
+  speechRetention.reset();
+}
+
+MetricsRegistry &MetricsRegistry::instance() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+int64_t MetricsRegistry::nextStreamId() {
+  static std::atomic<int64_t> next{1};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+StreamMetrics *MetricsRegistry::acquire(int64_t streamId, const char *model) {
+  for (auto &slot : slots_) {
+    bool expected = false;
+    if (slot.inUse.compare_exchange_strong(expected, true,
+                                           std::memory_order_acq_rel)) {
+      slot.clear();
+      slot.streamId.store(streamId, std::memory_order_relaxed);
+      slot.model.store(model, std::memory_order_release);
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+void MetricsRegistry::release(StreamMetrics *metrics) {
+  if (metrics != nullptr) {
+    metrics->inUse.store(false, std::memory_order_release);
+  }
+}
+
+void MetricsRegistry::resetMemoryPeaks() {
+  for (auto &slot : slots_) {
+    for (int c = 0; c < NUM_MEMORY_COMPONENTS; c++) {
+      slot.memoryPeakBytes[c].store(
+          slot.memoryBytes[c].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    slot.memoryPeakTotalBytes.store(
+        slot.memoryTotalBytes.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+  }
+}
+
+} // namespace poise
@@ -0,0 +1,166 @@
+/**
+ * Stream Metrics - Header
+ *
+ * Lock-free per-stream counters, gauges and latency histograms. Audio
+ * threads only perform relaxed atomic updates; collectors read snapshots
+ * without any lock.
+ */
+
+#ifndef STREAM_METRICS_H
+#define STREAM_METRICS_H
+
+#include "memory_accounting.h"
+#include <atomic>
+#include <cstdint>
+
+namespace poise {
+
+/**
+ * Fixed-bucket latency histogram (milliseconds).
+ */
+class LatencyHistogram {
+public:
+  static constexpr int NUM_BUCKETS = 10;
+  // Upper bounds in ms; the last bucket is +Inf
+  static constexpr double BOUNDS_MS[NUM_BUCKETS - 1] = {
+      0.5, 1.0, 2.0, 4.0, 8.0, 10.0, 16.0, 32.0, 64.0};
+
+  void observe(double ms);
+  void reset();
+
+  uint64_t bucketCount(int bucket) const {
+    return buckets_[bucket].load(std::memory_order_relaxed);
+  }
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  double sumMs() const {
+    return static_cast<double>(sumNs_.load(std::memory_order_relaxed)) /
+           1.0e6;
+  }
+
+private:
+  std::atomic<uint64_t> buckets_[NUM_BUCKETS] = {};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sumNs_{0};
+};
+
+/**
+ * Fixed-bucket histogram of a level in dB. Bounds are per instance so one
+ * class serves quantities with different ranges.
+ */
+class DbHistogram {
+public:
+  static constexpr int NUM_BUCKETS = 8;
+  // Upper bounds in dB; the last bucket is +Inf
+  static constexpr double NOISE_REDUCTION_BOUNDS_DB[NUM_BUCKETS - 1] = {
+      0.0, 3.0, 6.0, 10.0, 15.0, 20.0, 30.0};
+  static constexpr double SPEECH_RETENTION_BOUNDS_DB[NUM_BUCKETS - 1] = {
+      -20.0, -12.0, -9.0, -6.0, -3.0, -1.0, -0.25};
+
+  explicit DbHistogram(const double *bounds) : bounds_(bounds) {}
+
+  void observe(double db);
+  void reset();
+
+  double bound(int bucket) const { return bounds_[bucket]; }
+  uint64_t bucketCount(int bucket) const {
+    return buckets_[bucket].load(std::memory_order_relaxed);
+  }
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  double sumDb() const {
+    return static_cast<double>(sumMilliDb_.load(std::memory_order_relaxed)) /
+           1000.0;
+  }
+
+private:
+  const double *bounds_;
+  std::atomic<uint64_t> buckets_[NUM_BUCKETS] = {};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<int64_t> sumMilliDb_{0};
+};
+
+/**
+ * Metrics for a single stream. Lives in a static registry slot so
+ * collectors can read it without coordinating with stream teardown.
+ */
+struct StreamMetrics {
+  std::atomic<bool> inUse{false};
+  std::atomic<int64_t> streamId{0};
+  std::atomic<const char *> model{""};
+
+  // Counters
+  std::atomic<uint64_t> framesTotal{0};
+  std::atomic<uint64_t> framesInferred{0};
+  std::atomic<uint64_t> framesBypassed{0};
+  std::atomic<uint64_t> neuralVadBypassed{0};
+  std::atomic<uint64_t> stateEvictions{0};
+  std::atomic<uint64_t> deadlineMisses{0};
+  std::atomic<uint64_t> underruns{0};
+  std::atomic<uint64_t> nonFiniteEvents{0};
+  std::atomic<uint64_t> stateResets{0};
+  std::atomic<uint64_t> framesLowBenefit{0};
+
+  // Gauges
+  std::atomic<int64_t> stateResidentBytes{0};
+
+  // Native heap bytes charged to this stream (see MemoryCharge)
+  std::atomic<int64_t> memoryBytes[NUM_MEMORY_COMPONENTS] = {};
+  std::atomic<int64_t> memoryPeakBytes[NUM_MEMORY_COMPONENTS] = {};
+  std::atomic<int64_t> memoryTotalBytes{0};
+  std::atomic<int64_t> memoryPeakTotalBytes{0};
+
+  // Time spent in model inference per frame
+  LatencyHistogram inferenceLatency;
+
+  // Per-frame estimates for inferred frames (see EnhancementMetrics)
+  DbHistogram noiseReduction{DbHistogram::NOISE_REDUCTION_BOUNDS_DB};
+  DbHistogram speechRetention{DbHistogram::SPEECH_RETENTION_BOUNDS_DB};
+
+  void clear();
+};
+
+/**
+ * Process-wide registry of stream metric slots.
+ */
+class MetricsRegistry {
+public:
+  static constexpr int MAX_STREAMS = 64;
+
+  static MetricsRegistry &instance();
+
+  // Process-wide stream id; every stream type draws from the same counter
+  // so ids are unique as metric labels and as cold state pool keys
+  static int64_t nextStreamId();
+
+  /**
+   * Claim a slot for a stream.
+   * @param model Static label string (e.g. "legacy", "gtcrn")
+   * @return nullptr if all slots are taken (metrics are then skipped)
+   */
+  StreamMetrics *acquire(int64_t streamId, const char *model);
+
+  void release(StreamMetrics *metrics);
+
+  // Restart per-stream memory peaks from current values
+  void resetMemoryPeaks();
+
+  // Slot access for collectors; check inUse before reading
+  const StreamMetrics &slot(int index) const { return slots_[index]; }
+
+private:
+  MetricsRegistry() = default;
+
+  StreamMetrics slots_[MAX_STREAMS];
+};
+
+// Relaxed increment helpers for hot paths
+inline void metricsInc(std::atomic<uint64_t> &counter, uint64_t n = 1) {
+  counter.fetch_add(n, std::memory_order_relaxed);
+}
+
+inline void metricsSet(std::atomic<int64_t> &gauge, int64_t value) {
+  gauge.store(value, std::memory_order_relaxed);
+}
+
+} // namespace poise
+
+#endif // STREAM_METRICS_H
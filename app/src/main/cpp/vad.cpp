@@ -6,12 +6,12 @@
  */
 
 #include "vad.h"
-#include <android/log.h>
+#include "async_log.h"
 #include <cmath>
 #include <numeric>
 
 #define LOG_TAG "PoiseVAD"
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) POISE_LOG(poise::LOG_DEBUG, LOG_TAG, __VA_ARGS__)
 
 namespace poise {
 
@@ -27,14 +27,18 @@ VoiceActivityDetector::VoiceActivityDetector(float thresholdDb,
       bypassedFrames_(0) {}
 
 bool VoiceActivityDetector::isSpeech(const std::vector<float> &audio) {
+  return isSpeech(audio.data(), audio.size());
+}
+
+bool VoiceActivityDetector::isSpeech(const float *audio, size_t count) {
   totalFrames_++;
 
   // Calculate RMS energy
   float sumSquares = 0.0f;
-  for (float sample : audio) {
-    sumSquares += sample * sample;
+  for (size_t i = 0; i < count; i++) {
+    sumSquares += audio[i] * audio[i];
   }
-  float rms = std::sqrt(sumSquares / static_cast<float>(audio.size()));
+  float rms = std::sqrt(sumSquares / static_cast<float>(count));
 
   // Check if above threshold
   bool isActive = rms > thresholdLinear_;
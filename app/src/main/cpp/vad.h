@@ -5,6 +5,7 @@
 #ifndef VAD_H
 #define VAD_H
 
+#include <cstddef>
 #include <vector>
 
 namespace poise {
@@ -23,10 +24,14 @@ public:
 
   // Returns true if speech detected, false if silence
   bool isSpeech(const std::vector<float> &audio);
+  bool isSpeech(const float *audio, size_t count);
 
   // Get statistics
   VADStats getStats() const;
 
+  // True while the last frame was speech or within hang time
+  bool isActive() const { return framesSinceActive_ < hangFrames_; }
+
   // Reset state
   void reset();
 
@@ -0,0 +1,59 @@
+package com.poise.android.audio
+
+/**
+ * Native admission control for new processing streams.
+ *
+ * Every native stream constructor asks the controller first, so creating a [PoiseProcessor] or
+ * [GTCRNProcessor] throws [AdmissionRejectedException] once the projected CPU load would exceed the
+ * target. Callers that can run a cheaper model instead call [request] with a fallback beforehand
+ * and construct whichever model was granted.
+ */
+object AdmissionControl {
+
+    const val MODEL_LEGACY = "legacy"
+    const val MODEL_GTCRN = "gtcrn"
+
+    enum class Decision {
+        ADMIT,
+        DOWNGRADE, // Only the fallback model fits
+        REJECT
+    }
+
+    data class Load(
+            val utilizationCores: Float,
+            val streamLoadCores: Float,
+            val budgetCores: Float,
+            val onlineCores: Int
+    )
+
+    init {
+        System.loadLibrary("poise_native")
+    }
+
+    /**
+     * Decide on a stream of [model]. The granted model (or [fallback] after
+     * [Decision.DOWNGRADE]) must be constructed within a few seconds.
+     */
+    fun request(model: String, fallback: String? = null): Decision =
+            Decision.values()[nativeRequest(model, fallback)]
+
+    /** Fraction of the online cores all streams together may use (default 0.75). */
+    fun setTargetUtilization(fraction: Float) = nativeSetTargetUtilization(fraction)
+
+    /** Admit every stream while disabled, e.g. for capacity benchmarks that overload on purpose. */
+    fun setEnabled(enabled: Boolean) = nativeSetEnabled(enabled)
+
+    fun getLoad(): Load {
+        val values = nativeGetStats()
+        return Load(values[0], values[1], values[2], values[3].toInt())
+    }
+
+    private external fun nativeRequest(model: String, fallback: String?): Int
+    private external fun nativeSetTargetUtilization(fraction: Float)
+    private external fun nativeSetEnabled(enabled: Boolean)
+    private external fun nativeGetStats(): FloatArray
+}
+
+/** Thrown by stream constructors when admission control refuses the stream. */
+class AdmissionRejectedException(model: String) :
+        RuntimeException("Not enough CPU for another $model stream")
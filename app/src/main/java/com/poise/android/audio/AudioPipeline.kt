@@ -3,8 +3,11 @@ package com.poise.android.audio
 import android.content.Context
 import android.media.*
 import android.media.projection.MediaProjection
+import android.os.Process
 import android.util.Log
 import com.poise.android.service.AudioServiceState
+import java.io.File
+import java.util.concurrent.locks.LockSupport
 import kotlinx.coroutines.*
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.StateFlow
@@ -13,7 +16,8 @@ import kotlinx.coroutines.flow.asStateFlow
 /** Model selection for audio processing. */
 enum class ProcessorModel {
     GTCRN, // Lightweight (0.34MB), faster, spectrogram-based
-    LEGACY // DeepFilterNet (~10MB), slower, waveform-based
+    LEGACY, // DeepFilterNet (~10MB), slower, waveform-based
+    CASCADE // GTCRN by default, escalates to DeepFilterNet on high residual noise
 }
 
 /**
@@ -24,7 +28,7 @@ enum class ProcessorModel {
  */
 class AudioPipeline(
         private val context: Context,
-        private val model: ProcessorModel = ProcessorModel.GTCRN
+        private val requestedModel: ProcessorModel = ProcessorModel.GTCRN
 ) {
     companion object {
         private const val TAG = "AudioPipeline"
@@ -32,29 +36,46 @@ class AudioPipeline(
         private const val CHANNEL_CONFIG = AudioFormat.CHANNEL_IN_MONO
         private const val AUDIO_FORMAT = AudioFormat.ENCODING_PCM_FLOAT
 
-        // Frame sizes for each model
-        private const val LEGACY_FRAME_SIZE = 480 // 10ms at 48kHz
-        private const val GTCRN_FRAME_SIZE = 256 // 16ms at 16kHz
+        // Playback thread pulls from the playout buffer in 5ms blocks; when racing to idle it
+        // writes one capture burst per wake-up instead
+        private const val PLAYBACK_BLOCK = 240
+
+        // Longest capture burst (IdleGateConfig.maxBurstMs, 200ms)
+        private const val MAX_BURST_SAMPLES = SAMPLE_RATE / 5
+
+        // Capture keeps recording while a burst is processed: room for the longest burst plus as
+        // much again of processing time
+        private const val CAPTURE_BUFFER_SAMPLES = 2 * MAX_BURST_SAMPLES
+
+        // Covers one capture burst plus the time to process it; low-latency mode stays shallow
+        // because the playout target follows the measured arrival jitter
+        private const val PLAYOUT_MAX_DEPTH_MS = 400f
+
+        // A standby that cannot warm up and catch up within this much live audio is abandoned
+        private const val SWITCH_TIMEOUT_MS = 10_000L
     }
 
-    // Frame size depends on model
-    private val frameSize: Int
-        get() =
-                when (model) {
-                    ProcessorModel.GTCRN -> GTCRN_FRAME_SIZE
-                    ProcessorModel.LEGACY -> LEGACY_FRAME_SIZE
-                }
+    // Model actually running; admission control may downgrade the requested one
+    val model: ProcessorModel
+        get() = slot?.model ?: requestedModel
 
     private var audioRecord: AudioRecord? = null
     private var audioTrack: AudioTrack? = null
-    private var legacyProcessor: PoiseProcessor? = null
-    private var gtcrnProcessor: GTCRNProcessor? = null
+    private var slot: ModelSlot? = null
     private var processingJob: Job? = null
-    private var mediaProjection: MediaProjection? = null
 
-    // Resampling buffer for GTCRN (48kHz -> 16kHz)
-    private var resampleBuffer = FloatArray(0)
-    private var resampleAccumulator = mutableListOf<Float>()
+    // Hot switch in flight, and the one whose fade just finished (processing thread)
+    @Volatile private var standby: ModelStandby? = null
+    private var switched: ModelStandby? = null
+    private var idleGate: IdleGate? = null
+    private var burst: BurstScheduler? = null
+    @Volatile private var powerMode = PowerMode.LOW_LATENCY
+    @Volatile private var playbackBlock = PLAYBACK_BLOCK
+    private var trackMinFrames = 0
+    private var playoutBuffer: PlayoutBuffer? = null
+    private var playbackThread: Thread? = null
+    @Volatile private var outputPaused = false
+    private var mediaProjection: MediaProjection? = null
 
     private val _isRunning = MutableStateFlow(false)
     val isRunning: StateFlow<Boolean> = _isRunning.asStateFlow()
@@ -81,20 +102,11 @@ class AudioPipeline(
 
                 try {
                     // Initialize processor based on model selection
-                    when (model) {
-                        ProcessorModel.GTCRN -> {
-                            gtcrnProcessor = GTCRNProcessor(context)
-                            Log.i(TAG, "Using GTCRN model (fast, 0.34MB)")
-                        }
-                        ProcessorModel.LEGACY -> {
-                            legacyProcessor =
-                                    PoiseProcessor(context).also {
-                                        it.setupInputResampler(SAMPLE_RATE)
-                                        it.setupOutputResampler(SAMPLE_RATE)
-                                    }
-                            Log.i(TAG, "Using legacy model (slower, ~10MB)")
-                        }
-                    }
+                    slot = ModelSlot(context, admitModel(requestedModel))
+
+                    // Flight recorder dumps for post-mortem of glitches
+                    val flightDir = File(context.filesDir, "flight").apply { mkdirs() }
+                    NativeMetrics.setFlightRecorderDirectory(flightDir.absolutePath)
 
                     // Setup audio capture
                     setupAudioCapture(projection)
@@ -104,6 +116,7 @@ class AudioPipeline(
 
                     // Start processing loop
                     _isRunning.value = true
+                    startPlaybackThread()
                     processingJob = CoroutineScope(Dispatchers.IO).launch { processAudioLoop() }
 
                     Log.i(TAG, "Audio pipeline started")
@@ -133,7 +146,7 @@ class AudioPipeline(
 
         // Calculate buffer size
         val minBufferSize = AudioRecord.getMinBufferSize(SAMPLE_RATE, CHANNEL_CONFIG, AUDIO_FORMAT)
-        val bufferSize = maxOf(minBufferSize, LEGACY_FRAME_SIZE * 4 * 4) // At least 4 frames
+        val bufferSize = maxOf(minBufferSize, CAPTURE_BUFFER_SAMPLES * 4)
 
         // Create AudioRecord with playback capture
         audioRecord =
@@ -168,9 +181,12 @@ class AudioPipeline(
                         .setChannelMask(AudioFormat.CHANNEL_OUT_MONO)
                         .build()
 
+        // Jitter is absorbed by the adaptive playout buffer, so the track's active buffer stays
+        // minimal. Its capacity holds two bursts so race-to-idle can raise it (setPowerMode)
         val minBufferSize =
                 AudioTrack.getMinBufferSize(SAMPLE_RATE, AudioFormat.CHANNEL_OUT_MONO, AUDIO_FORMAT)
-        val bufferSize = maxOf(minBufferSize, LEGACY_FRAME_SIZE * 4 * 4)
+        val bufferSize = maxOf(minBufferSize, 2 * MAX_BURST_SAMPLES * 4)
+        trackMinFrames = minBufferSize / 4
 
         audioTrack =
                 AudioTrack.Builder()
@@ -181,26 +197,105 @@ class AudioPipeline(
                         .setPerformanceMode(AudioTrack.PERFORMANCE_MODE_LOW_LATENCY)
                         .build()
 
+        audioTrack?.bufferSizeInFrames = trackMinFrames
         audioTrack?.play()
         Log.i(TAG, "AudioTrack started: $SAMPLE_RATE Hz, low-latency mode")
+
+        playoutBuffer = PlayoutBuffer(SAMPLE_RATE, maxDepthMs = PLAYOUT_MAX_DEPTH_MS)
+    }
+
+    private fun startPlaybackThread() {
+        val track = audioTrack ?: return
+        val playout = playoutBuffer ?: return
+        playbackThread = Thread({ playbackLoop(track, playout) }, "PoisePlayback").apply { start() }
+    }
+
+    private fun playbackLoop(track: AudioTrack, playout: PlayoutBuffer) {
+        Process.setThreadPriority(Process.THREAD_PRIORITY_URGENT_AUDIO)
+        val block = FloatArray(MAX_BURST_SAMPLES)
+        while (_isRunning.value) {
+            if (outputPaused) {
+                LockSupport.park(this)
+                continue
+            }
+            // Always a full block: concealment fills in when processing falls behind
+            val count = playbackBlock
+            playout.pull(block, count)
+            track.write(block, 0, count, AudioTrack.WRITE_BLOCKING)
+        }
+    }
+
+    private fun pauseOutput() {
+        outputPaused = true
+        audioTrack?.pause()
+        audioTrack?.flush()
+    }
+
+    private fun resumeOutput() {
+        audioTrack?.play()
+        outputPaused = false
+        playbackThread?.let { LockSupport.unpark(it) }
+    }
+
+    /**
+     * Switch the running pipeline to [target] without a gap in the output.
+     *
+     * The target is loaded and warmed on the live input by a background [ModelStandby] while the
+     * current model keeps playing; the processing thread then crossfades to it at a hop boundary
+     * and hands the old model back to the standby thread to be released. Returns false if the
+     * pipeline is not running, already runs [target], or a switch is already in flight.
+     */
+    fun switchModel(target: ProcessorModel): Boolean {
+        val current = slot ?: return false
+        if (!_isRunning.value || standby != null || switched != null) return false
+        val admitted =
+                try {
+                    admitModel(target)
+                } catch (e: AdmissionRejectedException) {
+                    Log.w(TAG, "Switch to $target rejected: ${e.message}")
+                    return false
+                }
+        if (admitted == current.model) return false
+
+        Log.i(TAG, "Switching ${current.model} -> $admitted")
+        standby =
+                ModelStandby(context, admitted, SAMPLE_RATE, current.frameSize).also { it.start() }
+        return true
+    }
+
+    /**
+     * Trade output latency for battery life. [PowerMode.RACE_TO_IDLE] reads ~160 ms of capture per
+     * wake-up and processes it back to back, so the CPU can sleep between bursts. The playback
+     * thread then writes one burst per wake-up into a track buffer of two bursts, so output
+     * latency grows by about that much. Takes effect at the processing thread's next read.
+     */
+    fun setPowerMode(mode: PowerMode) {
+        if (powerMode != mode) Log.i(TAG, "Power mode: $mode")
+        powerMode = mode
     }
 
     private suspend fun processAudioLoop() {
         // For GTCRN: read at 48kHz, resample to 16kHz, process 256 samples
         // For Legacy: read and process 480 samples at 48kHz directly
-        val readSize =
-                when (model) {
-                    ProcessorModel.GTCRN -> 256 * 3 // ~768 samples at 48kHz = 256 at 16kHz
-                    ProcessorModel.LEGACY -> LEGACY_FRAME_SIZE
-                }
-        val inputBuffer = FloatArray(readSize)
+        var readSize = slot?.frameSize ?: return
+        var gate = IdleGate(SAMPLE_RATE, readSize).also { idleGate = it }
+        val scheduler = BurstScheduler(SAMPLE_RATE).also { burst = it }
+        var captureBuffer = FloatArray(gate.maxReadSamples)
+        var inputBuffer = FloatArray(readSize)
         var statsUpdateCounter = 0
+        var lastUnderrunCount = audioTrack?.underrunCount ?: 0
 
         while (_isRunning.value && currentCoroutineContext().isActive) {
             try {
-                // Read from capture
+                if (scheduler.mode != powerMode) {
+                    scheduler.mode = powerMode
+                    applyBurst(scheduler, gate, readSize)
+                }
+
+                // One frame (or burst) while active; one ~100ms probe block while idle
+                val toRead = gate.readSamples
                 val readResult =
-                        audioRecord?.read(inputBuffer, 0, readSize, AudioRecord.READ_BLOCKING)
+                        audioRecord?.read(captureBuffer, 0, toRead, AudioRecord.READ_BLOCKING)
                                 ?: continue
 
                 if (readResult < 0) {
@@ -208,48 +303,61 @@ class AudioPipeline(
                     continue
                 }
 
-                if (readResult < readSize) {
+                if (readResult < toRead) {
                     continue // Not enough samples
                 }
 
-                // Process based on model
-                val processedAudio =
-                        when (model) {
-                            ProcessorModel.GTCRN -> processGTCRN(inputBuffer)
-                            ProcessorModel.LEGACY -> legacyProcessor?.processFrame(inputBuffer)
-                        }
-
-                if (processedAudio != null && processedAudio.isNotEmpty()) {
-                    // For GTCRN: output is at 16kHz, need to upsample to 48kHz
-                    val outputAudio =
-                            when (model) {
-                                ProcessorModel.GTCRN -> upsample16kTo48k(processedAudio)
-                                ProcessorModel.LEGACY -> processedAudio
-                            }
-
-                    // Apply output volume from UI slider
-                    val volume = AudioServiceState.outputVolume.value
-                    for (i in outputAudio.indices) {
-                        outputAudio[i] = (outputAudio[i] * volume).coerceIn(-1f, 1f)
+                scheduler.beginBurst()
+                when (gate.observe(captureBuffer, toRead)) {
+                    IdleGate.Event.IDLE -> {
+                        scheduler.endBurst(toRead)
+                        continue
+                    }
+                    IdleGate.Event.ENTER_IDLE -> {
+                        // Nothing to play: let the output stream stop pulling, and move the
+                        // model state out of the resident heap until the signal returns
+                        pauseOutput()
+                        slot?.parkState()
+                        scheduler.endBurst(toRead)
+                        publishStats()
+                        continue
+                    }
+                    IdleGate.Event.WAKE -> {
+                        resumeOutput()
+                        playoutBuffer?.resync()
+                        // Skip the silent frames that preceded the signal
+                        processFrames(captureBuffer, gate.wakeOffset, toRead, readSize, inputBuffer)
                     }
+                    IdleGate.Event.ACTIVE, IdleGate.Event.SILENT -> {
+                        processFrames(captureBuffer, 0, toRead, readSize, inputBuffer)
+                    }
+                }
+                scheduler.endBurst(toRead)
+
+                // Forward track and playout underruns to the native flight recorder
+                val underrunCount =
+                        (audioTrack?.underrunCount ?: 0) + (playoutBuffer?.underruns ?: 0)
+                if (underrunCount > lastUnderrunCount) {
+                    lastUnderrunCount = underrunCount
+                    slot?.reportUnderrun()
+                }
 
-                    audioTrack?.write(outputAudio, 0, outputAudio.size, AudioTrack.WRITE_BLOCKING)
+                // The fade has finished: continue in the new model's frame size
+                switched?.let { done ->
+                    switched = null
+                    gate = done.gate
+                    readSize = done.frameSize
+                    applyBurst(scheduler, gate, readSize)
+                    captureBuffer = done.captureBuffer
+                    inputBuffer = done.inputBuffer
+                    finishSwitch(done)
                 }
 
                 // Update stats
                 statsUpdateCounter++
                 if (statsUpdateCounter >= 10) {
                     statsUpdateCounter = 0
-                    val stats =
-                            when (model) {
-                                ProcessorModel.GTCRN -> gtcrnProcessor?.getStats()
-                                ProcessorModel.LEGACY -> legacyProcessor?.getStats()
-                            }
-                    stats?.let {
-                        _stats.value = it
-                        _latestRtf.value = it.rtf
-                        AudioServiceState.updateStats(it)
-                    }
+                    publishStats()
                 }
             } catch (e: Exception) {
                 Log.e(TAG, "Processing error: ${e.message}")
@@ -257,48 +365,182 @@ class AudioPipeline(
         }
     }
 
-    /** Simple 48kHz to 16kHz downsampling (take every 3rd sample). */
-    private fun downsample48kTo16k(input: FloatArray): FloatArray {
-        val output = FloatArray(input.size / 3)
-        for (i in output.indices) {
-            output[i] = input[i * 3]
+    /** Size capture reads, playback writes and the track's active buffer for the power mode. */
+    private fun applyBurst(scheduler: BurstScheduler, gate: IdleGate, frameSize: Int) {
+        gate.activeFrames = scheduler.burstFrames(frameSize)
+        val burstSamples = gate.activeFrames * frameSize
+        if (scheduler.mode == PowerMode.RACE_TO_IDLE) {
+            playbackBlock = minOf(burstSamples, MAX_BURST_SAMPLES)
+            audioTrack?.bufferSizeInFrames = 2 * playbackBlock
+        } else {
+            playbackBlock = PLAYBACK_BLOCK
+            audioTrack?.bufferSizeInFrames = trackMinFrames
+        }
+    }
+
+    /**
+     * Process the frames of a capture block from [first] on, back to back. A switch whose fade
+     * ends mid-block keeps going through the standby, which takes the old frame size.
+     */
+    private fun processFrames(
+            capture: FloatArray,
+            first: Int,
+            count: Int,
+            frameSize: Int,
+            inputBuffer: FloatArray
+    ) {
+        for (frame in first until count / frameSize) {
+            System.arraycopy(capture, frame * frameSize, inputBuffer, 0, frameSize)
+            processAndPlay(inputBuffer)
+        }
+    }
+
+    private fun processAndPlay(inputBuffer: FloatArray) {
+        standby?.let {
+            processSwitching(it, inputBuffer)
+            return
         }
-        return output
+        val outputAudio = slot?.process(inputBuffer) ?: return
+        play(outputAudio, outputAudio.size)
     }
 
-    /** Simple 16kHz to 48kHz upsampling (linear interpolation). */
-    private fun upsample16kTo48k(input: FloatArray): FloatArray {
-        val output = FloatArray(input.size * 3)
-        for (i in input.indices) {
-            val baseIdx = i * 3
-            output[baseIdx] = input[i]
-            if (i < input.size - 1) {
-                val next = input[i + 1]
-                output[baseIdx + 1] = input[i] + (next - input[i]) / 3f
-                output[baseIdx + 2] = input[i] + (next - input[i]) * 2f / 3f
-            } else {
-                output[baseIdx + 1] = input[i]
-                output[baseIdx + 2] = input[i]
+    private fun play(outputAudio: FloatArray, count: Int) {
+        // Apply output volume from UI slider
+        val volume = AudioServiceState.outputVolume.value
+        for (i in 0 until count) {
+            outputAudio[i] = (outputAudio[i] * volume).coerceIn(-1f, 1f)
+        }
+
+        // The playback thread paces output; a slow frame here is absorbed by the buffer
+        playoutBuffer?.push(outputAudio, count)
+    }
+
+    /**
+     * One capture frame while a switch is in flight. Until the standby is warm the old model plays
+     * alone and the standby gets a copy of the input; once adopted, both models run here and the
+     * crossfade decides what is played.
+     */
+    private fun processSwitching(next: ModelStandby, inputBuffer: FloatArray) {
+        val current = slot ?: return
+        val fade = next.crossfade
+        next.offer(inputBuffer, inputBuffer.size)
+
+        if (!next.isAdopted) {
+            if (next.isFailed || next.offeredMs > SWITCH_TIMEOUT_MS) {
+                Log.w(TAG, "Switch to ${next.target} abandoned")
+                standby = null
+                next.close()
+            } else if (next.tryAdopt(inputBuffer.size)) {
+                // This frame starts on a hop boundary; the new model has already consumed the
+                // partial frame of input queued before it
+                fade.start(next.queuedInput - inputBuffer.size)
+            }
+            if (!next.isAdopted) {
+                current.process(inputBuffer)?.let { play(it, it.size) }
+                return
             }
         }
-        return output
+
+        if (!fade.isDone) current.process(inputBuffer)?.let { fade.pushOutgoing(it) }
+        while (next.pollFrame()) next.slot.process(next.frame)?.let { fade.pushIncoming(it) }
+        play(next.pullBuffer, fade.pull(next.pullBuffer))
+        if (fade.isDone) switched = next
+    }
+
+    /**
+     * Make the adopted standby's model current. The old model, gate and crossfade are released on
+     * the standby thread; the partial frame still queued there is completed from the capture so
+     * that reads line up with the new model's frames.
+     */
+    private fun finishSwitch(next: ModelStandby) {
+        val old = slot
+        val oldGate = idleGate
+        slot = next.slot
+        idleGate = next.gate
+        standby = null
+        if (next.crossfade.droppedSamples > 0) {
+            Log.w(TAG, "Crossfade dropped ${next.crossfade.droppedSamples} samples")
+        }
+        next.retire(old, oldGate, next.crossfade)
+
+        val frameSize = next.frameSize
+        val inputBuffer = next.inputBuffer
+        val leftover = next.drainInput(inputBuffer)
+        if (leftover > 0) {
+            val needed = frameSize - leftover
+            val read =
+                    audioRecord?.read(inputBuffer, leftover, needed, AudioRecord.READ_BLOCKING)
+                            ?: 0
+            if (read == needed) processAndPlay(inputBuffer)
+        }
+        Log.i(TAG, "Switched to ${next.target}")
+    }
+
+    private fun publishStats() {
+        slot?.getStats()?.let {
+            val gate = idleGate
+            val playout = playoutBuffer?.getStats()
+            val scheduler = burst
+            val withOutput =
+                    it.copy(
+                            isIdle = gate?.isIdle ?: false,
+                            idleMs = gate?.idleMs ?: 0L,
+                            playoutLatencyMs = playout?.avgLatencyMs ?: 0f,
+                            playoutUnderruns = playout?.underruns ?: 0,
+                            powerMode = scheduler?.mode ?: PowerMode.LOW_LATENCY,
+                            wakeupsPerSecond = scheduler?.getStats()?.wakeupsPerSecond ?: 0f
+                    )
+            _stats.value = withOutput
+            _latestRtf.value = withOutput.rtf
+            AudioServiceState.updateStats(withOutput)
+        }
     }
 
-    /** Process audio through GTCRN model with downsampling. */
-    private fun processGTCRN(input48k: FloatArray): FloatArray? {
-        // Downsample 48kHz -> 16kHz
-        val input16k = downsample48kTo16k(input48k)
-        return gtcrnProcessor?.processFrame(input16k)
+    /**
+     * Ask admission control for [requested]. The legacy model falls back to GTCRN when only that
+     * fits; a rejection aborts start().
+     */
+    private fun admitModel(requested: ProcessorModel): ProcessorModel {
+        val decision =
+                when (requested) {
+                    ProcessorModel.LEGACY ->
+                            AdmissionControl.request(
+                                    AdmissionControl.MODEL_LEGACY,
+                                    fallback = AdmissionControl.MODEL_GTCRN
+                            )
+                    ProcessorModel.GTCRN, ProcessorModel.CASCADE ->
+                            AdmissionControl.request(AdmissionControl.MODEL_GTCRN)
+                }
+        return when (decision) {
+            AdmissionControl.Decision.ADMIT -> requested
+            AdmissionControl.Decision.DOWNGRADE -> {
+                Log.w(TAG, "Admission control downgraded $requested to GTCRN")
+                ProcessorModel.GTCRN
+            }
+            AdmissionControl.Decision.REJECT ->
+                    throw AdmissionRejectedException(requested.name.lowercase())
+        }
     }
 
     /** Stop audio capture and processing. */
     fun stop() {
         _isRunning.value = false
 
-        processingJob?.cancel()
+        // Both threads use the native handles freed below, so wait until they have exited.
+        // Stopping the recorder first returns a blocking read at once.
+        audioRecord?.stop()
+        processingJob?.let { runBlocking { it.cancelAndJoin() } }
         processingJob = null
 
-        audioRecord?.stop()
+        // Wake a parked playback thread so it sees the stop; a blocking write returns within one
+        // block
+        playbackThread?.let {
+            LockSupport.unpark(it)
+            it.join()
+        }
+        playbackThread = null
+        outputPaused = false
+
         audioRecord?.release()
         audioRecord = null
 
@@ -306,11 +548,22 @@ class AudioPipeline(
         audioTrack?.release()
         audioTrack = null
 
-        gtcrnProcessor?.close()
-        gtcrnProcessor = null
+        playoutBuffer?.close()
+        playoutBuffer = null
+
+        // A switch in flight: frees the standby model, and after adoption its crossfade
+        standby?.close()
+        standby = null
+        switched = null
+
+        slot?.close()
+        slot = null
 
-        legacyProcessor?.close()
-        legacyProcessor = null
+        idleGate?.close()
+        idleGate = null
+
+        burst?.close()
+        burst = null
 
         mediaProjection?.stop()
         mediaProjection = null
@@ -320,9 +573,6 @@ class AudioPipeline(
 
     /** Reset processor state (clears ONNX model state). */
     fun resetProcessor() {
-        when (model) {
-            ProcessorModel.GTCRN -> gtcrnProcessor?.reset()
-            ProcessorModel.LEGACY -> legacyProcessor?.reset()
-        }
+        slot?.reset()
     }
 }
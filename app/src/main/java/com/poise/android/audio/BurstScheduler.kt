@@ -0,0 +1,72 @@
+package com.poise.android.audio
+
+/** How the processing loop trades output latency for wake-ups; ordinals match the native enum. */
+enum class PowerMode {
+    LOW_LATENCY, // One frame per wake-up, 10-16 ms
+    RACE_TO_IDLE // One ~160 ms burst per wake-up, processed back to back
+}
+
+/**
+ * Native capture scheduler for [PowerMode].
+ *
+ * [burstFrames] says how many model frames the loop should read per wake-up; the loop brackets
+ * each read's processing with [beginBurst] / [endBurst] so the scheduler can report wake-ups, busy
+ * time and process CPU time per second of audio. Used by the processing thread only.
+ */
+class BurstScheduler(sampleRate: Int, burstMs: Float = 160f) : AutoCloseable {
+
+    companion object {
+        init {
+            System.loadLibrary("poise_native")
+        }
+    }
+
+    private var handle: Long = nativeInit(sampleRate, burstMs)
+
+    var mode: PowerMode = PowerMode.LOW_LATENCY
+        set(value) {
+            field = value
+            nativeSetMode(handle, value.ordinal)
+        }
+
+    /** Frames per read for a model with [frameSamples]-sample frames; 1 in low-latency mode. */
+    fun burstFrames(frameSamples: Int): Int = nativeBurstFrames(handle, frameSamples)
+
+    fun beginBurst() = nativeBeginBurst(handle)
+
+    /** [samples] of capture were processed and their output pushed. */
+    fun endBurst(samples: Int) = nativeEndBurst(handle, samples)
+
+    data class Stats(
+            val bursts: Long,
+            val audioMs: Float,
+            val wakeupsPerSecond: Float,
+            val busyRatio: Float, // Busy wall time per audio time
+            val cpuMsPerAudioSecond: Float, // Whole process
+            val avgBusyMs: Float,
+            val maxBusyMs: Float
+    )
+
+    fun getStats(): Stats? =
+            nativeGetStats(handle)?.let {
+                Stats(it[1].toLong(), it[2], it[3], it[4], it[5], it[6], it[7])
+            }
+
+    fun resetStats() = nativeResetStats(handle)
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0
+        }
+    }
+
+    private external fun nativeInit(sampleRate: Int, burstMs: Float): Long
+    private external fun nativeSetMode(handle: Long, mode: Int)
+    private external fun nativeBurstFrames(handle: Long, frameSamples: Int): Int
+    private external fun nativeBeginBurst(handle: Long)
+    private external fun nativeEndBurst(handle: Long, samples: Int)
+    private external fun nativeGetStats(handle: Long): FloatArray?
+    private external fun nativeResetStats(handle: Long)
+    private external fun nativeDestroy(handle: Long)
+}
@@ -0,0 +1,145 @@
+package com.poise.android.audio
+
+import android.content.Context
+import android.util.Log
+
+/** Snapshot of the native cascade controller. */
+data class CascadeStats(
+        val stage: Int, // 0 = light, 1 = warming heavy, 2 = heavy
+        val residualNoiseDb: Float,
+        val heavyDutyRatio: Float,
+        val escalations: Int
+)
+
+/**
+ * Content-adaptive model cascade. GTCRN (light) runs every frame; the legacy DeepFilterNet model
+ * (heavy) takes over only while the native controller estimates high residual noise in the light
+ * output, and otherwise runs at a low duty cycle so its recurrent state stays warm. Outputs are
+ * crossfaded natively on stage changes.
+ *
+ * Works on the pipeline's 48 kHz frames (768 samples = one GTCRN hop); the heavy model's 480-sample
+ * frames are bridged with small FIFOs. The FIFOs hand back the previous pipeline frame, so the heavy
+ * path lags the input by one frame; the native mixer delays whichever path is earlier so the two
+ * outputs line up.
+ *
+ * @param lightLatency Latency of the light model's 48 kHz output, in samples
+ */
+class CascadeProcessor(
+        context: Context,
+        escalateDb: Float = -30f,
+        holdMs: Int = 5000,
+        warmDuty: Int = 8,
+        lightLatency: Int = 0
+) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "CascadeProcessor"
+        private const val HEAVY_FRAME_SIZE = 480
+        private const val LIGHT_FRAME_MS = 16
+        private const val PIPELINE_FRAME_SIZE = 768
+
+        init {
+            System.loadLibrary("poise_native")
+        }
+    }
+
+    private val heavy = PoiseProcessor(context)
+    private var handle: Long =
+            nativeCascadeInit(
+                    escalateDb,
+                    holdMs / LIGHT_FRAME_MS,
+                    warmDuty,
+                    lightLatency,
+                    PIPELINE_FRAME_SIZE
+            )
+
+    // FIFOs bridging 768-sample pipeline frames and 480-sample heavy frames
+    private val heavyIn = FloatArray(HEAVY_FRAME_SIZE * 4)
+    private var heavyInCount = 0
+    private val heavyOut = FloatArray(HEAVY_FRAME_SIZE * 8)
+    private var heavyOutCount = 0
+    private val heavyFrame = FloatArray(HEAVY_FRAME_SIZE)
+
+    init {
+        Log.i(TAG, "Cascade initialized: escalate at $escalateDb dB, hold ${holdMs}ms")
+    }
+
+    /**
+     * Blend one frame.
+     *
+     * @param input48k Raw input frame
+     * @param light48k Light model output for the same frame (same length)
+     */
+    fun processFrame(input48k: FloatArray, light48k: FloatArray): FloatArray {
+        if (handle == 0L) return light48k
+
+        val heavyOutput = if (nativeCascadeDecide(handle)) runHeavy(input48k) else null
+        return nativeCascadeMix(handle, light48k, heavyOutput)
+    }
+
+    private fun runHeavy(input: FloatArray): FloatArray? {
+        // Queue input (drop oldest on overflow)
+        if (heavyInCount + input.size > heavyIn.size) heavyInCount = 0
+        System.arraycopy(input, 0, heavyIn, heavyInCount, input.size)
+        heavyInCount += input.size
+
+        while (heavyInCount >= HEAVY_FRAME_SIZE) {
+            System.arraycopy(heavyIn, 0, heavyFrame, 0, HEAVY_FRAME_SIZE)
+            System.arraycopy(heavyIn, HEAVY_FRAME_SIZE, heavyIn, 0, heavyInCount - HEAVY_FRAME_SIZE)
+            heavyInCount -= HEAVY_FRAME_SIZE
+
+            val processed = heavy.processFrame(heavyFrame) ?: continue
+            if (heavyOutCount + processed.size > heavyOut.size) heavyOutCount = 0
+            System.arraycopy(processed, 0, heavyOut, heavyOutCount, processed.size)
+            heavyOutCount += processed.size
+        }
+
+        if (heavyOutCount < input.size) return null
+        val frame = heavyOut.copyOf(input.size)
+        System.arraycopy(heavyOut, input.size, heavyOut, 0, heavyOutCount - input.size)
+        heavyOutCount -= input.size
+        return frame
+    }
+
+    /** Park the heavy model's state; see [PoiseProcessor.parkState]. */
+    fun parkState() = heavy.parkState()
+
+    fun getCascadeStats(): CascadeStats? {
+        val values = nativeCascadeGetStats(handle) ?: return null
+        return CascadeStats(values[0].toInt(), values[1], values[2], values[3].toInt())
+    }
+
+    fun reset() {
+        heavy.reset()
+        heavyInCount = 0
+        heavyOutCount = 0
+        nativeCascadeReset(handle)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeCascadeDestroy(handle)
+            handle = 0
+        }
+        heavy.close()
+        Log.i(TAG, "CascadeProcessor closed")
+    }
+
+    // Native methods
+    private external fun nativeCascadeInit(
+            escalateDb: Float,
+            holdFrames: Int,
+            warmDuty: Int,
+            lightDelay: Int,
+            heavyDelay: Int
+    ): Long
+    private external fun nativeCascadeDecide(handle: Long): Boolean
+    private external fun nativeCascadeMix(
+            handle: Long,
+            light: FloatArray,
+            heavy: FloatArray?
+    ): FloatArray
+    private external fun nativeCascadeGetStats(handle: Long): FloatArray?
+    private external fun nativeCascadeReset(handle: Long)
+    private external fun nativeCascadeDestroy(handle: Long)
+}
@@ -0,0 +1,114 @@
+package com.poise.android.audio
+
+import android.content.Context
+import android.util.Log
+import java.util.concurrent.ConcurrentHashMap
+
+/**
+ * Serves GTCRN denoising to other local processes.
+ *
+ * Clients connect to a Unix domain socket for control only (see the native daemon_client.h);
+ * audio flows through per-stream shared-memory rings, never through the socket. Every stream
+ * runs against the model loaded once in [ModelRegistry] and keeps its own caches and STFT
+ * state. Clients must send 16 kHz audio in 256-sample frames. With many clients, a compact
+ * [stateFormat] halves the per-stream state footprint.
+ *
+ * Only processes running as this app's uid, or one of the uids passed to [start], may connect;
+ * other clients are rejected when they connect. Native clients use the poise_daemon_stream_* C
+ * API (poise_api.h).
+ */
+class DenoiseDaemon(
+        private val context: Context,
+        private val stateFormat: StateFormat = StateFormat.FP32
+) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "DenoiseDaemon"
+
+        /** Abstract-namespace socket name used when none is given. */
+        const val DEFAULT_SOCKET = "@poise_denoise"
+
+        init {
+            System.loadLibrary("poise_native")
+        }
+    }
+
+    private val streams = ConcurrentHashMap<Int, GTCRNProcessor>()
+    private var handle: Long = 0
+
+    val isRunning: Boolean
+        get() = handle != 0L
+
+    /** Number of client streams currently open. */
+    val streamCount: Int
+        get() = if (handle != 0L) nativeStreamCount(handle) else 0
+
+    /**
+     * Start listening on [socketPath] ("@name" for the abstract namespace).
+     *
+     * @param allowedUids Client uids accepted besides this app's own
+     * @return false if the socket could not be bound
+     */
+    fun start(socketPath: String = DEFAULT_SOCKET, allowedUids: IntArray? = null): Boolean {
+        if (handle != 0L) return true
+        handle =
+                nativeStart(
+                        socketPath,
+                        GTCRNProcessor.SAMPLE_RATE,
+                        GTCRNProcessor.FRAME_SIZE,
+                        allowedUids
+                )
+        Log.i(TAG, if (handle != 0L) "Listening on $socketPath" else "Failed to start")
+        return handle != 0L
+    }
+
+    /** Stop serving; every open client stream is closed. */
+    fun stop() {
+        if (handle != 0L) {
+            nativeStop(handle)
+            handle = 0
+        }
+    }
+
+    override fun close() {
+        stop()
+        streams.values.forEach { it.close() }
+        streams.clear()
+    }
+
+    // Called from the native daemon control thread
+    @Suppress("unused")
+    private fun onStreamOpened(streamId: Int): Boolean {
+        return try {
+            streams[streamId] = GTCRNProcessor(context, stateFormat = stateFormat)
+            true
+        } catch (e: Exception) {
+            Log.e(TAG, "Failed to open stream $streamId: ${e.message}", e)
+            false
+        }
+    }
+
+    // Called from the native daemon worker thread
+    @Suppress("unused")
+    private fun processFrame(streamId: Int, input: FloatArray, output: FloatArray): Boolean {
+        val processor = streams[streamId] ?: return false
+        val enhanced = processor.processFrame(input) ?: return false
+        enhanced.copyInto(output, endIndex = minOf(enhanced.size, output.size))
+        return true
+    }
+
+    // Called from the native daemon control thread
+    @Suppress("unused")
+    private fun onStreamClosed(streamId: Int) {
+        streams.remove(streamId)?.close()
+    }
+
+    private external fun nativeStart(
+            socketPath: String,
+            sampleRate: Int,
+            frameSamples: Int,
+            allowedUids: IntArray?
+    ): Long
+    private external fun nativeStreamCount(handle: Long): Int
+    private external fun nativeStop(handle: Long)
+}
@@ -15,11 +15,19 @@ import java.io.FileOutputStream
  * - State caching for real-time streaming
  * - Expected RTF < 1.0 on mobile devices
  */
-class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f) : AutoCloseable {
+class GTCRNProcessor(
+        context: Context,
+        private val vadThresholdDb: Float = -40f,
+        private val stateFormat: StateFormat = StateFormat.FP32
+) : AutoCloseable {
 
     companion object {
         private const val TAG = "GTCRNProcessor"
-        private const val ONNX_MODEL_NAME = "gtcrn.onnx"
+        const val ONNX_MODEL_NAME = "gtcrn.onnx"
+
+        // Neural VAD gate weights (NeuralVad layout, e.g. tools/vad_prune output). None ship
+        // with the app, so the gate is off unless this asset is added to a build.
+        const val NEURAL_VAD_ASSET = "neural_vad.bin"
 
         // Audio parameters
         const val FRAME_SIZE = 256 // hop_length (samples per frame)
@@ -38,9 +46,75 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
         private val TRA_SHAPE = longArrayOf(2, 3, 1, 1, 16)
         private val INTER_SHAPE = longArrayOf(2, 1, 33, 16)
 
+        // Inferred frames between cache health checks (~0.5 s)
+        private const val CACHE_CHECK_INTERVAL = 30
+
+        private val STATE_SLOT_SIZES = intArrayOf(CONV_CACHE_SIZE, TRA_CACHE_SIZE, INTER_CACHE_SIZE)
+        private val NO_CACHE = FloatArray(0)
+
+        /** FP32 working caches shared by compact-state streams running on the same thread. */
+        private class WorkingCaches {
+            val conv = FloatArray(CONV_CACHE_SIZE)
+            val tra = FloatArray(TRA_CACHE_SIZE)
+            val inter = FloatArray(INTER_CACHE_SIZE)
+        }
+
+        private val workingCaches = ThreadLocal.withInitial { WorkingCaches() }
+
         init {
             System.loadLibrary("poise_native")
         }
+
+        /**
+         * Load the GTCRN model into a new ONNX session. Several processors can share one
+         * session (weights are loaded once); each keeps its own caches and STFT state.
+         * Processors normally get theirs from [ModelRegistry].
+         */
+        fun createSession(context: Context): OrtSession {
+            // Copy model from assets to internal storage
+            val modelFile = File(context.filesDir, ONNX_MODEL_NAME)
+            if (!modelFile.exists()) {
+                context.assets.open(ONNX_MODEL_NAME).use { input ->
+                    FileOutputStream(modelFile).use { output -> input.copyTo(output) }
+                }
+                Log.i(TAG, "Model copied to: ${modelFile.absolutePath}")
+            }
+
+            // Create optimized session options
+            val sessionOptions =
+                    OrtSession.SessionOptions().apply {
+                        // Single thread is faster for small models (less overhead)
+                        setIntraOpNumThreads(1)
+                        setInterOpNumThreads(1)
+
+                        // Maximum optimization
+                        setOptimizationLevel(OrtSession.SessionOptions.OptLevel.ALL_OPT)
+
+                        // Enable memory pattern optimization
+                        setMemoryPatternOptimization(true)
+
+                        // Try XNNPACK first (optimized for ARM), then NNAPI
+                        try {
+                            // XNNPACK is often faster than NNAPI for small models
+                            addXnnpack(mapOf("intra_op_num_threads" to "1"))
+                            Log.i(TAG, "XNNPACK acceleration enabled")
+                        } catch (e: Exception) {
+                            Log.w(TAG, "XNNPACK not available, trying NNAPI: ${e.message}")
+                            try {
+                                addNnapi()
+                                Log.i(TAG, "NNAPI acceleration enabled")
+                            } catch (e2: Exception) {
+                                Log.w(TAG, "NNAPI not available, using CPU: ${e2.message}")
+                            }
+                        }
+                    }
+
+            val session =
+                    OrtEnvironment.getEnvironment()
+                            .createSession(modelFile.absolutePath, sessionOptions)
+            Log.i(TAG, "GTCRN ONNX model loaded (${modelFile.length() / 1024} KB)")
+            return session
+        }
     }
 
     // Native STFT processor handle
@@ -50,10 +124,15 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
     private var ortSession: OrtSession? = null
     private var ortEnv: OrtEnvironment? = null
 
-    // State caches (persisted between frames)
-    private var convCache = FloatArray(CONV_CACHE_SIZE) { 0f }
-    private var traCache = FloatArray(TRA_CACHE_SIZE) { 0f }
-    private var interCache = FloatArray(INTER_CACHE_SIZE) { 0f }
+    // State caches (persisted between frames). With a compact state format they live in
+    // stateStore and these point at the calling thread's working caches during inference.
+    private var stateStore: StateStore? = null
+    private var convCache =
+            if (stateFormat == StateFormat.FP32) FloatArray(CONV_CACHE_SIZE) else NO_CACHE
+    private var traCache =
+            if (stateFormat == StateFormat.FP32) FloatArray(TRA_CACHE_SIZE) else NO_CACHE
+    private var interCache =
+            if (stateFormat == StateFormat.FP32) FloatArray(INTER_CACHE_SIZE) else NO_CACHE
 
     // Pre-allocated buffers to avoid per-frame allocations (MUST be before init block)
     private val mixInputBuffer = FloatArray(514)
@@ -70,16 +149,35 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
     private var totalInferenceTimeMs = 0.0
     private var smoothedInferenceTimeMs = 0.0 // EMA for live stats
     private var vadBypassed = 0
+    private var neuralVadEnabled = false
+    private var neuralVadBypassed = 0
+    private var framesSinceCacheCheck = 0
+
+    // Idle state eviction, see setIdleStateEviction
+    private var evictAfterFrames = 0
+    private var silentFrames = 0
+    private var cachesParked = false
+
+    // Gated frames not yet counted in the native stream metrics (admission cost)
+    private var skippedFrames = 0
 
     init {
         try {
             // Initialize native STFT processor
             stftHandle = nativeSTFTInit()
+            if (stftHandle == 0L) throw AdmissionRejectedException(AdmissionControl.MODEL_GTCRN)
+            if (stateFormat != StateFormat.FP32) {
+                stateStore = StateStore(stateFormat, STATE_SLOT_SIZES)
+            }
             Log.i(TAG, "STFT processor initialized, handle=$stftHandle")
 
             // Load ONNX model
             loadModel(context)
 
+            if (context.assets.list("")?.contains(NEURAL_VAD_ASSET) == true) {
+                enableNeuralVad(context, NEURAL_VAD_ASSET)
+            }
+
             Log.i(TAG, "GTCRNProcessor initialized")
         } catch (e: UnsatisfiedLinkError) {
             Log.e(TAG, "Failed to load native library: ${e.message}", e)
@@ -92,47 +190,8 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
 
     private fun loadModel(context: Context) {
         ortEnv = OrtEnvironment.getEnvironment()
-
-        // Copy model from assets to internal storage
-        val modelFile = File(context.filesDir, ONNX_MODEL_NAME)
-        if (!modelFile.exists()) {
-            context.assets.open(ONNX_MODEL_NAME).use { input ->
-                FileOutputStream(modelFile).use { output -> input.copyTo(output) }
-            }
-            Log.i(TAG, "Model copied to: ${modelFile.absolutePath}")
-        }
-
-        // Create optimized session options
-        val sessionOptions =
-                OrtSession.SessionOptions().apply {
-                    // Single thread is faster for small models (less overhead)
-                    setIntraOpNumThreads(1)
-                    setInterOpNumThreads(1)
-
-                    // Maximum optimization
-                    setOptimizationLevel(OrtSession.SessionOptions.OptLevel.ALL_OPT)
-
-                    // Enable memory pattern optimization
-                    setMemoryPatternOptimization(true)
-
-                    // Try XNNPACK first (optimized for ARM), then NNAPI
-                    try {
-                        // XNNPACK is often faster than NNAPI for small models
-                        addXnnpack(mapOf("intra_op_num_threads" to "1"))
-                        Log.i(TAG, "XNNPACK acceleration enabled")
-                    } catch (e: Exception) {
-                        Log.w(TAG, "XNNPACK not available, trying NNAPI: ${e.message}")
-                        try {
-                            addNnapi()
-                            Log.i(TAG, "NNAPI acceleration enabled")
-                        } catch (e2: Exception) {
-                            Log.w(TAG, "NNAPI not available, using CPU: ${e2.message}")
-                        }
-                    }
-                }
-
-        ortSession = ortEnv?.createSession(modelFile.absolutePath, sessionOptions)
-        Log.i(TAG, "GTCRN ONNX model loaded (${modelFile.length() / 1024} KB)")
+        // Weights are loaded once per process and shared by every processor
+        ortSession = ModelRegistry.acquire(context, ModelRegistry.GTCRN)
     }
 
     // Pre-allocated input/output name arrays
@@ -165,13 +224,25 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
         if (!checkVAD(frame)) {
             vadBypassed++
             frameCount++
+            skippedFrames++
+            if (evictAfterFrames > 0 && ++silentFrames >= evictAfterFrames) parkState()
             return frame // Pass through silent audio
         }
+        silentFrames = 0
+        flushSkipped()
+        if (cachesParked) restoreCaches()
 
         return try {
             // 1. Compute STFT (native) -> 514 floats (257 real + 257 imag)
             val stftResult = nativeComputeSTFT(stftHandle, frame) ?: return frame
 
+            // Neural VAD gate: loud non-speech skips inference
+            if (neuralVadEnabled && !nativeGateSpeech(stftHandle)) {
+                neuralVadBypassed++
+                frameCount++
+                return postProcess(nativeReconstructBypass(stftHandle) ?: frame)
+            }
+
             // 2. Prepare ONNX input: reshape to [1, 257, 1, 2] in pre-allocated buffer
             prepareOnnxInput(stftResult)
 
@@ -193,14 +264,46 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
 
             frameCount++
 
+            // Null means the model produced NaN/Inf: native overlap-add was reset, so drop the
+            // poisoned caches too and output silence for this frame
+            if (enhanced == null) {
+                resetCaches("non-finite output")
+                return FloatArray(FRAME_SIZE)
+            }
+
             // Post-process
-            postProcess(enhanced ?: frame)
+            postProcess(enhanced)
         } catch (e: Exception) {
             Log.e(TAG, "processFrame error: ${e.message}", e)
             frame
         }
     }
 
+    /**
+     * Enable the native neural VAD gate, which runs on the STFT bins of every frame and skips
+     * GTCRN inference when it sees no speech (e.g. loud background noise). Called at init when
+     * the build bundles [NEURAL_VAD_ASSET]; otherwise only the energy VAD runs.
+     *
+     * @param weights Flat float32 weights in the native NeuralVad layout
+     * @return false if the weights were rejected
+     */
+    fun enableNeuralVad(weights: FloatArray): Boolean {
+        neuralVadEnabled = stftHandle != 0L && nativeLoadNeuralVad(stftHandle, weights)
+        Log.i(TAG, "Neural VAD ${if (neuralVadEnabled) "enabled" else "rejected"}")
+        return neuralVadEnabled
+    }
+
+    /** Load neural VAD weights (little-endian float32) from an asset and enable the gate. */
+    fun enableNeuralVad(context: Context, assetName: String): Boolean {
+        val bytes = context.assets.open(assetName).use { it.readBytes() }
+        val weights = FloatArray(bytes.size / 4)
+        java.nio.ByteBuffer.wrap(bytes)
+                .order(java.nio.ByteOrder.LITTLE_ENDIAN)
+                .asFloatBuffer()
+                .get(weights)
+        return enableNeuralVad(weights)
+    }
+
     private fun checkVAD(audio: FloatArray): Boolean {
         // RMS energy calculation
         var sumSquares = 0.0f
@@ -235,6 +338,8 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
         val session = ortSession ?: return null
 
         return try {
+            loadCaches()
+
             // Create input tensors (shapes are constant)
             val mixTensor =
                     OnnxTensor.createTensor(
@@ -273,6 +378,8 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
             traCacheOut.get(traCache)
             interCacheOut.rewind()
             interCacheOut.get(interCache)
+            checkCaches()
+            storeCaches()
 
             // Extract enhanced STFT into pre-allocated buffer
             enhOutput.rewind()
@@ -333,6 +440,8 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
 
     /** Get processing statistics. */
     fun getStats(): ProcessingStats {
+        // Long silences reach the native metrics here rather than at the next speech frame
+        if (stftHandle != 0L) flushSkipped()
         val displayFrames = frameCount
         val vadBypassRatio = if (frameCount > 0) vadBypassed.toFloat() / frameCount else 0f
         val rtf =
@@ -343,6 +452,9 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
                     0f
                 }
 
+        val memory = if (stftHandle != 0L) nativeMemoryUsage(stftHandle) else null
+        val enhancement = if (stftHandle != 0L) nativeEnhancementStats(stftHandle) else null
+
         return ProcessingStats(
                 frameCount = displayFrames,
                 avgTimeMs =
@@ -353,33 +465,162 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
                 vadActive = frameCount - vadBypassed,
                 vadBypassed = vadBypassed,
                 vadBypassRatio = vadBypassRatio,
-                isVadDetected = framesSinceActive < hangFrames // Active if within hang time
+                isVadDetected = framesSinceActive < hangFrames, // Active if within hang time
+                isStateParked = cachesParked,
+                neuralVadBypassed = neuralVadBypassed,
+                neuralVadSavedMs = neuralVadBypassed * smoothedInferenceTimeMs,
+                nativeBytes = memory?.get(0) ?: 0,
+                nativePeakBytes = memory?.get(1) ?: 0,
+                enhancedFrames = enhancement?.get(0)?.toLong() ?: 0,
+                noiseReductionDb = enhancement?.get(1) ?: 0f,
+                speechRetentionDb = enhancement?.get(2) ?: 0f,
+                lowBenefitRatio = enhancement?.get(3) ?: 0f
         )
     }
 
+    /** Bytes of recurrent state this stream keeps between frames. */
+    val stateResidentBytes: Long
+        get() =
+                if (cachesParked) 0
+                else
+                        stateStore?.residentBytes
+                                ?: (CONV_CACHE_SIZE + TRA_CACHE_SIZE + INTER_CACHE_SIZE) * 4L
+
+    /**
+     * Park the model caches in the compressed cold pool after [silenceMs] of continuous VAD
+     * bypass. They are restored before the next inference. 0 disables.
+     */
+    fun setIdleStateEviction(silenceMs: Float) {
+        val frameMs = FRAME_SIZE * 1000f / SAMPLE_RATE
+        evictAfterFrames = if (silenceMs > 0f) maxOf(1, (silenceMs / frameMs).toInt()) else 0
+        silentFrames = 0
+    }
+
+    /**
+     * Move the model caches to the native cold pool (FP16, packed) and drop the resident
+     * copies until the next speech frame. Called on long silence or when capture goes idle.
+     */
+    fun parkState() {
+        if (cachesParked || stftHandle == 0L) return
+        loadCaches()
+        if (!nativeParkCaches(stftHandle, convCache, traCache, interCache)) return
+        stateStore?.close()
+        stateStore = null
+        convCache = NO_CACHE
+        traCache = NO_CACHE
+        interCache = NO_CACHE
+        cachesParked = true
+    }
+
+    /** Bring parked caches back; a missing entry leaves the stream on zeroed caches. */
+    private fun restoreCaches() {
+        cachesParked = false
+        allocateCaches()
+        if (!nativeRestoreCaches(stftHandle, convCache, traCache, interCache)) {
+            Log.w(TAG, "Parked caches lost, continuing from zero state")
+        }
+        storeCaches()
+    }
+
+    /** Give a parked stream fresh caches: its own arrays, or a store plus working copies. */
+    private fun allocateCaches() {
+        if (stateFormat == StateFormat.FP32) {
+            convCache = FloatArray(CONV_CACHE_SIZE)
+            traCache = FloatArray(TRA_CACHE_SIZE)
+            interCache = FloatArray(INTER_CACHE_SIZE)
+        } else {
+            stateStore = StateStore(stateFormat, STATE_SLOT_SIZES)
+            val working = workingCaches.get()!!
+            convCache = working.conv
+            traCache = working.tra
+            interCache = working.inter
+        }
+    }
+
+    /** Report an output underrun so the native flight recorder captures the window. */
+    fun reportUnderrun() {
+        if (stftHandle != 0L) {
+            nativeReportUnderrun(stftHandle)
+        }
+    }
+
+    /** Report frames the energy gate skipped; one JNI call per silence run, not per frame. */
+    private fun flushSkipped() {
+        if (skippedFrames == 0) return
+        nativeCountSkipped(stftHandle, skippedFrames)
+        skippedFrames = 0
+    }
+
+    /** Point the caches at this thread's working copies and decode the compact state. */
+    private fun loadCaches() {
+        val store = stateStore ?: return
+        val working = workingCaches.get()!!
+        convCache = working.conv
+        traCache = working.tra
+        interCache = working.inter
+        store.load(0, convCache)
+        store.load(1, traCache)
+        store.load(2, interCache)
+    }
+
+    private fun storeCaches() {
+        val store = stateStore ?: return
+        store.store(0, convCache)
+        store.store(1, traCache)
+        store.store(2, interCache)
+    }
+
+    /** Every [CACHE_CHECK_INTERVAL] inferred frames, scan the new caches for NaN/Inf or drift. */
+    private fun checkCaches() {
+        if (++framesSinceCacheCheck < CACHE_CHECK_INTERVAL) return
+        framesSinceCacheCheck = 0
+        if (nativeCheckCaches(stftHandle, convCache, traCache, interCache)) {
+            resetCaches("failed health check")
+        }
+    }
+
+    private fun resetCaches(reason: String) {
+        convCache.fill(0f)
+        traCache.fill(0f)
+        interCache.fill(0f)
+        stateStore?.clear()
+        framesSinceCacheCheck = 0
+        Log.w(TAG, "Model caches reset: $reason")
+    }
+
     /** Reset processor state. */
     fun reset() {
+        if (cachesParked) {
+            allocateCaches()
+            cachesParked = false
+        }
+        silentFrames = 0
+        skippedFrames = 0
         convCache.fill(0f)
         traCache.fill(0f)
         interCache.fill(0f)
+        stateStore?.clear()
+        framesSinceCacheCheck = 0
         nativeSTFTReset(stftHandle)
         frameCount = 0
         totalInferenceTimeMs = 0.0
         smoothedInferenceTimeMs = 0.0
         vadBypassed = 0
+        neuralVadBypassed = 0
         framesSinceActive = hangFrames + 1
         Log.i(TAG, "GTCRNProcessor reset")
     }
 
     override fun close() {
-        ortSession?.close()
+        ortSession?.let { ModelRegistry.release(it) }
         ortSession = null
-        ortEnv?.close()
         ortEnv = null
         if (stftHandle != 0L) {
             nativeSTFTDestroy(stftHandle)
             stftHandle = 0
         }
+        stateStore?.close()
+        stateStore = null
         Log.i(TAG, "GTCRNProcessor closed")
     }
 
@@ -388,5 +629,30 @@ class GTCRNProcessor(context: Context, private val vadThresholdDb: Float = -40f)
     private external fun nativeComputeSTFT(handle: Long, audioChunk: FloatArray): FloatArray?
     private external fun nativeReconstruct(handle: Long, stftData: FloatArray): FloatArray?
     private external fun nativeSTFTReset(handle: Long)
+    private external fun nativeReportUnderrun(handle: Long)
+    private external fun nativeCountSkipped(handle: Long, frames: Int)
+    private external fun nativeCheckCaches(
+            handle: Long,
+            convCache: FloatArray,
+            traCache: FloatArray,
+            interCache: FloatArray
+    ): Boolean
+    private external fun nativeParkCaches(
+            handle: Long,
+            convCache: FloatArray,
+            traCache: FloatArray,
+            interCache: FloatArray
+    ): Boolean
+    private external fun nativeRestoreCaches(
+            handle: Long,
+            convCache: FloatArray,
+            traCache: FloatArray,
+            interCache: FloatArray
+    ): Boolean
+    private external fun nativeLoadNeuralVad(handle: Long, weights: FloatArray): Boolean
+    private external fun nativeGateSpeech(handle: Long): Boolean
+    private external fun nativeReconstructBypass(handle: Long): FloatArray?
     private external fun nativeSTFTDestroy(handle: Long)
+    private external fun nativeMemoryUsage(handle: Long): LongArray
+    private external fun nativeEnhancementStats(handle: Long): FloatArray?
 }
@@ -0,0 +1,90 @@
+package com.poise.android.audio
+
+/**
+ * Native capture-side idle detector.
+ *
+ * After [enterAfterMs] of digital silence the capture loop should stop output and read
+ * [readSamples] (one probe block, about [probeIntervalMs] long) per wake-up instead of one frame.
+ * The first probe block with signal reports [Event.WAKE]; frames from [wakeOffset] on should be
+ * processed right away.
+ *
+ * While active the loop reads [activeFrames] frames per wake-up: one normally, a burst of them in
+ * [PowerMode.RACE_TO_IDLE].
+ */
+class IdleGate(
+        sampleRate: Int,
+        private val frameSamples: Int,
+        silenceDb: Float = -90f,
+        enterAfterMs: Float = 2000f,
+        probeIntervalMs: Float = 100f
+) : AutoCloseable {
+
+    enum class Event {
+        ACTIVE,
+        SILENT,
+        ENTER_IDLE,
+        IDLE,
+        WAKE
+    }
+
+    companion object {
+        init {
+            System.loadLibrary("poise_native")
+        }
+    }
+
+    private var handle: Long =
+            nativeInit(sampleRate, frameSamples, silenceDb, enterAfterMs, probeIntervalMs)
+
+    /** Largest block [readSamples] can ask for; size capture buffers with this. */
+    val maxReadSamples: Int = maxOf(nativeMaxReadSamples(handle), frameSamples)
+
+    /** Frames per read while active; clamped natively to a 200 ms burst. */
+    var activeFrames: Int = 1
+        set(value) {
+            field = if (handle != 0L) nativeSetActiveFrames(handle, value) else 1
+        }
+
+    /** Samples to read next: [activeFrames] frames while active, one probe block while idle. */
+    val readSamples: Int
+        get() = if (handle != 0L) nativeReadSamples(handle) else frameSamples
+
+    /** After [Event.WAKE], index of the first frame in the probe block that carries signal. */
+    val wakeOffset: Int
+        get() = nativeWakeOffset(handle)
+
+    fun observe(samples: FloatArray, count: Int): Event {
+        if (handle == 0L) return Event.ACTIVE
+        return Event.values()[nativeObserve(handle, samples, count)]
+    }
+
+    val isIdle: Boolean
+        get() = (nativeGetStats(handle)?.get(0) ?: 0f) > 0f
+
+    /** Total time spent idle, in milliseconds. */
+    val idleMs: Long
+        get() = nativeGetStats(handle)?.get(1)?.toLong() ?: 0L
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0
+        }
+    }
+
+    private external fun nativeInit(
+            sampleRate: Int,
+            frameSamples: Int,
+            silenceDb: Float,
+            enterAfterMs: Float,
+            probeIntervalMs: Float
+    ): Long
+    private external fun nativeObserve(handle: Long, samples: FloatArray, count: Int): Int
+    private external fun nativeReadSamples(handle: Long): Int
+    private external fun nativeProbeSamples(handle: Long): Int
+    private external fun nativeMaxReadSamples(handle: Long): Int
+    private external fun nativeSetActiveFrames(handle: Long, frames: Int): Int
+    private external fun nativeWakeOffset(handle: Long): Int
+    private external fun nativeGetStats(handle: Long): FloatArray?
+    private external fun nativeDestroy(handle: Long)
+}
@@ -0,0 +1,58 @@
+package com.poise.android.audio
+
+/**
+ * Native sample-aligned crossfade from one model's output to another's during a hot switch.
+ *
+ * Both models' output is queued; [pull] releases the mix where both have produced audio, then the
+ * incoming model alone. Storage is allocated in the constructor, so every other call is safe on
+ * the processing thread. Only that thread may use it between construction and [close].
+ */
+internal class ModelCrossfade(sampleRate: Int, fadeMs: Float, maxBlock: Int) : AutoCloseable {
+
+    companion object {
+        init {
+            System.loadLibrary("poise_native")
+        }
+    }
+
+    private var handle: Long = nativeInit(sampleRate, fadeMs, maxBlock)
+
+    /**
+     * Start mixing. The next outgoing block begins on a hop boundary; the incoming model has
+     * already consumed [skipIncoming] samples of input before it, so that much of its next output
+     * is dropped.
+     */
+    fun start(skipIncoming: Int) = nativeStart(handle, skipIncoming)
+
+    fun pushOutgoing(samples: FloatArray, count: Int = samples.size) =
+            nativePushOutgoing(handle, samples, count)
+
+    fun pushIncoming(samples: FloatArray, count: Int = samples.size) =
+            nativePushIncoming(handle, samples, count)
+
+    /** Fill [out] with as much released output as is ready; returns the sample count. */
+    fun pull(out: FloatArray): Int = nativePull(handle, out)
+
+    val isDone: Boolean
+        get() = nativeIsDone(handle)
+
+    /** Samples lost because a queue overflowed; non-zero means the two models drifted apart. */
+    val droppedSamples: Int
+        get() = nativeDroppedSamples(handle)
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0
+        }
+    }
+
+    private external fun nativeInit(sampleRate: Int, fadeMs: Float, maxBlock: Int): Long
+    private external fun nativeStart(handle: Long, skipIncoming: Int)
+    private external fun nativePushOutgoing(handle: Long, samples: FloatArray, count: Int)
+    private external fun nativePushIncoming(handle: Long, samples: FloatArray, count: Int)
+    private external fun nativePull(handle: Long, out: FloatArray): Int
+    private external fun nativeIsDone(handle: Long): Boolean
+    private external fun nativeDroppedSamples(handle: Long): Int
+    private external fun nativeDestroy(handle: Long)
+}
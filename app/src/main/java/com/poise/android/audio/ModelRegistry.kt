@@ -0,0 +1,102 @@
+package com.poise.android.audio
+
+import ai.onnxruntime.OrtSession
+import android.content.Context
+import android.os.SystemClock
+import android.util.Log
+import java.io.File
+
+/**
+ * Process-wide cache of loaded models.
+ *
+ * Each model is parsed, optimized and prepacked into one ONNX session the first time a stream
+ * needs it; later streams get the same session, so the weights exist once however many streams
+ * run. Sessions are immutable and safe to run from several threads at once. Each stream keeps
+ * only its own recurrent state and scratch buffers, which makes creating a stream cheap.
+ *
+ * Sessions stay loaded after their last stream closes so a restart does not pay the load again;
+ * [trim] frees the unused ones.
+ */
+object ModelRegistry {
+    private const val TAG = "ModelRegistry"
+
+    const val GTCRN = "gtcrn"
+    const val LEGACY = "legacy"
+
+    data class ModelInfo(
+            val name: String,
+            val references: Int,
+            val loadMs: Double,
+            val modelBytes: Long
+    )
+
+    private class Entry(val session: OrtSession, val loadMs: Double, val modelBytes: Long) {
+        var references = 0
+    }
+
+    private val entries = HashMap<String, Entry>()
+
+    /**
+     * Get the shared session for [model], loading it on first use. Every call must be matched by
+     * [release].
+     */
+    @Synchronized
+    fun acquire(context: Context, model: String): OrtSession {
+        val entry =
+                entries[model]
+                        ?: load(context.applicationContext, model).also {
+                            entries[model] = it
+                            reportMemory()
+                        }
+        entry.references++
+        return entry.session
+    }
+
+    @Synchronized
+    fun release(session: OrtSession) {
+        val entry = entries.values.firstOrNull { it.session === session } ?: return
+        if (entry.references > 0) entry.references--
+    }
+
+    /**
+     * Close sessions no stream is using.
+     *
+     * @return number of models unloaded
+     */
+    @Synchronized
+    fun trim(): Int {
+        val unused = entries.filterValues { it.references == 0 }
+        for ((name, entry) in unused) {
+            entry.session.close()
+            entries.remove(name)
+            Log.i(TAG, "Unloaded $name")
+        }
+        if (unused.isNotEmpty()) reportMemory()
+        return unused.size
+    }
+
+    @Synchronized
+    fun models(): List<ModelInfo> =
+            entries.map { (name, e) -> ModelInfo(name, e.references, e.loadMs, e.modelBytes) }
+
+    /** Keep the native `onnx_model` memory component in step with the loaded models. */
+    private fun reportMemory() {
+        NativeMemory.setModelBytes(entries.values.sumOf { it.modelBytes })
+    }
+
+    private fun load(context: Context, model: String): Entry {
+        val start = SystemClock.elapsedRealtimeNanos()
+        val (session, fileName) =
+                when (model) {
+                    GTCRN ->
+                            GTCRNProcessor.createSession(context) to GTCRNProcessor.ONNX_MODEL_NAME
+                    LEGACY ->
+                            PoiseProcessor.createSession(context) to PoiseProcessor.ONNX_MODEL_NAME
+                    else -> throw IllegalArgumentException("Unknown model: $model")
+                }
+        val loadMs = (SystemClock.elapsedRealtimeNanos() - start) / 1e6
+        val bytes = File(context.filesDir, fileName).length()
+        Log.i(TAG, "Loaded $model once for all streams (${"%.1f".format(loadMs)} ms, $bytes bytes)")
+        return Entry(session, loadMs, bytes)
+    }
+}
@@ -0,0 +1,186 @@
+package com.poise.android.audio
+
+import android.content.Context
+import android.util.Log
+
+/**
+ * One model's processing chain at the pipeline's 48 kHz rate: a capture frame in, enhanced audio
+ * out. The pipeline normally runs one slot; during a hot model switch it runs two side by side.
+ *
+ * Constructing a slot loads and initializes the model, so do it off the processing thread.
+ */
+internal class ModelSlot(context: Context, requested: ProcessorModel) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "ModelSlot"
+        const val SAMPLE_RATE = 48000
+        private const val MODEL_RATE_16K = 16000
+
+        // 48 kHz capture samples per model frame
+        private const val LEGACY_FRAME_SIZE = PoiseProcessor.FRAME_SIZE // 10ms at 48kHz
+        private const val GTCRN_FRAME_SIZE = GTCRNProcessor.FRAME_SIZE * 3 // 16ms, 256 at 16kHz
+
+        // Silence after which a stream's model state moves to the compressed cold pool
+        private const val IDLE_STATE_EVICTION_MS = 2000f
+
+        fun frameSizeFor(model: ProcessorModel): Int =
+                when (model) {
+                    ProcessorModel.GTCRN, ProcessorModel.CASCADE -> GTCRN_FRAME_SIZE
+                    ProcessorModel.LEGACY -> LEGACY_FRAME_SIZE
+                }
+    }
+
+    // Model actually running; the cascade may fall back to GTCRN alone
+    var model: ProcessorModel = requested
+        private set
+
+    private var legacyProcessor: PoiseProcessor? = null
+    private var gtcrnProcessor: GTCRNProcessor? = null
+    private var cascadeProcessor: CascadeProcessor? = null
+
+    // 48 <-> 16 kHz around GTCRN, with their per-frame buffers
+    private var downsampler: Resampler? = null
+    private var upsampler: Resampler? = null
+    private var input16k = FloatArray(0)
+    private var output48k = FloatArray(0)
+
+    init {
+        when (requested) {
+            ProcessorModel.GTCRN -> {
+                gtcrnProcessor = GTCRNProcessor(context)
+                Log.i(TAG, "Using GTCRN model (fast, 0.34MB)")
+            }
+            ProcessorModel.LEGACY -> {
+                legacyProcessor =
+                        PoiseProcessor(context).also {
+                            it.setupInputResampler(SAMPLE_RATE)
+                            it.setupOutputResampler(SAMPLE_RATE)
+                            it.setIdleStateEviction(IDLE_STATE_EVICTION_MS)
+                        }
+                Log.i(TAG, "Using legacy model (slower, ~10MB)")
+            }
+            ProcessorModel.CASCADE -> {
+                gtcrnProcessor = GTCRNProcessor(context)
+            }
+        }
+        gtcrnProcessor?.setIdleStateEviction(IDLE_STATE_EVICTION_MS)
+        if (gtcrnProcessor != null) {
+            downsampler = Resampler(SAMPLE_RATE, MODEL_RATE_16K)
+            upsampler = Resampler(MODEL_RATE_16K, SAMPLE_RATE)
+            input16k = FloatArray(GTCRNProcessor.FRAME_SIZE)
+            output48k = FloatArray(GTCRN_FRAME_SIZE)
+            Log.i(TAG, "Resampling ${downsampler?.describe()}; ${upsampler?.describe()}")
+        }
+        if (requested == ProcessorModel.CASCADE) {
+            try {
+                cascadeProcessor = CascadeProcessor(context, lightLatency = gtcrnLatency())
+                Log.i(TAG, "Using GTCRN -> legacy cascade")
+            } catch (e: AdmissionRejectedException) {
+                // No room for the escalation model; run GTCRN alone
+                model = ProcessorModel.GTCRN
+                Log.w(TAG, "Cascade downgraded to GTCRN: ${e.message}")
+            }
+        }
+    }
+
+    /** Latency of the 48 kHz GTCRN chain in 48 kHz samples: resamplers plus STFT overlap. */
+    private fun gtcrnLatency(): Int {
+        val ratio = SAMPLE_RATE / MODEL_RATE_16K
+        val stftDelay = GTCRNProcessor.FFT_SIZE - GTCRNProcessor.FRAME_SIZE
+        val modelRateDelay = (downsampler?.delaySamples ?: 0f) + stftDelay
+        return Math.round(modelRateDelay * ratio + (upsampler?.delaySamples ?: 0f))
+    }
+
+    /** Capture samples per [process] call. */
+    val frameSize: Int
+        get() = frameSizeFor(model)
+
+    /**
+     * Enhance one frame of [frameSize] samples; the output is at 48 kHz as well and may be a buffer
+     * the next call reuses.
+     */
+    fun process(input48k: FloatArray): FloatArray? {
+        val processed =
+                when (model) {
+                    ProcessorModel.GTCRN, ProcessorModel.CASCADE -> processGTCRN(input48k)
+                    ProcessorModel.LEGACY -> legacyProcessor?.processFrame(input48k)
+                }
+        if (processed == null || processed.isEmpty()) return null
+
+        // For GTCRN: output is at 16kHz, need to upsample to 48kHz
+        return when (model) {
+            ProcessorModel.GTCRN -> upsample16kTo48k(processed)
+            ProcessorModel.LEGACY -> processed
+            ProcessorModel.CASCADE -> {
+                val light = upsample16kTo48k(processed)
+                cascadeProcessor?.processFrame(input48k, light) ?: light
+            }
+        }
+    }
+
+    fun reportUnderrun() {
+        when (model) {
+            ProcessorModel.GTCRN, ProcessorModel.CASCADE -> gtcrnProcessor?.reportUnderrun()
+            ProcessorModel.LEGACY -> legacyProcessor?.reportUnderrun()
+        }
+    }
+
+    /** Park the model state now (e.g. capture went idle); it comes back on the next speech. */
+    fun parkState() {
+        gtcrnProcessor?.parkState()
+        legacyProcessor?.parkState()
+        cascadeProcessor?.parkState()
+    }
+
+    fun getStats(): ProcessingStats? =
+            when (model) {
+                ProcessorModel.GTCRN, ProcessorModel.CASCADE -> gtcrnProcessor?.getStats()
+                ProcessorModel.LEGACY -> legacyProcessor?.getStats()
+            }
+
+    /** Reset processor state (clears ONNX model state). */
+    fun reset() {
+        downsampler?.reset()
+        upsampler?.reset()
+        when (model) {
+            ProcessorModel.GTCRN -> gtcrnProcessor?.reset()
+            ProcessorModel.LEGACY -> legacyProcessor?.reset()
+            ProcessorModel.CASCADE -> {
+                gtcrnProcessor?.reset()
+                cascadeProcessor?.reset()
+            }
+        }
+    }
+
+    override fun close() {
+        gtcrnProcessor?.close()
+        gtcrnProcessor = null
+
+        legacyProcessor?.close()
+        legacyProcessor = null
+
+        cascadeProcessor?.close()
+        cascadeProcessor = null
+
+        downsampler?.close()
+        downsampler = null
+
+        upsampler?.close()
+        upsampler = null
+    }
+
+    /** Process audio through GTCRN model with downsampling. */
+    private fun processGTCRN(input48k: FloatArray): FloatArray? {
+        val resampler = downsampler ?: return null
+        val count = resampler.process(input48k, input48k.size, input16k)
+        if (count < input16k.size) input16k.fill(0f, count)
+        return gtcrnProcessor?.processFrame(input16k)
+    }
+
+    /** GTCRN output back to 48kHz; the returned buffer is reused by the next frame. */
+    private fun upsample16kTo48k(input: FloatArray): FloatArray {
+        val resampler = upsampler ?: return input
+        val count = resampler.process(input, input.size, output48k)
+        return if (count == output48k.size) output48k else output48k.copyOf(count)
+    }
+}
@@ -0,0 +1,261 @@
+package com.poise.android.audio
+
+import android.content.Context
+import android.os.Process
+import android.os.SystemClock
+import android.util.Log
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicLong
+import java.util.concurrent.locks.LockSupport
+
+/**
+ * The target model of a hot switch, loaded and warmed on a low-priority thread.
+ *
+ * The processing thread [offer]s every capture frame while the old model keeps playing. The
+ * standby thread builds the target [ModelSlot] (session, native stream, buffers for its frame
+ * size), then runs it on the live input so its recurrent state converges. Once warm and caught
+ * up, the processing thread [tryAdopt]s it at a hop boundary and from then on runs it itself,
+ * crossfading through [crossfade]; the standby thread only waits to [retire] the old model.
+ *
+ * Everything the processing thread needs during and after the switch is allocated here, so the
+ * switch itself allocates nothing on that thread.
+ */
+internal class ModelStandby(
+        private val context: Context,
+        val target: ProcessorModel,
+        private val sampleRate: Int,
+        outgoingFrameSize: Int,
+        private val warmMs: Float = 1000f,
+        fadeMs: Float = 50f
+) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "ModelStandby"
+        private const val INPUT_SECONDS = 1 // Live input buffered while the standby catches up
+        private const val POLL_NS = 2_000_000L
+
+        private const val LOADING = 0
+        private const val IDLE = 1 // Warm-up thread waiting for input
+        private const val BUSY = 2 // Warm-up thread inside the model
+        private const val ADOPTED = 3 // Owned by the processing thread
+        private const val ABORTED = 4
+        private const val FAILED = 5
+
+        private fun roundUpPow2(value: Int): Int = Integer.highestOneBit(maxOf(value - 1, 1)) shl 1
+    }
+
+    private val state = AtomicInteger(LOADING)
+    private val requestedAtMs = SystemClock.elapsedRealtime()
+
+    // Live input ring, 48 kHz. The processing thread produces; the standby thread consumes until
+    // adoption, the processing thread afterwards.
+    private val input = FloatArray(roundUpPow2(sampleRate * INPUT_SECONDS))
+    private val inputMask = input.size - 1
+    private val writeIndex = AtomicLong(0)
+    private val readIndex = AtomicLong(0)
+    private val overflows = AtomicInteger(0)
+
+    // Built by the standby thread, read by the processing thread after adoption
+    lateinit var slot: ModelSlot
+        private set
+    lateinit var gate: IdleGate
+        private set
+    lateinit var captureBuffer: FloatArray
+        private set
+    lateinit var inputBuffer: FloatArray
+        private set
+    lateinit var frame: FloatArray
+        private set
+
+    val frameSize = ModelSlot.frameSizeFor(target)
+
+    val crossfade = ModelCrossfade(sampleRate, fadeMs, maxOf(frameSize, outgoingFrameSize))
+
+    /** Holds everything [ModelCrossfade.pull] can release at once. */
+    val pullBuffer = FloatArray(roundUpPow2(maxOf(frameSize, outgoingFrameSize) * 4) * 2)
+
+    @Volatile var isWarm = false
+        private set
+
+    // Handed over by the processing thread once the fade is done
+    private val retired = arrayOfNulls<AutoCloseable>(3)
+    @Volatile private var retireReady = false
+    @Volatile private var shutdown = false
+
+    private val thread = Thread(::run, "PoiseStandby")
+
+    fun start() = thread.start()
+
+    val isFailed: Boolean
+        get() = state.get() == FAILED
+
+    val isAdopted: Boolean
+        get() = state.get() == ADOPTED
+
+    val elapsedMs: Long
+        get() = SystemClock.elapsedRealtime() - requestedAtMs
+
+    /** Live input offered so far; unlike [elapsedMs] it does not advance while capture idles. */
+    val offeredMs: Long
+        get() = writeIndex.get() * 1000 / sampleRate
+
+    /** Input samples queued for the target model. */
+    val queuedInput: Int
+        get() = (writeIndex.get() - readIndex.get()).toInt()
+
+    /** Queue live capture (processing thread). Drops what does not fit. */
+    fun offer(samples: FloatArray, count: Int) {
+        val write = writeIndex.get()
+        if (write + count - readIndex.get() > input.size) {
+            overflows.incrementAndGet()
+            return
+        }
+        val start = (write and inputMask.toLong()).toInt()
+        val first = minOf(count, input.size - start)
+        System.arraycopy(samples, 0, input, start, first)
+        System.arraycopy(samples, first, input, 0, count - first)
+        writeIndex.set(write + count)
+    }
+
+    /**
+     * Take the warm model over at the hop boundary before the [justOffered] samples last offered,
+     * if it has consumed all input up to there but a partial frame. Processing thread only.
+     */
+    fun tryAdopt(justOffered: Int): Boolean {
+        if (shutdown || !isWarm || queuedInput - justOffered >= frameSize) return false
+        if (!state.compareAndSet(IDLE, ADOPTED)) return false
+        Log.i(TAG, "Adopting $target after ${elapsedMs} ms")
+        return true
+    }
+
+    /** Move the next full frame of input into [frame]; false if there is none. */
+    fun pollFrame(): Boolean {
+        val read = readIndex.get()
+        if (writeIndex.get() - read < frameSize) return false
+        copyInput(read, frame, 0, frameSize)
+        readIndex.set(read + frameSize)
+        return true
+    }
+
+    /** Move the partial frame left after the switch to the start of [dst]; returns its length. */
+    fun drainInput(dst: FloatArray): Int {
+        val read = readIndex.get()
+        val count = (writeIndex.get() - read).toInt().coerceAtMost(dst.size)
+        copyInput(read, dst, 0, count)
+        readIndex.set(read + count)
+        return count
+    }
+
+    /**
+     * Close the outgoing model's resources on the standby thread, which then exits. Processing
+     * thread only; allocation-free.
+     */
+    fun retire(slot: AutoCloseable?, gate: AutoCloseable?, fade: AutoCloseable?) {
+        retired[0] = slot
+        retired[1] = gate
+        retired[2] = fade
+        retireReady = true
+        LockSupport.unpark(thread)
+    }
+
+    /**
+     * Abandon the switch without blocking. Before adoption the standby thread frees what it built
+     * once its current frame is done; after adoption the caller must have stopped the processing
+     * thread, and everything is freed here.
+     */
+    override fun close() {
+        shutdown = true
+        while (true) {
+            val s = state.get()
+            if (s != LOADING && s != IDLE) break
+            if (state.compareAndSet(s, ABORTED)) break
+        }
+        LockSupport.unpark(thread)
+        if (state.get() == ADOPTED) {
+            closeBuilt()
+            crossfade.close()
+        }
+    }
+
+    private fun run() {
+        Process.setThreadPriority(Process.THREAD_PRIORITY_BACKGROUND)
+        try {
+            slot = ModelSlot(context, target)
+            gate = IdleGate(sampleRate, frameSize)
+            captureBuffer = FloatArray(gate.maxReadSamples)
+            inputBuffer = FloatArray(frameSize)
+            frame = FloatArray(frameSize)
+        } catch (e: Exception) {
+            Log.e(TAG, "Cannot load $target: ${e.message}", e)
+            if (::slot.isInitialized) slot.close()
+            state.set(FAILED)
+            crossfade.close()
+            return
+        }
+        if (shutdown || !state.compareAndSet(LOADING, IDLE)) {
+            abandon()
+            return
+        }
+        Log.i(TAG, "$target loaded in ${elapsedMs} ms, warming up")
+
+        // Warm on contiguous recent input only: drop what piled up during the load
+        readIndex.set(writeIndex.get())
+        val frameMs = frameSize * 1000f / sampleRate
+        val warmFrames = maxOf(1, (warmMs / frameMs).toInt())
+        var warmed = 0
+        var seenOverflows = overflows.get()
+
+        while (!shutdown) {
+            if (queuedInput < frameSize) {
+                LockSupport.parkNanos(this, POLL_NS)
+                if (state.get() != IDLE) break
+                continue
+            }
+            if (!state.compareAndSet(IDLE, BUSY)) break
+            val lost = overflows.get()
+            if (lost != seenOverflows) {
+                // Fell behind: the state saw a gap, so warm-up starts over
+                seenOverflows = lost
+                warmed = 0
+            }
+            if (pollFrame()) {
+                slot.process(frame)
+                warmed++
+            }
+            state.set(IDLE)
+            if (warmed >= warmFrames && !isWarm) {
+                isWarm = true
+                Log.i(TAG, "$target warm after $warmed frames")
+            }
+        }
+
+        if (state.get() != ADOPTED) {
+            state.set(ABORTED)
+            abandon()
+            return
+        }
+        while (!retireReady && !shutdown) LockSupport.park(this)
+        if (retireReady) {
+            for (resource in retired) resource?.close()
+            Log.i(TAG, "Switched to $target; previous model released")
+        }
+    }
+
+    private fun abandon() {
+        closeBuilt()
+        crossfade.close()
+        Log.i(TAG, "Switch to $target abandoned")
+    }
+
+    private fun closeBuilt() {
+        if (::slot.isInitialized) slot.close()
+        if (::gate.isInitialized) gate.close()
+    }
+
+    private fun copyInput(from: Long, dst: FloatArray, offset: Int, count: Int) {
+        val start = (from and inputMask.toLong()).toInt()
+        val first = minOf(count, input.size - start)
+        System.arraycopy(input, start, dst, offset, first)
+        System.arraycopy(input, 0, dst, offset + first, count - first)
+    }
+}
@@ -0,0 +1,51 @@
+package com.poise.android.audio
+
+/**
+ * Controls the native asynchronous logger.
+ *
+ * Native log calls only enqueue a record in a per-thread ring; a background thread formats and
+ * writes them. Records are dropped (and counted) rather than blocking when a ring is full.
+ */
+object NativeLog {
+
+    enum class Sink {
+        LOGCAT,
+        STDERR,
+        FILE
+    }
+
+    // Same values as android.util.Log priorities
+    const val DEBUG = 3
+    const val INFO = 4
+    const val WARN = 5
+    const val ERROR = 6
+
+    init {
+        System.loadLibrary("poise_native")
+    }
+
+    /** Send native logs to logcat (default). */
+    fun toLogcat() = nativeSetSink(Sink.LOGCAT.ordinal, null)
+
+    /** Append native logs to the file at [path]; falls back to stderr if it can't be opened. */
+    fun toFile(path: String) = nativeSetSink(Sink.FILE.ordinal, path)
+
+    /** Drop records below [level] at the call site. */
+    fun setMinLevel(level: Int) = nativeSetMinLevel(level)
+
+    /** Allocate the calling thread's ring now so its first log call does not allocate. */
+    fun prepareThread() = nativePrepareThread()
+
+    /** Write out everything queued so far. */
+    fun flush() = nativeFlush()
+
+    /** Records dropped because a thread logged faster than the writer drained. */
+    val droppedRecords: Long
+        get() = nativeDroppedRecords()
+
+    private external fun nativeSetSink(sink: Int, path: String?)
+    private external fun nativeSetMinLevel(level: Int)
+    private external fun nativePrepareThread()
+    private external fun nativeFlush()
+    private external fun nativeDroppedRecords(): Long
+}
@@ -0,0 +1,46 @@
+package com.poise.android.audio
+
+/**
+ * Native heap use by component, process-wide.
+ *
+ * Components report their footprint as they allocate and free, so reading is cheap and safe from
+ * any thread. Per-stream totals are in [ProcessingStats.nativeBytes]; the per-stream breakdown by
+ * component is exported through [NativeMetrics] as `poise_stream_memory_bytes`.
+ *
+ * Model weights live in ONNX Runtime, whose arenas are not visible from here; [ModelRegistry]
+ * reports the size of the loaded models as the `onnx_model` component instead.
+ */
+object NativeMemory {
+
+    init {
+        System.loadLibrary("poise_native")
+    }
+
+    data class Usage(val currentBytes: Long, val peakBytes: Long)
+
+    private val names: Array<String> by lazy { nativeComponentNames() }
+
+    /** Usage of every component, keyed by name (e.g. `stft`, `flight_recorder`). */
+    fun components(): Map<String, Usage> {
+        val values = nativeUsage()
+        return names.withIndex().associate { (i, name) ->
+            name to Usage(values[i * 2], values[i * 2 + 1])
+        }
+    }
+
+    /** Sum over all components. Its peak is the highest simultaneous total. */
+    fun total(): Usage {
+        val values = nativeUsage()
+        return Usage(values[values.size - 2], values[values.size - 1])
+    }
+
+    /** Restart peak tracking from the current values, e.g. between benchmark phases. */
+    fun resetPeaks() = nativeResetPeaks()
+
+    internal fun setModelBytes(bytes: Long) = nativeSetModelBytes(bytes)
+
+    private external fun nativeComponentNames(): Array<String>
+    private external fun nativeUsage(): LongArray
+    private external fun nativeResetPeaks()
+    private external fun nativeSetModelBytes(bytes: Long)
+}
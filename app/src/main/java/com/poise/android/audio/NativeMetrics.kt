@@ -0,0 +1,34 @@
+package com.poise.android.audio
+
+/**
+ * Native pipeline metrics in OpenMetrics/Prometheus text format.
+ *
+ * Collection reads lock-free snapshots of per-stream counters and latency histograms, so it is
+ * safe to call periodically while audio is running (from a non-audio thread).
+ */
+object NativeMetrics {
+
+    init {
+        System.loadLibrary("poise_native")
+    }
+
+    /** Render the current exposition for all native streams. */
+    fun render(): String = nativeRender()
+
+    /** Write the exposition to [path], replacing it atomically. */
+    fun exportToFile(path: String): Boolean = nativeExportToFile(path)
+
+    /** Send the exposition to a listening Unix domain socket at [socketPath]. */
+    fun exportToSocket(socketPath: String): Boolean = nativeExportToSocket(socketPath)
+
+    /**
+     * Enable flight recorder dumps into [dir]. Recording is always on; when a frame misses its
+     * deadline or an underrun is reported, the last few seconds are written there as CSV.
+     */
+    fun setFlightRecorderDirectory(dir: String) = nativeSetFlightRecorderDir(dir)
+
+    private external fun nativeRender(): String
+    private external fun nativeExportToFile(path: String): Boolean
+    private external fun nativeExportToSocket(socketPath: String): Boolean
+    private external fun nativeSetFlightRecorderDir(dir: String)
+}
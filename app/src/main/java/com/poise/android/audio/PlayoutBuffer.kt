@@ -0,0 +1,84 @@
+package com.poise.android.audio
+
+/** Snapshot of the native playout buffer. */
+data class PlayoutStats(
+        val depthMs: Float,
+        val targetMs: Float,
+        val jitterMs: Float,
+        val avgLatencyMs: Float,
+        val underruns: Int,
+        val concealedMs: Float,
+        val droppedMs: Float,
+        val insertedMs: Float
+)
+
+/**
+ * Adaptive jitter buffer between processing and playback.
+ *
+ * The processing thread [push]es processed audio; a playback thread [pull]s fixed blocks and
+ * writes them to the AudioTrack. The native side sizes its depth from the measured arrival jitter
+ * (for [underrunProbability]), trims or stretches during silence, and conceals underruns. Exactly
+ * one thread may push and one may pull; stop both before [close].
+ */
+class PlayoutBuffer(
+        sampleRate: Int,
+        underrunProbability: Float = 0.01f,
+        maxDepthMs: Float = 200f
+) : AutoCloseable {
+
+    companion object {
+        init {
+            System.loadLibrary("poise_native")
+        }
+    }
+
+    private var handle: Long = nativeInit(sampleRate, underrunProbability, maxDepthMs)
+
+    fun push(samples: FloatArray, count: Int = samples.size) {
+        if (handle != 0L) nativePush(handle, samples, count)
+    }
+
+    /**
+     * Start a new arrival-jitter baseline after the producer paused (e.g. on wake from idle), so
+     * the pause is not taken for jitter. Call from the pushing thread.
+     */
+    fun resync() {
+        if (handle != 0L) nativeResync(handle)
+    }
+
+    /** Fill [count] samples of [out]; returns how many were real (not concealment). */
+    fun pull(out: FloatArray, count: Int = out.size): Int {
+        if (handle == 0L) {
+            out.fill(0f, 0, count)
+            return 0
+        }
+        return nativePull(handle, out, count)
+    }
+
+    val underruns: Int
+        get() = if (handle != 0L) nativeUnderruns(handle) else 0
+
+    fun getStats(): PlayoutStats? {
+        val v = nativeGetStats(handle) ?: return null
+        return PlayoutStats(v[0], v[1], v[2], v[3], v[4].toInt(), v[5], v[6], v[7])
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0
+        }
+    }
+
+    private external fun nativeInit(
+            sampleRate: Int,
+            underrunProbability: Float,
+            maxDepthMs: Float
+    ): Long
+    private external fun nativePush(handle: Long, samples: FloatArray, count: Int)
+    private external fun nativePull(handle: Long, out: FloatArray, count: Int): Int
+    private external fun nativeResync(handle: Long)
+    private external fun nativeGetStats(handle: Long): FloatArray?
+    private external fun nativeUnderruns(handle: Long): Int
+    private external fun nativeDestroy(handle: Long)
+}
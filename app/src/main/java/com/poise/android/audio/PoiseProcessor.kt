@@ -13,25 +13,68 @@ import java.io.FileOutputStream
 class PoiseProcessor(
         context: Context,
         private val vadThresholdDb: Float = -40f,
-        private val attenLimDb: Float = -60f
+        private val attenLimDb: Float = -60f,
+        private val stateFormat: StateFormat = StateFormat.FP32
 ) : AutoCloseable {
 
     companion object {
         private const val TAG = "PoiseProcessor"
-        private const val ONNX_MODEL_NAME = "denoiser_model.onnx"
-        private const val FRAME_SIZE = 480
+        const val ONNX_MODEL_NAME = "denoiser_model.onnx"
+        const val FRAME_SIZE = 480
         private const val STATE_SIZE = 45304
-        private const val SAMPLE_RATE = 48000
+        const val SAMPLE_RATE = 48000
+
+        private val NO_STATE = FloatArray(0)
+
+        /** FP32 working state shared by compact-state streams running on the same thread. */
+        private val workingStates = ThreadLocal.withInitial { FloatArray(STATE_SIZE) }
 
         init {
             System.loadLibrary("poise_native")
         }
+
+        /** Load the legacy model into a new ONNX session; see [ModelRegistry] for sharing. */
+        fun createSession(context: Context): OrtSession {
+            // Copy model from assets to internal storage
+            val modelFile = File(context.filesDir, ONNX_MODEL_NAME)
+            if (!modelFile.exists()) {
+                context.assets.open(ONNX_MODEL_NAME).use { input ->
+                    FileOutputStream(modelFile).use { output -> input.copyTo(output) }
+                }
+                Log.i(TAG, "Model copied to: ${modelFile.absolutePath}")
+            }
+
+            // Create session options for optimized inference
+            val sessionOptions =
+                    OrtSession.SessionOptions().apply {
+                        // Use more threads for parallelism
+                        setIntraOpNumThreads(4)
+                        setOptimizationLevel(OrtSession.SessionOptions.OptLevel.ALL_OPT)
+
+                        // Try to use NNAPI (Android Neural Networks API) for hardware acceleration
+                        try {
+                            addNnapi()
+                            Log.i(TAG, "NNAPI acceleration enabled")
+                        } catch (e: Exception) {
+                            Log.w(TAG, "NNAPI not available, using CPU: ${e.message}")
+                        }
+                    }
+
+            val session =
+                    OrtEnvironment.getEnvironment()
+                            .createSession(modelFile.absolutePath, sessionOptions)
+            Log.i(TAG, "ONNX model loaded")
+            return session
+        }
     }
 
     private var nativeHandle: Long = 0
     private var ortSession: OrtSession? = null
     private var ortEnv: OrtEnvironment? = null
-    private var states: FloatArray = FloatArray(STATE_SIZE) { 0f }
+    // Recurrent state between frames; held in stateStore instead with a compact format
+    private var states: FloatArray =
+            if (stateFormat == StateFormat.FP32) FloatArray(STATE_SIZE) else NO_STATE
+    private var stateStore: StateStore? = null
 
     private var frameCount = 0
     private var totalInferenceTimeMs = 0.0
@@ -40,6 +83,10 @@ class PoiseProcessor(
         try {
             // Initialize native processor
             nativeHandle = nativeInit(vadThresholdDb, attenLimDb)
+            if (nativeHandle == 0L) throw AdmissionRejectedException(AdmissionControl.MODEL_LEGACY)
+            if (stateFormat != StateFormat.FP32) {
+                stateStore = StateStore(stateFormat, intArrayOf(STATE_SIZE))
+            }
             Log.i(TAG, "Native processor initialized, handle=$nativeHandle")
 
             // Load ONNX model
@@ -57,34 +104,8 @@ class PoiseProcessor(
 
     private fun loadModel(context: Context) {
         ortEnv = OrtEnvironment.getEnvironment()
-
-        // Copy model from assets to internal storage
-        val modelFile = File(context.filesDir, ONNX_MODEL_NAME)
-        if (!modelFile.exists()) {
-            context.assets.open(ONNX_MODEL_NAME).use { input ->
-                FileOutputStream(modelFile).use { output -> input.copyTo(output) }
-            }
-            Log.i(TAG, "Model copied to: ${modelFile.absolutePath}")
-        }
-
-        // Create session options for optimized inference
-        val sessionOptions =
-                OrtSession.SessionOptions().apply {
-                    // Use more threads for parallelism
-                    setIntraOpNumThreads(4)
-                    setOptimizationLevel(OrtSession.SessionOptions.OptLevel.ALL_OPT)
-
-                    // Try to use NNAPI (Android Neural Networks API) for hardware acceleration
-                    try {
-                        addNnapi()
-                        Log.i(TAG, "NNAPI acceleration enabled")
-                    } catch (e: Exception) {
-                        Log.w(TAG, "NNAPI not available, using CPU: ${e.message}")
-                    }
-                }
-
-        ortSession = ortEnv?.createSession(modelFile.absolutePath, sessionOptions)
-        Log.i(TAG, "ONNX model loaded")
+        // Weights are loaded once per process and shared by every processor
+        ortSession = ModelRegistry.acquire(context, ModelRegistry.LEGACY)
     }
 
     /** Setup resampler for input audio if device sample rate differs from model. */
@@ -131,15 +152,22 @@ class PoiseProcessor(
             val isSpeech = nativeCheckVAD(nativeHandle, preprocessed)
             if (!isSpeech) {
                 vadBypassed++
+                if (evictAfterFrames > 0 && ++silentFrames >= evictAfterFrames) parkState()
                 // Still apply post-processing for consistent output
-                return nativePostProcess(nativeHandle, preprocessed)
+                return nativePostProcess(nativeHandle, preprocessed, null)
             }
+            silentFrames = 0
+            if (stateParked) restoreState()
 
             // Run ONNX inference
-            val enhanced = runOnnxInference(preprocessed) ?: preprocessed
-
-            // Post-process (native)
-            nativePostProcess(nativeHandle, enhanced)
+            val enhanced = runOnnxInference(preprocessed)
+            val newStates = pendingStates
+            pendingStates = null
+
+            // Post-process (native); the new state is health-checked before it is kept
+            val output = nativePostProcess(nativeHandle, enhanced ?: preprocessed, newStates)
+            newStates?.let { commitStates(it) }
+            output
         } catch (e: Exception) {
             Log.e(TAG, "processFrame error: ${e.message}", e)
             inputFrame // Return original on error
@@ -150,6 +178,14 @@ class PoiseProcessor(
     private var totalFrames: Int = 0
     private var vadBypassed: Int = 0
 
+    // Model output state of the current frame, kept once post-processing has checked it
+    private var pendingStates: FloatArray? = null
+
+    // Idle state eviction, see setIdleStateEviction
+    private var evictAfterFrames = 0
+    private var silentFrames = 0
+    private var stateParked = false
+
     private fun runOnnxInference(inputFrame: FloatArray): FloatArray? {
         val session = ortSession ?: return null
         val env = ortEnv ?: return null
@@ -159,7 +195,12 @@ class PoiseProcessor(
         try {
             // Prepare inputs
             val inputTensor = OnnxTensor.createTensor(env, inputFrame)
-            val statesTensor = OnnxTensor.createTensor(env, states)
+            val inputStates =
+                    stateStore?.let { store ->
+                        workingStates.get()!!.also { store.load(0, it) }
+                    }
+                            ?: states
+            val statesTensor = OnnxTensor.createTensor(env, inputStates)
             val attenTensor = OnnxTensor.createTensor(env, floatArrayOf(attenLimDb))
 
             val inputs =
@@ -172,12 +213,9 @@ class PoiseProcessor(
             // Run inference
             val outputs = session.run(inputs)
 
-            // Extract outputs
+            // Extract outputs; the new states are kept after post-processing
             val enhancedAudio = (outputs[0].value as FloatArray)
-            val newStates = (outputs[1].value as FloatArray)
-
-            // Update states for next frame
-            states = newStates
+            pendingStates = (outputs[1].value as FloatArray)
 
             // Cleanup tensors
             inputTensor.close()
@@ -197,6 +235,11 @@ class PoiseProcessor(
         }
     }
 
+    private fun commitStates(newStates: FloatArray) {
+        val store = stateStore
+        if (store != null) store.store(0, newStates) else states = newStates
+    }
+
     /** Get processing statistics. */
     fun getStats(): ProcessingStats {
         // Always use our Kotlin-side counters - they're more reliable
@@ -213,6 +256,8 @@ class PoiseProcessor(
                     0f
                 }
 
+        val memory = if (nativeHandle != 0L) nativeMemoryUsage(nativeHandle) else null
+
         return ProcessingStats(
                 frameCount = displayFrames,
                 avgTimeMs = if (frameCount > 0) totalInferenceTimeMs / frameCount else 0.0,
@@ -221,13 +266,79 @@ class PoiseProcessor(
                 vadActive = totalFrames - vadBypassed,
                 vadBypassed = vadBypassed,
                 vadBypassRatio = vadBypassRatio,
-                isVadDetected = true // Default to true as we don't have hang time tracking here yet
+                // Default to true as we don't have hang time tracking here yet
+                isVadDetected = true,
+                isStateParked = stateParked,
+                nativeBytes = memory?.get(0) ?: 0,
+                nativePeakBytes = memory?.get(1) ?: 0
         )
     }
 
+    /**
+     * Park the recurrent state in the compressed cold pool after [silenceMs] of continuous VAD
+     * bypass. It is restored before the next inference. 0 disables.
+     */
+    fun setIdleStateEviction(silenceMs: Float) {
+        val frameMs = FRAME_SIZE * 1000f / SAMPLE_RATE
+        evictAfterFrames = if (silenceMs > 0f) maxOf(1, (silenceMs / frameMs).toInt()) else 0
+        silentFrames = 0
+    }
+
+    /**
+     * Move the recurrent state to the native cold pool (FP16, packed) and drop the resident
+     * copy until the next speech frame. Called on long silence or when capture goes idle.
+     */
+    fun parkState() {
+        if (stateParked || nativeHandle == 0L) return
+        val store = stateStore
+        val current = store?.let { workingStates.get()!!.also { w -> it.load(0, w) } } ?: states
+        if (nativeParkState(nativeHandle, current) == 0L) return
+        if (store != null) {
+            store.close()
+            stateStore = null
+        } else {
+            states = NO_STATE
+        }
+        stateParked = true
+    }
+
+    /** Bring parked state back; a missing entry leaves the stream on zeroed state. */
+    private fun restoreState() {
+        stateParked = false
+        val restored =
+                if (stateFormat == StateFormat.FP32) FloatArray(STATE_SIZE)
+                else workingStates.get()!!
+        if (!nativeRestoreState(nativeHandle, restored)) {
+            Log.w(TAG, "Parked state lost, continuing from zero state")
+        }
+        if (stateFormat == StateFormat.FP32) {
+            states = restored
+        } else {
+            stateStore =
+                    StateStore(stateFormat, intArrayOf(STATE_SIZE)).also { it.store(0, restored) }
+        }
+    }
+
+    /** Report an output underrun so the native flight recorder captures the window. */
+    fun reportUnderrun() {
+        if (nativeHandle != 0L) {
+            nativeReportUnderrun(nativeHandle)
+        }
+    }
+
+    /** Bytes of recurrent state this stream keeps between frames. */
+    val stateResidentBytes: Long
+        get() = if (stateParked) 0 else stateStore?.residentBytes ?: STATE_SIZE * 4L
+
     /** Reset processor state. */
     fun reset() {
-        states = FloatArray(STATE_SIZE) { 0f }
+        if (stateFormat == StateFormat.FP32) states = FloatArray(STATE_SIZE) { 0f }
+        if (stateParked && stateFormat != StateFormat.FP32) {
+            stateStore = StateStore(stateFormat, intArrayOf(STATE_SIZE))
+        }
+        stateStore?.clear()
+        stateParked = false
+        silentFrames = 0
         frameCount = 0
         totalInferenceTimeMs = 0.0
         nativeReset(nativeHandle)
@@ -239,8 +350,10 @@ class PoiseProcessor(
             nativeDestroy(nativeHandle)
             nativeHandle = 0
         }
-        ortSession?.close()
+        ortSession?.let { ModelRegistry.release(it) }
         ortSession = null
+        stateStore?.close()
+        stateStore = null
         Log.i(TAG, "PoiseProcessor closed")
     }
 
@@ -250,8 +363,16 @@ class PoiseProcessor(
     private external fun nativeSetupOutputResampler(handle: Long, targetSr: Int, outputSr: Int)
     private external fun nativeProcessPreInference(handle: Long, audioData: FloatArray): FloatArray?
     private external fun nativeCheckVAD(handle: Long, audioData: FloatArray): Boolean
-    private external fun nativePostProcess(handle: Long, audioData: FloatArray): FloatArray
+    private external fun nativePostProcess(
+            handle: Long,
+            audioData: FloatArray,
+            states: FloatArray?
+    ): FloatArray
     private external fun nativeGetStats(handle: Long): ProcessingStats?
+    private external fun nativeParkState(handle: Long, states: FloatArray): Long
+    private external fun nativeRestoreState(handle: Long, states: FloatArray): Boolean
+    private external fun nativeReportUnderrun(handle: Long)
     private external fun nativeReset(handle: Long)
     private external fun nativeDestroy(handle: Long)
+    private external fun nativeMemoryUsage(handle: Long): LongArray
 }
@@ -9,7 +9,25 @@ data class ProcessingStats(
         val vadActive: Int,
         val vadBypassed: Int,
         val vadBypassRatio: Float,
-        val isVadDetected: Boolean = false
+        val isVadDetected: Boolean = false,
+        val isStateParked: Boolean = false,
+        val stateBytesSaved: Long = 0,
+        val neuralVadBypassed: Int = 0,
+        val neuralVadSavedMs: Double = 0.0,
+        val isIdle: Boolean = false,
+        val idleMs: Long = 0,
+        val playoutLatencyMs: Float = 0f,
+        val playoutUnderruns: Int = 0,
+        val powerMode: PowerMode = PowerMode.LOW_LATENCY,
+        val wakeupsPerSecond: Float = 0f, // Processing-thread wake-ups per second of audio
+        val nativeBytes: Long = 0, // Native heap charged to this stream, see [NativeMemory]
+        val nativePeakBytes: Long = 0,
+        // Estimated per-frame effect of inference, ~1 s averages (GTCRN streams only). Low-benefit
+        // frames are those where the model removed under 3 dB of noise or saw none to remove
+        val enhancedFrames: Long = 0,
+        val noiseReductionDb: Float = 0f,
+        val speechRetentionDb: Float = 0f,
+        val lowBenefitRatio: Float = 0f
 ) {
     val isRealTime: Boolean
         get() = rtf < 1.0f
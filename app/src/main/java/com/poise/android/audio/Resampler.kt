@@ -0,0 +1,78 @@
+package com.poise.android.audio
+
+/**
+ * Native streaming sample-rate converter.
+ *
+ * The conversion is planned once per (rates, quality) and shared: integer halfband stages on the
+ * high-rate side and one short polyphase stage, whichever cascade needs the fewest multiply-adds
+ * for the quality target. Stages are causal, so a fixed input block gives a fixed output block
+ * once the ratio divides it (768 -> 256 for 48 -> 16 kHz). Used by one thread at a time.
+ */
+class Resampler(
+        val inputRate: Int,
+        val outputRate: Int,
+        quality: Quality = Quality.BALANCED
+) : AutoCloseable {
+
+    /** Passband and stopband target; ordinals match the native ResampleQuality. */
+    enum class Quality {
+        FAST, // 80% of the lower Nyquist, 50 dB
+        BALANCED, // 90%, 70 dB
+        HIGH // 95%, 90 dB
+    }
+
+    companion object {
+        init {
+            System.loadLibrary("poise_native")
+        }
+    }
+
+    private var handle: Long = nativeInit(inputRate, outputRate, quality.ordinal)
+
+    init {
+        require(handle != 0L) { "Unsupported conversion $inputRate -> $outputRate Hz" }
+    }
+
+    /** Largest output [process] can produce for [count] input samples. */
+    fun maxOutput(count: Int): Int = nativeMaxOutput(handle, count)
+
+    /** Resample [count] samples of [input] into [output]; returns the samples written. */
+    fun process(input: FloatArray, count: Int, output: FloatArray): Int =
+            nativeProcess(handle, input, count, output)
+
+    /** Plan stages, e.g. "48000->24000 hb(23) | 24000->16000 pp 2/3x66". */
+    fun describe(): String = nativeDescribe(handle) ?: ""
+
+    /** Multiply-adds per output sample for the chosen plan and for a single polyphase stage. */
+    val macsPerOutput: Float
+        get() = nativePlanInfo(handle)?.get(0) ?: 0f
+
+    val singleStageMacsPerOutput: Float
+        get() = nativePlanInfo(handle)?.get(1) ?: 0f
+
+    /** Group delay in output samples. */
+    val delaySamples: Float
+        get() = nativePlanInfo(handle)?.get(2) ?: 0f
+
+    fun reset() = nativeReset(handle)
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0
+        }
+    }
+
+    private external fun nativeInit(inputRate: Int, outputRate: Int, quality: Int): Long
+    private external fun nativeProcess(
+            handle: Long,
+            input: FloatArray,
+            count: Int,
+            output: FloatArray
+    ): Int
+    private external fun nativeMaxOutput(handle: Long, count: Int): Int
+    private external fun nativePlanInfo(handle: Long): FloatArray?
+    private external fun nativeDescribe(handle: Long): String?
+    private external fun nativeReset(handle: Long)
+    private external fun nativeDestroy(handle: Long)
+}
@@ -0,0 +1,60 @@
+package com.poise.android.audio
+
+/** Storage format for recurrent model state kept between frames. */
+enum class StateFormat {
+    FP32,
+    FP16, // Half the footprint; saturates at +-65504
+    BF16 // Half the footprint; full FP32 range, 8-bit precision
+}
+
+/**
+ * Native compact storage for a stream's recurrent state.
+ *
+ * The model reads and writes FP32 tensors; [store] converts a slot to the compact format right
+ * after inference and [load] converts it back right before the next one, so a stream only keeps
+ * the compact copy resident. Conversion is vectorized and does not copy through the JNI layer.
+ *
+ * @param slotSizes Floats per state tensor
+ */
+class StateStore(val format: StateFormat, slotSizes: IntArray) : AutoCloseable {
+
+    companion object {
+        init {
+            System.loadLibrary("poise_native")
+        }
+    }
+
+    private var handle: Long = nativeCreate(format.ordinal, slotSizes)
+
+    /** Bytes held between frames. */
+    val residentBytes: Long
+        get() = if (handle != 0L) nativeResidentBytes(handle) else 0
+
+    fun store(slot: Int, values: FloatArray) {
+        nativeStore(handle, slot, values)
+    }
+
+    /** Decode [slot] into [values], which must hold at least the slot size. */
+    fun load(slot: Int, values: FloatArray) {
+        nativeLoad(handle, slot, values)
+    }
+
+    /** Zero every slot. */
+    fun clear() {
+        if (handle != 0L) nativeClear(handle)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0
+        }
+    }
+
+    private external fun nativeCreate(format: Int, slotSizes: IntArray): Long
+    private external fun nativeStore(handle: Long, slot: Int, values: FloatArray): Boolean
+    private external fun nativeLoad(handle: Long, slot: Int, values: FloatArray): Boolean
+    private external fun nativeClear(handle: Long)
+    private external fun nativeResidentBytes(handle: Long): Long
+    private external fun nativeDestroy(handle: Long)
+}
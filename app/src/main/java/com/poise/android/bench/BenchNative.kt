@@ -0,0 +1,37 @@
+package com.poise.android.bench
+
+import com.poise.android.audio.NativeMemory
+import org.json.JSONObject
+
+/** Native helpers shared by the benchmarks. */
+object BenchNative {
+
+    init {
+        System.loadLibrary("poise_native")
+    }
+
+    /**
+     * Pin the calling thread to [cpu]. Threads it starts afterwards, such as ONNX Runtime
+     * intra-op pools created by a session, inherit the pinning.
+     */
+    fun pinCurrentThread(cpu: Int): Boolean = nativePinCurrentThread(cpu)
+
+    fun unpinCurrentThread() = nativeUnpinCurrentThread()
+
+    /** Native heap by component plus `total`, each as current and peak bytes. */
+    fun memoryJson(): JSONObject {
+        val json = JSONObject()
+        for ((name, usage) in NativeMemory.components() + ("total" to NativeMemory.total())) {
+            json.put(
+                    name,
+                    JSONObject()
+                            .put("currentBytes", usage.currentBytes)
+                            .put("peakBytes", usage.peakBytes)
+            )
+        }
+        return json
+    }
+
+    private external fun nativePinCurrentThread(cpu: Int): Boolean
+    private external fun nativeUnpinCurrentThread()
+}
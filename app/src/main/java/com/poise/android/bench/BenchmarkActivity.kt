@@ -0,0 +1,135 @@
+package com.poise.android.bench
+
+import android.app.Activity
+import android.os.Bundle
+import android.util.Log
+import android.view.WindowManager
+import android.widget.TextView
+import com.poise.android.audio.ProcessorModel
+import com.poise.android.audio.Resampler
+import com.poise.android.audio.StateFormat
+import java.io.File
+import org.json.JSONObject
+
+/**
+ * Headless entry point for on-device benchmarks. Only the shell can start it:
+ *
+ * ```
+ * adb shell am start -n com.poise.android/.bench.BenchmarkActivity \
+ *     --es suite capacity --es model gtcrn --ef missBudget 0.01
+ * ```
+ *
+ * Suites: `capacity` (streams per core, see [CapacityBenchmark]), `state_precision` (FP16/BF16
+ * state error against FP32, see [StatePrecisionBenchmark]), `cold_start` (start to first
+ * enhanced frame by phase, see [ColdStartBenchmark]; run it through scripts/bench_cold_start.sh)
+ * `resampler` (device-rate conversion cost, see [ResamplerBenchmark]) and `power` (energy per
+ * second of audio in each power mode, see [PowerBenchmark]).
+ *
+ * This class must not touch the native library itself so that `cold_start` can time loading it.
+ *
+ * The report is logged on one line tagged `PoiseBench` and written to `files/bench/<suite>.json`.
+ */
+class BenchmarkActivity : Activity() {
+
+    companion object {
+        private const val TAG = "PoiseBench"
+    }
+
+    private lateinit var output: TextView
+
+    override fun onCreate(savedInstanceState: Bundle?) {
+        super.onCreate(savedInstanceState)
+        window.addFlags(WindowManager.LayoutParams.FLAG_KEEP_SCREEN_ON)
+        output = TextView(this).apply { setPadding(32, 32, 32, 32) }
+        setContentView(output)
+
+        val suite = intent.getStringExtra("suite") ?: "capacity"
+        output.text = "Running $suite benchmark..."
+        Thread({ runSuite(suite) }, "PoiseBench").start()
+    }
+
+    private fun runSuite(suite: String) {
+        val report =
+                try {
+                    when (suite) {
+                        "capacity" -> CapacityBenchmark(applicationContext, capacityConfig()).run()
+                        "cold_start" ->
+                                ColdStartBenchmark(
+                                                applicationContext,
+                                                ColdStartBenchmark.Config(
+                                                        model = modelExtra(),
+                                                        coldFiles =
+                                                                intent.getBooleanExtra(
+                                                                        "coldFiles",
+                                                                        true
+                                                                )
+                                                )
+                                        )
+                                        .run()
+                        "state_precision" ->
+                                StatePrecisionBenchmark(
+                                                applicationContext,
+                                                StatePrecisionBenchmark.Config(
+                                                        model = modelExtra(),
+                                                        inputPath = intent.getStringExtra("input")
+                                                )
+                                        )
+                                        .run()
+                        "resampler" ->
+                                ResamplerBenchmark(
+                                                ResamplerBenchmark.Config(
+                                                        quality = resampleQualityExtra()
+                                                )
+                                        )
+                                        .run()
+                        "power" ->
+                                PowerBenchmark(
+                                                applicationContext,
+                                                PowerBenchmark.Config(
+                                                        model = modelExtra(),
+                                                        seconds = intent.getIntExtra("seconds", 60),
+                                                        startDelaySeconds =
+                                                                intent.getIntExtra("startDelay", 0)
+                                                )
+                                        )
+                                        .run()
+                        else -> JSONObject().put("error", "Unknown suite: $suite")
+                    }
+                } catch (e: Exception) {
+                    Log.e(TAG, "Benchmark $suite failed", e)
+                    JSONObject().put("error", e.toString())
+                }
+
+        val text = report.toString()
+        Log.i(TAG, text)
+        val dir = File(filesDir, "bench").apply { mkdirs() }
+        File(dir, "$suite.json").writeText(text)
+        runOnUiThread { output.text = report.toString(2) }
+    }
+
+    private fun modelExtra(): ProcessorModel =
+            when (intent.getStringExtra("model")) {
+                "legacy" -> ProcessorModel.LEGACY
+                else -> ProcessorModel.GTCRN
+            }
+
+    private fun stateFormatExtra(): StateFormat =
+            intent.getStringExtra("stateFormat")?.let { StateFormat.valueOf(it.uppercase()) }
+                    ?: StateFormat.FP32
+
+    private fun resampleQualityExtra(): Resampler.Quality =
+            intent.getStringExtra("quality")?.let { Resampler.Quality.valueOf(it.uppercase()) }
+                    ?: Resampler.Quality.BALANCED
+
+    private fun capacityConfig(): CapacityBenchmark.Config {
+        val defaults = CapacityBenchmark.Config()
+        return CapacityBenchmark.Config(
+                model = modelExtra(),
+                stateFormat = stateFormatExtra(),
+                missBudget = intent.getFloatExtra("missBudget", 0.01f).toDouble(),
+                maxStreams = intent.getIntExtra("maxStreams", defaults.maxStreams),
+                stepSeconds = intent.getIntExtra("stepSeconds", defaults.stepSeconds),
+                cpu = intent.getIntExtra("cpu", defaults.cpu)
+        )
+    }
+}
@@ -0,0 +1,294 @@
+package com.poise.android.bench
+
+import android.content.Context
+import android.os.BatteryManager
+import android.os.Debug
+import android.os.Process
+import android.util.Log
+import com.poise.android.audio.AdmissionControl
+import com.poise.android.audio.GTCRNProcessor
+import com.poise.android.audio.NativeMemory
+import com.poise.android.audio.PoiseProcessor
+import com.poise.android.audio.ProcessorModel
+import com.poise.android.audio.StateFormat
+import java.util.concurrent.locks.LockSupport
+import kotlin.math.ceil
+import kotlin.random.Random
+import org.json.JSONArray
+import org.json.JSONObject
+
+/**
+ * Finds how many real-time streams of one model a single core sustains.
+ *
+ * All streams run on one thread pinned to one CPU. Each stream has its own clock (random phase
+ * and a few hundred ppm of drift) and its own talk-spurt VAD profile, so frames arrive unaligned
+ * and a realistic share of them takes the VAD bypass path. Frames are served earliest release
+ * first; a frame misses its deadline when it finishes more than one frame period after its
+ * release. The stream count is ramped one at a time until the p99, over streams and one-second
+ * windows, of the deadline-miss rate exceeds [Config.missBudget]. The last count within budget is
+ * the streams/core figure.
+ */
+class CapacityBenchmark(private val context: Context, private val config: Config = Config()) {
+
+    data class Config(
+            val model: ProcessorModel = ProcessorModel.GTCRN,
+            val stateFormat: StateFormat = StateFormat.FP32,
+            val missBudget: Double = 0.01, // p99 of per-window miss rates
+            val maxStreams: Int = 32,
+            val stepSeconds: Int = 10,
+            val cpu: Int = Runtime.getRuntime().availableProcessors() - 1,
+            val seed: Long = 1
+    )
+
+    data class Step(
+            val streams: Int,
+            val p99MissRate: Double,
+            val meanMissRate: Double,
+            val p99LatencyMs: Double,
+            val dutyCycle: Double, // Fraction of the step the core spent processing
+            val cpuMsPerStreamSecond: Double,
+            val pssKb: Long,
+            val memoryPerStreamKb: Double,
+            val nativeBytesPerStream: Double, // Native heap excluding the shared model
+            val nativeMemory: JSONObject, // By component, peaks over this step
+            val avgCurrentUa: Long // Battery current, 0 if unsupported
+    )
+
+    companion object {
+        private const val TAG = "CapacityBench"
+        private const val WINDOW_NS = 1_000_000_000L
+        private const val MAX_DRIFT_PPM = 300.0
+    }
+
+    private val frameSamples: Int
+    private val periodNs: Long
+    private val sampleRate: Int
+
+    init {
+        require(config.model != ProcessorModel.CASCADE) { "Benchmark one model at a time" }
+        if (config.model == ProcessorModel.GTCRN) {
+            frameSamples = GTCRNProcessor.FRAME_SIZE
+            sampleRate = GTCRNProcessor.SAMPLE_RATE
+        } else {
+            frameSamples = PoiseProcessor.FRAME_SIZE
+            sampleRate = PoiseProcessor.SAMPLE_RATE
+        }
+        periodNs = frameSamples * 1_000_000_000L / sampleRate
+    }
+
+    /** One simulated stream: its clock, VAD profile, processor and miss counters. */
+    private inner class SimStream(index: Int, random: Random) : AutoCloseable {
+        private val gtcrn: GTCRNProcessor?
+        private val legacy: PoiseProcessor?
+
+        private val streamPeriodNs =
+                (periodNs * (1.0 + random.nextDouble(-MAX_DRIFT_PPM, MAX_DRIFT_PPM) * 1e-6))
+                        .toLong()
+        private val phaseNs = random.nextLong(periodNs)
+        private val signal =
+                SyntheticSpeech(
+                        seed = config.seed * 7919 + index,
+                        sampleRate = sampleRate,
+                        frameSamples = frameSamples,
+                        speechFraction = random.nextDouble(0.1, 0.9),
+                        pitchHz = random.nextDouble(90.0, 260.0)
+                )
+
+        private val frame = FloatArray(frameSamples)
+        private var startNs = 0L
+        private var frameIndex = 0L
+
+        var releaseNs = 0L
+            private set
+
+        val windowFrames = ArrayList<Int>()
+        val windowMisses = ArrayList<Int>()
+
+        init {
+            if (config.model == ProcessorModel.GTCRN) {
+                gtcrn = GTCRNProcessor(context, stateFormat = config.stateFormat)
+                legacy = null
+            } else {
+                legacy = PoiseProcessor(context, stateFormat = config.stateFormat)
+                gtcrn = null
+            }
+        }
+
+        fun start(stepStartNs: Long) {
+            startNs = stepStartNs + phaseNs
+            frameIndex = 0
+            releaseNs = startNs
+            windowFrames.clear()
+            windowMisses.clear()
+        }
+
+        /** Process the frame released at [releaseNs]; returns completion time. */
+        fun serve(stepStartNs: Long): Long {
+            signal.fill(frame)
+            if (gtcrn != null) gtcrn.processFrame(frame) else legacy?.processFrame(frame)
+            val doneNs = System.nanoTime()
+
+            val window = ((releaseNs - stepStartNs) / WINDOW_NS).toInt()
+            while (windowFrames.size <= window) {
+                windowFrames.add(0)
+                windowMisses.add(0)
+            }
+            windowFrames[window]++
+            if (doneNs > releaseNs + streamPeriodNs) windowMisses[window]++
+
+            frameIndex++
+            releaseNs = startNs + frameIndex * streamPeriodNs
+            return doneNs
+        }
+
+        override fun close() {
+            gtcrn?.close()
+            legacy?.close()
+        }
+    }
+
+    /**
+     * Run the ramp. Blocks for up to maxStreams * stepSeconds; call from a background thread.
+     *
+     * @return JSON report with the knee and every step measured
+     */
+    fun run(): JSONObject {
+        val pinned = BenchNative.pinCurrentThread(config.cpu)
+        Process.setThreadPriority(Process.THREAD_PRIORITY_URGENT_AUDIO)
+        AdmissionControl.setEnabled(false)
+
+        val random = Random(config.seed)
+        val streams = ArrayList<SimStream>()
+        val steps = ArrayList<Step>()
+        val battery = context.getSystemService(BatteryManager::class.java)
+        val baselinePssKb = Debug.getPss()
+        var capacity = 0
+
+        try {
+            for (n in 1..config.maxStreams) {
+                streams.add(SimStream(n, random))
+                val step = runStep(streams, battery, baselinePssKb)
+                steps.add(step)
+                Log.i(
+                        TAG,
+                        "n=$n p99 miss=${"%.4f".format(step.p99MissRate)} " +
+                                "duty=${"%.2f".format(step.dutyCycle)}"
+                )
+                if (step.p99MissRate > config.missBudget) break
+                capacity = n
+            }
+        } finally {
+            streams.forEach { it.close() }
+            AdmissionControl.setEnabled(true)
+            BenchNative.unpinCurrentThread()
+        }
+
+        val atKnee = steps.getOrNull(capacity - 1)
+        return JSONObject().apply {
+            put("benchmark", "stream_capacity")
+            put("model", config.model.name.lowercase())
+            put("stateFormat", config.stateFormat.name)
+            put("cpu", config.cpu)
+            put("pinned", pinned)
+            put("frameMs", periodNs / 1e6)
+            put("missBudget", config.missBudget)
+            put("stepSeconds", config.stepSeconds)
+            put("streamsPerCore", capacity)
+            put("reachedMaxStreams", capacity == config.maxStreams)
+            put("memoryPerStreamKb", atKnee?.memoryPerStreamKb ?: 0.0)
+            put("nativeBytesPerStream", atKnee?.nativeBytesPerStream ?: 0.0)
+            put("cpuMsPerStreamSecond", atKnee?.cpuMsPerStreamSecond ?: 0.0)
+            put("dutyCycleAtKnee", atKnee?.dutyCycle ?: 0.0)
+            put("steps", JSONArray().apply { steps.forEach { put(stepJson(it)) } })
+        }
+    }
+
+    private fun runStep(
+            streams: List<SimStream>,
+            battery: BatteryManager?,
+            baselinePssKb: Long
+    ): Step {
+        val stepNs = config.stepSeconds * 1_000_000_000L
+        val stepStartNs = System.nanoTime() + periodNs
+        val stepEndNs = stepStartNs + stepNs
+        streams.forEach { it.start(stepStartNs) }
+        NativeMemory.resetPeaks()
+
+        val latenciesMs = ArrayList<Double>()
+        val currentSamples = ArrayList<Long>()
+        var nextCurrentNs = stepStartNs
+        var busyNs = 0L
+        val cpuStartMs = Process.getElapsedCpuTime()
+
+        while (true) {
+            val stream = streams.minByOrNull { it.releaseNs } ?: break
+            val releaseNs = stream.releaseNs
+            if (releaseNs >= stepEndNs) break
+
+            val waitNs = releaseNs - System.nanoTime()
+            if (waitNs > 0) LockSupport.parkNanos(waitNs)
+
+            val startNs = System.nanoTime()
+            val doneNs = stream.serve(stepStartNs)
+            busyNs += doneNs - startNs
+            latenciesMs.add((doneNs - releaseNs) / 1e6)
+
+            if (battery != null && doneNs >= nextCurrentNs) {
+                currentSamples.add(
+                        battery.getLongProperty(BatteryManager.BATTERY_PROPERTY_CURRENT_NOW)
+                )
+                nextCurrentNs += WINDOW_NS / 4
+            }
+        }
+        val cpuMs = Process.getElapsedCpuTime() - cpuStartMs
+
+        val missRates = ArrayList<Double>()
+        for (stream in streams) {
+            for (w in stream.windowFrames.indices) {
+                val frames = stream.windowFrames[w]
+                if (frames > 0) missRates.add(stream.windowMisses[w].toDouble() / frames)
+            }
+        }
+        val n = streams.size
+        val pssKb = Debug.getPss()
+        val native = NativeMemory.components()
+        val streamBytes =
+                NativeMemory.total().currentBytes - (native["onnx_model"]?.currentBytes ?: 0)
+        val validCurrent = currentSamples.filter { it != 0L && it != Long.MIN_VALUE }
+        return Step(
+                streams = n,
+                p99MissRate = percentile(missRates, 0.99),
+                meanMissRate = if (missRates.isEmpty()) 0.0 else missRates.average(),
+                p99LatencyMs = percentile(latenciesMs, 0.99),
+                dutyCycle = busyNs.toDouble() / stepNs,
+                cpuMsPerStreamSecond = cpuMs.toDouble() / (n * config.stepSeconds),
+                pssKb = pssKb,
+                memoryPerStreamKb = (pssKb - baselinePssKb).toDouble() / n,
+                nativeBytesPerStream = streamBytes.toDouble() / n,
+                nativeMemory = BenchNative.memoryJson(),
+                avgCurrentUa = if (validCurrent.isEmpty()) 0 else validCurrent.average().toLong()
+        )
+    }
+
+    private fun percentile(values: MutableList<Double>, q: Double): Double {
+        if (values.isEmpty()) return 0.0
+        values.sort()
+        val index = (ceil(q * values.size).toInt() - 1).coerceIn(0, values.size - 1)
+        return values[index]
+    }
+
+    private fun stepJson(step: Step) =
+            JSONObject().apply {
+                put("streams", step.streams)
+                put("p99MissRate", step.p99MissRate)
+                put("meanMissRate", step.meanMissRate)
+                put("p99LatencyMs", step.p99LatencyMs)
+                put("dutyCycle", step.dutyCycle)
+                put("cpuMsPerStreamSecond", step.cpuMsPerStreamSecond)
+                put("pssKb", step.pssKb)
+                put("memoryPerStreamKb", step.memoryPerStreamKb)
+                put("nativeBytesPerStream", step.nativeBytesPerStream)
+                put("nativeMemory", step.nativeMemory)
+                put("avgCurrentUa", step.avgCurrentUa)
+            }
+}
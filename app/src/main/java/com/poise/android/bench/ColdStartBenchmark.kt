@@ -0,0 +1,179 @@
+package com.poise.android.bench
+
+import ai.onnxruntime.OrtEnvironment
+import ai.onnxruntime.OrtSession
+import android.content.Context
+import android.os.Process
+import android.os.SystemClock
+import com.poise.android.audio.GTCRNProcessor
+import com.poise.android.audio.ModelRegistry
+import com.poise.android.audio.PoiseProcessor
+import com.poise.android.audio.ProcessorModel
+import java.io.File
+import java.io.FileOutputStream
+import org.json.JSONObject
+
+/**
+ * Breaks the delay from start to the first enhanced frame into phases.
+ *
+ * Only meaningful as the first work in a fresh process: scripts/bench_cold_start.sh force-stops
+ * the app before every run. The report records whether the native library was already mapped,
+ * so warm runs can be discarded.
+ *
+ * Phases are measured back to back. Session creation is split by building the session three
+ * times with more enabled each time, and the phase is the difference:
+ * - parse: graph load only, no optimization or prepacking
+ * - optimize: graph optimizations on top of parse
+ * - prepack: prepacking and execution providers, which is the production session
+ * The later builds find the model file in the page cache, so disk time only appears in parse.
+ */
+class ColdStartBenchmark(private val context: Context, private val config: Config = Config()) {
+
+    data class Config(
+            val model: ProcessorModel = ProcessorModel.GTCRN,
+            val coldFiles: Boolean = true, // Delete the extracted model so the asset copy is timed
+            val frames: Int = 500
+    )
+
+    companion object {
+        private const val LIBRARY = "poise_native"
+        private const val STEADY_WINDOW = 10 // Consecutive frames near steady state
+        private const val STEADY_TOLERANCE = 1.2
+    }
+
+    private val modelName: String
+    private val frameSamples: Int
+    private val sampleRate: Int
+
+    init {
+        require(config.model != ProcessorModel.CASCADE) { "Benchmark one model at a time" }
+        if (config.model == ProcessorModel.GTCRN) {
+            modelName = GTCRNProcessor.ONNX_MODEL_NAME
+            frameSamples = GTCRNProcessor.FRAME_SIZE
+            sampleRate = GTCRNProcessor.SAMPLE_RATE
+        } else {
+            modelName = PoiseProcessor.ONNX_MODEL_NAME
+            frameSamples = PoiseProcessor.FRAME_SIZE
+            sampleRate = PoiseProcessor.SAMPLE_RATE
+        }
+    }
+
+    fun run(): JSONObject {
+        val report = JSONObject()
+        report.put("benchmark", "cold_start")
+        report.put("model", config.model.name.lowercase())
+
+        // Process fork to here: zygote specialization, Application and Activity creation
+        val suiteStartMs = SystemClock.elapsedRealtime()
+        report.put("processStartMs", suiteStartMs - Process.getStartElapsedRealtime())
+
+        val coldProcess = !libraryMapped()
+        report.put("coldProcess", coldProcess)
+        report.put("libraryInitMs", timeMs { System.loadLibrary(LIBRARY) })
+
+        val modelFile = File(context.filesDir, modelName)
+        if (config.coldFiles) modelFile.delete()
+        report.put("assetCopyMs", timeMs { extractModel(modelFile) })
+        report.put("modelBytes", modelFile.length())
+
+        val env = OrtEnvironment.getEnvironment()
+        val parseMs = timeMs { buildUnpackedSession(env, modelFile, optimize = false) }
+        val optimizedMs = timeMs { buildUnpackedSession(env, modelFile, optimize = true) }
+        val registryModel =
+                if (config.model == ProcessorModel.GTCRN) ModelRegistry.GTCRN
+                else ModelRegistry.LEGACY
+        var session: OrtSession? = null
+        val productionMs = timeMs { session = ModelRegistry.acquire(context, registryModel) }
+        report.put("modelParseMs", parseMs)
+        report.put("graphOptimizeMs", (optimizedMs - parseMs).coerceAtLeast(0.0))
+        report.put("weightPrepackMs", (productionMs - optimizedMs).coerceAtLeast(0.0))
+        report.put("sessionCreateMs", productionMs)
+
+        val signal = SyntheticSpeech(1, sampleRate, frameSamples, 0.99, 140.0)
+        val frame = FloatArray(frameSamples)
+        val frameMs = DoubleArray(config.frames)
+        var process: (FloatArray) -> Unit = {}
+        var close: () -> Unit = {}
+        report.put(
+                "streamInitMs",
+                timeMs {
+                    if (config.model == ProcessorModel.GTCRN) {
+                        val p = GTCRNProcessor(context)
+                        process = { p.processFrame(it) }
+                        close = p::close
+                    } else {
+                        val p = PoiseProcessor(context)
+                        process = { p.processFrame(it) }
+                        close = p::close
+                    }
+                }
+        )
+        var firstFrameDoneMs = 0L
+        try {
+            for (i in frameMs.indices) {
+                signal.fill(frame)
+                frameMs[i] = timeMs { process(frame) }
+                if (i == 0) firstFrameDoneMs = SystemClock.elapsedRealtime()
+            }
+            // Peaks cover library load, session creation and warm-up
+            report.put("nativeMemory", BenchNative.memoryJson())
+        } finally {
+            close()
+            session?.let { ModelRegistry.release(it) }
+        }
+
+        val steadyMs = frameMs.copyOfRange(frameMs.size / 2, frameMs.size).sorted().let {
+            it[it.size / 2]
+        }
+        val steadyFrom = steadyStart(frameMs, steadyMs)
+        report.put("firstFrameMs", frameMs[0])
+        report.put("steadyFrameMs", steadyMs)
+        report.put("framesToSteady", steadyFrom)
+        report.put("timeToSteadyMs", frameMs.take(steadyFrom).sum())
+        report.put("warmupExcessMs", frameMs.take(steadyFrom).sumOf { it - steadyMs })
+        report.put("startToFirstFrameMs", firstFrameDoneMs - Process.getStartElapsedRealtime())
+        return report
+    }
+
+    /** Index of the first frame that starts [STEADY_WINDOW] frames within tolerance of steady. */
+    private fun steadyStart(frameMs: DoubleArray, steadyMs: Double): Int {
+        val limit = steadyMs * STEADY_TOLERANCE
+        var run = 0
+        for (i in frameMs.indices) {
+            run = if (frameMs[i] <= limit) run + 1 else 0
+            if (run == STEADY_WINDOW) return i - STEADY_WINDOW + 1
+        }
+        return frameMs.size
+    }
+
+    /** Build and discard a CPU session with weight prepacking disabled. */
+    private fun buildUnpackedSession(env: OrtEnvironment, file: File, optimize: Boolean) {
+        val options =
+                OrtSession.SessionOptions().apply {
+                    setIntraOpNumThreads(1)
+                    setOptimizationLevel(
+                            if (optimize) OrtSession.SessionOptions.OptLevel.ALL_OPT
+                            else OrtSession.SessionOptions.OptLevel.NO_OPT
+                    )
+                    addConfigEntry("session.disable_prepacking", "1")
+                }
+        env.createSession(file.absolutePath, options).close()
+        options.close()
+    }
+
+    private fun extractModel(file: File) {
+        if (file.exists()) return
+        context.assets.open(modelName).use { input ->
+            FileOutputStream(file).use { output -> input.copyTo(output) }
+        }
+    }
+
+    private fun libraryMapped(): Boolean =
+            File("/proc/self/maps").useLines { lines -> lines.any { "lib$LIBRARY.so" in it } }
+
+    private inline fun timeMs(block: () -> Unit): Double {
+        val start = SystemClock.elapsedRealtimeNanos()
+        block()
+        return (SystemClock.elapsedRealtimeNanos() - start) / 1e6
+    }
+}
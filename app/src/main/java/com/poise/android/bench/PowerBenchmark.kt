@@ -0,0 +1,213 @@
+package com.poise.android.bench
+
+import android.content.Context
+import android.content.Intent
+import android.content.IntentFilter
+import android.os.BatteryManager
+import android.os.Process
+import com.poise.android.audio.BurstScheduler
+import com.poise.android.audio.ModelSlot
+import com.poise.android.audio.PlayoutBuffer
+import com.poise.android.audio.PowerMode
+import com.poise.android.audio.ProcessorModel
+import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.locks.LockSupport
+import kotlin.math.abs
+import org.json.JSONArray
+import org.json.JSONObject
+
+/**
+ * Energy per second of audio for each [PowerMode].
+ *
+ * Runs the pipeline's processing loop against a real-time clock: synthetic 48 kHz capture becomes
+ * available at the capture rate and is read in the mode's block (one frame, or one burst), each
+ * frame goes through a [ModelSlot] into a [PlayoutBuffer], and a playback thread drains that at
+ * real-time pace in the block size the pipeline uses for the mode. Per mode the report has the
+ * wake-ups, busy time and process CPU time per audio second, the playout latency and underruns,
+ * and the battery current, with the energy derived from it and from the charge counter.
+ *
+ * Battery figures are for the whole device. For meaningful numbers run it unplugged (adb over
+ * Wi-Fi) with the display off: pass `--ei startDelay 10` and press power after starting.
+ */
+class PowerBenchmark(private val context: Context, private val config: Config = Config()) {
+
+    data class Config(
+            val model: ProcessorModel = ProcessorModel.GTCRN,
+            val modes: List<PowerMode> = listOf(PowerMode.LOW_LATENCY, PowerMode.RACE_TO_IDLE),
+            val seconds: Int = 60,
+            val burstMs: Float = 160f,
+            val startDelaySeconds: Int = 0 // Time to turn the screen off
+    )
+
+    companion object {
+        private const val SAMPLE_RATE = ModelSlot.SAMPLE_RATE
+        private const val PLAYBACK_BLOCK = 240
+        private const val PLAYOUT_MAX_DEPTH_MS = 400f
+        private const val CURRENT_INTERVAL_NS = 250_000_000L
+        private const val WARMUP_FRAMES = 50
+    }
+
+    fun run(): JSONObject {
+        Process.setThreadPriority(Process.THREAD_PRIORITY_URGENT_AUDIO)
+        if (config.startDelaySeconds > 0) Thread.sleep(config.startDelaySeconds * 1000L)
+
+        val battery = context.getSystemService(BatteryManager::class.java)
+        val results = JSONArray()
+        val energy = HashMap<PowerMode, Double>()
+        for (mode in config.modes) {
+            val row = measure(mode, battery)
+            energy[mode] = row.optDouble("energyMjPerAudioSecond", 0.0)
+            results.put(row)
+        }
+
+        val baseline = energy[PowerMode.LOW_LATENCY] ?: 0.0
+        return JSONObject()
+                .put("suite", "power")
+                .put("model", config.model.name.lowercase())
+                .put("seconds", config.seconds)
+                .put("burstMs", config.burstMs.toDouble())
+                .put("plugged", isPlugged())
+                .put("modes", results)
+                .apply {
+                    val race = energy[PowerMode.RACE_TO_IDLE]
+                    if (race != null && baseline > 0.0) {
+                        put("raceToIdleEnergyRatio", race / baseline)
+                    }
+                }
+    }
+
+    private fun measure(mode: PowerMode, battery: BatteryManager?): JSONObject {
+        val slot = ModelSlot(context, config.model)
+        val scheduler = BurstScheduler(SAMPLE_RATE, config.burstMs).apply { this.mode = mode }
+        val playout = PlayoutBuffer(SAMPLE_RATE, maxDepthMs = PLAYOUT_MAX_DEPTH_MS)
+        try {
+            val frameSize = slot.frameSize
+            val frames = scheduler.burstFrames(frameSize)
+            val blockNs = frames * frameSize * 1_000_000_000L / SAMPLE_RATE
+            val input = FloatArray(frameSize)
+            val speech = SyntheticSpeech(11, SAMPLE_RATE, frameSize, 0.6, 140.0)
+
+            repeat(WARMUP_FRAMES) {
+                speech.fill(input)
+                slot.process(input)
+            }
+
+            // As in the pipeline: one burst per playback wake-up when racing to idle
+            val playbackBlock =
+                    if (mode == PowerMode.RACE_TO_IDLE) frames * frameSize else PLAYBACK_BLOCK
+            val running = AtomicBoolean(true)
+            val startNs = System.nanoTime()
+            val playback =
+                    Thread(
+                                    {
+                                        Process.setThreadPriority(
+                                                Process.THREAD_PRIORITY_URGENT_AUDIO
+                                        )
+                                        playbackLoop(playout, playbackBlock, startNs, running)
+                                    },
+                                    "PowerBenchPlayback"
+                            )
+                            .apply { start() }
+
+            val currentSamples = ArrayList<Long>()
+            val chargeStart = chargeCounter(battery)
+            val cpuStartMs = Process.getElapsedCpuTime()
+            val blocks = (config.seconds * 1_000_000_000L / blockNs).toInt()
+            var nextCurrentNs = startNs
+            for (block in 1..blocks) {
+                // The capture read returns once the whole block has been recorded
+                val waitNs = startNs + block * blockNs - System.nanoTime()
+                if (waitNs > 0) LockSupport.parkNanos(waitNs)
+
+                scheduler.beginBurst()
+                repeat(frames) {
+                    speech.fill(input)
+                    slot.process(input)?.let { playout.push(it, it.size) }
+                }
+                scheduler.endBurst(frames * frameSize)
+
+                // Read between bursts in both modes; the charge counter below is independent of
+                // when the gauge is polled
+                val now = System.nanoTime()
+                if (battery != null && now >= nextCurrentNs) {
+                    currentSamples.add(
+                            battery.getLongProperty(BatteryManager.BATTERY_PROPERTY_CURRENT_NOW)
+                    )
+                    nextCurrentNs = now + CURRENT_INTERVAL_NS
+                }
+            }
+            val cpuMs = Process.getElapsedCpuTime() - cpuStartMs
+            val chargeEnd = chargeCounter(battery)
+            val wallSeconds = (System.nanoTime() - startNs) / 1e9
+            running.set(false)
+            playback.join()
+
+            val audioSeconds = blocks * blockNs / 1e9
+            val voltageMv = batteryVoltageMv()
+            val validCurrent = currentSamples.filter { it != 0L && it != Long.MIN_VALUE }
+            val avgCurrentUa = if (validCurrent.isEmpty()) 0.0 else abs(validCurrent.average())
+            val avgPowerMw = avgCurrentUa * voltageMv / 1e6
+            val stats = scheduler.getStats()
+            val playoutStats = playout.getStats()
+
+            return JSONObject().apply {
+                put("mode", mode.name.lowercase())
+                put("framesPerWakeup", frames)
+                put("audioSeconds", audioSeconds)
+                put("wakeupsPerSecond", (stats?.wakeupsPerSecond ?: 0f).toDouble())
+                put("busyRatio", (stats?.busyRatio ?: 0f).toDouble())
+                put("avgBurstBusyMs", (stats?.avgBusyMs ?: 0f).toDouble())
+                put("maxBurstBusyMs", (stats?.maxBusyMs ?: 0f).toDouble())
+                put("cpuMsPerAudioSecond", cpuMs / audioSeconds)
+                put("playoutLatencyMs", (playoutStats?.avgLatencyMs ?: 0f).toDouble())
+                put("playoutUnderruns", playoutStats?.underruns ?: 0)
+                put("avgCurrentUa", avgCurrentUa)
+                put("voltageMv", voltageMv)
+                put("energyMjPerAudioSecond", avgPowerMw * wallSeconds / audioSeconds)
+                if (chargeStart != null && chargeEnd != null && chargeStart > 0 && chargeEnd > 0) {
+                    // 1 uAh = 3.6 mC; mC x V = mJ. Coarse: many gauges step in 0.1-1 mAh
+                    val usedMicroAh = (chargeStart - chargeEnd).toDouble()
+                    put("chargeUsedMicroAh", usedMicroAh)
+                    put(
+                            "chargeEnergyMjPerAudioSecond",
+                            usedMicroAh * 3.6 * voltageMv / 1000.0 / audioSeconds
+                    )
+                }
+            }
+        } finally {
+            playout.close()
+            scheduler.close()
+            slot.close()
+        }
+    }
+
+    /** Real-time consumer, like the pipeline's playback thread without the AudioTrack. */
+    private fun playbackLoop(
+            playout: PlayoutBuffer,
+            block: Int,
+            startNs: Long,
+            running: AtomicBoolean
+    ) {
+        val buffer = FloatArray(block)
+        val blockNs = block * 1_000_000_000L / SAMPLE_RATE
+        var next = startNs
+        while (running.get()) {
+            next += blockNs
+            val waitNs = next - System.nanoTime()
+            if (waitNs > 0) LockSupport.parkNanos(waitNs)
+            playout.pull(buffer, block)
+        }
+    }
+
+    private fun chargeCounter(battery: BatteryManager?): Int? =
+            battery?.getIntProperty(BatteryManager.BATTERY_PROPERTY_CHARGE_COUNTER)
+
+    private fun batteryStatus(): Intent? =
+            context.registerReceiver(null, IntentFilter(Intent.ACTION_BATTERY_CHANGED))
+
+    private fun batteryVoltageMv(): Int =
+            batteryStatus()?.getIntExtra(BatteryManager.EXTRA_VOLTAGE, 0) ?: 0
+
+    private fun isPlugged(): Boolean =
+            (batteryStatus()?.getIntExtra(BatteryManager.EXTRA_PLUGGED, 0) ?: 0) != 0
+}
@@ -0,0 +1,100 @@
+package com.poise.android.bench
+
+import android.os.Process
+import com.poise.android.audio.Resampler
+import org.json.JSONArray
+import org.json.JSONObject
+
+/**
+ * Cost of converting common device rates to and from the model rates.
+ *
+ * For each conversion the planned cascade runs over [Config.seconds] of synthetic speech in
+ * 10 ms blocks. Reported: the plan, its multiply-adds per output sample next to the single
+ * polyphase stage it replaced, the group delay, and the measured CPU time per second of audio,
+ * also relative to the 48 kHz conversion to the same model rate.
+ */
+class ResamplerBenchmark(private val config: Config = Config()) {
+
+    data class Config(
+            val deviceRates: List<Int> = listOf(44100, 48000, 88200, 96000, 32000, 22050),
+            val modelRates: List<Int> = listOf(16000, 48000),
+            val quality: Resampler.Quality = Resampler.Quality.BALANCED,
+            val seconds: Int = 20
+    )
+
+    companion object {
+        private const val BASELINE_RATE = 48000
+    }
+
+    fun run(): JSONObject {
+        Process.setThreadPriority(Process.THREAD_PRIORITY_URGENT_AUDIO)
+        val results = JSONArray()
+        for (modelRate in config.modelRates) {
+            val baseline = measure(BASELINE_RATE, modelRate)
+            for (deviceRate in config.deviceRates) {
+                if (deviceRate == modelRate) continue
+                results.put(row(deviceRate, modelRate, baseline, "capture"))
+                results.put(row(modelRate, deviceRate, null, "playback"))
+            }
+        }
+        return JSONObject()
+                .put("suite", "resampler")
+                .put("quality", config.quality.name.lowercase())
+                .put("seconds", config.seconds)
+                .put("conversions", results)
+    }
+
+    private fun row(inputRate: Int, outputRate: Int, baseline: Measurement?, direction: String) =
+            measure(inputRate, outputRate).let { m ->
+                JSONObject()
+                        .put("direction", direction)
+                        .put("inputRate", inputRate)
+                        .put("outputRate", outputRate)
+                        .put("plan", m.plan)
+                        .put("macsPerOutput", m.macsPerOutput.toDouble())
+                        .put("singleStageMacsPerOutput", m.singleStageMacs.toDouble())
+                        .put("delayMs", m.delaySamples * 1000.0 / outputRate)
+                        .put("cpuMsPerAudioSecond", m.msPerSecond)
+                        .apply {
+                            if (baseline != null && baseline.msPerSecond > 0.0) {
+                                put("costVs48k", m.msPerSecond / baseline.msPerSecond)
+                            }
+                        }
+            }
+
+    private class Measurement(
+            val plan: String,
+            val macsPerOutput: Float,
+            val singleStageMacs: Float,
+            val delaySamples: Float,
+            val msPerSecond: Double
+    )
+
+    private fun measure(inputRate: Int, outputRate: Int): Measurement =
+            Resampler(inputRate, outputRate, config.quality).use { resampler ->
+                val block = inputRate / 100
+                val input = FloatArray(block)
+                val output = FloatArray(resampler.maxOutput(block))
+                val speech = SyntheticSpeech(7, inputRate, block, 0.6, 140.0)
+
+                // One second to warm caches and the JIT, then the timed run
+                repeat(100) {
+                    speech.fill(input)
+                    resampler.process(input, block, output)
+                }
+                var nanos = 0L
+                repeat(config.seconds * 100) {
+                    speech.fill(input)
+                    val start = System.nanoTime()
+                    resampler.process(input, block, output)
+                    nanos += System.nanoTime() - start
+                }
+                Measurement(
+                        resampler.describe(),
+                        resampler.macsPerOutput,
+                        resampler.singleStageMacsPerOutput,
+                        resampler.delaySamples,
+                        nanos / 1e6 / config.seconds
+                )
+            }
+}
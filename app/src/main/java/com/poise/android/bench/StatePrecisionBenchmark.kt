@@ -0,0 +1,169 @@
+package com.poise.android.bench
+
+import android.content.Context
+import com.poise.android.audio.AdmissionControl
+import com.poise.android.audio.GTCRNProcessor
+import com.poise.android.audio.PoiseProcessor
+import com.poise.android.audio.ProcessorModel
+import com.poise.android.audio.StateFormat
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import kotlin.math.abs
+import kotlin.math.log10
+import org.json.JSONArray
+import org.json.JSONObject
+
+/**
+ * Offline check of compact state storage: runs the same audio through one processor per
+ * [StateFormat] in lockstep and compares each output with the FP32 reference.
+ *
+ * Input is a 16-bit mono WAV at the model's rate ([Config.inputPath]) or, without one, a
+ * synthetic talk-spurt signal. Reported per format: output SNR against FP32, the worst sample
+ * deviation, and the state bytes each stream keeps resident.
+ */
+class StatePrecisionBenchmark(private val context: Context, private val config: Config = Config()) {
+
+    data class Config(
+            val model: ProcessorModel = ProcessorModel.GTCRN,
+            val inputPath: String? = null,
+            val seconds: Int = 30 // Synthetic input only
+    )
+
+    private val frameSamples: Int
+    private val sampleRate: Int
+
+    init {
+        require(config.model != ProcessorModel.CASCADE) { "Benchmark one model at a time" }
+        if (config.model == ProcessorModel.GTCRN) {
+            frameSamples = GTCRNProcessor.FRAME_SIZE
+            sampleRate = GTCRNProcessor.SAMPLE_RATE
+        } else {
+            frameSamples = PoiseProcessor.FRAME_SIZE
+            sampleRate = PoiseProcessor.SAMPLE_RATE
+        }
+    }
+
+    private class Variant(
+            val format: StateFormat,
+            val process: (FloatArray) -> FloatArray?,
+            val stateBytes: () -> Long,
+            val close: () -> Unit
+    ) {
+        var errorEnergy = 0.0
+        var maxDeviation = 0.0
+    }
+
+    fun run(): JSONObject {
+        val input = config.inputPath?.let { readWav(File(it)) } ?: synthesize()
+        AdmissionControl.setEnabled(false)
+        val variants = StateFormat.values().map { createVariant(it) }
+
+        var referenceEnergy = 0.0
+        val frame = FloatArray(frameSamples)
+        try {
+            var offset = 0
+            while (offset + frameSamples <= input.size) {
+                input.copyInto(frame, 0, offset, offset + frameSamples)
+                offset += frameSamples
+
+                // Each processor gets its own copy; outputs may alias the input
+                val reference = variants[0].process(frame.copyOf())?.copyOf() ?: continue
+                for (r in reference) referenceEnergy += r * r
+                for (variant in variants.drop(1)) {
+                    val output = variant.process(frame.copyOf()) ?: continue
+                    for (i in reference.indices) {
+                        val d = (output.getOrElse(i) { 0f } - reference[i]).toDouble()
+                        variant.errorEnergy += d * d
+                        variant.maxDeviation = maxOf(variant.maxDeviation, abs(d))
+                    }
+                }
+            }
+        } finally {
+            variants.forEach { it.close() }
+            AdmissionControl.setEnabled(true)
+        }
+
+        return JSONObject().apply {
+            put("benchmark", "state_precision")
+            put("model", config.model.name.lowercase())
+            put("input", config.inputPath ?: "synthetic")
+            put("seconds", input.size.toDouble() / sampleRate)
+            put(
+                    "formats",
+                    JSONArray().apply {
+                        for (variant in variants) {
+                            put(
+                                    JSONObject().apply {
+                                        put("format", variant.format.name)
+                                        put("stateBytesPerStream", variant.stateBytes())
+                                        if (variant.format != StateFormat.FP32) {
+                                            put("snrDb", snrDb(referenceEnergy, variant.errorEnergy))
+                                            put("maxDeviation", variant.maxDeviation)
+                                        }
+                                    }
+                            )
+                        }
+                    }
+            )
+        }
+    }
+
+    private fun createVariant(format: StateFormat): Variant =
+            if (config.model == ProcessorModel.GTCRN) {
+                val p = GTCRNProcessor(context, stateFormat = format)
+                Variant(format, p::processFrame, { p.stateResidentBytes }, p::close)
+            } else {
+                val p = PoiseProcessor(context, stateFormat = format)
+                Variant(format, p::processFrame, { p.stateResidentBytes }, p::close)
+            }
+
+    private fun snrDb(signal: Double, error: Double): Double =
+            if (error <= 0.0) 200.0 else 10.0 * log10(signal / error)
+
+    private fun synthesize(): FloatArray {
+        val signal = SyntheticSpeech(1, sampleRate, frameSamples, 0.6, 140.0)
+        val frames = config.seconds * sampleRate / frameSamples
+        val out = FloatArray(frames * frameSamples)
+        val frame = FloatArray(frameSamples)
+        for (f in 0 until frames) {
+            signal.fill(frame)
+            frame.copyInto(out, f * frameSamples)
+        }
+        return out
+    }
+
+    /** Minimal RIFF reader: 16-bit PCM, mono, at the model's sample rate. */
+    private fun readWav(file: File): FloatArray {
+        val bytes = ByteBuffer.wrap(file.readBytes()).order(ByteOrder.LITTLE_ENDIAN)
+        val isWav =
+                bytes.remaining() >= 12 &&
+                        bytes.getInt(0) == 0x46464952 && // "RIFF"
+                        bytes.getInt(8) == 0x45564157 // "WAVE"
+        require(isWav) { "${file.name} is not a WAV file" }
+        var position = 12
+        var samples: FloatArray? = null
+        while (position + 8 <= bytes.limit() && samples == null) {
+            val id = bytes.getInt(position)
+            val size = bytes.getInt(position + 4)
+            val body = position + 8
+            when (id) {
+                0x20746d66 -> { // "fmt "
+                    val channels = bytes.getShort(body + 2).toInt()
+                    val rate = bytes.getInt(body + 4)
+                    val bits = bytes.getShort(body + 14).toInt()
+                    val pcm = bytes.getShort(body).toInt() == 1
+                    require(pcm && channels == 1 && bits == 16 && rate == sampleRate) {
+                        "Need 16-bit PCM mono at $sampleRate Hz, got $bits-bit x$channels at $rate"
+                    }
+                }
+                0x61746164 -> { // "data"
+                    val count = minOf(size, bytes.limit() - body) / 2
+                    samples = FloatArray(count) { bytes.getShort(body + it * 2) / 32768f }
+                }
+            }
+            position = body + size + (size and 1)
+        }
+        return requireNotNull(samples) { "${file.name} has no data chunk" }
+    }
+}
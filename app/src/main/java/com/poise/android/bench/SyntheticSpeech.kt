@@ -0,0 +1,46 @@
+package com.poise.android.bench
+
+import kotlin.math.PI
+import kotlin.math.sin
+import kotlin.random.Random
+
+/**
+ * Deterministic talk-spurt signal for benchmarks: voiced harmonics over a little noise while
+ * "speaking", a -80 dBFS noise floor otherwise. Spurt lengths follow a two-state Markov chain
+ * whose long-run speech share is [speechFraction].
+ */
+class SyntheticSpeech(
+        seed: Long,
+        private val sampleRate: Int,
+        frameSamples: Int,
+        val speechFraction: Double,
+        private val pitchHz: Double,
+        meanSpurtMs: Double = 1200.0
+) {
+    private val rng = Random(seed)
+    private val frameMs = frameSamples * 1000.0 / sampleRate
+    private val meanOnMs = meanSpurtMs
+    private val meanOffMs = meanSpurtMs * (1.0 - speechFraction) / speechFraction
+    private var speaking = rng.nextDouble() < speechFraction
+    private var phase = 0.0
+
+    /** Fill [frame] with the next block of signal. */
+    fun fill(frame: FloatArray) {
+        val flip = frameMs / (if (speaking) meanOnMs else meanOffMs)
+        if (rng.nextDouble() < flip) speaking = !speaking
+
+        val step = 2.0 * PI * pitchHz / sampleRate
+        for (i in frame.indices) {
+            val noise = (rng.nextFloat() - 0.5f) * 2e-4f
+            frame[i] =
+                    if (speaking) {
+                        phase += step
+                        (0.08 * sin(phase) + 0.04 * sin(2 * phase) + 0.02 * sin(3 * phase))
+                                .toFloat() + noise * 50f
+                    } else {
+                        noise
+                    }
+        }
+        if (phase > 2.0 * PI) phase %= 2.0 * PI
+    }
+}
@@ -1,8 +1,11 @@
 package com.poise.android.service
 
 import android.app.*
+import android.content.BroadcastReceiver
+import android.content.ComponentCallbacks2
 import android.content.Context
 import android.content.Intent
+import android.content.IntentFilter
 import android.content.pm.ServiceInfo
 import android.media.AudioAttributes
 import android.media.AudioFocusRequest
@@ -11,12 +14,18 @@ import android.media.projection.MediaProjection
 import android.media.projection.MediaProjectionManager
 import android.os.Build
 import android.os.IBinder
+import android.os.PowerManager
 import android.util.Log
 import androidx.core.app.NotificationCompat
 import com.poise.android.MainActivity
 import com.poise.android.R
 import com.poise.android.audio.AudioPipeline
+import com.poise.android.audio.DenoiseDaemon
+import com.poise.android.audio.ModelRegistry
+import com.poise.android.audio.PowerMode
 import com.poise.android.audio.ProcessingStats
+import com.poise.android.audio.ProcessorModel
+import com.poise.android.audio.StateFormat
 import kotlinx.coroutines.*
 import kotlinx.coroutines.flow.StateFlow
 
@@ -35,8 +44,14 @@ class AudioCaptureService : Service() {
         const val ACTION_STOP = "com.poise.android.STOP_CAPTURE"
         const val ACTION_VOLUME_UP = "com.poise.android.VOLUME_UP"
         const val ACTION_VOLUME_DOWN = "com.poise.android.VOLUME_DOWN"
+        const val ACTION_SWITCH_MODEL = "com.poise.android.SWITCH_MODEL"
         const val EXTRA_RESULT_CODE = "result_code"
         const val EXTRA_RESULT_DATA = "result_data"
+        const val EXTRA_MODEL = "model" // ProcessorModel name, for ACTION_SWITCH_MODEL
+        // ACTION_START: also serve denoising to other processes while capturing (Boolean), and
+        // client uids accepted besides our own (IntArray)
+        const val EXTRA_SERVE_DAEMON = "serve_daemon"
+        const val EXTRA_DAEMON_UIDS = "daemon_uids"
         private const val VOLUME_STEP = 0.1f // 10% per tap
 
         private var instance: AudioCaptureService? = null
@@ -47,12 +62,27 @@ class AudioCaptureService : Service() {
     }
 
     private var audioPipeline: AudioPipeline? = null
+    private var denoiseDaemon: DenoiseDaemon? = null
     private var mediaProjection: MediaProjection? = null
     private var audioManager: AudioManager? = null
     private var audioFocusRequest: AudioFocusRequest? = null
     private var originalMusicVolume: Int = 0
     private val serviceScope = CoroutineScope(Dispatchers.IO + SupervisorJob())
 
+    // Nobody watches the screen while it is off, so latency can go for battery life
+    private val screenReceiver =
+            object : BroadcastReceiver() {
+                override fun onReceive(context: Context, intent: Intent) {
+                    when (intent.action) {
+                        Intent.ACTION_SCREEN_OFF ->
+                                audioPipeline?.setPowerMode(PowerMode.RACE_TO_IDLE)
+                        Intent.ACTION_SCREEN_ON ->
+                                audioPipeline?.setPowerMode(PowerMode.LOW_LATENCY)
+                    }
+                }
+            }
+    private var screenReceiverRegistered = false
+
     override fun onCreate() {
         super.onCreate()
         instance = this
@@ -77,6 +107,9 @@ class AudioCaptureService : Service() {
                 if (resultCode == Activity.RESULT_OK && resultData != null) {
                     try {
                         startCapture(resultCode, resultData)
+                        if (intent.getBooleanExtra(EXTRA_SERVE_DAEMON, false)) {
+                            startDaemon(intent.getIntArrayExtra(EXTRA_DAEMON_UIDS))
+                        }
                     } catch (e: Exception) {
                         Log.e(TAG, "Failed to start capture: ${e.message}", e)
                         stopSelf()
@@ -102,6 +135,16 @@ class AudioCaptureService : Service() {
                 AudioServiceState.setOutputVolume(current - VOLUME_STEP)
                 updateNotification()
             }
+            ACTION_SWITCH_MODEL -> {
+                // Loads in the background; playback continues on the current model meanwhile
+                val name = intent.getStringExtra(EXTRA_MODEL)
+                val target = ProcessorModel.values().firstOrNull { it.name == name }
+                if (target == null) {
+                    Log.w(TAG, "Unknown model: $name")
+                } else if (audioPipeline?.switchModel(target) != true) {
+                    Log.w(TAG, "Not switching to $target")
+                }
+            }
         }
         return START_NOT_STICKY
     }
@@ -138,6 +181,7 @@ class AudioCaptureService : Service() {
 
         // Start audio pipeline
         audioPipeline = AudioPipeline(this)
+        registerScreenReceiver()
         serviceScope.launch {
             try {
                 audioPipeline?.start(mediaProjection!!)
@@ -151,10 +195,29 @@ class AudioCaptureService : Service() {
         }
     }
 
+    /** Serve the shared model to local clients for as long as the foreground service runs. */
+    private fun startDaemon(allowedUids: IntArray?) {
+        if (denoiseDaemon != null) return
+        val daemon = DenoiseDaemon(this, StateFormat.FP16)
+        if (daemon.start(allowedUids = allowedUids)) {
+            denoiseDaemon = daemon
+        } else {
+            daemon.close()
+        }
+    }
+
     private fun stopCapture() {
         // Reset shared state
         AudioServiceState.reset()
 
+        denoiseDaemon?.close()
+        denoiseDaemon = null
+
+        if (screenReceiverRegistered) {
+            unregisterReceiver(screenReceiver)
+            screenReceiverRegistered = false
+        }
+
         // Restore system volume
         restoreSystemAudio()
 
@@ -176,6 +239,20 @@ class AudioCaptureService : Service() {
         Log.i(TAG, "Audio capture stopped")
     }
 
+    private fun registerScreenReceiver() {
+        val filter =
+                IntentFilter().apply {
+                    addAction(Intent.ACTION_SCREEN_OFF)
+                    addAction(Intent.ACTION_SCREEN_ON)
+                }
+        registerReceiver(screenReceiver, filter)
+        screenReceiverRegistered = true
+
+        // Started from a notification with the screen already off
+        val powerManager = getSystemService(Context.POWER_SERVICE) as PowerManager
+        if (!powerManager.isInteractive) audioPipeline?.setPowerMode(PowerMode.RACE_TO_IDLE)
+    }
+
     private fun requestAudioFocus() {
         if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.O) {
             val audioAttributes =
@@ -317,6 +394,14 @@ class AudioCaptureService : Service() {
 
     override fun onBind(intent: Intent?): IBinder? = null
 
+    override fun onTrimMemory(level: Int) {
+        super.onTrimMemory(level)
+        // Models stay loaded between captures for a fast restart; give them up under pressure
+        if (level >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW) {
+            ModelRegistry.trim()
+        }
+    }
+
     override fun onDestroy() {
         stopCapture()
         serviceScope.cancel()
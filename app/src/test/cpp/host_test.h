@@ -0,0 +1,56 @@
+/**
+ * Host Test Helpers - Header
+ *
+ * Minimal checks for the host unit tests: a failed check prints its
+ * location and marks the test failed, and the test's main() returns
+ * testResult() so CTest sees the outcome.
+ */
+
+#ifndef POISE_HOST_TEST_H
+#define POISE_HOST_TEST_H
+
+#include <cmath>
+#include <cstdio>
+
+namespace hosttest {
+
+inline int &failures() {
+  static int count = 0;
+  return count;
+}
+
+inline bool check(bool ok, const char *expr, const char *file, int line) {
+  if (!ok) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+    failures()++;
+  }
+  return ok;
+}
+
+inline bool checkNear(double actual, double expected, double tolerance,
+                      const char *expr, const char *file, int line) {
+  bool ok = std::fabs(actual - expected) <= tolerance;
+  if (!ok) {
+    std::fprintf(stderr, "%s:%d: %s = %g, expected %g +- %g\n", file, line,
+                 expr, actual, expected, tolerance);
+    failures()++;
+  }
+  return ok;
+}
+
+inline int testResult() {
+  if (failures() > 0) {
+    std::fprintf(stderr, "%d check(s) failed\n", failures());
+    return 1;
+  }
+  return 0;
+}
+
+} // namespace hosttest
+
+#define CHECK(expr) hosttest::check((expr), #expr, __FILE__, __LINE__)
+#define CHECK_NEAR(actual, expected, tolerance)                                \
+  hosttest::checkNear((actual), (expected), (tolerance), #actual, __FILE__,    \
+                      __LINE__)
+
+#endif // POISE_HOST_TEST_H
@@ -0,0 +1,103 @@
+/**
+ * Playout Buffer Tests
+ *
+ * Target depth tracking against real arrival timing: 4 ms blocks pushed on
+ * a steady schedule, then with periodic late arrivals, then steady again
+ * once the jitter history has turned over. Loaded hosts stall threads for
+ * 20 ms and more now and then, so the injected lateness is large, and the
+ * underrun target is loose enough to ride out a few stalls per window.
+ */
+
+#include "host_test.h"
+#include "playout_buffer.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace poise;
+
+namespace {
+
+constexpr int SAMPLE_RATE = 16000;
+constexpr int BLOCK = 64; // 4 ms
+constexpr int BLOCK_MS = 4;
+constexpr float NOISE_MS = 25.0f; // Allowance for host stalls
+constexpr float MIN_DEPTH_MS = 4.0f;
+constexpr float UNDERRUN_PROBABILITY = 0.05f;
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Push blocks on a 4 ms schedule; every lateEvery-th block (0 = none) is
+ * held back lateMs first, and the blocks queued behind it follow at once.
+ */
+void runSchedule(PlayoutBuffer &buffer, int blocks, int lateEvery,
+                 int lateMs) {
+  std::vector<float> in(BLOCK, 0.0f);
+  std::vector<float> out(BLOCK);
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < blocks; i++) {
+    Clock::time_point due = start + std::chrono::milliseconds(i * BLOCK_MS);
+    if (lateEvery > 0 && i % lateEvery == 0) {
+      due += std::chrono::milliseconds(lateMs);
+    }
+    std::this_thread::sleep_until(due);
+    buffer.push(in.data(), BLOCK);
+    CHECK(buffer.pull(out.data(), BLOCK) <= BLOCK);
+  }
+}
+
+void testTargetTracksJitter() {
+  PlayoutConfig config;
+  config.minDepthMs = MIN_DEPTH_MS;
+  config.underrunProbability = UNDERRUN_PROBABILITY;
+  PlayoutBuffer buffer(SAMPLE_RATE, config);
+  CHECK_NEAR(buffer.getStats().targetMs, MIN_DEPTH_MS, 0.1);
+
+  // On time: the target stays near the minimum
+  runSchedule(buffer, 300, 0, 0);
+  float steadyMs = buffer.getStats().targetMs;
+  CHECK(steadyMs >= MIN_DEPTH_MS);
+  CHECK(steadyMs < MIN_DEPTH_MS + NOISE_MS);
+
+  // One block in 32 arrives 60 ms late and the next ones catch up, so about
+  // half the blocks are late: the target must cover nearly all of it
+  runSchedule(buffer, 300, 32, 60);
+  PlayoutStats jittery = buffer.getStats();
+  CHECK(jittery.jitterMs > 50.0f);
+  CHECK(jittery.targetMs > MIN_DEPTH_MS + 50.0f);
+  CHECK(jittery.targetMs < MIN_DEPTH_MS + 60.0f + NOISE_MS);
+
+  // Once the 256-block history holds only on-time arrivals, it comes back
+  runSchedule(buffer, 400, 0, 0);
+  CHECK(buffer.getStats().targetMs < MIN_DEPTH_MS + NOISE_MS);
+}
+
+void testTargetClampedToMax() {
+  // Lateness plus minDepthMs exceeds maxDepthMs, but the arrival gaps stay
+  // well below it (a longer gap would count as a producer pause)
+  PlayoutConfig config;
+  config.minDepthMs = 30.0f;
+  config.maxDepthMs = 60.0f;
+  config.underrunProbability = UNDERRUN_PROBABILITY;
+  PlayoutBuffer buffer(SAMPLE_RATE, config);
+  runSchedule(buffer, 200, 32, 40);
+  CHECK_NEAR(buffer.getStats().targetMs, 60.0, 0.1);
+}
+
+void testPullAlwaysFills() {
+  PlayoutBuffer buffer(SAMPLE_RATE);
+  std::vector<float> out(BLOCK, 1.0f);
+  // Nothing pushed: prebuffering silence, no real samples
+  CHECK(buffer.pull(out.data(), BLOCK) == 0);
+  CHECK(out[0] == 0.0f && out[BLOCK - 1] == 0.0f);
+}
+
+} // anonymous namespace
+
+int main() {
+  testPullAlwaysFills();
+  testTargetTracksJitter();
+  testTargetClampedToMax();
+  return hosttest::testResult();
+}
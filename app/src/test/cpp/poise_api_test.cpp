@@ -0,0 +1,458 @@
+/**
+ * C API Tests
+ *
+ * Round trips through the public C ABI as a host would drive it: an
+ * identity model through the infer callback, through split phase and in a
+ * multi-stream batch, failure and non-finite handling, parked state,
+ * parameters, stats with an older struct, a legacy processor around a
+ * host-run model, and a resampler.
+ */
+
+#include "host_test.h"
+#include "poise_api.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr int FRAME = POISE_FRAME_SAMPLES;
+constexpr int FRAMES = 40;
+constexpr int DELAY = 256; // One STFT hop
+
+std::vector<float> noise(int count) {
+  std::vector<float> out(count);
+  uint32_t seed = 1;
+  for (float &x : out) {
+    seed = seed * 1664525u + 1013904223u;
+    x = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.5f;
+  }
+  return out;
+}
+
+struct Model {
+  int calls = 0;
+  int result = 0;
+  bool poison = false;
+};
+
+int inferIdentity(void *userData, float *real, float *imag, int numBins) {
+  auto *model = static_cast<Model *>(userData);
+  model->calls++;
+  if (model->poison) {
+    real[numBins / 2] = std::numeric_limits<float>::quiet_NaN();
+  }
+  (void)imag;
+  return model->result;
+}
+
+// Largest difference from the input delayed by DELAY, past the warm-up
+float delayedError(const std::vector<float> &in, const std::vector<float> &out) {
+  float error = 0.0f;
+  for (size_t i = 2 * DELAY; i < out.size(); i++) {
+    error = std::max(error, std::fabs(out[i] - in[i - DELAY]));
+  }
+  return error;
+}
+
+poise_stream *createStream(Model *model) {
+  poise_stream_config config;
+  poise_stream_config_init(&config);
+  config.infer = inferIdentity;
+  config.user_data = model;
+  poise_stream *stream = nullptr;
+  if (!CHECK(poise_stream_create(&config, &stream) == POISE_OK)) {
+    return nullptr;
+  }
+  return stream;
+}
+
+void testVersion() {
+  CHECK(poise_api_version() == POISE_API_VERSION);
+  CHECK(poise_api_version() >> 16 == POISE_API_VERSION_MAJOR);
+}
+
+void testProcessIdentity() {
+  Model model;
+  poise_stream *stream = createStream(&model);
+  if (stream == nullptr) {
+    return;
+  }
+  std::vector<float> in = noise(FRAMES * FRAME);
+  std::vector<float> out(in.size());
+  int ok = 0;
+  for (int f = 0; f < FRAMES; f++) {
+    ok += poise_stream_process(stream, &in[f * FRAME], &out[f * FRAME]) ==
+          POISE_OK;
+  }
+  CHECK(ok == FRAMES);
+  CHECK(model.calls == FRAMES);
+  CHECK(delayedError(in, out) < 1e-4f);
+
+  poise_stream_stats stats;
+  stats.struct_size = sizeof(stats);
+  CHECK(poise_stream_get_stats(stream, &stats) == POISE_OK);
+  CHECK(stats.frames == FRAMES);
+  CHECK(stats.frames_inferred == FRAMES);
+  CHECK(stats.non_finite_events == 0);
+
+  // A host built against a header with only the first counters: nothing
+  // past its struct is written
+  std::vector<uint8_t> old(sizeof(poise_stream_stats), 0xAB);
+  auto *oldStats = reinterpret_cast<poise_stream_stats *>(old.data());
+  size_t oldSize = offsetof(poise_stream_stats, frames_inferred);
+  oldStats->struct_size = static_cast<uint32_t>(oldSize);
+  CHECK(poise_stream_get_stats(stream, oldStats) == POISE_OK);
+  CHECK(oldStats->frames == FRAMES);
+  CHECK(old[oldSize] == 0xAB && old.back() == 0xAB);
+  poise_stream_destroy(stream);
+}
+
+void testSplitPhaseMatchesProcess() {
+  Model model;
+  poise_stream *stream = createStream(&model);
+  if (stream == nullptr) {
+    return;
+  }
+  std::vector<float> in = noise(FRAMES * FRAME);
+  std::vector<float> out(in.size());
+  float real[POISE_NUM_BINS];
+  float imag[POISE_NUM_BINS];
+  int ok = 0;
+  for (int f = 0; f < FRAMES; f++) {
+    ok += poise_stream_analyze(stream, &in[f * FRAME], real, imag) ==
+              POISE_OK &&
+          poise_stream_gate_open(stream) &&
+          poise_stream_synthesize(stream, real, imag, &out[f * FRAME]) ==
+              POISE_OK;
+  }
+  CHECK(ok == FRAMES);
+  CHECK(model.calls == 0);
+  CHECK(delayedError(in, out) < 1e-4f);
+
+  // After a reset the stream starts from silence again
+  poise_stream_reset(stream);
+  std::vector<float> again(in.size());
+  for (int f = 0; f < FRAMES; f++) {
+    poise_stream_analyze(stream, &in[f * FRAME], real, imag);
+    poise_stream_synthesize(stream, real, imag, &again[f * FRAME]);
+  }
+  CHECK(again == out);
+  poise_stream_destroy(stream);
+}
+
+void testFailuresPassThrough() {
+  Model model;
+  poise_stream *stream = createStream(&model);
+  if (stream == nullptr) {
+    return;
+  }
+  std::vector<float> in = noise(FRAMES * FRAME);
+  std::vector<float> out(in.size());
+
+  // A failing model passes the input through unchanged (but delayed)
+  model.result = 1;
+  int failed = 0;
+  for (int f = 0; f < FRAMES; f++) {
+    failed += poise_stream_process(stream, &in[f * FRAME], &out[f * FRAME]) ==
+              POISE_ERROR_INFERENCE_FAILED;
+  }
+  CHECK(failed == FRAMES);
+  CHECK(delayedError(in, out) < 1e-4f);
+
+  // NaN from the model: silence out, counted in the stats
+  model.result = 0;
+  model.poison = true;
+  std::vector<float> frame(FRAME, 1.0f);
+  CHECK(poise_stream_process(stream, in.data(), frame.data()) ==
+        POISE_ERROR_NON_FINITE);
+  bool silent = true;
+  for (float x : frame) {
+    silent = silent && x == 0.0f;
+  }
+  CHECK(silent);
+  poise_stream_stats stats;
+  stats.struct_size = sizeof(stats);
+  poise_stream_get_stats(stream, &stats);
+  CHECK(stats.non_finite_events == 1);
+  CHECK(stats.state_resets == 1);
+
+  CHECK(poise_stream_process(nullptr, in.data(), frame.data()) ==
+        POISE_ERROR_INVALID_ARGUMENT);
+  poise_stream_destroy(stream);
+}
+
+void testBatchMatchesSingle() {
+  // 5 streams fill an 8-lane batch with 3 idle lanes; stream 3's model
+  // fails and stream 4's produces NaN on the last frame
+  constexpr int STREAMS = 5;
+  Model models[STREAMS];
+  Model reference;
+  poise_stream *streams[STREAMS];
+  poise_stream *single = createStream(&reference);
+  for (int s = 0; s < STREAMS; s++) {
+    streams[s] = createStream(&models[s]);
+    if (streams[s] == nullptr || single == nullptr) {
+      return;
+    }
+  }
+  models[3].result = 1;
+
+  std::vector<float> in = noise(FRAMES * FRAME);
+  std::vector<float> expected(in.size());
+  for (int f = 0; f < FRAMES; f++) {
+    poise_stream_process(single, &in[f * FRAME], &expected[f * FRAME]);
+  }
+
+  // Each stream gets the input scaled differently so lanes cannot mix
+  std::vector<std::vector<float>> inputs(STREAMS, in);
+  std::vector<std::vector<float>> outputs(STREAMS,
+                                          std::vector<float>(in.size()));
+  for (int s = 0; s < STREAMS; s++) {
+    for (float &x : inputs[s]) {
+      x *= static_cast<float>(s + 1);
+    }
+  }
+  poise_status results[STREAMS];
+  int mismatched = 0;
+  for (int f = 0; f < FRAMES; f++) {
+    models[4].poison = f == FRAMES - 1;
+    const float *frameIn[STREAMS];
+    float *frameOut[STREAMS];
+    for (int s = 0; s < STREAMS; s++) {
+      frameIn[s] = &inputs[s][f * FRAME];
+      frameOut[s] = &outputs[s][f * FRAME];
+    }
+    CHECK(poise_stream_process_batch(streams, STREAMS, frameIn, frameOut,
+                                     results) == POISE_OK);
+    mismatched += results[0] != POISE_OK ||
+                  results[3] != POISE_ERROR_INFERENCE_FAILED ||
+                  results[4] != (f == FRAMES - 1 ? POISE_ERROR_NON_FINITE
+                                                 : POISE_OK);
+  }
+  CHECK(mismatched == 0);
+
+  float error = 0.0f;
+  for (int s = 0; s < 4; s++) {
+    for (size_t i = 0; i < in.size(); i++) {
+      error = std::max(error, std::fabs(outputs[s][i] / (s + 1) -
+                                        expected[i]));
+    }
+  }
+  CHECK(error < 1e-4f);
+  CHECK(outputs[4][in.size() - 1] == 0.0f);
+
+  poise_stream_stats stats;
+  stats.struct_size = sizeof(stats);
+  poise_stream_get_stats(streams[0], &stats);
+  CHECK(stats.frames == FRAMES && stats.frames_inferred == FRAMES);
+  poise_stream_get_stats(streams[4], &stats);
+  CHECK(stats.non_finite_events == 1);
+
+  // A stream listed twice is rejected before anything runs
+  poise_stream *twice[2] = {streams[0], streams[0]};
+  const float *frameIn[2] = {in.data(), in.data()};
+  float *frameOut[2] = {expected.data(), expected.data()};
+  CHECK(poise_stream_process_batch(twice, 2, frameIn, frameOut, results) ==
+        POISE_ERROR_INVALID_ARGUMENT);
+  CHECK(poise_stream_process_batch(streams, POISE_MAX_BATCH + 1, frameIn,
+                                   frameOut, results) ==
+        POISE_ERROR_INVALID_ARGUMENT);
+
+  for (poise_stream *stream : streams) {
+    poise_stream_destroy(stream);
+  }
+  poise_stream_destroy(single);
+}
+
+void testParkRestoreState() {
+  poise_stream *stream = nullptr;
+  if (!CHECK(poise_stream_create(nullptr, &stream) == POISE_OK)) {
+    return;
+  }
+  std::vector<float> state = noise(3000);
+  std::fill(state.begin() + 1000, state.begin() + 2000, 0.0f);
+  CHECK(poise_stream_park_state(stream, state.data(), state.size()) ==
+        POISE_OK);
+
+  std::vector<float> restored(state.size());
+  CHECK(poise_stream_restore_state(stream, restored.data(),
+                                   restored.size()) == POISE_OK);
+  float error = 0.0f;
+  for (size_t i = 0; i < state.size(); i++) {
+    error = std::max(error, std::fabs(restored[i] - state[i]));
+  }
+  CHECK(error <= 0.25f / 1024.0f); // FP16 step below 0.5
+  CHECK(restored[1500] == 0.0f);
+
+  // Restoring takes the parked state: a second restore finds nothing
+  CHECK(poise_stream_restore_state(stream, restored.data(),
+                                   restored.size()) ==
+        POISE_ERROR_INVALID_ARGUMENT);
+
+  // Wrong size: rejected and zeroed
+  CHECK(poise_stream_park_state(stream, state.data(), state.size()) ==
+        POISE_OK);
+  std::vector<float> wrong(state.size() - 1, 1.0f);
+  CHECK(poise_stream_restore_state(stream, wrong.data(), wrong.size()) ==
+        POISE_ERROR_INVALID_ARGUMENT);
+  CHECK(wrong[0] == 0.0f && wrong.back() == 0.0f);
+  poise_stream_destroy(stream);
+}
+
+void testParams() {
+  poise_stream *stream = nullptr;
+  if (!CHECK(poise_stream_create(nullptr, &stream) == POISE_OK)) {
+    return;
+  }
+  float value = 0.0f;
+  CHECK(poise_stream_get_param(stream, POISE_PARAM_BYPASS_GAIN_DB, &value) ==
+        POISE_OK);
+  CHECK(value == -24.0f);
+  CHECK(poise_stream_set_param(stream, POISE_PARAM_BYPASS_GAIN_DB, -12.0f) ==
+        POISE_OK);
+  poise_stream_get_param(stream, POISE_PARAM_BYPASS_GAIN_DB, &value);
+  CHECK(value == -12.0f);
+
+  // Off threshold is clamped to the on threshold
+  poise_stream_set_param(stream, POISE_PARAM_VAD_ON_THRESHOLD, 0.3f);
+  poise_stream_get_param(stream, POISE_PARAM_VAD_OFF_THRESHOLD, &value);
+  CHECK(value == 0.3f);
+
+  CHECK(poise_stream_set_param(stream, POISE_PARAM_DEADLINE_MS, 0.0f) ==
+        POISE_ERROR_INVALID_ARGUMENT);
+  CHECK(poise_stream_set_param(stream, POISE_PARAM_BYPASS_GAIN_DB, NAN) ==
+        POISE_ERROR_INVALID_ARGUMENT);
+  CHECK(poise_stream_get_param(stream, static_cast<poise_param>(99),
+                               &value) == POISE_ERROR_INVALID_ARGUMENT);
+  poise_stream_destroy(stream);
+}
+
+// 16 kHz capture in 10 ms chunks around an identity "model" at 48 kHz
+void testLegacyProcessor() {
+  poise_processor *processor = nullptr;
+  CHECK(poise_processor_create(nullptr, &processor) == POISE_OK);
+  CHECK(poise_processor_set_capture_rate(processor, 16000) == POISE_OK);
+  CHECK(poise_processor_set_playback_rate(processor, 16000) == POISE_OK);
+  CHECK(poise_processor_set_capture_rate(processor, 0) ==
+        POISE_ERROR_INVALID_ARGUMENT);
+  const int outputSamples = poise_processor_max_output(processor);
+  CHECK(outputSamples == 160);
+
+  constexpr int CHUNK = 160;
+  constexpr int CHUNKS = 50;
+  std::vector<float> in = noise(CHUNK * CHUNKS);
+  in[5 * CHUNK] = std::numeric_limits<float>::quiet_NaN();
+  float frame[POISE_LEGACY_FRAME_SAMPLES];
+  std::vector<float> output(outputSamples);
+  std::vector<float> state(64, 0.5f);
+  int begun = 0;
+  int written = 0;
+  int producedTotal = 0;
+  for (int c = 0; c < CHUNKS; c++) {
+    poise_status status = poise_processor_begin_frame(
+        processor, in.data() + c * CHUNK, CHUNK, frame);
+    if (status == POISE_ERROR_AGAIN) {
+      CHECK(begun == 0); // Only while the capture resampler fills
+      continue;
+    }
+    CHECK(status == POISE_OK);
+    begun++;
+    CHECK(std::all_of(frame, frame + POISE_LEGACY_FRAME_SAMPLES,
+                      [](float x) { return std::isfinite(x); }));
+    CHECK(poise_processor_check_vad(processor, frame) == POISE_OK);
+
+    // The model blows up once: the frame falls back to its input and the
+    // state is reset
+    bool poison = c == CHUNKS - 1;
+    if (poison) {
+      frame[7] = std::numeric_limits<float>::infinity();
+    }
+    status = poise_processor_finish_frame(processor, frame, output.data(),
+                                          outputSamples, &written);
+    CHECK(status == (poison ? POISE_ERROR_NON_FINITE : POISE_OK));
+    CHECK(written == 0 || written == outputSamples);
+    producedTotal += written;
+    if (poise_processor_state_due(processor)) {
+      CHECK(poise_processor_check_state(processor, state.data(),
+                                        state.size()) ==
+            (poison ? POISE_ERROR_NON_FINITE : POISE_OK));
+    }
+  }
+  CHECK(begun >= CHUNKS - 2);
+  CHECK(producedTotal >= (begun - 2) * outputSamples);
+  CHECK(state[0] == 0.0f);
+  CHECK(std::all_of(output.begin(), output.end(),
+                    [](float x) { return std::isfinite(x); }));
+  CHECK(poise_processor_finish_frame(processor, frame, output.data(),
+                                     outputSamples - 1, &written) ==
+        POISE_ERROR_INVALID_ARGUMENT);
+
+  poise_processor_stats stats = poise_processor_stats();
+  stats.struct_size = sizeof(stats);
+  CHECK(poise_processor_get_stats(processor, &stats) == POISE_OK);
+  CHECK(stats.frames_inferred == static_cast<uint64_t>(begun));
+  CHECK(stats.vad_speech == static_cast<uint64_t>(begun));
+  CHECK(stats.non_finite_events == 2); // The input NaN and the model's Inf
+  CHECK(stats.state_resets == 1);
+  CHECK(stats.memory_bytes > 0);
+
+  CHECK(poise_processor_park_state(processor, state.data(), state.size()) ==
+        POISE_OK);
+  std::vector<float> restored(state.size(), 1.0f);
+  CHECK(poise_processor_restore_state(processor, restored.data(),
+                                      restored.size()) == POISE_OK);
+  CHECK(restored == state);
+
+  poise_processor_reset(processor);
+  CHECK(poise_processor_state_due(processor) == 0);
+  poise_processor_destroy(processor);
+}
+
+void testResampler() {
+  CHECK(poise_resampler_create(0, 16000, POISE_RESAMPLE_BALANCED) == nullptr);
+  CHECK(poise_resampler_create(48000, 16000,
+                               static_cast<poise_resample_quality>(3)) ==
+        nullptr);
+
+  poise_resampler *resampler =
+      poise_resampler_create(48000, 16000, POISE_RESAMPLE_BALANCED);
+  if (!CHECK(resampler != nullptr)) {
+    return;
+  }
+  poise_resampler_info info;
+  info.struct_size = sizeof(info);
+  CHECK(poise_resampler_get_info(resampler, &info) == POISE_OK);
+  CHECK(info.stages == 2);
+  CHECK(info.macs_per_output <= info.direct_macs_per_output);
+
+  std::vector<float> in(768, 0.0f);
+  std::vector<float> out(poise_resampler_max_output(resampler, 768));
+  CHECK(poise_resampler_process(resampler, in.data(), 768, out.data(),
+                                static_cast<int>(out.size())) == 256);
+
+  char text[8];
+  size_t length = poise_resampler_describe(resampler, text, sizeof(text));
+  CHECK(length > sizeof(text));
+  CHECK(std::strlen(text) == sizeof(text) - 1);
+  poise_resampler_destroy(resampler);
+}
+
+} // anonymous namespace
+
+int main() {
+  testVersion();
+  testProcessIdentity();
+  testSplitPhaseMatchesProcess();
+  testFailuresPassThrough();
+  testBatchMatchesSingle();
+  testParkRestoreState();
+  testParams();
+  testLegacyProcessor();
+  testResampler();
+  return hosttest::testResult();
+}
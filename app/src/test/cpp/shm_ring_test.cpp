@@ -0,0 +1,177 @@
+/**
+ * Shared-Memory Ring Tests
+ *
+ * Frame order and wrap-around, full/empty handling, validation of a peer's
+ * header and indices, a producer and consumer on two threads over two
+ * mappings of one region, and the eventfd helpers.
+ */
+
+#include "host_test.h"
+#include "shm_ring.h"
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace poise;
+
+namespace {
+
+constexpr uint32_t CAPACITY = 4;
+constexpr uint32_t FRAME = 8;
+
+void fillFrame(float *frame, uint64_t n) {
+  for (uint32_t i = 0; i < FRAME; i++) {
+    frame[i] = static_cast<float>(n * FRAME + i);
+  }
+}
+
+void testInitRejectsBadGeometry() {
+  std::vector<uint8_t> memory(ShmRing::bytesFor(8, FRAME));
+  ShmRing ring;
+  CHECK(!ring.init(memory.data(), 0, FRAME));
+  CHECK(!ring.init(memory.data(), 6, FRAME));
+  CHECK(!ring.init(memory.data(), 8, 0));
+  CHECK(!ring.init(nullptr, 8, FRAME));
+  CHECK(!ring.valid());
+  CHECK(ShmRing::bytesFor(8, FRAME) % 64 == 0);
+}
+
+void testPushPopWraps() {
+  std::vector<uint8_t> memory(ShmRing::bytesFor(CAPACITY, FRAME));
+  ShmRing ring;
+  CHECK(ring.init(memory.data(), CAPACITY, FRAME));
+
+  float in[FRAME];
+  float out[FRAME];
+  uint64_t captureNs = 0;
+  CHECK(!ring.pop(out, &captureNs));
+
+  // Several laps around the ring, filling it completely each time
+  uint64_t next = 0;
+  uint64_t expected = 0;
+  for (int lap = 0; lap < 5; lap++) {
+    for (uint32_t i = 0; i < CAPACITY; i++, next++) {
+      fillFrame(in, next);
+      CHECK(ring.push(in, 1000 + next));
+    }
+    fillFrame(in, next);
+    CHECK(!ring.push(in, 0)); // Full
+    CHECK(ring.available() == CAPACITY);
+
+    uint64_t peeked = 0;
+    CHECK(ring.peekCaptureNs(&peeked) && peeked == 1000 + expected);
+    for (uint32_t i = 0; i < CAPACITY; i++, expected++) {
+      CHECK(ring.pop(out, &captureNs));
+      CHECK(captureNs == 1000 + expected);
+      CHECK(out[0] == static_cast<float>(expected * FRAME));
+      CHECK(out[FRAME - 1] == static_cast<float>(expected * FRAME + FRAME - 1));
+    }
+    CHECK(ring.available() == 0);
+  }
+}
+
+void testAttachValidatesPeer() {
+  size_t size = ShmRing::bytesFor(CAPACITY, FRAME);
+  std::vector<uint8_t> memory(size);
+  ShmRing owner;
+  CHECK(owner.init(memory.data(), CAPACITY, FRAME));
+
+  ShmRing peer;
+  CHECK(peer.attach(memory.data(), size));
+  CHECK(peer.capacity() == CAPACITY && peer.frameSamples() == FRAME);
+  CHECK(!ShmRing().attach(memory.data(), size - 1)); // Mapping too small
+
+  auto *header = reinterpret_cast<ShmRingHeader *>(memory.data());
+  header->magic = 0;
+  CHECK(!ShmRing().attach(memory.data(), size));
+  header->magic = SHM_RING_MAGIC;
+  header->capacity = 3;
+  CHECK(!ShmRing().attach(memory.data(), size));
+  header->capacity = CAPACITY;
+
+  // A write index the peer pushed past the capacity is not trusted
+  header->writeIndex.store(CAPACITY + 1);
+  float out[FRAME];
+  CHECK(!peer.pop(out, nullptr));
+  CHECK(peer.available() == 0);
+}
+
+void testTwoMappingsTwoThreads() {
+  size_t size = ShmRing::bytesFor(CAPACITY, FRAME);
+  SharedRegion producerRegion;
+  if (!CHECK(producerRegion.create("poise_test_ring", size))) {
+    return;
+  }
+  SharedRegion consumerRegion;
+  if (!CHECK(consumerRegion.map(dup(producerRegion.fd()), size))) {
+    return;
+  }
+
+  ShmRing producer;
+  CHECK(producer.init(producerRegion.data(), CAPACITY, FRAME));
+  ShmRing consumer;
+  CHECK(consumer.attach(consumerRegion.data(), size));
+
+  int ready = createEventFd();
+  CHECK(ready >= 0);
+  constexpr uint64_t FRAMES = 2000;
+
+  std::thread thread([&] {
+    float in[FRAME];
+    for (uint64_t n = 0; n < FRAMES;) {
+      fillFrame(in, n);
+      if (producer.push(in, n)) {
+        signalEventFd(ready);
+        n++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  float out[FRAME];
+  uint64_t received = 0;
+  bool ordered = true;
+  while (received < FRAMES) {
+    uint64_t captureNs = 0;
+    if (consumer.pop(out, &captureNs)) {
+      ordered = ordered && captureNs == received &&
+                out[FRAME - 1] == static_cast<float>(received * FRAME +
+                                                     FRAME - 1);
+      received++;
+    } else if (!waitEventFd(ready, 1000)) {
+      break;
+    }
+  }
+  thread.join();
+  CHECK(received == FRAMES);
+  CHECK(ordered);
+  close(ready);
+}
+
+void testEventFd() {
+  int fd = createEventFd();
+  if (!CHECK(fd >= 0)) {
+    return;
+  }
+  CHECK(!drainEventFd(fd));
+  CHECK(!waitEventFd(fd, 0));
+  signalEventFd(fd);
+  signalEventFd(fd);
+  CHECK(waitEventFd(fd, 0));
+  CHECK(!drainEventFd(fd)); // Both signals were drained by the wait
+  close(fd);
+}
+
+} // anonymous namespace
+
+int main() {
+  testInitRejectsBadGeometry();
+  testPushPopWraps();
+  testAttachValidatesPeer();
+  testTwoMappingsTwoThreads();
+  testEventFd();
+  return hosttest::testResult();
+}
@@ -0,0 +1,159 @@
+/**
+ * State Codec Tests
+ *
+ * FP16/BF16 conversion, the parked-state codec (FP16 + byte planes +
+ * PackBits) and resident PackedState round trips.
+ */
+
+#include "host_test.h"
+#include "state_codec.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace poise;
+
+namespace {
+
+void testHalfConversion() {
+  CHECK(floatToHalf(0.0f) == 0x0000);
+  CHECK(floatToHalf(-0.0f) == 0x8000);
+  CHECK(floatToHalf(1.0f) == 0x3C00);
+  CHECK(floatToHalf(-2.0f) == 0xC000);
+  CHECK(floatToHalf(65504.0f) == 0x7BFF);
+  CHECK(floatToHalf(std::numeric_limits<float>::infinity()) == 0x7C00);
+  CHECK((floatToHalf(std::numeric_limits<float>::quiet_NaN()) & 0x7FFF) >
+        0x7C00);
+
+  // Ties round to even: 1 + 0.5 ulp stays at 1, 1 + 1.5 ulp goes to 1 + 2 ulp
+  CHECK(floatToHalf(1.0f + 0.5f / 1024.0f) == 0x3C00);
+  CHECK(floatToHalf(1.0f + 1.5f / 1024.0f) == 0x3C02);
+
+  // Smallest subnormal, and values that flush to zero
+  CHECK(floatToHalf(5.9604645e-8f) == 0x0001);
+  CHECK(floatToHalf(1e-9f) == 0x0000);
+  CHECK(halfToFloat(0x0001) == 5.9604645e-8f);
+
+  // Every finite half survives a round trip through float exactly
+  int mismatches = 0;
+  for (uint32_t h = 0; h < 0x10000; h++) {
+    if ((h & 0x7C00) == 0x7C00) {
+      continue; // Inf/NaN
+    }
+    mismatches += floatToHalf(halfToFloat(static_cast<uint16_t>(h))) != h;
+  }
+  CHECK(mismatches == 0);
+}
+
+void testBFloat16Conversion() {
+  CHECK(floatToBFloat16(1.0f) == 0x3F80);
+  CHECK(bfloat16ToFloat(0x3F80) == 1.0f);
+  CHECK(bfloat16ToFloat(floatToBFloat16(1e30f)) > 9.9e29f);
+  float nan = std::numeric_limits<float>::quiet_NaN();
+  CHECK(std::isnan(bfloat16ToFloat(floatToBFloat16(nan))));
+}
+
+void testPackStateSaturates() {
+  const float values[] = {1e6f, -1e6f, 0.5f, -65504.0f};
+  uint16_t words[4];
+  packState(StateFormat::FP16, values, words, 4);
+  float back[4];
+  unpackState(StateFormat::FP16, words, back, 4);
+  CHECK(back[0] == 65504.0f);
+  CHECK(back[1] == -65504.0f);
+  CHECK(back[2] == 0.5f);
+  CHECK(back[3] == -65504.0f);
+
+  // Bulk conversion matches the scalar one (covers the vector path and
+  // its tail)
+  std::vector<float> ramp(37);
+  for (size_t i = 0; i < ramp.size(); i++) {
+    ramp[i] = (static_cast<float>(i) - 18.0f) * 0.123f;
+  }
+  std::vector<uint16_t> packed(ramp.size());
+  packState(StateFormat::FP16, ramp.data(), packed.data(), ramp.size());
+  int mismatches = 0;
+  for (size_t i = 0; i < ramp.size(); i++) {
+    mismatches += packed[i] != floatToHalf(ramp[i]);
+  }
+  CHECK(mismatches == 0);
+}
+
+void testCodecRoundTrip() {
+  // Long zero runs (longer than one PackBits run), a constant stretch and
+  // noise that has to go out as literals
+  std::vector<float> state(4096, 0.0f);
+  for (size_t i = 1000; i < 1300; i++) {
+    state[i] = 0.25f;
+  }
+  uint32_t seed = 7;
+  for (size_t i = 2000; i < 3000; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    state[i] = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 4.0f;
+  }
+
+  std::vector<uint8_t> packed;
+  StateCodec::encode(state.data(), state.size(), packed);
+  CHECK(packed.size() < state.size() * sizeof(uint16_t));
+
+  std::vector<float> decoded(state.size(), -1.0f);
+  CHECK(StateCodec::decode(packed, decoded.data(), decoded.size()));
+  int mismatches = 0;
+  for (size_t i = 0; i < state.size(); i++) {
+    mismatches += decoded[i] != halfToFloat(floatToHalf(state[i]));
+  }
+  CHECK(mismatches == 0);
+
+  // Out-of-range state saturates instead of coming back as Inf
+  const float large[] = {1e6f, -7e4f, 65504.0f, 70000.0f};
+  StateCodec::encode(large, 4, packed);
+  float back[4];
+  CHECK(StateCodec::decode(packed, back, 4));
+  CHECK(back[0] == 65504.0f && back[1] == -65504.0f);
+  CHECK(back[2] == 65504.0f && back[3] == 65504.0f);
+  StateCodec::encode(state.data(), state.size(), packed);
+
+  // Wrong size and truncated data are rejected
+  CHECK(!StateCodec::decode(packed, decoded.data(), decoded.size() - 1));
+  std::vector<uint8_t> truncated(packed.begin(), packed.end() - 3);
+  CHECK(!StateCodec::decode(truncated, decoded.data(), decoded.size()));
+}
+
+void testPackedState() {
+  const size_t slots[] = {5, 300};
+  for (StateFormat format :
+       {StateFormat::FP32, StateFormat::FP16, StateFormat::BF16}) {
+    PackedState state(format, slots, 2);
+    std::vector<float> a(5, 1.5f);
+    std::vector<float> b(300);
+    for (size_t i = 0; i < b.size(); i++) {
+      b[i] = static_cast<float>(i) / 64.0f;
+    }
+    state.store(0, a.data());
+    state.store(1, b.data());
+
+    std::vector<float> outA(5);
+    std::vector<float> outB(300);
+    state.load(0, outA.data());
+    state.load(1, outB.data());
+    CHECK(outA[4] == 1.5f);
+    // i / 64 needs at most 9 significant bits below 512
+    CHECK_NEAR(outB[299], 299.0f / 64.0f,
+               format == StateFormat::BF16 ? 0.02 : 0.0);
+
+    state.clear();
+    state.load(1, outB.data());
+    CHECK(outB[299] == 0.0f);
+  }
+}
+
+} // anonymous namespace
+
+int main() {
+  testHalfConversion();
+  testBFloat16Conversion();
+  testPackStateSaturates();
+  testCodecRoundTrip();
+  testPackedState();
+  return hosttest::testResult();
+}
@@ -0,0 +1,38 @@
+#!/usr/bin/env bash
+#
+# Cold-start benchmark driver. Runs the cold_start suite of BenchmarkActivity
+# in a fresh app process per run (am start -S force-stops the app first) and
+# collects one JSON report per line.
+#
+# Usage: scripts/bench_cold_start.sh [runs] [gtcrn|legacy] [output.jsonl]
+#
+# Reports with "coldProcess": false ran in a process that already had the
+# native library loaded and should be discarded.
+
+set -euo pipefail
+
+RUNS="${1:-10}"
+MODEL="${2:-gtcrn}"
+OUT="${3:-cold_start_${MODEL}.jsonl}"
+PACKAGE="com.poise.android"
+ACTIVITY="${PACKAGE}/.bench.BenchmarkActivity"
+TIMEOUT_S=120
+
+: > "$OUT"
+for run in $(seq 1 "$RUNS"); do
+  adb logcat -c
+  adb shell am start -S -W -n "$ACTIVITY" \
+    --es suite cold_start --es model "$MODEL" > /dev/null
+
+  # The activity logs its report as a single JSON line under the PoiseBench tag
+  report=$(timeout "$TIMEOUT_S" adb logcat -v raw -s PoiseBench:I | grep -m 1 '^{' || true)
+  if [[ -z "$report" ]]; then
+    echo "run $run: no report within ${TIMEOUT_S}s" >&2
+    continue
+  fi
+  echo "$report" >> "$OUT"
+  echo "run $run: $report"
+done
+
+adb shell am force-stop "$PACKAGE"
+echo "Wrote $(wc -l < "$OUT") reports to $OUT"
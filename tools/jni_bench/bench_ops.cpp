@@ -0,0 +1,111 @@
+/**
+ * JNI Overhead Benchmark - Operations Implementation
+ *
+ * The legacy ops drive PoiseProcessor the way the bridge does, without the
+ * resamplers (the benchmark runs at the model rate).
+ */
+
+#include "bench_ops.h"
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace jnibench {
+
+const OpShape SHAPES[NUM_OPS] = {
+    {"legacy_pre", LEGACY_FRAME, LEGACY_FRAME},     // nativeProcessPreInference
+    {"legacy_vad", LEGACY_FRAME, 0},                // nativeCheckVAD
+    {"legacy_post", LEGACY_FRAME, LEGACY_FRAME},    // nativePostProcess
+    {"stft_analyze", GTCRN_FRAME, 2 * NUM_BINS},    // nativeComputeSTFT
+    {"stft_synthesize", 2 * NUM_BINS, GTCRN_FRAME}, // nativeReconstruct
+    {"cascade_mix", 2 * CASCADE_FRAME, CASCADE_FRAME}, // light, heavy
+    {"idle_observe", LEGACY_FRAME, 0},                 // IdleGate
+    {"playout_cycle", GTCRN_FRAME, GTCRN_FRAME},       // push + pull
+    {"state_store", static_cast<int>(STATE_SLOT), 0},
+    {"state_load", 0, static_cast<int>(STATE_SLOT)},
+};
+
+Fixture::Fixture(poise::StateFormat format)
+    : state(format, &STATE_SLOT, 1), in(STATE_SLOT), out(STATE_SLOT) {
+  // Low-level noise: keeps the VAD, limiter and FFT on their usual paths
+  uint32_t seed = 1;
+  for (float &sample : in) {
+    seed = seed * 1664525u + 1013904223u;
+    sample = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.1f;
+  }
+}
+
+void runOp(Fixture &f, int op, const float *in, float *out) {
+  switch (op) {
+  case OP_LEGACY_PRE:
+    std::memcpy(out, in, LEGACY_FRAME * sizeof(float));
+    f.processor.scrubInput(out, LEGACY_FRAME);
+    f.processor.beginFrame();
+    break;
+  case OP_LEGACY_VAD:
+    f.sink = f.sink + f.processor.checkVad(in, LEGACY_FRAME);
+    break;
+  case OP_LEGACY_POST:
+    std::memcpy(out, in, LEGACY_FRAME * sizeof(float));
+    f.processor.finishFrame(out, LEGACY_FRAME);
+    break;
+  case OP_STFT_ANALYZE:
+    f.stft.computeSTFT(in, out, out + NUM_BINS);
+    break;
+  case OP_STFT_SYNTHESIZE:
+    f.stft.reconstructAudio(in, in + NUM_BINS, out);
+    break;
+  case OP_CASCADE_MIX:
+    f.cascade.observeLightOutput(in, CASCADE_FRAME);
+    f.cascade.mix(in, in + CASCADE_FRAME, out, CASCADE_FRAME);
+    break;
+  case OP_IDLE_OBSERVE:
+    f.sink = f.sink + static_cast<int>(f.idleGate.observe(in, LEGACY_FRAME));
+    break;
+  case OP_PLAYOUT_CYCLE:
+    f.playout.push(in, GTCRN_FRAME);
+    f.sink = f.sink + f.playout.pull(out, GTCRN_FRAME);
+    break;
+  case OP_STATE_STORE:
+    f.state.store(0, in);
+    break;
+  case OP_STATE_LOAD:
+    f.state.load(0, out);
+    break;
+  default:
+    break;
+  }
+}
+
+int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+double timeHandleLookup(int iterations) {
+  // Shaped like the bridge's handle maps
+  static std::unordered_map<int64_t, std::unique_ptr<Fixture>> lookupMap;
+  static std::mutex lookupMutex;
+  if (iterations <= 0) {
+    return 0.0;
+  }
+  {
+    std::lock_guard<std::mutex> lock(lookupMutex);
+    for (int64_t handle = 1; handle <= 4 && lookupMap.size() < 4; handle++) {
+      lookupMap[handle] = nullptr;
+    }
+  }
+  volatile size_t found = 0;
+  int64_t start = nowNs();
+  for (int i = 0; i < iterations; i++) {
+    std::lock_guard<std::mutex> lock(lookupMutex);
+    auto it = lookupMap.find(static_cast<int64_t>(i & 3) + 1);
+    found = found + (it != lookupMap.end());
+  }
+  return static_cast<double>(nowNs() - start) / iterations;
+}
+
+} // namespace jnibench
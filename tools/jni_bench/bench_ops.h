@@ -0,0 +1,89 @@
+/**
+ * JNI Overhead Benchmark - Operations
+ *
+ * The work behind each measured per-frame entry point, run on core objects
+ * owned outside the bridge's handle maps. Shared by the JNI shim, which
+ * wraps it in each marshalling variant, and by the native baseline driver,
+ * which needs no JVM.
+ */
+
+#ifndef POISE_JNI_BENCH_OPS_H
+#define POISE_JNI_BENCH_OPS_H
+
+#include "idle_gate.h"
+#include "model_cascade.h"
+#include "playout_buffer.h"
+#include "poise_processor.h"
+#include "state_codec.h"
+#include "stft.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jnibench {
+
+// Must match the OP_* constants in Overhead.java
+enum Op : int {
+  OP_LEGACY_PRE = 0,
+  OP_LEGACY_VAD = 1,
+  OP_LEGACY_POST = 2,
+  OP_STFT_ANALYZE = 3,
+  OP_STFT_SYNTHESIZE = 4,
+  OP_CASCADE_MIX = 5,
+  OP_IDLE_OBSERVE = 6,
+  OP_PLAYOUT_CYCLE = 7,
+  OP_STATE_STORE = 8,
+  OP_STATE_LOAD = 9,
+  NUM_OPS
+};
+
+constexpr int LEGACY_FRAME = 480; // 10 ms at 48 kHz
+constexpr int GTCRN_FRAME = poise::STFTProcessor::HOP_SIZE; // 16 ms at 16 kHz
+constexpr int NUM_BINS = poise::STFTProcessor::NUM_BINS;
+constexpr int CASCADE_FRAME = 768;                  // 16 ms at 48 kHz
+constexpr size_t STATE_SLOT = 2 * 1 * 16 * 16 * 33; // GTCRN conv cache
+
+struct OpShape {
+  const char *name; // As in Overhead.OP_NAMES
+  int in;           // Floats read per frame
+  int out;          // Floats written per frame
+};
+
+extern const OpShape SHAPES[NUM_OPS];
+
+inline bool validOp(int op) { return op >= 0 && op < NUM_OPS; }
+
+/**
+ * The core objects behind the measured entry points.
+ */
+struct Fixture {
+  poise::PoiseProcessor processor;
+  poise::STFTProcessor stft;
+  poise::ModelCascade cascade;
+  poise::IdleGate idleGate{48000, LEGACY_FRAME};
+  poise::PlayoutBuffer playout{16000};
+  poise::PackedState state;
+
+  // Native-side buffers for the raw loop and the copy variant
+  std::vector<float> in;
+  std::vector<float> out;
+  volatile int sink = 0;
+
+  explicit Fixture(poise::StateFormat format);
+};
+
+// One frame of op; in and out hold at least SHAPES[op].in / .out floats
+void runOp(Fixture &f, int op, const float *in, float *out);
+
+int64_t nowNs();
+
+/**
+ * Lock a mutex and find a handle in an unordered_map, as every bridge entry
+ * point does before its work.
+ * @return Nanoseconds per lookup
+ */
+double timeHandleLookup(int iterations);
+
+} // namespace jnibench
+
+#endif // POISE_JNI_BENCH_OPS_H
@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""Generate the Java stand-ins for the app classes that declare natives.
+
+The bench harness calls every `external fun` of the app from a desktop JVM,
+which cannot load the Kotlin classes themselves. This reads the Kotlin
+sources and writes one Java class per declaring class with the same native
+methods (static, so the harness needs no instances; the JNI symbols are the
+same), plus Java copies of the classes the bridge constructs, such as
+ProcessingStats, with the same constructor. A signature change on the
+Kotlin side then changes the stubs, and the harness or the bridge's
+GetMethodID lookups fail instead of measuring a stale copy.
+
+A class with methods marked "// Called from the native ..." is a host the
+bridge calls back into: its stub is abstract, with instance natives, and
+the harness implements the callbacks.
+
+    gen_stubs.py <kotlin-source-root> <out-dir>
+
+Prints the generated files, one per line.
+"""
+
+import os
+import re
+import sys
+
+PRIMITIVES = {
+    "Int": "int",
+    "Long": "long",
+    "Float": "float",
+    "Double": "double",
+    "Boolean": "boolean",
+    "Short": "short",
+    "Byte": "byte",
+    "Unit": "void",
+    "String": "String",
+    "IntArray": "int[]",
+    "LongArray": "long[]",
+    "FloatArray": "float[]",
+    "DoubleArray": "double[]",
+    "ShortArray": "short[]",
+    "ByteArray": "byte[]",
+    "BooleanArray": "boolean[]",
+    "Array<String>": "String[]",
+}
+
+PACKAGE = re.compile(r"^package\s+([\w.]+)", re.M)
+DECLARATION = re.compile(
+    r"^\s*(?:(?:public|internal|private)\s+)?"
+    r"(data\s+class|enum\s+class|class|object)\s+(\w+)")
+EXTERNAL = re.compile(
+    r"external\s+fun\s+(\w+)\s*\((.*?)\)\s*(?::\s*([\w<>?]+))?", re.S)
+PARAMETER = re.compile(r"^(?:val\s+|var\s+)?(\w+)\s*:\s*([\w<>?]+)")
+CALLBACK = re.compile(
+    r"//\s*Called from (?:the )?native[^\n]*\n(?:\s*@[^\n]*\n)*"
+    r"\s*(?:(?:private|internal|protected)\s+)?fun\s+(\w+)\s*\((.*?)\)"
+    r"\s*(?::\s*([\w<>?]+))?", re.S)
+
+
+class Source:
+    def __init__(self, path):
+        with open(path, encoding="utf-8") as f:
+            self.text = f.read()
+        self.path = path
+        match = PACKAGE.search(self.text)
+        self.package = match.group(1) if match else ""
+
+
+def strip_comments(text):
+    """Blank out comments, keeping every offset."""
+    blank = lambda m: re.sub(r"[^\n]", " ", m.group())
+    return re.sub(r"//[^\n]*", blank, re.sub(r"/\*.*?\*/", blank, text,
+                                               flags=re.S))
+
+
+def top_level_classes(source):
+    """(name, kind, start, end) of each top-level declaration; each runs to
+    the next one."""
+    text = strip_comments(source.text)
+    classes = []
+    depth = 0
+    pos = 0
+    for line in text.splitlines(keepends=True):
+        match = DECLARATION.match(line) if depth == 0 else None
+        if match:
+            if classes:
+                classes[-1][3] = pos
+            classes.append([match.group(2), match.group(1), pos, len(text)])
+        pos += len(line)
+        depth += line.count("{") - line.count("}")
+    return text, classes
+
+
+def split_parameters(text):
+    """Top-level comma split, ignoring commas inside <>, () and defaults."""
+    parts, depth, current = [], 0, ""
+    for ch in text:
+        if ch in "<(":
+            depth += 1
+        elif ch in ">)":
+            depth -= 1
+        if ch == "," and depth == 0:
+            parts.append(current)
+            current = ""
+        else:
+            current += ch
+    if current.strip():
+        parts.append(current)
+    return [p.strip() for p in parts if p.strip()]
+
+
+class Generator:
+    def __init__(self, root):
+        self.sources = []
+        for directory, _, files in os.walk(root):
+            for name in sorted(files):
+                if name.endswith(".kt"):
+                    self.sources.append(Source(os.path.join(directory, name)))
+        self.sources.sort(key=lambda s: s.path)
+        self.wanted = []  # (package, name) of constructed classes
+        self.files = {}
+
+    def java_type(self, kotlin, package, where):
+        kotlin = kotlin.rstrip("?")
+        if kotlin in PRIMITIVES:
+            return PRIMITIVES[kotlin]
+        if re.fullmatch(r"\w+", kotlin) and self.find(package, kotlin):
+            if (package, kotlin) not in self.wanted:
+                self.wanted.append((package, kotlin))
+            return kotlin
+        sys.exit(f"{where}: no Java mapping for Kotlin type {kotlin}")
+
+    def find(self, package, name):
+        for source in self.sources:
+            if source.package != package:
+                continue
+            text, classes = top_level_classes(source)
+            for cls, kind, start, end in classes:
+                if cls == name:
+                    return source, text[start:end], kind
+        return None
+
+    def signature(self, source, match):
+        """Java "result name(type param, ...)" of a fun declaration."""
+        where = f"{source.path}: {match.group(1)}"
+        params = []
+        for param in split_parameters(match.group(2)):
+            p = PARAMETER.match(param)
+            if not p:
+                sys.exit(f"{where}: cannot parse '{param}'")
+            java = self.java_type(p.group(2), source.package, where)
+            params.append(f"{java} {p.group(1)}")
+        result = self.java_type(match.group(3) or "Unit", source.package,
+                                where)
+        return f"{result} {match.group(1)}({', '.join(params)})"
+
+    def natives(self):
+        for source in self.sources:
+            text, classes = top_level_classes(source)
+            for name, _, start, end in classes:
+                natives = [self.signature(source, m)
+                           for m in EXTERNAL.finditer(text, start, end)]
+                if not natives:
+                    continue
+                callbacks = [self.signature(source, m) for m in
+                             CALLBACK.finditer(source.text, start, end)]
+                if callbacks:
+                    body = (f"public abstract class {name} {{\n"
+                            + "\n\n".join(f"    public native {n};"
+                                           for n in natives) + "\n\n"
+                            + "\n\n".join(f"    protected abstract {c};"
+                                           for c in callbacks) + "\n}\n")
+                else:
+                    body = (f"public final class {name} {{\n"
+                            f"    private {name}() {{}}\n\n"
+                            + "\n\n".join(f"    public static native {n};"
+                                           for n in natives) + "\n}\n")
+                self.emit(source, name, body)
+
+    def constructed(self):
+        # Types named in native signatures, and any they need in turn
+        i = 0
+        while i < len(self.wanted):
+            package, name = self.wanted[i]
+            i += 1
+            source, body, kind = self.find(package, name)
+            if kind.startswith("enum"):
+                constants = body[body.index("{") + 1:]
+                constants = constants.split(";")[0].split("}")[0]
+                names = [c.strip() for c in constants.split(",") if c.strip()]
+                self.emit(source, name,
+                          f"public enum {name} {{\n"
+                          f"    {', '.join(names)}\n}}\n")
+                continue
+            if "(" not in body.split("{")[0]:
+                sys.exit(f"{source.path}: {name} has no primary constructor")
+            header = body[body.index("(") + 1:]
+            depth, end = 1, 0
+            while depth:
+                depth += {"(": 1, ")": -1}.get(header[end], 0)
+                end += 1
+            fields, params, assigns = [], [], []
+            for param in split_parameters(header[:end - 1]):
+                p = PARAMETER.match(param)
+                where = f"{source.path}: {name}"
+                if not p:
+                    sys.exit(f"{where}: cannot parse '{param}'")
+                java = self.java_type(p.group(2), package, where)
+                fields.append(f"    public final {java} {p.group(1)};")
+                params.append(f"            {java} {p.group(1)}")
+                assigns.append(f"        this.{p.group(1)} = {p.group(1)};")
+            self.emit(source, name,
+                      f"public final class {name} {{\n"
+                      + "\n".join(fields) + "\n\n"
+                      f"    public {name}(\n" + ",\n".join(params) + ") {\n"
+                      + "\n".join(assigns) + "\n    }\n}\n")
+
+    def emit(self, source, name, body):
+        path = os.path.join(*source.package.split("."), name + ".java")
+        origin = os.path.basename(source.path)
+        self.files[path] = (
+            f"// Generated from {origin} by tools/jni_bench/gen_stubs.py\n"
+            f"package {source.package};\n\n{body}")
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: gen_stubs.py <kotlin-source-root> <out-dir>")
+    generator = Generator(sys.argv[1])
+    generator.natives()
+    generator.constructed()
+    for path, text in sorted(generator.files.items()):
+        out = os.path.join(sys.argv[2], path)
+        os.makedirs(os.path.dirname(out), exist_ok=True)
+        # Leave unchanged files alone so javac does not rebuild them
+        try:
+            with open(out, encoding="utf-8") as f:
+                unchanged = f.read() == text
+        except OSError:
+            unchanged = False
+        if not unchanged:
+            with open(out, "w", encoding="utf-8") as f:
+                f.write(text)
+        print(out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,666 @@
+package com.poise.android.jnibench;
+
+import com.poise.android.audio.AdmissionControl;
+import com.poise.android.audio.BurstScheduler;
+import com.poise.android.audio.CascadeProcessor;
+import com.poise.android.audio.DenoiseDaemon;
+import com.poise.android.audio.GTCRNProcessor;
+import com.poise.android.audio.IdleGate;
+import com.poise.android.audio.ModelCrossfade;
+import com.poise.android.audio.NativeLog;
+import com.poise.android.audio.NativeMemory;
+import com.poise.android.audio.NativeMetrics;
+import com.poise.android.audio.PlayoutBuffer;
+import com.poise.android.audio.PoiseProcessor;
+import com.poise.android.audio.Resampler;
+import com.poise.android.audio.StateStore;
+import com.poise.android.bench.BenchNative;
+import java.io.File;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Locale;
+import java.util.Random;
+
+/**
+ * Measures what crossing JNI costs per call for every entry point of poise_native, on a desktop
+ * JVM against the host build of the library.
+ *
+ * For each entry point the report has the cost of the call from Java through the shipped bridge
+ * function and, where the bridge wraps a core C++ operation, the cost of that operation called
+ * directly in a native loop; the difference is the boundary overhead. The parts of that overhead
+ * are measured on their own: an empty native call, a mutex plus handle-map lookup and
+ * NewFloatArray. Each per-frame operation is also run through the copy, critical, direct-buffer
+ * and batched marshalling variants in jni_overhead.cpp, and the per-frame entry points of each
+ * model are summed against its frame period.
+ *
+ * <pre>
+ * java -Djava.library.path=&lt;dir of libpoise_native.so&gt; -jar jni_bench.jar \
+ *     [report.json] [iterations] [batch]
+ * </pre>
+ *
+ * Host numbers are for comparing marshalling strategies; absolute per-frame figures for a phone
+ * come from running the same comparison on ART.
+ */
+public final class JniOverheadBench {
+
+    private static final int LEGACY_FRAME = 480;
+    private static final int GTCRN_FRAME = 256;
+    private static final int SPECTRUM = 514;
+    private static final int CASCADE_FRAME = 768;
+    private static final int LEGACY_STATE = 45304;
+    // GTCRN conv, tra and inter caches
+    private static final int[] STATE_SLOTS = {
+        2 * 1 * 16 * 16 * 33, 2 * 3 * 1 * 1 * 16, 2 * 1 * 33 * 16
+    };
+    private static final int STATE_FP16 = 1;
+    private static final int LOG_WARN = 5;
+    private static final int RESAMPLE_BALANCED = 1;
+
+    private static final int ROUNDS = 7;
+    // Creating and destroying native objects is much slower than a frame call
+    private static final int LIFECYCLE_DIVISOR = 20;
+
+    private static final String LEGACY = "legacy";
+    private static final String GTCRN = "gtcrn";
+    private static final String CASCADE = "cascade_controller";
+    private static final String[] ALL_MODELS = {LEGACY, GTCRN, CASCADE};
+    private static final String[] NO_MODELS = {};
+
+    /** One measured entry point (or lifecycle pair). */
+    private static final class Case {
+        final String name;
+        final String[] frameModels; // Models calling it once per frame
+        final int rawOp; // Core operation behind it, or -1
+        final boolean lifecycle;
+        final Runnable call;
+
+        double productionNs;
+        double rawNs = Double.NaN;
+
+        Case(String name, String[] frameModels, int rawOp, boolean lifecycle, Runnable call) {
+            this.name = name;
+            this.frameModels = frameModels;
+            this.rawOp = rawOp;
+            this.lifecycle = lifecycle;
+            this.call = call;
+        }
+    }
+
+    /** Daemon host whose callbacks pass audio through. */
+    private static final class DaemonHost extends DenoiseDaemon {
+        @Override
+        protected boolean onStreamOpened(int streamId) {
+            return true;
+        }
+
+        @Override
+        protected boolean processFrame(int streamId, float[] input, float[] output) {
+            System.arraycopy(input, 0, output, 0, Math.min(input.length, output.length));
+            return true;
+        }
+
+        @Override
+        protected void onStreamClosed(int streamId) {}
+    }
+
+    private final int iterations;
+    private final int batch;
+    private final File tempDir;
+    private final List<Case> cases = new ArrayList<>();
+
+    private final float[] legacyFrame = new float[LEGACY_FRAME];
+    private final float[] gtcrnFrame = new float[GTCRN_FRAME];
+    private final float[] light = new float[CASCADE_FRAME];
+    private final float[] heavy = new float[CASCADE_FRAME];
+    private final float[] slot = new float[STATE_SLOTS[0]];
+    private final float[] traCache = new float[STATE_SLOTS[1]];
+    private final float[] interCache = new float[STATE_SLOTS[2]];
+    private final float[] legacyState = new float[LEGACY_STATE];
+    private final float[] pullOut = new float[GTCRN_FRAME];
+    private float[] spectrum = new float[SPECTRUM];
+
+    private JniOverheadBench(int iterations, int batch, File tempDir) {
+        this.iterations = iterations;
+        this.batch = batch;
+        this.tempDir = tempDir;
+        Random random = new Random(1);
+        for (float[] buffer : new float[][] {legacyFrame, gtcrnFrame, light, heavy, slot}) {
+            for (int i = 0; i < buffer.length; i++) {
+                buffer[i] = (random.nextFloat() - 0.5f) * 0.1f;
+            }
+        }
+    }
+
+    public static void main(String[] args) throws IOException {
+        File report = new File(args.length > 0 ? args[0] : "jni_overhead.json");
+        int iterations = args.length > 1 ? Integer.parseInt(args[1]) : 20000;
+        int batch = args.length > 2 ? Integer.parseInt(args[2]) : 8;
+
+        System.loadLibrary("poise_native");
+        File tempDir = Files.createTempDirectory("poise_jni_bench").toFile();
+        String json = new JniOverheadBench(iterations, batch, tempDir).run();
+        Files.write(report.toPath(), json.getBytes(StandardCharsets.UTF_8));
+        System.out.println("Wrote " + report.getAbsolutePath());
+    }
+
+    private String run() {
+        // Entry points are measured with bookkeeping as shipped, but admission decisions and
+        // lifecycle logging would only add noise
+        NativeLog.nativeSetMinLevel(LOG_WARN);
+        AdmissionControl.nativeSetEnabled(false);
+
+        long fixture = Overhead.nativeCreateFixture(STATE_FP16);
+        StringBuilder json = new StringBuilder();
+        try {
+            json.append("{\"benchmark\":\"jni_overhead\"");
+            json.append(",\"jvm\":").append(quote(System.getProperty("java.vm.name") + " "
+                    + System.getProperty("java.version")));
+            json.append(",\"arch\":").append(quote(System.getProperty("os.arch")));
+            json.append(",\"iterations\":").append(iterations);
+            json.append(",\"batch\":").append(batch);
+            appendFixedCosts(json);
+            appendEntryPoints(json, fixture);
+            appendVariants(json, fixture);
+            appendFrames(json);
+            json.append('}');
+        } finally {
+            Overhead.nativeDestroyFixture(fixture);
+        }
+        return json.toString();
+    }
+
+    // ========================================================================
+    // Measurement
+    // ========================================================================
+
+    /** Median over rounds of the mean cost per call, after one warm-up round. */
+    private static double nsPerCall(Runnable call, int iterations) {
+        for (int i = 0; i < iterations; i++) {
+            call.run();
+        }
+        double[] rounds = new double[ROUNDS];
+        for (int r = 0; r < ROUNDS; r++) {
+            long start = System.nanoTime();
+            for (int i = 0; i < iterations; i++) {
+                call.run();
+            }
+            rounds[r] = (double) (System.nanoTime() - start) / iterations;
+        }
+        return median(rounds);
+    }
+
+    private double rawNsPerCall(long fixture, int op) {
+        Overhead.nativeRaw(fixture, op, iterations);
+        double[] rounds = new double[ROUNDS];
+        for (int r = 0; r < ROUNDS; r++) {
+            rounds[r] = Overhead.nativeRaw(fixture, op, iterations);
+        }
+        return median(rounds);
+    }
+
+    private static double median(double[] values) {
+        Arrays.sort(values);
+        return values[values.length / 2];
+    }
+
+    // ========================================================================
+    // Fixed costs
+    // ========================================================================
+
+    private void appendFixedCosts(StringBuilder json) {
+        double emptyNs = nsPerCall(Overhead::nativeEmpty, iterations);
+        double[] lookupRounds = new double[ROUNDS];
+        for (int r = 0; r < ROUNDS; r++) {
+            lookupRounds[r] = Overhead.nativeLookup(iterations);
+        }
+        double lookupNs = median(lookupRounds);
+
+        json.append(",\"emptyCallNs\":").append(fmt(emptyNs));
+        json.append(",\"lookupNs\":").append(fmt(lookupNs));
+        json.append(",\"newFloatArrayNs\":{");
+        int[] sizes = {4, GTCRN_FRAME, LEGACY_FRAME, SPECTRUM};
+        for (int i = 0; i < sizes.length; i++) {
+            int size = sizes[i];
+            double ns = nsPerCall(() -> Overhead.nativeNewFloatArray(size), iterations) - emptyNs;
+            json.append(i > 0 ? "," : "").append(quote(Integer.toString(size)));
+            json.append(':').append(fmt(ns));
+        }
+        json.append('}');
+
+        System.out.printf(Locale.ROOT, "empty call %.1f ns, lock + lookup %.1f ns%n",
+                emptyNs, lookupNs);
+    }
+
+    // ========================================================================
+    // Entry points
+    // ========================================================================
+
+    private void appendEntryPoints(StringBuilder json, long fixture) {
+        List<Long> handles = createHandles();
+        try {
+            registerCases(handles);
+            System.out.printf(Locale.ROOT, "%-64s %12s %12s %12s%n",
+                    "entry point", "call ns", "raw ns", "overhead ns");
+            for (Case c : cases) {
+                int n = c.lifecycle ? Math.max(1, iterations / LIFECYCLE_DIVISOR) : iterations;
+                c.productionNs = nsPerCall(c.call, n);
+                if (c.rawOp >= 0) {
+                    c.rawNs = rawNsPerCall(fixture, c.rawOp);
+                }
+                System.out.printf(Locale.ROOT, "%-64s %12.1f %12s %12s%n", c.name,
+                        c.productionNs, Double.isNaN(c.rawNs) ? "-" : fmt(c.rawNs),
+                        Double.isNaN(c.rawNs) ? "-" : fmt(c.productionNs - c.rawNs));
+            }
+        } finally {
+            destroyHandles(handles);
+        }
+
+        json.append(",\"entryPoints\":[");
+        for (int i = 0; i < cases.size(); i++) {
+            Case c = cases.get(i);
+            json.append(i > 0 ? "," : "").append("{\"name\":").append(quote(c.name));
+            json.append(",\"lifecycle\":").append(c.lifecycle);
+            json.append(",\"productionNs\":").append(fmt(c.productionNs));
+            if (!Double.isNaN(c.rawNs)) {
+                json.append(",\"rawOp\":").append(quote(Overhead.OP_NAMES[c.rawOp]));
+                json.append(",\"rawNs\":").append(fmt(c.rawNs));
+                json.append(",\"overheadNs\":").append(fmt(c.productionNs - c.rawNs));
+            }
+            json.append(",\"frameModels\":[");
+            for (int m = 0; m < c.frameModels.length; m++) {
+                json.append(m > 0 ? "," : "").append(quote(c.frameModels[m]));
+            }
+            json.append("]}");
+        }
+        json.append(']');
+    }
+
+    // Indices into the handle list
+    private static final int H_LEGACY = 0;
+    private static final int H_STFT = 1;
+    private static final int H_GATED_STFT = 2;
+    private static final int H_CASCADE = 3;
+    private static final int H_IDLE = 4;
+    private static final int H_PLAYOUT = 5;
+    private static final int H_STATE = 6;
+    private static final int H_DAEMON = 7;
+    private static final int H_CROSSFADE = 8;
+    private static final int H_DOWNSAMPLER = 9;
+    private static final int H_UPSAMPLER = 10;
+    private static final int H_BURST = 11;
+
+    private DenoiseDaemon daemon;
+
+    private List<Long> createHandles() {
+        List<Long> handles = new ArrayList<>();
+        handles.add(PoiseProcessor.nativeInit(-40f, -60f));
+        handles.add(GTCRNProcessor.nativeSTFTInit());
+        long gated = GTCRNProcessor.nativeSTFTInit();
+        GTCRNProcessor.nativeLoadNeuralVad(gated, new float[Overhead.nativeNeuralVadParams()]);
+        handles.add(gated);
+        handles.add(CascadeProcessor.nativeCascadeInit(-30f, 300, 8, 0, 768));
+        handles.add(IdleGate.nativeInit(48000, LEGACY_FRAME, -60f, 2000f, 500f));
+        handles.add(PlayoutBuffer.nativeInit(16000, 0.01f, 200f));
+        handles.add(StateStore.nativeCreate(STATE_FP16, STATE_SLOTS));
+        daemon = new DaemonHost();
+        handles.add(daemon.nativeStart("@poise_jni_bench", 16000, GTCRN_FRAME, null));
+        long crossfade = ModelCrossfade.nativeInit(48000, 50f, LEGACY_FRAME);
+        ModelCrossfade.nativeStart(crossfade, 0);
+        handles.add(crossfade);
+        handles.add(Resampler.nativeInit(48000, 16000, RESAMPLE_BALANCED));
+        handles.add(Resampler.nativeInit(16000, 48000, RESAMPLE_BALANCED));
+        handles.add(BurstScheduler.nativeInit(48000, 160f));
+
+        float[] analyzed = GTCRNProcessor.nativeComputeSTFT(handles.get(H_STFT), gtcrnFrame);
+        if (analyzed != null) {
+            spectrum = analyzed;
+        }
+        return handles;
+    }
+
+    private void destroyHandles(List<Long> handles) {
+        PoiseProcessor.nativeDestroy(handles.get(H_LEGACY));
+        GTCRNProcessor.nativeSTFTDestroy(handles.get(H_STFT));
+        GTCRNProcessor.nativeSTFTDestroy(handles.get(H_GATED_STFT));
+        CascadeProcessor.nativeCascadeDestroy(handles.get(H_CASCADE));
+        IdleGate.nativeDestroy(handles.get(H_IDLE));
+        PlayoutBuffer.nativeDestroy(handles.get(H_PLAYOUT));
+        StateStore.nativeDestroy(handles.get(H_STATE));
+        daemon.nativeStop(handles.get(H_DAEMON));
+        ModelCrossfade.nativeDestroy(handles.get(H_CROSSFADE));
+        Resampler.nativeDestroy(handles.get(H_DOWNSAMPLER));
+        Resampler.nativeDestroy(handles.get(H_UPSAMPLER));
+        BurstScheduler.nativeDestroy(handles.get(H_BURST));
+    }
+
+    private void add(String name, String[] models, int rawOp, Runnable call) {
+        cases.add(new Case(name, models, rawOp, false, call));
+    }
+
+    private void addLifecycle(String name, Runnable call) {
+        cases.add(new Case(name, NO_MODELS, -1, true, call));
+    }
+
+    private void registerCases(List<Long> handles) {
+        final long legacy = handles.get(H_LEGACY);
+        final long stft = handles.get(H_STFT);
+        final long gated = handles.get(H_GATED_STFT);
+        final long cascade = handles.get(H_CASCADE);
+        final long idle = handles.get(H_IDLE);
+        final long playout = handles.get(H_PLAYOUT);
+        final long state = handles.get(H_STATE);
+        final long daemonHandle = handles.get(H_DAEMON);
+        final long crossfade = handles.get(H_CROSSFADE);
+        final float[] crossfadeOut = new float[4 * LEGACY_FRAME];
+        final long downsampler = handles.get(H_DOWNSAMPLER);
+        final long upsampler = handles.get(H_UPSAMPLER);
+        final long burst = handles.get(H_BURST);
+        final float[] frame16k = new float[GTCRN_FRAME];
+        final float[] frame48k = new float[CASCADE_FRAME];
+        final String[] gtcrnFrames = {GTCRN, CASCADE};
+        final float[] vadWeights = new float[Overhead.nativeNeuralVadParams()];
+        final String metricsFile = new File(tempDir, "metrics.txt").getPath();
+        final String noListener = new File(tempDir, "no_listener.sock").getPath();
+        final String[] legacyOnly = {LEGACY};
+        final String[] gtcrnOnly = {GTCRN};
+        final String[] cascadeOnly = {CASCADE};
+
+        add("PoiseProcessor.nativeProcessPreInference", legacyOnly, Overhead.OP_LEGACY_PRE,
+                () -> PoiseProcessor.nativeProcessPreInference(legacy, legacyFrame));
+        add("PoiseProcessor.nativeCheckVAD", legacyOnly, Overhead.OP_LEGACY_VAD,
+                () -> PoiseProcessor.nativeCheckVAD(legacy, legacyFrame));
+        add("PoiseProcessor.nativePostProcess", legacyOnly, Overhead.OP_LEGACY_POST,
+                () -> PoiseProcessor.nativePostProcess(legacy, legacyFrame, null));
+        add("PoiseProcessor.nativeGetStats", NO_MODELS, -1,
+                () -> PoiseProcessor.nativeGetStats(legacy));
+        add("PoiseProcessor.nativeMemoryUsage", NO_MODELS, -1,
+                () -> PoiseProcessor.nativeMemoryUsage(legacy));
+        add("PoiseProcessor.nativeReportUnderrun", NO_MODELS, -1,
+                () -> PoiseProcessor.nativeReportUnderrun(legacy));
+        add("PoiseProcessor.nativeParkState+nativeRestoreState", NO_MODELS, -1, () -> {
+            PoiseProcessor.nativeParkState(legacy, legacyState);
+            PoiseProcessor.nativeRestoreState(legacy, legacyState);
+        });
+        add("PoiseProcessor.nativeReset", NO_MODELS, -1,
+                () -> PoiseProcessor.nativeReset(legacy));
+        addLifecycle("PoiseProcessor.nativeInit+nativeSetup*Resampler+nativeDestroy", () -> {
+            long h = PoiseProcessor.nativeInit(-40f, -60f);
+            PoiseProcessor.nativeSetupInputResampler(h, 44100, 48000);
+            PoiseProcessor.nativeSetupOutputResampler(h, 48000, 44100);
+            PoiseProcessor.nativeDestroy(h);
+        });
+
+        add("GTCRNProcessor.nativeComputeSTFT", gtcrnOnly, Overhead.OP_STFT_ANALYZE,
+                () -> GTCRNProcessor.nativeComputeSTFT(stft, gtcrnFrame));
+        add("GTCRNProcessor.nativeGateSpeech", gtcrnOnly, -1,
+                () -> GTCRNProcessor.nativeGateSpeech(gated));
+        add("GTCRNProcessor.nativeReconstruct", gtcrnOnly, Overhead.OP_STFT_SYNTHESIZE,
+                () -> GTCRNProcessor.nativeReconstruct(stft, spectrum));
+        add("GTCRNProcessor.nativeReconstructBypass", NO_MODELS, Overhead.OP_STFT_SYNTHESIZE,
+                () -> GTCRNProcessor.nativeReconstructBypass(stft));
+        add("GTCRNProcessor.nativeLoadNeuralVad", NO_MODELS, -1,
+                () -> GTCRNProcessor.nativeLoadNeuralVad(gated, vadWeights));
+        add("GTCRNProcessor.nativeMemoryUsage", NO_MODELS, -1,
+                () -> GTCRNProcessor.nativeMemoryUsage(stft));
+        add("GTCRNProcessor.nativeEnhancementStats", NO_MODELS, -1,
+                () -> GTCRNProcessor.nativeEnhancementStats(stft));
+        add("GTCRNProcessor.nativeReportUnderrun", NO_MODELS, -1,
+                () -> GTCRNProcessor.nativeReportUnderrun(stft));
+        add("GTCRNProcessor.nativeCountSkipped", NO_MODELS, -1,
+                () -> GTCRNProcessor.nativeCountSkipped(stft, 1));
+        add("GTCRNProcessor.nativeCheckCaches", NO_MODELS, -1,
+                () -> GTCRNProcessor.nativeCheckCaches(stft, slot, traCache, interCache));
+        add("GTCRNProcessor.nativeParkCaches+nativeRestoreCaches", NO_MODELS, -1, () -> {
+            GTCRNProcessor.nativeParkCaches(stft, slot, traCache, interCache);
+            GTCRNProcessor.nativeRestoreCaches(stft, slot, traCache, interCache);
+        });
+        add("GTCRNProcessor.nativeSTFTReset", NO_MODELS, -1,
+                () -> GTCRNProcessor.nativeSTFTReset(stft));
+        addLifecycle("GTCRNProcessor.nativeSTFTInit+nativeSTFTDestroy",
+                () -> GTCRNProcessor.nativeSTFTDestroy(GTCRNProcessor.nativeSTFTInit()));
+
+        add("CascadeProcessor.nativeCascadeDecide", cascadeOnly, -1,
+                () -> CascadeProcessor.nativeCascadeDecide(cascade));
+        add("CascadeProcessor.nativeCascadeMix", cascadeOnly, Overhead.OP_CASCADE_MIX,
+                () -> CascadeProcessor.nativeCascadeMix(cascade, light, heavy));
+        add("CascadeProcessor.nativeCascadeGetStats", NO_MODELS, -1,
+                () -> CascadeProcessor.nativeCascadeGetStats(cascade));
+        add("CascadeProcessor.nativeCascadeReset", NO_MODELS, -1,
+                () -> CascadeProcessor.nativeCascadeReset(cascade));
+        addLifecycle("CascadeProcessor.nativeCascadeInit+nativeCascadeDestroy",
+                () -> CascadeProcessor.nativeCascadeDestroy(
+                        CascadeProcessor.nativeCascadeInit(-30f, 300, 8, 0, 768)));
+
+        add("IdleGate.nativeReadSamples", ALL_MODELS, -1,
+                () -> IdleGate.nativeReadSamples(idle));
+        add("IdleGate.nativeObserve", ALL_MODELS, Overhead.OP_IDLE_OBSERVE,
+                () -> IdleGate.nativeObserve(idle, legacyFrame, LEGACY_FRAME));
+        add("IdleGate.nativeProbeSamples", NO_MODELS, -1,
+                () -> IdleGate.nativeProbeSamples(idle));
+        add("IdleGate.nativeMaxReadSamples", NO_MODELS, -1,
+                () -> IdleGate.nativeMaxReadSamples(idle));
+        add("IdleGate.nativeSetActiveFrames", NO_MODELS, -1,
+                () -> IdleGate.nativeSetActiveFrames(idle, 1));
+        add("IdleGate.nativeWakeOffset", NO_MODELS, -1, () -> IdleGate.nativeWakeOffset(idle));
+        add("IdleGate.nativeGetStats", NO_MODELS, -1, () -> IdleGate.nativeGetStats(idle));
+        addLifecycle("IdleGate.nativeInit+nativeDestroy",
+                () -> IdleGate.nativeDestroy(
+                        IdleGate.nativeInit(48000, LEGACY_FRAME, -60f, 2000f, 500f)));
+
+        add("PlayoutBuffer.nativePush+nativePull", ALL_MODELS, Overhead.OP_PLAYOUT_CYCLE, () -> {
+            PlayoutBuffer.nativePush(playout, gtcrnFrame, GTCRN_FRAME);
+            PlayoutBuffer.nativePull(playout, pullOut, GTCRN_FRAME);
+        });
+        add("PlayoutBuffer.nativeResync", NO_MODELS, -1,
+                () -> PlayoutBuffer.nativeResync(playout));
+        add("PlayoutBuffer.nativeGetStats", NO_MODELS, -1,
+                () -> PlayoutBuffer.nativeGetStats(playout));
+        add("PlayoutBuffer.nativeUnderruns", NO_MODELS, -1,
+                () -> PlayoutBuffer.nativeUnderruns(playout));
+        addLifecycle("PlayoutBuffer.nativeInit+nativeDestroy",
+                () -> PlayoutBuffer.nativeDestroy(PlayoutBuffer.nativeInit(16000, 0.01f, 200f)));
+
+        // Once per capture read: every frame in low-latency mode, every burst otherwise
+        add("BurstScheduler.nativeBeginBurst+nativeEndBurst", ALL_MODELS, -1, () -> {
+            BurstScheduler.nativeBeginBurst(burst);
+            BurstScheduler.nativeEndBurst(burst, LEGACY_FRAME);
+        });
+        add("BurstScheduler.nativeBurstFrames", NO_MODELS, -1,
+                () -> BurstScheduler.nativeBurstFrames(burst, CASCADE_FRAME));
+        add("BurstScheduler.nativeSetMode", NO_MODELS, -1,
+                () -> BurstScheduler.nativeSetMode(burst, 0));
+        add("BurstScheduler.nativeGetStats", NO_MODELS, -1,
+                () -> BurstScheduler.nativeGetStats(burst));
+        add("BurstScheduler.nativeResetStats", NO_MODELS, -1,
+                () -> BurstScheduler.nativeResetStats(burst));
+        addLifecycle("BurstScheduler.nativeInit+nativeDestroy",
+                () -> BurstScheduler.nativeDestroy(BurstScheduler.nativeInit(48000, 160f)));
+
+        // Per frame only with compact state, so not in the frame totals
+        add("StateStore.nativeStore", NO_MODELS, Overhead.OP_STATE_STORE,
+                () -> StateStore.nativeStore(state, 0, slot));
+        add("StateStore.nativeLoad", NO_MODELS, Overhead.OP_STATE_LOAD,
+                () -> StateStore.nativeLoad(state, 0, slot));
+        add("StateStore.nativeClear", NO_MODELS, -1, () -> StateStore.nativeClear(state));
+        add("StateStore.nativeResidentBytes", NO_MODELS, -1,
+                () -> StateStore.nativeResidentBytes(state));
+        addLifecycle("StateStore.nativeCreate+nativeDestroy",
+                () -> StateStore.nativeDestroy(StateStore.nativeCreate(STATE_FP16, STATE_SLOTS)));
+
+        // GTCRN runs at 16 kHz inside the 48 kHz pipeline: one of each per frame
+        add("Resampler.nativeProcess(48k->16k)", gtcrnFrames, -1,
+                () -> Resampler.nativeProcess(downsampler, light, CASCADE_FRAME, frame16k));
+        add("Resampler.nativeProcess(16k->48k)", gtcrnFrames, -1,
+                () -> Resampler.nativeProcess(upsampler, gtcrnFrame, GTCRN_FRAME, frame48k));
+        addLifecycle("Resampler.nativeInit+nativeDestroy",
+                () -> Resampler.nativeDestroy(
+                        Resampler.nativeInit(44100, 16000, RESAMPLE_BALANCED)));
+
+        // Only during a hot model switch, so not in the frame totals
+        add("ModelCrossfade.nativePush*+nativePull", NO_MODELS, -1, () -> {
+            ModelCrossfade.nativePushOutgoing(crossfade, legacyFrame, LEGACY_FRAME);
+            ModelCrossfade.nativePushIncoming(crossfade, legacyFrame, LEGACY_FRAME);
+            ModelCrossfade.nativePull(crossfade, crossfadeOut);
+        });
+        add("ModelCrossfade.nativeIsDone", NO_MODELS, -1,
+                () -> ModelCrossfade.nativeIsDone(crossfade));
+        add("ModelCrossfade.nativeDroppedSamples", NO_MODELS, -1,
+                () -> ModelCrossfade.nativeDroppedSamples(crossfade));
+        addLifecycle("ModelCrossfade.nativeInit+nativeDestroy",
+                () -> ModelCrossfade.nativeDestroy(
+                        ModelCrossfade.nativeInit(48000, 50f, CASCADE_FRAME)));
+
+        add("DenoiseDaemon.nativeStreamCount", NO_MODELS, -1,
+                () -> daemon.nativeStreamCount(daemonHandle));
+        addLifecycle("DenoiseDaemon.nativeStart+nativeStop", () -> {
+            DenoiseDaemon host = new DaemonHost();
+            host.nativeStop(
+                    host.nativeStart("@poise_jni_bench_lifecycle", 16000, GTCRN_FRAME, null));
+        });
+
+        add("NativeLog.nativeSetMinLevel", NO_MODELS, -1,
+                () -> NativeLog.nativeSetMinLevel(LOG_WARN));
+        add("NativeLog.nativeSetSink", NO_MODELS, -1, () -> NativeLog.nativeSetSink(1, null));
+        add("NativeLog.nativePrepareThread", NO_MODELS, -1, NativeLog::nativePrepareThread);
+        add("NativeLog.nativeFlush", NO_MODELS, -1, NativeLog::nativeFlush);
+        add("NativeLog.nativeDroppedRecords", NO_MODELS, -1, NativeLog::nativeDroppedRecords);
+
+        addLifecycle("BenchNative.nativePinCurrentThread+nativeUnpinCurrentThread", () -> {
+            BenchNative.nativePinCurrentThread(0);
+            BenchNative.nativeUnpinCurrentThread();
+        });
+
+        // The request path only runs with admission enabled; the case before it turns it on
+        add("AdmissionControl.nativeSetEnabled", NO_MODELS, -1,
+                () -> AdmissionControl.nativeSetEnabled(true));
+        add("AdmissionControl.nativeRequest", NO_MODELS, -1,
+                () -> AdmissionControl.nativeRequest(GTCRN, LEGACY));
+        add("AdmissionControl.nativeSetTargetUtilization", NO_MODELS, -1,
+                () -> AdmissionControl.nativeSetTargetUtilization(0.75f));
+        add("AdmissionControl.nativeGetStats", NO_MODELS, -1,
+                AdmissionControl::nativeGetStats);
+
+        add("NativeMemory.nativeComponentNames", NO_MODELS, -1,
+                NativeMemory::nativeComponentNames);
+        add("NativeMemory.nativeUsage", NO_MODELS, -1, NativeMemory::nativeUsage);
+        add("NativeMemory.nativeResetPeaks", NO_MODELS, -1, NativeMemory::nativeResetPeaks);
+        add("NativeMemory.nativeSetModelBytes", NO_MODELS, -1,
+                () -> NativeMemory.nativeSetModelBytes(0));
+
+        add("NativeMetrics.nativeRender", NO_MODELS, -1, NativeMetrics::nativeRender);
+        add("NativeMetrics.nativeExportToFile", NO_MODELS, -1,
+                () -> NativeMetrics.nativeExportToFile(metricsFile));
+        add("NativeMetrics.nativeExportToSocket (no listener)", NO_MODELS, -1,
+                () -> NativeMetrics.nativeExportToSocket(noListener));
+        // Last: enables flight recorder dumps for everything after it
+        add("NativeMetrics.nativeSetFlightRecorderDir", NO_MODELS, -1,
+                () -> NativeMetrics.nativeSetFlightRecorderDir(tempDir.getPath()));
+    }
+
+    // ========================================================================
+    // Marshalling variants
+    // ========================================================================
+
+    private void appendVariants(StringBuilder json, long fixture) {
+        System.out.printf(Locale.ROOT, "%n%-16s %10s %10s %10s %10s %10s%n", "op", "raw",
+                "copy", "critical", "direct", "batched");
+        json.append(",\"variants\":[");
+        for (int op = 0; op < Overhead.NUM_OPS; op++) {
+            final int o = op;
+            int inSize = Math.max(1, Overhead.nativeInputSize(op));
+            int outSize = Math.max(1, Overhead.nativeOutputSize(op));
+            float[] in = Arrays.copyOf(slot, inSize);
+            float[] out = new float[outSize];
+            FloatBuffer directIn = directBuffer(inSize);
+            FloatBuffer directOut = directBuffer(outSize);
+            FloatBuffer batchIn = directBuffer(inSize * batch);
+            FloatBuffer batchOut = directBuffer(outSize * batch);
+            directIn.put(in).rewind();
+            for (int f = 0; f < batch; f++) {
+                batchIn.put(in);
+            }
+            batchIn.rewind();
+
+            double rawNs = rawNsPerCall(fixture, op);
+            double copyNs = nsPerCall(() -> Overhead.nativeCopy(fixture, o, in, out), iterations);
+            double criticalNs =
+                    nsPerCall(() -> Overhead.nativeCritical(fixture, o, in, out), iterations);
+            double directNs = nsPerCall(
+                    () -> Overhead.nativeDirect(fixture, o, directIn, directOut, 1), iterations);
+            double batchedNs = nsPerCall(
+                    () -> Overhead.nativeDirect(fixture, o, batchIn, batchOut, batch),
+                    Math.max(1, iterations / batch)) / batch;
+
+            System.out.printf(Locale.ROOT, "%-16s %10.1f %10.1f %10.1f %10.1f %10.1f%n",
+                    Overhead.OP_NAMES[op], rawNs, copyNs, criticalNs, directNs, batchedNs);
+            json.append(op > 0 ? "," : "").append("{\"op\":").append(quote(Overhead.OP_NAMES[op]));
+            json.append(",\"inFloats\":").append(Overhead.nativeInputSize(op));
+            json.append(",\"outFloats\":").append(Overhead.nativeOutputSize(op));
+            json.append(",\"rawNs\":").append(fmt(rawNs));
+            json.append(",\"copyNs\":").append(fmt(copyNs));
+            json.append(",\"criticalNs\":").append(fmt(criticalNs));
+            json.append(",\"directNs\":").append(fmt(directNs));
+            json.append(",\"batchedNsPerFrame\":").append(fmt(batchedNs));
+            json.append('}');
+        }
+        json.append(']');
+    }
+
+    private static FloatBuffer directBuffer(int floats) {
+        return ByteBuffer.allocateDirect(floats * 4).order(ByteOrder.nativeOrder()).asFloatBuffer();
+    }
+
+    // ========================================================================
+    // Per-frame budget
+    // ========================================================================
+
+    private void appendFrames(StringBuilder json) {
+        String[] models = ALL_MODELS;
+        double[] frameMs = {10.0, 16.0, 16.0};
+
+        System.out.printf(Locale.ROOT, "%n%-20s %12s %12s %12s %10s%n", "frame path", "call ns",
+                "raw ns", "overhead ns", "% budget");
+        json.append(",\"frames\":[");
+        for (int m = 0; m < models.length; m++) {
+            double callNs = 0;
+            double overheadNs = 0;
+            int calls = 0;
+            for (Case c : cases) {
+                if (!Arrays.asList(c.frameModels).contains(models[m])) {
+                    continue;
+                }
+                calls++;
+                callNs += c.productionNs;
+                // Without a raw counterpart the whole call is boundary cost
+                overheadNs += Double.isNaN(c.rawNs) ? c.productionNs : c.productionNs - c.rawNs;
+            }
+            double budgetFraction = overheadNs / (frameMs[m] * 1e6);
+
+            System.out.printf(Locale.ROOT, "%-20s %12.1f %12.1f %12.1f %9.4f%%%n", models[m],
+                    callNs, callNs - overheadNs, overheadNs, budgetFraction * 100);
+            json.append(m > 0 ? "," : "").append("{\"model\":").append(quote(models[m]));
+            json.append(",\"frameMs\":").append(fmt(frameMs[m]));
+            json.append(",\"callsPerFrame\":").append(calls);
+            json.append(",\"callNs\":").append(fmt(callNs));
+            json.append(",\"overheadNs\":").append(fmt(overheadNs));
+            json.append(",\"overheadBudgetFraction\":").append(budgetFraction);
+            json.append('}');
+        }
+        json.append(']');
+    }
+
+    private static String fmt(double value) {
+        return String.format(Locale.ROOT, "%.1f", value);
+    }
+
+    private static String quote(String value) {
+        return '"' + value.replace("\\", "\\\\").replace("\"", "\\\"") + '"';
+    }
+}
@@ -0,0 +1,60 @@
+package com.poise.android.jnibench;
+
+/** Benchmark-only natives from jni_overhead.cpp. */
+final class Overhead {
+    // Must match enum Op in jni_overhead.cpp
+    static final int OP_LEGACY_PRE = 0;
+    static final int OP_LEGACY_VAD = 1;
+    static final int OP_LEGACY_POST = 2;
+    static final int OP_STFT_ANALYZE = 3;
+    static final int OP_STFT_SYNTHESIZE = 4;
+    static final int OP_CASCADE_MIX = 5;
+    static final int OP_IDLE_OBSERVE = 6;
+    static final int OP_PLAYOUT_CYCLE = 7;
+    static final int OP_STATE_STORE = 8;
+    static final int OP_STATE_LOAD = 9;
+    static final int NUM_OPS = 10;
+
+    static final String[] OP_NAMES = {
+        "legacy_pre",
+        "legacy_vad",
+        "legacy_post",
+        "stft_analyze",
+        "stft_synthesize",
+        "cascade_mix",
+        "idle_observe",
+        "playout_cycle",
+        "state_store",
+        "state_load"
+    };
+
+    private Overhead() {}
+
+    static native long nativeCreateFixture(int stateFormat);
+
+    static native void nativeDestroyFixture(long fixture);
+
+    static native int nativeInputSize(int op);
+
+    static native int nativeOutputSize(int op);
+
+    static native int nativeNeuralVadParams();
+
+    static native void nativeEmpty();
+
+    static native float[] nativeNewFloatArray(int count);
+
+    /** @return nanoseconds per op, run in a native loop */
+    static native double nativeRaw(long fixture, int op, int iterations);
+
+    /** @return nanoseconds per mutex lock plus handle-map find */
+    static native double nativeLookup(int iterations);
+
+    static native boolean nativeCopy(long fixture, int op, float[] in, float[] out);
+
+    static native boolean nativeCritical(long fixture, int op, float[] in, float[] out);
+
+    /** Direct FloatBuffers holding frames consecutive frames. */
+    static native boolean nativeDirect(
+            long fixture, int op, java.nio.FloatBuffer in, java.nio.FloatBuffer out, int frames);
+}
@@ -0,0 +1,196 @@
+/**
+ * JNI Overhead Benchmark - Host Shim
+ *
+ * Benchmark-only natives linked next to jni_bridge.cpp in the host build of
+ * poise_native. They run the work behind each per-frame entry point
+ * (bench_ops.h) without crossing JNI (raw), and behind leaner marshalling
+ * variants, so the harness can split an entry point's cost into work and
+ * boundary crossing:
+ *
+ *   copy      Get/SetFloatArrayRegion into preallocated native buffers,
+ *             output written into a caller-owned array
+ *   critical  GetPrimitiveArrayCritical on both arrays, no copies
+ *   direct    GetDirectBufferAddress on direct FloatBuffers
+ *   batched   direct buffers carrying several frames per call
+ *
+ * None of the variants take a handle-map lock; the fixture pointer is passed
+ * as the handle.
+ */
+
+#include "bench_ops.h"
+#include "neural_vad.h"
+#include <jni.h>
+
+using namespace jnibench;
+
+namespace {
+
+Fixture *fixtureFrom(jlong handle) {
+  return reinterpret_cast<Fixture *>(handle);
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_com_poise_android_jnibench_Overhead_nativeCreateFixture(JNIEnv *env,
+                                                             jclass clazz,
+                                                             jint format) {
+  auto *fixture = new Fixture(static_cast<poise::StateFormat>(format));
+  return reinterpret_cast<jlong>(fixture);
+}
+
+JNIEXPORT void JNICALL
+Java_com_poise_android_jnibench_Overhead_nativeDestroyFixture(JNIEnv *env,
+                                                              jclass clazz,
+                                                              jlong fixture) {
+  delete fixtureFrom(fixture);
+}
+
+JNIEXPORT jint JNICALL Java_com_poise_android_jnibench_Overhead_nativeInputSize(
+    JNIEnv *env, jclass clazz, jint op) {
+  return validOp(op) ? SHAPES[op].in : 0;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_poise_android_jnibench_Overhead_nativeOutputSize(JNIEnv *env,
+                                                          jclass clazz,
+                                                          jint op) {
+  return validOp(op) ? SHAPES[op].out : 0;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_poise_android_jnibench_Overhead_nativeNeuralVadParams(JNIEnv *env,
+                                                               jclass clazz) {
+  return poise::NeuralVad::PARAM_COUNT;
+}
+
+/**
+ * Does nothing: the bare Java -> native -> Java transition.
+ */
+JNIEXPORT void JNICALL Java_com_poise_android_jnibench_Overhead_nativeEmpty(
+    JNIEnv *env, jclass clazz) {}
+
+/**
+ * Allocate and return a float[count], as entry points returning frames do.
+ */
+JNIEXPORT jfloatArray JNICALL
+Java_com_poise_android_jnibench_Overhead_nativeNewFloatArray(JNIEnv *env,
+                                                             jclass clazz,
+                                                             jint count) {
+  return env->NewFloatArray(count);
+}
+
+/**
+ * Run op iterations times without leaving native code.
+ * @return Nanoseconds per call
+ */
+JNIEXPORT jdouble JNICALL Java_com_poise_android_jnibench_Overhead_nativeRaw(
+    JNIEnv *env, jclass clazz, jlong handle, jint op, jint iterations) {
+  Fixture *f = fixtureFrom(handle);
+  if (f == nullptr || !validOp(op) || iterations <= 0) {
+    return 0.0;
+  }
+  int64_t start = nowNs();
+  for (int i = 0; i < iterations; i++) {
+    runOp(*f, op, f->in.data(), f->out.data());
+  }
+  return static_cast<double>(nowNs() - start) / iterations;
+}
+
+/**
+ * Lock a mutex and find a handle in an unordered_map, as every bridge entry
+ * point does before its work.
+ * @return Nanoseconds per lookup
+ */
+JNIEXPORT jdouble JNICALL Java_com_poise_android_jnibench_Overhead_nativeLookup(
+    JNIEnv *env, jclass clazz, jint iterations) {
+  return timeHandleLookup(iterations);
+}
+
+/**
+ * Copy variant: in is copied into native memory, out is written back into a
+ * caller-owned array. No per-call allocation.
+ */
+JNIEXPORT jboolean JNICALL Java_com_poise_android_jnibench_Overhead_nativeCopy(
+    JNIEnv *env, jclass clazz, jlong handle, jint op, jfloatArray in,
+    jfloatArray out) {
+  Fixture *f = fixtureFrom(handle);
+  if (f == nullptr || !validOp(op) ||
+      env->GetArrayLength(in) < SHAPES[op].in ||
+      env->GetArrayLength(out) < SHAPES[op].out) {
+    return JNI_FALSE;
+  }
+  if (SHAPES[op].in > 0) {
+    env->GetFloatArrayRegion(in, 0, SHAPES[op].in, f->in.data());
+  }
+  runOp(*f, op, f->in.data(), f->out.data());
+  if (SHAPES[op].out > 0) {
+    env->SetFloatArrayRegion(out, 0, SHAPES[op].out, f->out.data());
+  }
+  return JNI_TRUE;
+}
+
+/**
+ * Critical variant: both arrays are pinned (or copied, at the VM's choice)
+ * for the duration of the op.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_jnibench_Overhead_nativeCritical(JNIEnv *env,
+                                                        jclass clazz,
+                                                        jlong handle, jint op,
+                                                        jfloatArray in,
+                                                        jfloatArray out) {
+  Fixture *f = fixtureFrom(handle);
+  if (f == nullptr || !validOp(op) ||
+      env->GetArrayLength(in) < SHAPES[op].in ||
+      env->GetArrayLength(out) < SHAPES[op].out) {
+    return JNI_FALSE;
+  }
+  auto *inData =
+      static_cast<float *>(env->GetPrimitiveArrayCritical(in, nullptr));
+  auto *outData =
+      static_cast<float *>(env->GetPrimitiveArrayCritical(out, nullptr));
+  if (inData != nullptr && outData != nullptr) {
+    runOp(*f, op, inData, outData);
+  }
+  if (outData != nullptr) {
+    env->ReleasePrimitiveArrayCritical(out, outData, 0);
+  }
+  if (inData != nullptr) {
+    env->ReleasePrimitiveArrayCritical(in, inData, JNI_ABORT);
+  }
+  return inData != nullptr && outData != nullptr ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Batched variant: frames consecutive frames per call from direct buffers.
+ * frames = 1 is the direct-buffer variant.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_poise_android_jnibench_Overhead_nativeDirect(JNIEnv *env,
+                                                      jclass clazz,
+                                                      jlong handle, jint op,
+                                                      jobject in, jobject out,
+                                                      jint frames) {
+  Fixture *f = fixtureFrom(handle);
+  if (f == nullptr || !validOp(op) || frames <= 0) {
+    return JNI_FALSE;
+  }
+  auto *inData = static_cast<float *>(env->GetDirectBufferAddress(in));
+  auto *outData = static_cast<float *>(env->GetDirectBufferAddress(out));
+  jlong inFloats = env->GetDirectBufferCapacity(in);
+  jlong outFloats = env->GetDirectBufferCapacity(out);
+  if (inData == nullptr || outData == nullptr ||
+      inFloats < static_cast<jlong>(SHAPES[op].in) * frames ||
+      outFloats < static_cast<jlong>(SHAPES[op].out) * frames) {
+    return JNI_FALSE;
+  }
+  for (int i = 0; i < frames; i++) {
+    runOp(*f, op, inData + i * SHAPES[op].in, outData + i * SHAPES[op].out);
+  }
+  return JNI_TRUE;
+}
+
+} // extern "C"
@@ -0,0 +1,100 @@
+/**
+ * JNI Overhead Benchmark - Native Baseline
+ *
+ * The raw half of the JNI report without a JVM: every op in bench_ops.h and
+ * the handle-map lookup, timed in a native loop exactly as nativeRaw and
+ * nativeLookup time them (one warm-up round, median of seven). The JVM
+ * crossing and marshalling costs still need run_jni_bench.
+ *
+ * Usage:
+ *   native_baseline [report.json] [iterations]
+ *
+ * Writes to stdout when no report path is given.
+ */
+
+#include "async_log.h"
+#include "bench_ops.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace jnibench;
+
+namespace {
+
+constexpr int ROUNDS = 7;
+
+template <typename Fn> double medianNs(Fn &&timeRound) {
+  timeRound();
+  double rounds[ROUNDS];
+  for (double &round : rounds) {
+    round = timeRound();
+  }
+  std::sort(rounds, rounds + ROUNDS);
+  return rounds[ROUNDS / 2];
+}
+
+double rawNs(Fixture &f, int op, int iterations) {
+  return medianNs([&] {
+    int64_t start = nowNs();
+    for (int i = 0; i < iterations; i++) {
+      runOp(f, op, f.in.data(), f.out.data());
+    }
+    return static_cast<double>(nowNs() - start) / iterations;
+  });
+}
+
+const char *arch() {
+#if defined(__aarch64__)
+  return "aarch64";
+#elif defined(__arm__)
+  return "arm";
+#elif defined(__x86_64__)
+  return "x86_64";
+#else
+  return "unknown";
+#endif
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  const char *reportPath = argc > 1 ? argv[1] : nullptr;
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 20000;
+  if (iterations <= 0) {
+    std::fprintf(stderr, "usage: native_baseline [report.json] [iterations]\n");
+    return 2;
+  }
+  poise::AsyncLog::setMinLevel(poise::LOG_WARN);
+
+  Fixture fixture(poise::StateFormat::FP16);
+  std::string json = "{\"benchmark\":\"jni_overhead_native\"";
+  json += ",\"arch\":\"" + std::string(arch()) + "\"";
+  json += ",\"iterations\":" + std::to_string(iterations);
+
+  char number[32];
+  double lookup = medianNs([&] { return timeHandleLookup(iterations); });
+  std::snprintf(number, sizeof(number), "%.1f", lookup);
+  json += ",\"lookupNs\":" + std::string(number);
+
+  json += ",\"rawNs\":{";
+  for (int op = 0; op < NUM_OPS; op++) {
+    std::snprintf(number, sizeof(number), "%.1f",
+                  rawNs(fixture, op, iterations));
+    json += op > 0 ? "," : "";
+    json += "\"" + std::string(SHAPES[op].name) + "\":" + number;
+  }
+  json += "}}\n";
+
+  FILE *out = reportPath != nullptr ? std::fopen(reportPath, "w") : stdout;
+  if (out == nullptr) {
+    std::perror(reportPath);
+    return 1;
+  }
+  std::fputs(json.c_str(), out);
+  if (out != stdout) {
+    std::fclose(out);
+  }
+  return 0;
+}
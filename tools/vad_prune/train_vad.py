@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""Train the neural VAD gate and export it in the NeuralVad weight layout.
+
+The network is the one neural_vad.cpp runs: NUM_BANDS features -> dense
+HIDDEN (tanh) -> GRU HIDDEN -> dense 1 (sigmoid). Features come from
+vad_features, so they are computed by the shipped code, not re-implemented
+here.
+
+    train_vad.py train <prefix> <out.bin> [--epochs N] [--checkpoint model.pt]
+    train_vad.py export <model.pt> <out.bin>
+
+<prefix> is the output prefix given to vad_features. Every export is read
+back and run through a plain-Python copy of the native GRU step on held-out
+clips; the export fails if it disagrees with PyTorch, so a layout change on
+either side cannot ship silently.
+
+Needs PyTorch.
+"""
+
+import argparse
+import math
+import random
+import struct
+import sys
+from array import array
+
+import torch
+from torch import nn
+
+NUM_BANDS = 16
+HIDDEN = 24
+# Flat NeuralVad layout (neural_vad.h): the GRU blocks are PyTorch's own
+# weight_ih_l0, weight_hh_l0, bias_ih_l0, bias_hh_l0 (gates r, z, n)
+LAYOUT = [
+    ("inp.weight", (HIDDEN, NUM_BANDS)),
+    ("inp.bias", (HIDDEN,)),
+    ("gru.weight_ih_l0", (3 * HIDDEN, HIDDEN)),
+    ("gru.weight_hh_l0", (3 * HIDDEN, HIDDEN)),
+    ("gru.bias_ih_l0", (3 * HIDDEN,)),
+    ("gru.bias_hh_l0", (3 * HIDDEN,)),
+    ("out.weight", (1, HIDDEN)),
+    ("out.bias", (1,)),
+]
+PARAM_COUNT = sum(math.prod(shape) for _, shape in LAYOUT)
+# Largest |p_torch - p_native| the export check accepts
+EXPORT_TOLERANCE = 1e-4
+
+
+class NeuralVadNet(nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.inp = nn.Linear(NUM_BANDS, HIDDEN)
+        self.gru = nn.GRU(HIDDEN, HIDDEN, batch_first=True)
+        self.out = nn.Linear(HIDDEN, 1)
+
+    def forward(self, features):
+        hidden, _ = self.gru(torch.tanh(self.inp(features)))
+        return self.out(hidden).squeeze(-1)  # Logits per frame
+
+
+def load_clips(prefix):
+    features = array("f")
+    with open(prefix + ".features", "rb") as f:
+        features.frombytes(f.read())
+    if sys.byteorder != "little":
+        features.byteswap()
+    with open(prefix + ".labels", "rb") as f:
+        labels = f.read()
+    with open(prefix + ".clips") as f:
+        lengths = [int(line) for line in f if line.strip()]
+    if len(features) != NUM_BANDS * len(labels) or sum(lengths) != len(labels):
+        sys.exit(f"{prefix}.*: features, labels and clips do not match")
+
+    all_x = torch.tensor(features, dtype=torch.float32).view(-1, NUM_BANDS)
+    all_y = torch.tensor(list(labels), dtype=torch.float32)
+    clips, start = [], 0
+    for n in lengths:
+        clips.append((all_x[start:start + n], all_y[start:start + n]))
+        start += n
+    return clips
+
+
+def batches(clips, size, shuffle):
+    order = list(range(len(clips)))
+    if shuffle:
+        random.shuffle(order)
+    for i in range(0, len(order), size):
+        chunk = [clips[j] for j in order[i:i + size]]
+        x = nn.utils.rnn.pad_sequence([c[0] for c in chunk], batch_first=True)
+        y = nn.utils.rnn.pad_sequence([c[1] for c in chunk], batch_first=True)
+        mask = nn.utils.rnn.pad_sequence(
+            [torch.ones(len(c[1])) for c in chunk], batch_first=True)
+        yield x, y, mask
+
+
+def evaluate(model, clips):
+    """Frame accuracy, speech recall and non-speech specificity at p = 0.5."""
+    hits = speech = speech_hits = silence = silence_hits = 0
+    model.eval()
+    with torch.no_grad():
+        for x, y in clips:
+            decision = model(x.unsqueeze(0))[0] > 0
+            truth = y > 0.5
+            hits += (decision == truth).sum().item()
+            speech += truth.sum().item()
+            speech_hits += (decision & truth).sum().item()
+            silence += (~truth).sum().item()
+            silence_hits += (~decision & ~truth).sum().item()
+    frames = max(1, speech + silence)
+    return (hits / frames, speech_hits / max(1, speech),
+            silence_hits / max(1, silence))
+
+
+def train(args):
+    torch.manual_seed(args.seed)
+    random.seed(args.seed)
+    clips = load_clips(args.prefix)
+    # Every tenth clip is held out (the first, for tiny sets)
+    if len(clips) >= 10:
+        held_out = clips[::10]
+        training = [c for i, c in enumerate(clips) if i % 10]
+    else:
+        held_out, training = clips[:1], clips[1:] or clips
+
+    speech = sum(c[1].sum().item() for c in training)
+    frames = sum(len(c[1]) for c in training)
+    pos_weight = torch.tensor((frames - speech) / max(1.0, speech))
+    loss_fn = nn.BCEWithLogitsLoss(pos_weight=pos_weight, reduction="none")
+
+    model = NeuralVadNet()
+    optimizer = torch.optim.Adam(model.parameters(), lr=args.lr)
+    for epoch in range(args.epochs):
+        model.train()
+        total = 0.0
+        for x, y, mask in batches(training, args.batch, shuffle=True):
+            loss = (loss_fn(model(x), y) * mask).sum() / mask.sum()
+            optimizer.zero_grad()
+            loss.backward()
+            nn.utils.clip_grad_norm_(model.parameters(), 1.0)
+            optimizer.step()
+            total += loss.item()
+        accuracy, recall, specificity = evaluate(model, held_out)
+        print(f"epoch {epoch + 1:3d}  loss {total:8.3f}  held-out accuracy "
+              f"{accuracy:.3f}, speech {recall:.3f}, non-speech "
+              f"{specificity:.3f}")
+
+    if args.checkpoint:
+        torch.save(model.state_dict(), args.checkpoint)
+    export(model, args.out, held_out)
+
+
+def flatten(model):
+    state = model.state_dict()
+    values = []
+    for name, shape in LAYOUT:
+        tensor = state[name]
+        if tuple(tensor.shape) != shape:
+            sys.exit(f"{name}: shape {tuple(tensor.shape)}, expected {shape}")
+        values.extend(tensor.detach().cpu().reshape(-1).tolist())
+    assert len(values) == PARAM_COUNT
+    return values
+
+
+def native_probabilities(weights, x):
+    """neural_vad.cpp's forward pass, step by step, on flat weights."""
+    pos = 0
+
+    def take(n):
+        nonlocal pos
+        pos += n
+        return weights[pos - n:pos]
+
+    in_w, in_b = take(HIDDEN * NUM_BANDS), take(HIDDEN)
+    wx, wh = take(3 * HIDDEN * HIDDEN), take(3 * HIDDEN * HIDDEN)
+    bx, bh = take(3 * HIDDEN), take(3 * HIDDEN)
+    out_w, out_b = take(HIDDEN), take(1)
+
+    def matvec(w, b, v, rows, cols):
+        return [b[r] + sum(w[r * cols + c] * v[c] for c in range(cols))
+                for r in range(rows)]
+
+    def sigmoid(v):
+        return 1.0 / (1.0 + math.exp(-v))
+
+    h = [0.0] * HIDDEN
+    probs = []
+    for frame in x.tolist():
+        inp = [math.tanh(v)
+               for v in matvec(in_w, in_b, frame, HIDDEN, NUM_BANDS)]
+        gx = matvec(wx, bx, inp, 3 * HIDDEN, HIDDEN)
+        gh = matvec(wh, bh, h, 3 * HIDDEN, HIDDEN)
+        for i in range(HIDDEN):
+            r = sigmoid(gx[i] + gh[i])
+            z = sigmoid(gx[HIDDEN + i] + gh[HIDDEN + i])
+            n = math.tanh(gx[2 * HIDDEN + i] + r * gh[2 * HIDDEN + i])
+            h[i] = (1.0 - z) * n + z * h[i]
+        logit = out_b[0] + sum(out_w[i] * h[i] for i in range(HIDDEN))
+        probs.append(sigmoid(logit))
+    return probs
+
+
+def export(model, path, check_clips):
+    values = flatten(model)
+    with open(path, "wb") as f:
+        f.write(struct.pack(f"<{PARAM_COUNT}f", *values))
+
+    with open(path, "rb") as f:
+        weights = list(struct.unpack(f"<{PARAM_COUNT}f", f.read()))
+    model.eval()
+    error = 0.0
+    with torch.no_grad():
+        for x, _ in check_clips[:2]:
+            x = x[:200]
+            reference = torch.sigmoid(model(x.unsqueeze(0))[0]).tolist()
+            native = native_probabilities(weights, x)
+            error = max([error] + [abs(a - b)
+                                   for a, b in zip(reference, native)])
+    if error > EXPORT_TOLERANCE:
+        sys.exit(f"{path}: native step differs from PyTorch by {error:.2e}")
+    print(f"wrote {path}: {PARAM_COUNT} float32 weights "
+          f"(native check max |dp| {error:.1e})")
+
+
+def export_checkpoint(args):
+    model = NeuralVadNet()
+    model.load_state_dict(torch.load(args.checkpoint, map_location="cpu"))
+    # Without clips, check on random features
+    torch.manual_seed(0)
+    export(model, args.out, [(torch.randn(200, NUM_BANDS), None)])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    p = commands.add_parser("train", help="train on vad_features output")
+    p.add_argument("prefix")
+    p.add_argument("out")
+    p.add_argument("--epochs", type=int, default=40)
+    p.add_argument("--batch", type=int, default=16)
+    p.add_argument("--lr", type=float, default=3e-3)
+    p.add_argument("--seed", type=int, default=1)
+    p.add_argument("--checkpoint", help="also save the PyTorch state_dict")
+    p.set_defaults(run=train)
+
+    p = commands.add_parser("export", help="export a saved state_dict")
+    p.add_argument("checkpoint")
+    p.add_argument("out")
+    p.set_defaults(run=export_checkpoint)
+
+    args = parser.parse_args()
+    args.run(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,229 @@
+/**
+ * Neural VAD Training Feature Dump
+ *
+ * Builds a labelled training set for the neural VAD gate from clean speech
+ * and noise recordings. Every speech clip is padded with a second of
+ * silence on both sides, mixed with a noise clip (taken in turn, looped)
+ * at a random SNR, analyzed with the shipped STFT and run through
+ * NeuralVad::computeFeatures, so the features are exactly what the gate
+ * sees on device. A frame is labelled speech when the clean speech in its
+ * analysis window is within --active-range dB of the clip's loudest frame.
+ *
+ * Usage:
+ *   vad_features <out-prefix> [options] --speech <a.wav>... --noise <n.wav>...
+ *     --snr-min DB       Lowest mixing SNR (default -5)
+ *     --snr-max DB       Highest mixing SNR (default 20)
+ *     --active-range DB  Speech label range below the loudest frame
+ *                        (default 35)
+ *     --seed N           Mixing seed (default 1)
+ *
+ * Writes <out-prefix>.features (float32 LE, NUM_BANDS per frame),
+ * <out-prefix>.labels (one byte per frame, 1 = speech) and
+ * <out-prefix>.clips (frames per clip, one per line; the gate's state
+ * starts from zero at each clip). train_vad.py trains on these.
+ */
+
+#include "async_log.h"
+#include "neural_vad.h"
+#include "stft.h"
+#include "wav_io.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using poise::NeuralVad;
+using poise::STFTProcessor;
+using vadtools::SAMPLE_RATE;
+
+namespace {
+
+constexpr int HOP = STFTProcessor::HOP_SIZE;
+constexpr int FFT_SIZE = STFTProcessor::FFT_SIZE;
+constexpr int NUM_BINS = STFTProcessor::NUM_BINS;
+constexpr int BANDS = NeuralVad::NUM_BANDS;
+
+// Silence around each utterance, so every clip has non-speech frames
+constexpr int PAD_SAMPLES = SAMPLE_RATE;
+// Frames quieter than this are never speech, however quiet the clip
+constexpr float MIN_ACTIVE_DB = -60.0f;
+
+struct Options {
+  float snrMinDb = -5.0f;
+  float snrMaxDb = 20.0f;
+  float activeRangeDb = 35.0f;
+  unsigned seed = 1;
+};
+
+float powerDb(const float *x, int count) {
+  double sum = 0.0;
+  for (int i = 0; i < count; i++) {
+    sum += static_cast<double>(x[i]) * x[i];
+  }
+  return 10.0f * std::log10(static_cast<float>(sum / std::max(1, count)) +
+                            1e-12f);
+}
+
+// Clean speech power of the analysis window that ends at frame f's hop
+std::vector<float> frameLevels(const std::vector<float> &speech, int frames) {
+  std::vector<float> levels(frames);
+  for (int f = 0; f < frames; f++) {
+    int end = (f + 1) * HOP;
+    int start = std::max(0, end - FFT_SIZE);
+    levels[f] = powerDb(speech.data() + start, end - start);
+  }
+  return levels;
+}
+
+bool writeFile(const std::string &path, const void *data, size_t bytes) {
+  FILE *f = std::fopen(path.c_str(), "wb");
+  if (!f) {
+    return false;
+  }
+  bool ok = std::fwrite(data, 1, bytes, f) == bytes;
+  return std::fclose(f) == 0 && ok;
+}
+
+void usage() {
+  std::fprintf(stderr,
+               "usage: vad_features <out-prefix> [--snr-min DB] "
+               "[--snr-max DB] [--active-range DB] [--seed N] "
+               "--speech <clip.wav>... --noise <clip.wav>...\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  if (argc < 6) {
+    usage();
+    return 2;
+  }
+  poise::AsyncLog::setMinLevel(poise::LOG_WARN);
+
+  std::string prefix = argv[1];
+  Options options;
+  std::vector<const char *> speechPaths;
+  std::vector<const char *> noisePaths;
+  std::vector<const char *> *list = nullptr;
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--snr-min" && hasValue) {
+      options.snrMinDb = std::strtof(argv[++i], nullptr);
+    } else if (arg == "--snr-max" && hasValue) {
+      options.snrMaxDb = std::strtof(argv[++i], nullptr);
+    } else if (arg == "--active-range" && hasValue) {
+      options.activeRangeDb = std::strtof(argv[++i], nullptr);
+    } else if (arg == "--seed" && hasValue) {
+      options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--speech") {
+      list = &speechPaths;
+    } else if (arg == "--noise") {
+      list = &noisePaths;
+    } else if (arg.rfind("--", 0) == 0 || list == nullptr) {
+      usage();
+      return 2;
+    } else {
+      list->push_back(argv[i]);
+    }
+  }
+  if (speechPaths.empty() || noisePaths.empty() ||
+      options.snrMaxDb < options.snrMinDb) {
+    usage();
+    return 2;
+  }
+
+  std::vector<std::vector<float>> noises;
+  for (const char *path : noisePaths) {
+    std::vector<float> noise;
+    if (!vadtools::readClip(path, noise) || noise.empty()) {
+      std::fprintf(stderr, "%s: not a readable WAV clip\n", path);
+      return 1;
+    }
+    noises.push_back(std::move(noise));
+  }
+
+  std::mt19937 rng(options.seed);
+  std::uniform_real_distribution<float> snrDb(options.snrMinDb,
+                                              options.snrMaxDb);
+  std::vector<float> features;
+  std::vector<uint8_t> labels;
+  std::string clips;
+  int64_t speechFrames = 0;
+
+  for (size_t c = 0; c < speechPaths.size(); c++) {
+    std::vector<float> utterance;
+    if (!vadtools::readClip(speechPaths[c], utterance)) {
+      std::fprintf(stderr, "%s: not a readable WAV clip\n", speechPaths[c]);
+      return 1;
+    }
+    std::vector<float> speech(PAD_SAMPLES, 0.0f);
+    speech.insert(speech.end(), utterance.begin(), utterance.end());
+    speech.resize(speech.size() + PAD_SAMPLES, 0.0f);
+    int frames = static_cast<int>(speech.size()) / HOP;
+
+    // Labels from the clean speech, relative to its loudest frame
+    std::vector<float> levels = frameLevels(speech, frames);
+    float peakDb = *std::max_element(levels.begin(), levels.end());
+    float activeDb = std::max(MIN_ACTIVE_DB, peakDb - options.activeRangeDb);
+    int active = 0;
+    double activePower = 0.0;
+    for (float level : levels) {
+      if (level >= activeDb) {
+        active++;
+        activePower += std::pow(10.0, level / 10.0);
+      }
+    }
+    if (active == 0) {
+      std::fprintf(stderr, "%s: no speech above %.0f dBFS, skipped\n",
+                   speechPaths[c], MIN_ACTIVE_DB);
+      continue;
+    }
+
+    // SNR against the power of the active speech frames only
+    float speechDb =
+        10.0f * std::log10(static_cast<float>(activePower / active));
+    const std::vector<float> &noise = noises[c % noises.size()];
+    float noiseDb = powerDb(noise.data(), static_cast<int>(noise.size()));
+    float gain = std::pow(10.0f, (speechDb - snrDb(rng) - noiseDb) / 20.0f);
+    size_t offset = rng() % noise.size();
+    std::vector<float> mix(speech.size());
+    for (size_t i = 0; i < mix.size(); i++) {
+      mix[i] = speech[i] + gain * noise[(offset + i) % noise.size()];
+    }
+
+    STFTProcessor stft;
+    NeuralVad vad(SAMPLE_RATE, FFT_SIZE);
+    float real[NUM_BINS];
+    float imag[NUM_BINS];
+    float frame[BANDS];
+    for (int f = 0; f < frames; f++) {
+      stft.computeSTFT(mix.data() + f * HOP, real, imag);
+      vad.computeFeatures(real, imag, NUM_BINS, frame);
+      features.insert(features.end(), frame, frame + BANDS);
+      labels.push_back(levels[f] >= activeDb ? 1 : 0);
+    }
+    speechFrames += active;
+    clips += std::to_string(frames) + "\n";
+  }
+
+  if (labels.empty()) {
+    std::fprintf(stderr, "no usable speech clips\n");
+    return 1;
+  }
+  if (!writeFile(prefix + ".features", features.data(),
+                 features.size() * sizeof(float)) ||
+      !writeFile(prefix + ".labels", labels.data(), labels.size()) ||
+      !writeFile(prefix + ".clips", clips.data(), clips.size())) {
+    std::fprintf(stderr, "%s.*: write failed\n", prefix.c_str());
+    return 1;
+  }
+  std::printf("%zu frames (%.1f s), %.1f%% speech, %d bands\n", labels.size(),
+              labels.size() * HOP / static_cast<double>(SAMPLE_RATE),
+              100.0 * speechFrames / labels.size(), BANDS);
+  return 0;
+}
@@ -0,0 +1,444 @@
+/**
+ * Neural VAD Block Pruning Tool
+ *
+ * Prunes the three weight matrices of the neural VAD gate (input
+ * projection, GRU input and recurrent weights) in whole 4x4 or 1x8 blocks,
+ * lowest L2 norm first, so the gate runs on the block-sparse kernels.
+ *
+ * The quality gate is agreement with the dense model on real audio: every
+ * clip is analyzed with the shipped STFT and run through both gates, and a
+ * pruning passes while the fraction of frames whose speech decision flips
+ * and the mean probability error stay within bounds. The per-layer block
+ * norm thresholds are tuned against that gate: first the largest uniform
+ * sparsity up to the target that passes, then each layer on its own is
+ * pushed further toward the target while the gate still passes (the input
+ * side usually tolerates more than the recurrent weights).
+ *
+ * Usage:
+ *   vad_prune <dense.bin> <out.bin> [options] <clip.wav>...
+ *     --sparsity S       Target fraction of weights removed (default 0.6)
+ *     --shape 4x4|1x8    Block shape (default 4x4)
+ *     --max-flips F      Max fraction of frames whose decision changes
+ *                        (default 0.01)
+ *     --max-prob-error E Max mean |p - p_dense| (default 0.02)
+ *
+ * Weights are flat little-endian float32 in the NeuralVad layout (the app
+ * asset format); the output is the same layout with pruned blocks zeroed,
+ * so it loads anywhere the dense file does. Clips are mono or stereo WAV,
+ * 16-bit PCM or float, at any rate (converted to 16 kHz).
+ *
+ * The app ships no gate weights, so the sparse kernels only run in builds
+ * that bundle this tool's output as assets/neural_vad.bin.
+ */
+
+#include "async_log.h"
+#include "block_sparse.h"
+#include "neural_vad.h"
+#include "stft.h"
+#include "wav_io.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using poise::BlockShape;
+using poise::BlockSparseMatrix;
+using poise::NeuralVad;
+using poise::STFTProcessor;
+
+namespace {
+
+using vadtools::SAMPLE_RATE;
+constexpr int HOP = STFTProcessor::HOP_SIZE;
+constexpr int NUM_BINS = STFTProcessor::NUM_BINS;
+constexpr int HIDDEN = NeuralVad::HIDDEN;
+constexpr int BANDS = NeuralVad::NUM_BANDS;
+
+// Bisection steps for each threshold search
+constexpr int SEARCH_STEPS = 8;
+// Timing runs over all frames until at least this long
+constexpr double MIN_TIMING_SECONDS = 1.0;
+
+struct Layer {
+  const char *name;
+  int offset; // Into the flat weights
+  int rows;
+  int cols;
+};
+
+// Matrices of the NeuralVad layout (see neural_vad.h)
+const Layer LAYERS[] = {
+    {"in", 0, HIDDEN, BANDS},
+    {"gru_x", HIDDEN * BANDS + HIDDEN, 3 * HIDDEN, HIDDEN},
+    {"gru_h", HIDDEN * BANDS + HIDDEN + 3 * HIDDEN * HIDDEN, 3 * HIDDEN,
+     HIDDEN},
+};
+constexpr int NUM_LAYERS = sizeof(LAYERS) / sizeof(LAYERS[0]);
+
+struct Clip {
+  std::string name;
+  std::vector<float> real; // frames x NUM_BINS
+  std::vector<float> imag;
+  int frames = 0;
+};
+
+struct Options {
+  float sparsity = 0.6f;
+  BlockShape shape = BlockShape::B4X4;
+  float maxFlips = 0.01f;
+  float maxProbError = 0.02f;
+};
+
+struct GateResult {
+  std::vector<float> prob;
+  std::vector<uint8_t> speech;
+};
+
+struct Agreement {
+  float flips = 0.0f;     // Fraction of frames with a different decision
+  float probError = 0.0f; // Mean absolute probability difference
+};
+
+// ============================================================================
+// Input
+// ============================================================================
+
+bool loadClip(const char *path, Clip &clip) {
+  std::vector<float> samples;
+  if (!vadtools::readClip(path, samples)) {
+    return false;
+  }
+
+  STFTProcessor stft;
+  clip.name = path;
+  clip.frames = static_cast<int>(samples.size()) / HOP;
+  clip.real.resize(static_cast<size_t>(clip.frames) * NUM_BINS);
+  clip.imag.resize(clip.real.size());
+  for (int f = 0; f < clip.frames; f++) {
+    stft.computeSTFT(samples.data() + f * HOP, &clip.real[f * NUM_BINS],
+                     &clip.imag[f * NUM_BINS]);
+  }
+  return clip.frames > 0;
+}
+
+// ============================================================================
+// Pruning and the quality gate
+// ============================================================================
+
+void blockDims(BlockShape shape, int &rows, int &cols) {
+  rows = shape == BlockShape::B4X4 ? 4 : 1;
+  cols = shape == BlockShape::B4X4 ? 4 : 8;
+}
+
+/** Zero the lowest-norm blocks of each layer to its target sparsity. */
+std::vector<float> prune(const std::vector<float> &dense, BlockShape shape,
+                         const float *sparsity) {
+  std::vector<float> pruned = dense;
+  int blockRows, blockCols;
+  blockDims(shape, blockRows, blockCols);
+
+  for (int l = 0; l < NUM_LAYERS; l++) {
+    const Layer &layer = LAYERS[l];
+    float *w = pruned.data() + layer.offset;
+    struct Block {
+      float norm;
+      int row;
+      int col;
+    };
+    std::vector<Block> blocks;
+    for (int r = 0; r < layer.rows; r += blockRows) {
+      for (int c = 0; c < layer.cols; c += blockCols) {
+        float sum = 0.0f;
+        for (int i = 0; i < blockRows; i++) {
+          for (int j = 0; j < blockCols; j++) {
+            float v = w[(r + i) * layer.cols + c + j];
+            sum += v * v;
+          }
+        }
+        blocks.push_back({sum, r, c});
+      }
+    }
+    std::sort(blocks.begin(), blocks.end(),
+              [](const Block &a, const Block &b) { return a.norm < b.norm; });
+    int drop = static_cast<int>(sparsity[l] * blocks.size() + 0.5f);
+    for (int b = 0; b < drop; b++) {
+      for (int i = 0; i < blockRows; i++) {
+        float *row = w + (blocks[b].row + i) * layer.cols + blocks[b].col;
+        std::fill(row, row + blockCols, 0.0f);
+      }
+    }
+  }
+  return pruned;
+}
+
+GateResult runGate(const std::vector<float> &weights,
+                   const std::vector<Clip> &clips) {
+  GateResult result;
+  NeuralVad vad(SAMPLE_RATE, STFTProcessor::FFT_SIZE);
+  vad.loadWeights(weights.data(), static_cast<int>(weights.size()));
+  for (const Clip &clip : clips) {
+    vad.reset();
+    for (int f = 0; f < clip.frames; f++) {
+      result.prob.push_back(vad.process(&clip.real[f * NUM_BINS],
+                                        &clip.imag[f * NUM_BINS], NUM_BINS));
+      result.speech.push_back(vad.isSpeech() ? 1 : 0);
+    }
+  }
+  return result;
+}
+
+Agreement compare(const GateResult &reference, const GateResult &result) {
+  Agreement agreement;
+  size_t n = reference.prob.size();
+  if (n == 0) {
+    return agreement;
+  }
+  double flips = 0.0, error = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    flips += reference.speech[i] != result.speech[i];
+    error += std::fabs(reference.prob[i] - result.prob[i]);
+  }
+  agreement.flips = static_cast<float>(flips / n);
+  agreement.probError = static_cast<float>(error / n);
+  return agreement;
+}
+
+struct Search {
+  const std::vector<float> &dense;
+  const std::vector<Clip> &clips;
+  const GateResult &reference;
+  const Options &options;
+  int evaluations = 0;
+
+  bool passes(const float *sparsity, Agreement *out = nullptr) {
+    evaluations++;
+    Agreement a = compare(
+        reference, runGate(prune(dense, options.shape, sparsity), clips));
+    if (out) {
+      *out = a;
+    }
+    return a.flips <= options.maxFlips && a.probError <= options.maxProbError;
+  }
+
+  // Largest value in [lo, hi] for which set(value) passes, given lo passes
+  template <typename Set> float bisect(float lo, float hi, Set set) {
+    float levels[NUM_LAYERS];
+    set(hi, levels);
+    if (passes(levels)) {
+      return hi;
+    }
+    for (int step = 0; step < SEARCH_STEPS; step++) {
+      float mid = 0.5f * (lo + hi);
+      set(mid, levels);
+      if (passes(levels)) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+};
+
+// Seconds per frame of the gate, over every clip frame
+double timeGate(const std::vector<float> &weights,
+                const std::vector<Clip> &clips) {
+  NeuralVad vad(SAMPLE_RATE, STFTProcessor::FFT_SIZE);
+  vad.loadWeights(weights.data(), static_cast<int>(weights.size()));
+  int64_t frames = 0;
+  volatile float sink = 0.0f;
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0.0;
+  while (elapsed < MIN_TIMING_SECONDS) {
+    for (const Clip &clip : clips) {
+      for (int f = 0; f < clip.frames; f++) {
+        sink = sink + vad.process(&clip.real[f * NUM_BINS],
+                                  &clip.imag[f * NUM_BINS], NUM_BINS);
+      }
+      frames += clip.frames;
+    }
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  }
+  return elapsed / frames;
+}
+
+// Seconds per frame of the three matrix products alone
+double timeMatrices(const std::vector<float> &weights) {
+  BlockSparseMatrix matrices[NUM_LAYERS];
+  for (int l = 0; l < NUM_LAYERS; l++) {
+    matrices[l] = BlockSparseMatrix::pack(weights.data() + LAYERS[l].offset,
+                                          LAYERS[l].rows, LAYERS[l].cols);
+  }
+  std::vector<float> x(3 * HIDDEN, 0.5f);
+  std::vector<float> y(3 * HIDDEN, 0.0f);
+  int64_t frames = 0;
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0.0;
+  while (elapsed < MIN_TIMING_SECONDS) {
+    for (int i = 0; i < 10000; i++) {
+      for (const BlockSparseMatrix &m : matrices) {
+        m.multiplyAccumulate(x.data(), y.data());
+      }
+      x[i % HIDDEN] = y[i % HIDDEN] * 1e-3f; // Keep the loop live
+    }
+    frames += 10000;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  }
+  return elapsed / frames;
+}
+
+int matrixMacs(const std::vector<float> &weights) {
+  NeuralVad vad(SAMPLE_RATE, STFTProcessor::FFT_SIZE);
+  vad.loadWeights(weights.data(), static_cast<int>(weights.size()));
+  return vad.matrixMacs();
+}
+
+void usage() {
+  std::fprintf(stderr,
+               "usage: vad_prune <dense.bin> <out.bin> [--sparsity S] "
+               "[--shape 4x4|1x8] [--max-flips F] [--max-prob-error E] "
+               "<clip.wav>...\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  if (argc < 4) {
+    usage();
+    return 2;
+  }
+  // Every gate evaluation loads weights; keep its log line out of the report
+  poise::AsyncLog::setMinLevel(poise::LOG_WARN);
+
+  const char *inputPath = argv[1];
+  const char *outputPath = argv[2];
+  Options options;
+  std::vector<const char *> clipPaths;
+  for (int i = 3; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--sparsity" && hasValue) {
+      options.sparsity =
+          std::clamp(std::strtof(argv[++i], nullptr), 0.0f, 1.0f);
+    } else if (arg == "--shape" && hasValue) {
+      std::string shape = argv[++i];
+      if (shape != "4x4" && shape != "1x8") {
+        usage();
+        return 2;
+      }
+      options.shape = shape == "4x4" ? BlockShape::B4X4 : BlockShape::B1X8;
+    } else if (arg == "--max-flips" && hasValue) {
+      options.maxFlips = std::strtof(argv[++i], nullptr);
+    } else if (arg == "--max-prob-error" && hasValue) {
+      options.maxProbError = std::strtof(argv[++i], nullptr);
+    } else if (arg.rfind("--", 0) == 0) {
+      usage();
+      return 2;
+    } else {
+      clipPaths.push_back(argv[i]);
+    }
+  }
+
+  std::vector<uint8_t> bytes;
+  if (!vadtools::readFile(inputPath, bytes) ||
+      bytes.size() != NeuralVad::PARAM_COUNT * sizeof(float)) {
+    std::fprintf(stderr, "%s: expected %d float32 weights\n", inputPath,
+                 NeuralVad::PARAM_COUNT);
+    return 1;
+  }
+  std::vector<float> dense(NeuralVad::PARAM_COUNT);
+  std::memcpy(dense.data(), bytes.data(), bytes.size());
+
+  std::vector<Clip> clips;
+  int64_t totalFrames = 0;
+  for (const char *path : clipPaths) {
+    Clip clip;
+    if (!loadClip(path, clip)) {
+      std::fprintf(stderr, "%s: not a readable WAV clip\n", path);
+      return 1;
+    }
+    totalFrames += clip.frames;
+    clips.push_back(std::move(clip));
+  }
+  if (clips.empty()) {
+    usage();
+    return 2;
+  }
+  std::printf("%zu clips, %lld frames (%.1f s)\n", clips.size(),
+              static_cast<long long>(totalFrames),
+              totalFrames * HOP / static_cast<double>(SAMPLE_RATE));
+
+  GateResult reference = runGate(dense, clips);
+  Search search{dense, clips, reference, options};
+
+  // Uniform sparsity first, then each layer on its own toward the target
+  float uniform = search.bisect(0.0f, options.sparsity,
+                                [](float s, float *levels) {
+                                  std::fill(levels, levels + NUM_LAYERS, s);
+                                });
+  float levels[NUM_LAYERS];
+  std::fill(levels, levels + NUM_LAYERS, uniform);
+  if (uniform < options.sparsity) {
+    for (int l = 0; l < NUM_LAYERS; l++) {
+      levels[l] = search.bisect(levels[l], options.sparsity,
+                                [&levels, l](float s, float *out) {
+                                  std::copy(levels, levels + NUM_LAYERS, out);
+                                  out[l] = s;
+                                });
+    }
+  }
+
+  Agreement agreement;
+  search.passes(levels, &agreement);
+  std::vector<float> pruned = prune(dense, options.shape, levels);
+
+  FILE *out = std::fopen(outputPath, "wb");
+  if (!out || std::fwrite(pruned.data(), sizeof(float), pruned.size(), out) !=
+                  pruned.size()) {
+    std::fprintf(stderr, "%s: write failed\n", outputPath);
+    if (out) {
+      std::fclose(out);
+    }
+    return 1;
+  }
+  std::fclose(out);
+
+  int denseMacs = matrixMacs(dense);
+  int prunedMacs = matrixMacs(pruned);
+  double denseUs = timeGate(dense, clips) * 1e6;
+  double prunedUs = timeGate(pruned, clips) * 1e6;
+  double denseMatrixUs = timeMatrices(dense) * 1e6;
+  double prunedMatrixUs = timeMatrices(pruned) * 1e6;
+
+  std::printf("shape %s, target %.0f%%, %d gate evaluations\n",
+              poise::blockShapeName(options.shape), options.sparsity * 100.0f,
+              search.evaluations);
+  for (int l = 0; l < NUM_LAYERS; l++) {
+    const Layer &layer = LAYERS[l];
+    float sparsity = BlockSparseMatrix::blockSparsity(
+        pruned.data() + layer.offset, layer.rows, layer.cols, options.shape);
+    std::printf("  %-6s %3dx%-3d %5.1f%% pruned\n", layer.name, layer.rows,
+                layer.cols, sparsity * 100.0f);
+  }
+  std::printf("decision flips %.3f%% (max %.3f%%), mean |dp| %.4f (max %.4f)\n",
+              agreement.flips * 100.0f, options.maxFlips * 100.0f,
+              agreement.probError, options.maxProbError);
+  std::printf("matrix MACs %d -> %d (%.2fx fewer)\n", denseMacs, prunedMacs,
+              prunedMacs > 0 ? static_cast<double>(denseMacs) / prunedMacs
+                             : 0.0);
+  std::printf("matrix time %.3f -> %.3f us/frame (%.2fx)\n", denseMatrixUs,
+              prunedMatrixUs,
+              prunedMatrixUs > 0.0 ? denseMatrixUs / prunedMatrixUs : 0.0);
+  std::printf("gate time %.3f -> %.3f us/frame (%.2fx, features included)\n",
+              denseUs, prunedUs, prunedUs > 0.0 ? denseUs / prunedUs : 0.0);
+  return 0;
+}
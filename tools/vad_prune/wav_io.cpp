@@ -0,0 +1,109 @@
+/**
+ * WAV Input for the VAD Tools - Implementation
+ */
+
+#include "wav_io.h"
+#include "resampler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace vadtools {
+
+namespace {
+
+uint32_t le32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+uint16_t le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+// Mono float samples and their rate; stereo is averaged
+bool readWav(const char *path, std::vector<float> &samples, int &rate) {
+  std::vector<uint8_t> data;
+  if (!readFile(path, data) || data.size() < 12 ||
+      std::memcmp(data.data(), "RIFF", 4) != 0 ||
+      std::memcmp(data.data() + 8, "WAVE", 4) != 0) {
+    return false;
+  }
+  int format = 0, channels = 0, bits = 0;
+  size_t pos = 12;
+  while (pos + 8 <= data.size()) {
+    const uint8_t *chunk = data.data() + pos;
+    size_t size = le32(chunk + 4);
+    size_t body = pos + 8;
+    size = std::min(size, data.size() - body);
+    if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+      format = le16(chunk + 8);
+      channels = le16(chunk + 10);
+      rate = static_cast<int>(le32(chunk + 12));
+      bits = le16(chunk + 22);
+      if (format == 0xFFFE && size >= 26) {
+        format = le16(chunk + 32); // WAVE_FORMAT_EXTENSIBLE subformat
+      }
+    } else if (std::memcmp(chunk, "data", 4) == 0 && channels > 0) {
+      bool pcm16 = format == 1 && bits == 16;
+      bool float32 = format == 3 && bits == 32;
+      if (!pcm16 && !float32) {
+        return false;
+      }
+      size_t frames = size / (channels * bits / 8);
+      samples.assign(frames, 0.0f);
+      const uint8_t *p = data.data() + body;
+      for (size_t i = 0; i < frames; i++) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; c++) {
+          if (pcm16) {
+            sum += static_cast<int16_t>(le16(p)) / 32768.0f;
+            p += 2;
+          } else {
+            uint32_t word = le32(p);
+            float value;
+            std::memcpy(&value, &word, sizeof(value));
+            sum += value;
+            p += 4;
+          }
+        }
+        samples[i] = sum / channels;
+      }
+      return true;
+    }
+    pos = body + size + (size & 1);
+  }
+  return false;
+}
+
+} // anonymous namespace
+
+bool readFile(const char *path, std::vector<uint8_t> &data) {
+  FILE *f = std::fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  std::fseek(f, 0, SEEK_END);
+  long size = std::ftell(f);
+  std::fseek(f, 0, SEEK_SET);
+  data.resize(size > 0 ? size : 0);
+  bool ok = std::fread(data.data(), 1, data.size(), f) == data.size();
+  std::fclose(f);
+  return ok;
+}
+
+bool readClip(const char *path, std::vector<float> &samples) {
+  int rate = 0;
+  if (!readWav(path, samples, rate) || rate <= 0) {
+    return false;
+  }
+  if (rate != SAMPLE_RATE) {
+    poise::CascadeResampler resampler(rate, SAMPLE_RATE);
+    int count = static_cast<int>(samples.size());
+    std::vector<float> converted(resampler.maxOutput(count));
+    converted.resize(resampler.process(samples.data(), count,
+                                       converted.data(),
+                                       static_cast<int>(converted.size())));
+    samples.swap(converted);
+  }
+  return true;
+}
+
+} // namespace vadtools
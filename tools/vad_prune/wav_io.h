@@ -0,0 +1,29 @@
+/**
+ * WAV Input for the VAD Tools - Header
+ *
+ * Just enough WAV reading for training and pruning clips: mono or stereo,
+ * 16-bit PCM or float, at any rate, converted to mono 16 kHz with the
+ * shipped resampler.
+ */
+
+#ifndef VAD_TOOLS_WAV_IO_H
+#define VAD_TOOLS_WAV_IO_H
+
+#include <cstdint>
+#include <vector>
+
+namespace vadtools {
+
+constexpr int SAMPLE_RATE = 16000;
+
+bool readFile(const char *path, std::vector<uint8_t> &data);
+
+/**
+ * Read a clip as mono SAMPLE_RATE samples; stereo is averaged.
+ * @return false if the file is missing or not a supported WAV
+ */
+bool readClip(const char *path, std::vector<float> &samples);
+
+} // namespace vadtools
+
+#endif // VAD_TOOLS_WAV_IO_H